@@ -11,6 +11,7 @@
 
 #include "Aeb.h"
 #include "AebIo.h"
+#include "AppVerify.h"
 #include "AppVersion.h"
 #include "ApplicationServicesImp.h"
 #include "ArgumentList.h"
@@ -22,13 +23,30 @@
 #include "ProgressConsole.h"
 #include "SessionManagerImp.h"
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDirIterator>
 #include <QtCore/QFile>
+#include <QtCore/QProcess>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryFile>
 
+#include <algorithm>
+#include <deque>
+#include <stdlib.h>
 #include <vector>
 using namespace std;
 
+namespace
+{
+   struct BatchJob
+   {
+      string mFilename;
+      QProcess* mpProcess;
+      QTemporaryFile* mpOutput;
+   };
+}
+
 BatchApplication::BatchApplication(QCoreApplication& app) :
    Application(app)
 {
@@ -205,13 +223,35 @@ int BatchApplication::run(int argc, char** argv)
    }
 
    // Perform the batch processing
-   PlugInManagerServicesImp* pManager = PlugInManagerServicesImp::instance();
-   if (pManager != NULL)
+   bool bSuccess = false;
+
+   vector<string> batchFiles;
+   unsigned int jobCount = 1;
+   if (pArgumentList != NULL)
    {
-      pManager->executeStartupPlugIns(mpProgress);
+      batchFiles = pArgumentList->getOptions("input");
+
+      string jobsArg = pArgumentList->getOption("jobs");
+      if (jobsArg.empty() == false && atoi(jobsArg.c_str()) > 1)
+      {
+         jobCount = static_cast<unsigned int>(atoi(jobsArg.c_str()));
+      }
+   }
+
+   if (jobCount > 1 && batchFiles.size() > 1)
+   {
+      bSuccess = executeBatchFilesConcurrently(batchFiles, jobCount, argc, argv);
    }
+   else
+   {
+      PlugInManagerServicesImp* pManager = PlugInManagerServicesImp::instance();
+      if (pManager != NULL)
+      {
+         pManager->executeStartupPlugIns(mpProgress);
+      }
 
-   bool bSuccess = executeStartupBatchWizards();
+      bSuccess = executeStartupBatchWizards();
+   }
 
    // Close the session to cleanup created objects
    SessionManagerImp::instance()->close();
@@ -234,6 +274,111 @@ int BatchApplication::run(int argc, char** argv)
    return -1;
 }
 
+bool BatchApplication::executeBatchFilesConcurrently(const vector<string>& batchFiles, unsigned int jobCount,
+                                                     int argc, char** argv)
+{
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   VERIFY(pArgumentList != NULL);
+
+   // Each batch file is processed by a separate batch process so that the plug-ins
+   // executed for one file never share application state with those of another file
+   string inputOption = pArgumentList->getDelimiter() + "input:";
+   string jobsOption = pArgumentList->getDelimiter() + "jobs:";
+
+   QStringList baseArguments;
+   for (int i = 1; i < argc; ++i)
+   {
+      string argument = argv[i];
+      if (argument.compare(0, inputOption.length(), inputOption) != 0 &&
+         argument.compare(0, jobsOption.length(), jobsOption) != 0)
+      {
+         baseArguments.push_back(QString::fromLocal8Bit(argv[i]));
+      }
+   }
+
+   unsigned int fileCount = batchFiles.size();
+   jobCount = min(jobCount, fileCount);
+
+   // Processes are started in file order and their output is displayed in file order,
+   // so the console output does not depend on which process finishes first.  Each process
+   // writes to its own temporary file instead of a pipe, so that processes which are not
+   // being waited on do not block once a pipe buffer fills up.
+   deque<BatchJob> runningJobs;
+   unsigned int nextFile = 0;
+   unsigned int completedFiles = 0;
+   bool bOverallSuccess = true;
+
+   while (nextFile < fileCount || runningJobs.empty() == false)
+   {
+      while (nextFile < fileCount && runningJobs.size() < jobCount)
+      {
+         BatchJob job;
+         job.mFilename = batchFiles[nextFile++];
+         job.mpProcess = new QProcess();
+         job.mpOutput = new QTemporaryFile();
+         if (job.mpOutput->open())
+         {
+            job.mpOutput->close();
+            job.mpProcess->setStandardOutputFile(job.mpOutput->fileName());
+         }
+
+         job.mpProcess->setProcessChannelMode(QProcess::MergedChannels);
+         job.mpProcess->start(QCoreApplication::applicationFilePath(),
+            QStringList(baseArguments) << QString::fromStdString(inputOption + job.mFilename));
+         runningJobs.push_back(job);
+      }
+
+      BatchJob job = runningJobs.front();
+      runningJobs.pop_front();
+
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("Processing batch file: " + job.mFilename, completedFiles * 100 / fileCount,
+            NORMAL);
+      }
+
+      bool bSuccess = job.mpProcess->waitForStarted(-1) && job.mpProcess->waitForFinished(-1) &&
+         job.mpProcess->exitStatus() == QProcess::NormalExit && job.mpProcess->exitCode() == 0;
+      delete job.mpProcess;
+
+      if (job.mpOutput->open())
+      {
+         QByteArray output = job.mpOutput->readAll();
+         if (output.isEmpty() == false)
+         {
+            cout << output.constData();
+            cout.flush();
+         }
+      }
+
+      delete job.mpOutput;
+      ++completedFiles;
+
+      if (mpProgress != NULL)
+      {
+         if (bSuccess)
+         {
+            mpProgress->updateProgress("Batch file complete: " + job.mFilename, completedFiles * 100 / fileCount,
+               NORMAL);
+         }
+         else
+         {
+            mpProgress->updateProgress("Batch file failed: " + job.mFilename, completedFiles * 100 / fileCount,
+               WARNING);
+         }
+      }
+
+      bOverallSuccess = bOverallSuccess && bSuccess;
+   }
+
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("Processing batch files completed.", 100, NORMAL);
+   }
+
+   return bOverallSuccess;
+}
+
 void BatchApplication::reportWarning(const string& warningMessage) const
 {
    if (warningMessage.empty() == false)
@@ -14,6 +14,7 @@
 #include "SubjectAdapter.h"
 
 #include <string>
+#include <vector>
 
 class BatchApplication : public Application, public SubjectAdapter
 {
@@ -33,6 +34,9 @@ public:
 
 private:
    BatchApplication& operator=(const BatchApplication& rhs);
+
+   bool executeBatchFilesConcurrently(const std::vector<std::string>& batchFiles, unsigned int jobCount,
+      int argc, char** argv);
 };
 
 #endif
@@ -49,6 +49,7 @@ int main(int argc, char** argv)
    pArgumentList->registerOption("input");
    pArgumentList->registerOption("generate");
    pArgumentList->registerOption("processors");
+   pArgumentList->registerOption("jobs");
    pArgumentList->registerOption("version");
    pArgumentList->registerOption("showHiddenExtensions");
    pArgumentList->registerOption("help");
@@ -168,6 +169,7 @@ int main(int argc, char** argv)
       cout << "     " << dlm << "brief                 Displays brief output messages" << endl;
       cout << "     " << dlm << "verybrief             Displays only abort, warning, and error messages" << endl;
       cout << "     " << dlm << "processors            Sets number of available processors" << endl;
+      cout << "     " << dlm << "jobs                  Sets the number of batch files processed at once" << endl;
       //cout << "     " << dlm << "test        Runs a set of operational tests" << endl;
       //cout << "     " << dlm << "testAll     Runs the full set of system tests" << endl;
       cout << "     " << dlm << "showHiddenExtensions  Show hidden extensions when listing installed extensions" << endl;
@@ -0,0 +1,263 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include <iostream>
+
+#include "AppVersion.h"
+#include "ApplicationServicesImp.h"
+#include "ArgumentList.h"
+#include "BenchmarkApplication.h"
+#include "BenchmarkResults.h"
+#include "ConfigurationSettingsImp.h"
+#include "DateTime.h"
+#include "Filename.h"
+#include "GraphicBenchmarks.h"
+#include "InstrumentationImp.h"
+#include "ObjectResource.h"
+#include "PlugInManagerServicesImp.h"
+#include "ProgressBriefConsole.h"
+#include "RasterBenchmarks.h"
+#include "SessionManagerImp.h"
+#include "StringUtilities.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QString>
+
+#include <sstream>
+using namespace std;
+
+BenchmarkApplication::BenchmarkApplication(QCoreApplication& app) :
+   Application(app)
+{
+   if (isXmlInitialized() == false)
+   {
+      reportError("Unable to initialize Xerces/XQilla.");
+      exit(-1);
+   }
+
+   Service<ApplicationServices> pApp;
+   attach(SIGNAL_NAME(Subject, Deleted), Signal(pApp.get(), SIGNAL_NAME(ApplicationServices, ApplicationClosed)));
+}
+
+BenchmarkApplication::~BenchmarkApplication()
+{
+   notify(SIGNAL_NAME(Subject, Deleted));
+}
+
+const string& BenchmarkApplication::getObjectType() const
+{
+   static string sType("BenchmarkApplication");
+   return sType;
+}
+
+bool BenchmarkApplication::isKindOf(const string& className) const
+{
+   if (className == getObjectType())
+   {
+      return true;
+   }
+
+   return SubjectAdapter::isKindOf(className);
+}
+
+int BenchmarkApplication::run(int argc, char** argv)
+{
+   // Parse the dataset and benchmark options before initializing the application
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   if (pArgumentList == NULL)
+   {
+      return -1;
+   }
+
+   DatasetSpec dataset;
+   unsigned int iterations = 3;
+   bool error = false;
+   string value = pArgumentList->getOption("rows");
+   if (value.empty() == false)
+   {
+      dataset.mRows = StringUtilities::fromXmlString<unsigned int>(value, &error);
+   }
+   value = pArgumentList->getOption("columns");
+   if (error == false && value.empty() == false)
+   {
+      dataset.mColumns = StringUtilities::fromXmlString<unsigned int>(value, &error);
+   }
+   value = pArgumentList->getOption("bands");
+   if (error == false && value.empty() == false)
+   {
+      dataset.mBands = StringUtilities::fromXmlString<unsigned int>(value, &error);
+   }
+   value = pArgumentList->getOption("encoding");
+   if (error == false && value.empty() == false)
+   {
+      dataset.mEncoding = StringUtilities::fromXmlString<EncodingType>(value, &error);
+   }
+   value = pArgumentList->getOption("interleave");
+   if (error == false && value.empty() == false)
+   {
+      dataset.mInterleave = StringUtilities::fromXmlString<InterleaveFormatType>(value, &error);
+   }
+   value = pArgumentList->getOption("seed");
+   if (error == false && value.empty() == false)
+   {
+      dataset.mSeed = StringUtilities::fromXmlString<unsigned int>(value, &error);
+   }
+   value = pArgumentList->getOption("iterations");
+   if (error == false && value.empty() == false)
+   {
+      iterations = StringUtilities::fromXmlString<unsigned int>(value, &error);
+   }
+   if (error == true || dataset.mEncoding.isValid() == false || dataset.mInterleave.isValid() == false)
+   {
+      reportError("Invalid benchmark dataset option.");
+      return -1;
+   }
+
+   string outputFile = pArgumentList->getOption("output");
+   if (outputFile.empty() == true)
+   {
+      outputFile = "benchmark.json";
+   }
+
+   // Initialize the application
+   int iReturn = Application::run(argc, argv);
+   if (iReturn == -1)
+   {
+      return -1;
+   }
+
+   // Set the application to run in batch mode
+   ApplicationServicesImp* pApp = ApplicationServicesImp::instance();
+   if (pApp != NULL)
+   {
+      pApp->setBatch();
+   }
+
+   mpProgress = new ProgressBriefConsole(pArgumentList->exists("verybrief"));
+
+   PlugInManagerServicesImp* pManager = PlugInManagerServicesImp::instance();
+   if (pManager != NULL)
+   {
+      pManager->executeStartupPlugIns(mpProgress);
+   }
+
+   // Record the environment so that results from different machines and builds can be compared
+   BenchmarkResults results;
+   ConfigurationSettingsImp* pSettings = ConfigurationSettingsImp::instance();
+   results.setEnvironment("application", APP_NAME);
+   results.setEnvironment("version", pSettings->getVersion() + " Build " + pSettings->getBuildRevision());
+   results.setEnvironment("operatingSystem", pSettings->getOperatingSystemName());
+   results.setEnvironment("architecture", pSettings->getArchitectureName());
+   results.setEnvironment("threadCount", StringUtilities::toXmlString(ConfigurationSettings::getSettingThreadCount()));
+   results.setEnvironment("iterations", StringUtilities::toXmlString(iterations));
+   results.setEnvironment("dataset", dataset.toString());
+   FactoryResource<DateTime> pNow;
+   pNow->setToCurrentTime();
+   results.setEnvironment("date", pNow->getFormattedUtc("%Y-%m-%dT%H:%M:%SZ"));
+
+   string tempPath = QDir::tempPath().toStdString();
+   const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+   if (pTempPath != NULL && pTempPath->getFullPathAndName().empty() == false)
+   {
+      tempPath = pTempPath->getFullPathAndName();
+   }
+
+   string traceFile = pArgumentList->getOption("trace");
+   if (traceFile.empty() == false)
+   {
+      InstrumentationImp::instance()->setEnabled(true);
+      InstrumentationImp::instance()->setTracing(true);
+   }
+
+   RasterBenchmarks benchmarks(dataset, mpProgress, results);
+   benchmarks.setIterations(iterations);
+   benchmarks.setTemporaryPath(tempPath);
+   benchmarks.setSuites(splitList(pArgumentList->getOption("suites")));
+   benchmarks.setPagers(splitList(pArgumentList->getOption("pagers")));
+   bool bSuccess = benchmarks.run();
+
+   GraphicBenchmarks graphicBenchmarks(mpProgress, results);
+   graphicBenchmarks.setIterations(iterations);
+   graphicBenchmarks.setSeed(dataset.mSeed);
+   graphicBenchmarks.setSuites(splitList(pArgumentList->getOption("suites")));
+   bSuccess = graphicBenchmarks.run() && bSuccess;
+
+   if (results.writeJson(outputFile) == false)
+   {
+      reportError("Unable to write the benchmark results to " + outputFile + ".");
+      bSuccess = false;
+   }
+   else
+   {
+      cout << "Benchmark results written to " << outputFile << endl;
+   }
+
+   if (traceFile.empty() == false)
+   {
+      InstrumentationImp::instance()->setEnabled(false);
+      if (InstrumentationImp::instance()->writeChromeTrace(traceFile) == false)
+      {
+         reportError("Unable to write the instrumentation trace to " + traceFile + ".");
+         bSuccess = false;
+      }
+      else
+      {
+         cout << "Instrumentation trace written to " << traceFile << endl;
+      }
+   }
+
+   // Close the session to cleanup created objects
+   SessionManagerImp::instance()->close();
+
+   // Cleanup
+   delete dynamic_cast<ProgressBriefConsole*>(mpProgress);
+   mpProgress = NULL;
+
+   if (bSuccess == true)
+   {
+      return 0;
+   }
+
+   return -1;
+}
+
+void BenchmarkApplication::reportWarning(const string& warningMessage) const
+{
+   if (warningMessage.empty() == false)
+   {
+      cerr << endl << APP_NAME << " WARNING: " << warningMessage << endl;
+   }
+}
+
+void BenchmarkApplication::reportError(const string& errorMessage) const
+{
+   string message = errorMessage;
+   if (message.empty() == true)
+   {
+      message = "Unknown error";
+   }
+
+   cerr << endl << APP_NAME << " ERROR: " << message << endl;
+}
+
+vector<string> BenchmarkApplication::splitList(const string& value)
+{
+   vector<string> items;
+   istringstream stream(value);
+   string item;
+   while (getline(stream, item, ','))
+   {
+      if (item.empty() == false)
+      {
+         items.push_back(item);
+      }
+   }
+
+   return items;
+}
@@ -0,0 +1,39 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BENCHMARKAPPLICATION_H
+#define BENCHMARKAPPLICATION_H
+
+#include "Application.h"
+#include "SubjectAdapter.h"
+
+#include <string>
+#include <vector>
+
+class BenchmarkApplication : public Application, public SubjectAdapter
+{
+public:
+   BenchmarkApplication(QCoreApplication& app);
+   ~BenchmarkApplication();
+
+   const std::string& getObjectType() const;
+   bool isKindOf(const std::string& className) const;
+
+   int run(int argc, char** argv);
+
+   void reportWarning(const std::string& warningMessage) const;
+   void reportError(const std::string& errorMessage) const;
+
+private:
+   BenchmarkApplication& operator=(const BenchmarkApplication& rhs);
+
+   static std::vector<std::string> splitList(const std::string& value);
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "BenchmarkResults.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+BenchmarkResults::BenchmarkResults()
+{
+}
+
+void BenchmarkResults::setEnvironment(const string& key, const string& value)
+{
+   for (vector<pair<string, string> >::iterator iter = mEnvironment.begin(); iter != mEnvironment.end(); ++iter)
+   {
+      if (iter->first == key)
+      {
+         iter->second = value;
+         return;
+      }
+   }
+
+   mEnvironment.push_back(make_pair(key, value));
+}
+
+void BenchmarkResults::addResult(const BenchmarkResult& result)
+{
+   mResults.push_back(result);
+}
+
+void BenchmarkResults::addSkipped(const string& suite, const string& name, const string& pager,
+                                  const string& dataset, const string& message)
+{
+   BenchmarkResult result;
+   result.mSuite = suite;
+   result.mName = name;
+   result.mPager = pager;
+   result.mDataset = dataset;
+   result.mSkipped = true;
+   result.mMessage = message;
+   mResults.push_back(result);
+}
+
+const vector<BenchmarkResult>& BenchmarkResults::getResults() const
+{
+   return mResults;
+}
+
+unsigned int BenchmarkResults::getFailureCount() const
+{
+   unsigned int count = 0;
+   for (vector<BenchmarkResult>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter)
+   {
+      if (iter->mSkipped == false && iter->mIterations == 0)
+      {
+         ++count;
+      }
+   }
+
+   return count;
+}
+
+void BenchmarkResults::writeJson(ostream& output) const
+{
+   output << setprecision(9);
+   output << "{" << endl;
+   output << "   \"environment\": {";
+   for (vector<pair<string, string> >::const_iterator iter = mEnvironment.begin(); iter != mEnvironment.end(); ++iter)
+   {
+      output << (iter == mEnvironment.begin() ? "" : ",") << endl;
+      output << "      \"" << escape(iter->first) << "\": \"" << escape(iter->second) << "\"";
+   }
+   output << endl << "   }," << endl;
+
+   output << "   \"results\": [";
+   for (vector<BenchmarkResult>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter)
+   {
+      output << (iter == mResults.begin() ? "" : ",") << endl;
+      output << "      {" << endl;
+      output << "         \"suite\": \"" << escape(iter->mSuite) << "\"," << endl;
+      output << "         \"name\": \"" << escape(iter->mName) << "\"," << endl;
+      output << "         \"pager\": \"" << escape(iter->mPager) << "\"," << endl;
+      output << "         \"dataset\": \"" << escape(iter->mDataset) << "\"," << endl;
+      if (iter->mSkipped)
+      {
+         output << "         \"skipped\": true," << endl;
+      }
+      else
+      {
+         output << "         \"iterations\": " << iter->mIterations << "," << endl;
+         output << "         \"minSeconds\": " << iter->mMinSeconds << "," << endl;
+         output << "         \"meanSeconds\": " << iter->mMeanSeconds << "," << endl;
+         output << "         \"maxSeconds\": " << iter->mMaxSeconds << "," << endl;
+         output << "         \"bytes\": " << iter->mBytes << "," << endl;
+         double throughput = 0.0;
+         if (iter->mMinSeconds > 0.0)
+         {
+            throughput = iter->mBytes / iter->mMinSeconds / (1024.0 * 1024.0);
+         }
+         output << "         \"megabytesPerSecond\": " << throughput << "," << endl;
+      }
+      output << "         \"message\": \"" << escape(iter->mMessage) << "\"" << endl;
+      output << "      }";
+   }
+   output << endl << "   ]" << endl;
+   output << "}" << endl;
+}
+
+bool BenchmarkResults::writeJson(const string& filename) const
+{
+   ofstream output(filename.c_str());
+   if (!output.is_open())
+   {
+      return false;
+   }
+
+   writeJson(output);
+   return output.good();
+}
+
+string BenchmarkResults::escape(const string& value)
+{
+   ostringstream escaped;
+   for (string::const_iterator iter = value.begin(); iter != value.end(); ++iter)
+   {
+      unsigned char character = static_cast<unsigned char>(*iter);
+      switch (character)
+      {
+      case '"':
+         escaped << "\\\"";
+         break;
+      case '\\':
+         escaped << "\\\\";
+         break;
+      case '\n':
+         escaped << "\\n";
+         break;
+      case '\r':
+         escaped << "\\r";
+         break;
+      case '\t':
+         escaped << "\\t";
+         break;
+      default:
+         if (character < 0x20)
+         {
+            escaped << "\\u" << hex << setw(4) << setfill('0') << static_cast<unsigned int>(character) <<
+               dec << setfill(' ');
+         }
+         else
+         {
+            escaped << *iter;
+         }
+         break;
+      }
+   }
+
+   return escaped.str();
+}
@@ -0,0 +1,70 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BENCHMARKRESULTS_H
+#define BENCHMARKRESULTS_H
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BenchmarkResult
+{
+   BenchmarkResult() :
+      mIterations(0),
+      mMinSeconds(0.0),
+      mMeanSeconds(0.0),
+      mMaxSeconds(0.0),
+      mBytes(0.0),
+      mSkipped(false)
+   {
+   }
+
+   std::string mSuite;        // "access", "statistics", "convolution", ...
+   std::string mName;         // the variant within the suite, e.g. "row" or "tile"
+   std::string mPager;        // the pager holding the data being read
+   std::string mDataset;      // a description of the synthetic dataset
+   unsigned int mIterations;
+   double mMinSeconds;
+   double mMeanSeconds;
+   double mMaxSeconds;
+   double mBytes;             // bytes touched by one iteration, used to compute throughput
+   bool mSkipped;
+   std::string mMessage;      // the reason a benchmark was skipped or failed
+};
+
+/**
+ * Collects benchmark timings and the environment they were measured in and
+ * writes them as a single JSON document.
+ */
+class BenchmarkResults
+{
+public:
+   BenchmarkResults();
+
+   void setEnvironment(const std::string& key, const std::string& value);
+   void addResult(const BenchmarkResult& result);
+   void addSkipped(const std::string& suite, const std::string& name, const std::string& pager,
+      const std::string& dataset, const std::string& message);
+
+   const std::vector<BenchmarkResult>& getResults() const;
+   unsigned int getFailureCount() const;
+
+   void writeJson(std::ostream& output) const;
+   bool writeJson(const std::string& filename) const;
+
+private:
+   static std::string escape(const std::string& value);
+
+   std::vector<std::pair<std::string, std::string> > mEnvironment;
+   std::vector<BenchmarkResult> mResults;
+};
+
+#endif
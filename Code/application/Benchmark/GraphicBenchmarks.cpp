@@ -0,0 +1,304 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include <QtCore/QElapsedTimer>
+
+#include "AnnotationElement.h"
+#include "BenchmarkResults.h"
+#include "GraphicBenchmarks.h"
+#include "GraphicGroup.h"
+#include "GraphicGroupImp.h"
+#include "GraphicObjectImp.h"
+#include "ObjectResource.h"
+#include "Progress.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+   // The number of hit tests and area queries in one iteration
+   const unsigned int QUERY_COUNT = 1000;
+
+   // The width and height of each query area, e.g. a zoomed in view
+   const double QUERY_SIZE = 256.0;
+
+   inline unsigned int nextRandom(unsigned int& state)
+   {
+      state = state * 1103515245U + 12345U;
+      return (state >> 16) & 0x7fff;
+   }
+
+   inline double nextCoordinate(unsigned int& state, double extent)
+   {
+      unsigned int high = nextRandom(state);
+      unsigned int low = nextRandom(state);
+      return extent * ((high << 15) | low) / (1 << 30);
+   }
+
+   string toString(unsigned int value)
+   {
+      ostringstream stream;
+      stream << value;
+      return stream.str();
+   }
+}
+
+GraphicBenchmarks::GraphicBenchmarks(Progress* pProgress, BenchmarkResults& results) :
+   mpProgress(pProgress),
+   mResults(results),
+   mIterations(3),
+   mObjectCount(20000),
+   mSeed(1),
+   mExtent(8192.0)
+{
+}
+
+void GraphicBenchmarks::setSuites(const vector<string>& suites)
+{
+   mSuites = suites;
+}
+
+void GraphicBenchmarks::setIterations(unsigned int iterations)
+{
+   mIterations = max(iterations, 1U);
+}
+
+void GraphicBenchmarks::setObjectCount(unsigned int count)
+{
+   mObjectCount = count;
+}
+
+void GraphicBenchmarks::setSeed(unsigned int seed)
+{
+   mSeed = seed;
+}
+
+vector<string> GraphicBenchmarks::getSuiteNames()
+{
+   vector<string> suites;
+   suites.push_back("graphics");
+   return suites;
+}
+
+bool GraphicBenchmarks::run()
+{
+   if (isSuiteSelected("graphics") == false)
+   {
+      return true;
+   }
+
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("Creating the benchmark annotation layer...", 0, NORMAL);
+   }
+
+   ModelResource<AnnotationElement> pAnnotation("Benchmark Annotation", NULL);
+   GraphicGroupImp* pGroup = (pAnnotation.get() == NULL) ? NULL :
+      dynamic_cast<GraphicGroupImp*>(pAnnotation->getGroup());
+   if (pGroup == NULL)
+   {
+      mResults.addSkipped("graphics", "all", "none", getDataset(), "Unable to create the annotation element.");
+      return false;
+   }
+
+   // Lay out the rectangles without updating the group extents for each one
+   unsigned int state = mSeed;
+   pAnnotation->setInteractive(false);
+   list<GraphicObject*> objects = pGroup->addObjects(mObjectCount, RECTANGLE_OBJECT);
+   for (list<GraphicObject*>::iterator iter = objects.begin(); iter != objects.end(); ++iter)
+   {
+      LocationType llCorner;
+      llCorner.mX = nextCoordinate(state, mExtent);
+      llCorner.mY = nextCoordinate(state, mExtent);
+      LocationType urCorner;
+      urCorner.mX = llCorner.mX + 1.0 + nextRandom(state) % 32;
+      urCorner.mY = llCorner.mY + 1.0 + nextRandom(state) % 32;
+      (*iter)->setBoundingBox(llCorner, urCorner);
+   }
+   pAnnotation->setInteractive(true);
+   pGroup->updateBoundingBox();
+
+   mPoints.clear();
+   for (unsigned int index = 0; index < QUERY_COUNT; ++index)
+   {
+      LocationType point;
+      point.mX = nextCoordinate(state, mExtent);
+      point.mY = nextCoordinate(state, mExtent);
+      mPoints.push_back(point);
+   }
+
+   runBenchmark("hit indexed", pGroup, &GraphicBenchmarks::hitIndexed);
+   runBenchmark("hit linear", pGroup, &GraphicBenchmarks::hitLinear);
+   runBenchmark("visible indexed", pGroup, &GraphicBenchmarks::queryIndexed);
+   runBenchmark("visible linear", pGroup, &GraphicBenchmarks::queryLinear);
+   runBenchmark("move", pGroup, &GraphicBenchmarks::moveObjects);
+
+   return mResults.getFailureCount() == 0;
+}
+
+string GraphicBenchmarks::getDataset() const
+{
+   ostringstream stream;
+   stream << mObjectCount << " rectangles over " << mExtent << "x" << mExtent << " seed " << mSeed;
+   return stream.str();
+}
+
+bool GraphicBenchmarks::isSuiteSelected(const string& suite) const
+{
+   return mSuites.empty() || find(mSuites.begin(), mSuites.end(), suite) != mSuites.end();
+}
+
+void GraphicBenchmarks::runBenchmark(const string& name, GraphicGroupImp* pGroup, BenchmarkMethod method)
+{
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("Running the graphics " + name + " benchmark...", 0, NORMAL);
+   }
+
+   BenchmarkResult result;
+   result.mSuite = "graphics";
+   result.mName = name;
+   result.mPager = "none";
+   result.mDataset = getDataset();
+
+   double totalSeconds = 0.0;
+   for (unsigned int iteration = 0; iteration < mIterations; ++iteration)
+   {
+      string message;
+
+      QElapsedTimer timer;
+      timer.start();
+      bool success = (this->*method)(pGroup, message);
+      double seconds = static_cast<double>(timer.nsecsElapsed()) / 1.0e9;
+
+      if (success == false)
+      {
+         result.mIterations = 0;
+         result.mMessage = message.empty() ? "The benchmark failed." : message;
+         break;
+      }
+
+      result.mMinSeconds = (iteration == 0) ? seconds : min(result.mMinSeconds, seconds);
+      result.mMaxSeconds = max(result.mMaxSeconds, seconds);
+      result.mMessage = message;
+      totalSeconds += seconds;
+      ++result.mIterations;
+   }
+
+   if (result.mIterations > 0)
+   {
+      result.mMeanSeconds = totalSeconds / result.mIterations;
+   }
+   else if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("The graphics " + name + " benchmark failed: " + result.mMessage, 0, WARNING);
+   }
+
+   mResults.addResult(result);
+}
+
+bool GraphicBenchmarks::hitIndexed(GraphicGroupImp* pGroup, string& message)
+{
+   unsigned int hits = 0;
+   for (vector<LocationType>::const_iterator iter = mPoints.begin(); iter != mPoints.end(); ++iter)
+   {
+      if (pGroup->hitObject(*iter) != NULL)
+      {
+         ++hits;
+      }
+   }
+
+   message = ::toString(hits) + " of " + ::toString(mPoints.size()) + " points hit an object";
+   return true;
+}
+
+bool GraphicBenchmarks::hitLinear(GraphicGroupImp* pGroup, string& message)
+{
+   // The hit test used by the group before it was indexed
+   const list<GraphicObject*>& objects = pGroup->getObjects();
+   unsigned int hits = 0;
+   for (vector<LocationType>::const_iterator iter = mPoints.begin(); iter != mPoints.end(); ++iter)
+   {
+      for (list<GraphicObject*>::const_reverse_iterator objectIter = objects.rbegin();
+         objectIter != objects.rend(); ++objectIter)
+      {
+         GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(*objectIter);
+         if (pObjectImp != NULL && pObjectImp->hit(*iter) == true)
+         {
+            ++hits;
+            break;
+         }
+      }
+   }
+
+   message = ::toString(hits) + " of " + ::toString(mPoints.size()) + " points hit an object";
+   return true;
+}
+
+bool GraphicBenchmarks::queryIndexed(GraphicGroupImp* pGroup, string& message)
+{
+   unsigned int found = 0;
+   vector<GraphicObject*> visibleObjects;
+   for (vector<LocationType>::const_iterator iter = mPoints.begin(); iter != mPoints.end(); ++iter)
+   {
+      pGroup->getObjects(*iter, LocationType(iter->mX + QUERY_SIZE, iter->mY + QUERY_SIZE), visibleObjects);
+      found += visibleObjects.size();
+   }
+
+   message = ::toString(found) + " objects in " + ::toString(mPoints.size()) + " areas";
+   return true;
+}
+
+bool GraphicBenchmarks::queryLinear(GraphicGroupImp* pGroup, string& message)
+{
+   const list<GraphicObject*>& objects = pGroup->getObjects();
+   unsigned int found = 0;
+   vector<GraphicObject*> visibleObjects;
+   for (vector<LocationType>::const_iterator iter = mPoints.begin(); iter != mPoints.end(); ++iter)
+   {
+      visibleObjects.clear();
+      for (list<GraphicObject*>::const_iterator objectIter = objects.begin(); objectIter != objects.end(); ++objectIter)
+      {
+         LocationType llCorner = (*objectIter)->getLlCorner();
+         LocationType urCorner = (*objectIter)->getUrCorner();
+         if (llCorner.mX <= iter->mX + QUERY_SIZE && urCorner.mX >= iter->mX &&
+            llCorner.mY <= iter->mY + QUERY_SIZE && urCorner.mY >= iter->mY)
+         {
+            visibleObjects.push_back(*objectIter);
+         }
+      }
+      found += visibleObjects.size();
+   }
+
+   message = ::toString(found) + " objects in " + ::toString(mPoints.size()) + " areas";
+   return true;
+}
+
+bool GraphicBenchmarks::moveObjects(GraphicGroupImp* pGroup, string& message)
+{
+   // Nudge objects back and forth so that the group's index and extents are updated for each change
+   const list<GraphicObject*>& objects = pGroup->getObjects();
+   unsigned int moved = 0;
+   for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end() && moved < QUERY_COUNT;
+      ++iter, ++moved)
+   {
+      GraphicObject* pObject = *iter;
+      LocationType llCorner = pObject->getLlCorner();
+      LocationType urCorner = pObject->getUrCorner();
+      double offset = (moved % 2 == 0) ? 1.0 : -1.0;
+      pObject->setBoundingBox(LocationType(llCorner.mX + offset, llCorner.mY),
+         LocationType(urCorner.mX + offset, urCorner.mY));
+   }
+
+   message = ::toString(moved) + " objects moved";
+   return true;
+}
@@ -0,0 +1,71 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GRAPHICBENCHMARKS_H
+#define GRAPHICBENCHMARKS_H
+
+#include "LocationType.h"
+
+#include <string>
+#include <vector>
+
+class BenchmarkResults;
+class GraphicGroupImp;
+class Progress;
+
+/**
+ * Times hit testing and visible area queries against a synthetic annotation
+ * layer, both through the group's spatial index and with a linear scan of
+ * the object list for comparison.
+ */
+class GraphicBenchmarks
+{
+public:
+   GraphicBenchmarks(Progress* pProgress, BenchmarkResults& results);
+
+   /**
+    * Selects the benchmark suites to run.  An empty list runs every suite.
+    * The only valid suite is "graphics".
+    */
+   void setSuites(const std::vector<std::string>& suites);
+
+   void setIterations(unsigned int iterations);
+   void setObjectCount(unsigned int count);
+   void setSeed(unsigned int seed);
+
+   static std::vector<std::string> getSuiteNames();
+
+   bool run();
+
+private:
+   GraphicBenchmarks& operator=(const GraphicBenchmarks& rhs);
+
+   typedef bool (GraphicBenchmarks::*BenchmarkMethod)(GraphicGroupImp* pGroup, std::string& message);
+
+   std::string getDataset() const;
+   bool isSuiteSelected(const std::string& suite) const;
+   void runBenchmark(const std::string& name, GraphicGroupImp* pGroup, BenchmarkMethod method);
+
+   bool hitIndexed(GraphicGroupImp* pGroup, std::string& message);
+   bool hitLinear(GraphicGroupImp* pGroup, std::string& message);
+   bool queryIndexed(GraphicGroupImp* pGroup, std::string& message);
+   bool queryLinear(GraphicGroupImp* pGroup, std::string& message);
+   bool moveObjects(GraphicGroupImp* pGroup, std::string& message);
+
+   Progress* mpProgress;
+   BenchmarkResults& mResults;
+   std::vector<std::string> mSuites;
+   unsigned int mIterations;
+   unsigned int mObjectCount;
+   unsigned int mSeed;
+   double mExtent;
+   std::vector<LocationType> mPoints;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include <QtCore/QCoreApplication>
+
+#include "AppConfig.h"
+#include "AppVersion.h"
+#include "ArgumentList.h"
+#include "BenchmarkApplication.h"
+#include "ConfigurationSettingsImp.h"
+#include "GraphicBenchmarks.h"
+#include "RasterBenchmarks.h"
+#include "SystemServicesImp.h"
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   string joinNames(const vector<string>& names)
+   {
+      string joined;
+      for (vector<string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+      {
+         joined += (iter == names.begin() ? "" : ",") + *iter;
+      }
+      return joined;
+   }
+}
+
+// Defines the entry point for the raster benchmark suite
+int main(int argc, char** argv)
+{
+   SystemServicesImp::instance()->WriteLogInfo(string(APP_NAME) + " Benchmark Startup");
+
+   //Need to initialize QCoreApplication so that ConfigSettingsImp
+   //can use QCoreApplication::applicationDirPath()
+   QCoreApplication qCoreApp(argc, argv);
+
+   // Register the command line options
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   if (pArgumentList == NULL)
+   {
+      SystemServicesImp::instance()->WriteLogInfo(string(APP_NAME) + " Benchmark shutdown");
+      return -1;
+   }
+   pArgumentList->registerOption("output");
+   pArgumentList->registerOption("rows");
+   pArgumentList->registerOption("columns");
+   pArgumentList->registerOption("bands");
+   pArgumentList->registerOption("encoding");
+   pArgumentList->registerOption("interleave");
+   pArgumentList->registerOption("seed");
+   pArgumentList->registerOption("iterations");
+   pArgumentList->registerOption("suites");
+   pArgumentList->registerOption("pagers");
+   pArgumentList->registerOption("trace");
+   pArgumentList->registerOption("processors");
+   pArgumentList->registerOption("verybrief");
+   pArgumentList->registerOption("help");
+   pArgumentList->registerOption("h");
+   pArgumentList->registerOption("?");
+   pArgumentList->set(argc, argv);
+
+   BenchmarkApplication benchmarkApp(qCoreApp);
+
+   string configSettingsErrorMsg;
+   bool configSettingsValid = false;
+   ConfigurationSettingsImp* pSettings = ConfigurationSettingsImp::instance();
+   if (pSettings != NULL)
+   {
+      configSettingsValid = pSettings->isInitialized();
+      if (configSettingsValid)
+      {
+         pSettings->validateInitialization();
+         configSettingsValid = pSettings->isInitialized();
+      }
+      if (pSettings->getInitializationErrorMsg() != NULL)
+      {
+         configSettingsErrorMsg = pSettings->getInitializationErrorMsg();
+      }
+   }
+
+   if (!configSettingsValid)
+   {
+      if (configSettingsErrorMsg.empty())
+      {
+         configSettingsErrorMsg = "Unable to locate configuration settings";
+      }
+      benchmarkApp.reportError(configSettingsErrorMsg);
+      SystemServicesImp::instance()->WriteLogInfo(string(APP_NAME) + " Benchmark shutdown");
+      return -1;
+   }
+   else if (!configSettingsErrorMsg.empty())
+   {
+      benchmarkApp.reportWarning(configSettingsErrorMsg);
+   }
+
+   cout << endl;
+   cout << APP_NAME_LONG << endl;
+   cout << APP_NAME << " Benchmark, Version " << pSettings->getVersion() << " Build " <<
+      pSettings->getBuildRevision() << endl;
+
+   // Display help
+   if ((pArgumentList->exists("help") == true) || (pArgumentList->exists("h") == true) ||
+      (pArgumentList->exists("?") == true))
+   {
+      string dlm = pArgumentList->getDelimiter();
+      cout << endl << "benchmark " << dlm << "output:results.json " << dlm << "rows:2048 " << dlm <<
+         "columns:2048 " << dlm << "bands:8 " << dlm << "encoding:INT2UBYTES " << dlm << "interleave:BIP" << endl;
+      cout << "     " << dlm << "output       The JSON file to write the results to (default benchmark.json)" << endl;
+      cout << "     " << dlm << "rows         The number of rows in the synthetic dataset" << endl;
+      cout << "     " << dlm << "columns      The number of columns in the synthetic dataset" << endl;
+      cout << "     " << dlm << "bands        The number of bands in the synthetic dataset" << endl;
+      cout << "     " << dlm << "encoding     The data type, e.g. INT1UBYTE, INT2UBYTES or FLT4BYTES" << endl;
+      cout << "     " << dlm << "interleave   BIP, BIL or BSQ" << endl;
+      cout << "     " << dlm << "seed         The seed used to generate the synthetic dataset" << endl;
+      cout << "     " << dlm << "iterations   The number of times each benchmark is run" << endl;
+      cout << "     " << dlm << "suites       A comma separated list of suites to run: " <<
+         joinNames(RasterBenchmarks::getSuiteNames()) << "," << joinNames(GraphicBenchmarks::getSuiteNames()) << endl;
+      cout << "     " << dlm << "pagers       A comma separated list of pagers to use: " <<
+         joinNames(RasterBenchmarks::getPagerNames()) << endl;
+      cout << "     " << dlm << "trace        A Chrome trace file to write the instrumentation spans to" << endl;
+      cout << "     " << dlm << "processors   Sets number of available processors" << endl;
+      cout << "     " << dlm << "verybrief    Displays only abort, warning, and error messages" << endl;
+      cout << "     " << dlm << "help         Displays this help message" << endl;
+      SystemServicesImp::instance()->WriteLogInfo(string(APP_NAME) + " Benchmark shutdown");
+      return 0;
+   }
+
+   int iSuccess = benchmarkApp.run(argc, argv);
+
+   SystemServicesImp::instance()->WriteLogInfo(string(APP_NAME) + " Benchmark Shutdown");
+   return iSuccess;
+}
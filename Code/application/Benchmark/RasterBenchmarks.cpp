@@ -0,0 +1,835 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
+#include "BenchmarkResults.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "Executable.h"
+#include "FileDescriptor.h"
+#include "ImportDescriptor.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "PlugInResource.h"
+#include "Progress.h"
+#include "RasterBenchmarks.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "Statistics.h"
+#include "StringUtilities.h"
+#include "switchOnEncoding.h"
+
+#include <ossim/matrix/newmat.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * Describes how the synthetic dataset is loaded so that it is paged by a
+ * specific pager.  Pagers without an exporter for their format cannot be
+ * loaded from synthetic data and are reported as skipped.
+ */
+struct RasterBenchmarks::PagerConfiguration
+{
+   const char* mpPager;
+   const char* mpExporter;      // NULL if the dataset is created directly
+   const char* mpExtension;
+   const char* mpImporter;
+   bool mImportDataFile;        // import the raw data file instead of the exported file
+   bool mInMemory;
+};
+
+namespace
+{
+   const RasterBenchmarks::PagerConfiguration* getPagerConfigurations(unsigned int& count);
+
+   // A small linear congruential generator so that the data and the random
+   // access pattern are identical on every platform for a given seed
+   inline unsigned int nextRandom(unsigned int& state)
+   {
+      state = state * 1103515245U + 12345U;
+      return (state >> 16) & 0x7fff;
+   }
+
+   template<typename T>
+   void fillRow(T* pRow, unsigned int row, unsigned int firstBand, unsigned int numBands, unsigned int numColumns,
+      InterleaveFormatType interleave, unsigned int& state)
+   {
+      for (unsigned int band = 0; band < numBands; ++band)
+      {
+         for (unsigned int column = 0; column < numColumns; ++column)
+         {
+            size_t index = (interleave == BIP) ? column * numBands + band : band * numColumns + column;
+            unsigned int value = ((row * 3 + column * 5 + (firstBand + band) * 11) % 100) + nextRandom(state) % 28;
+            pRow[index] = static_cast<T>(value);
+         }
+      }
+   }
+
+   template<typename T>
+   void sumElements(const T* pData, size_t count, unsigned int& checksum)
+   {
+      for (size_t index = 0; index < count; ++index)
+      {
+         checksum += static_cast<unsigned int>(pData[index]);
+      }
+   }
+
+   string toString(unsigned int value)
+   {
+      ostringstream stream;
+      stream << value;
+      return stream.str();
+   }
+}
+
+string DatasetSpec::toString() const
+{
+   ostringstream stream;
+   stream << mRows << "x" << mColumns << "x" << mBands << " " << StringUtilities::toXmlString(mEncoding) << " " <<
+      StringUtilities::toXmlString(mInterleave) << " seed " << mSeed;
+   return stream.str();
+}
+
+double DatasetSpec::getSize() const
+{
+   return static_cast<double>(mRows) * mColumns * mBands * RasterUtilities::bytesInEncoding(mEncoding);
+}
+
+RasterBenchmarks::RasterBenchmarks(const DatasetSpec& dataset, Progress* pProgress, BenchmarkResults& results) :
+   mDataset(dataset),
+   mpProgress(pProgress),
+   mResults(results),
+   mIterations(3),
+   mChecksum(0)
+{
+}
+
+void RasterBenchmarks::setSuites(const vector<string>& suites)
+{
+   mSuites = suites;
+}
+
+void RasterBenchmarks::setPagers(const vector<string>& pagers)
+{
+   mPagers = pagers;
+}
+
+void RasterBenchmarks::setIterations(unsigned int iterations)
+{
+   mIterations = max(iterations, 1U);
+}
+
+void RasterBenchmarks::setTemporaryPath(const string& path)
+{
+   mTemporaryPath = path;
+}
+
+vector<string> RasterBenchmarks::getSuiteNames()
+{
+   vector<string> suites;
+   suites.push_back("access");
+   suites.push_back("interleave");
+   suites.push_back("statistics");
+   suites.push_back("convolution");
+   suites.push_back("bandmath");
+   suites.push_back("pca");
+   suites.push_back("export");
+   return suites;
+}
+
+vector<string> RasterBenchmarks::getPagerNames()
+{
+   vector<string> pagers;
+   unsigned int count = 0;
+   const PagerConfiguration* pConfigurations = getPagerConfigurations(count);
+   for (unsigned int index = 0; index < count; ++index)
+   {
+      pagers.push_back(pConfigurations[index].mpPager);
+   }
+
+   return pagers;
+}
+
+bool RasterBenchmarks::run()
+{
+   if (mDataset.mRows == 0 || mDataset.mColumns == 0 || mDataset.mBands == 0 ||
+      RasterUtilities::bytesInEncoding(mDataset.mEncoding) == 0 ||
+      mDataset.mEncoding == INT4SCOMPLEX || mDataset.mEncoding == FLT8COMPLEX)
+   {
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("The benchmark dataset must have a non-zero size and a non-complex encoding.",
+            0, ERRORS);
+      }
+      return false;
+   }
+
+   // Don't load the dataset if only suites from other benchmarks were selected
+   vector<string> suites = getSuiteNames();
+   bool suiteSelected = false;
+   for (vector<string>::const_iterator iter = suites.begin(); iter != suites.end(); ++iter)
+   {
+      suiteSelected = suiteSelected || isSuiteSelected(*iter);
+   }
+
+   if (suiteSelected == false)
+   {
+      return true;
+   }
+
+   const string dataset = mDataset.toString();
+   unsigned int count = 0;
+   const PagerConfiguration* pConfigurations = getPagerConfigurations(count);
+   for (unsigned int index = 0; index < count; ++index)
+   {
+      const PagerConfiguration& pager = pConfigurations[index];
+      if (isPagerSelected(pager.mpPager) == false)
+      {
+         continue;
+      }
+
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(string("Loading the benchmark dataset with the ") + pager.mpPager + "...", 0,
+            NORMAL);
+      }
+
+      string message;
+      vector<string> files;
+      RasterElement* pSource = NULL;
+      RasterElement* pRaster = NULL;
+      if (pager.mpExporter == NULL && pager.mpImporter == NULL && pager.mpExtension == NULL)
+      {
+         pRaster = createSyntheticRaster(string("Benchmark ") + pager.mpPager, pager.mInMemory);
+         if (pRaster == NULL)
+         {
+            message = "Unable to create the synthetic dataset.";
+         }
+      }
+      else if (pager.mpExporter == NULL || pager.mpImporter == NULL)
+      {
+         message = "The synthetic dataset cannot be written in a format read by this pager.";
+      }
+      else
+      {
+         pSource = createSyntheticRaster(string("Benchmark Source ") + pager.mpPager, true);
+         if (pSource == NULL)
+         {
+            message = "Unable to create the synthetic dataset.";
+         }
+         else
+         {
+            pRaster = loadRaster(pager, pSource, files, message);
+            Service<ModelServices>()->destroyElement(pSource);
+         }
+      }
+
+      if (pRaster == NULL)
+      {
+         mResults.addSkipped("all", "all", pager.mpPager, dataset, message);
+         removeFiles(files);
+         continue;
+      }
+
+      runBenchmark("access", "row", pager.mpPager, pRaster, &RasterBenchmarks::readRows);
+      runBenchmark("access", "column", pager.mpPager, pRaster, &RasterBenchmarks::readColumns);
+      runBenchmark("access", "tile", pager.mpPager, pRaster, &RasterBenchmarks::readTiles);
+      runBenchmark("access", "toPixel", pager.mpPager, pRaster, &RasterBenchmarks::readRandomPixels);
+      runBenchmark("interleave", "BIP", pager.mpPager, pRaster, &RasterBenchmarks::readAsBip);
+      runBenchmark("interleave", "BIL", pager.mpPager, pRaster, &RasterBenchmarks::readAsBil);
+      runBenchmark("interleave", "BSQ", pager.mpPager, pRaster, &RasterBenchmarks::readAsBsq);
+      runBenchmark("statistics", "all bands", pager.mpPager, pRaster, &RasterBenchmarks::computeStatistics);
+      runBenchmark("convolution", "3x3 kernel", pager.mpPager, pRaster, &RasterBenchmarks::convolve);
+      runBenchmark("bandmath", "b1 + b2", pager.mpPager, pRaster, &RasterBenchmarks::bandMath);
+      runBenchmark("pca", "second moment", pager.mpPager, pRaster, &RasterBenchmarks::principalComponents);
+      runBenchmark("export", "ENVI", pager.mpPager, pRaster, &RasterBenchmarks::exportEnvi);
+
+      Service<ModelServices>()->destroyElement(pRaster);
+      removeFiles(files);
+   }
+
+   mResults.setEnvironment("checksum", ::toString(mChecksum));
+   return mResults.getFailureCount() == 0;
+}
+
+RasterElement* RasterBenchmarks::createSyntheticRaster(const string& name, bool inMemory)
+{
+   ModelResource<RasterElement> pRaster(RasterUtilities::createRasterElement(name, mDataset.mRows,
+      mDataset.mColumns, mDataset.mBands, mDataset.mEncoding, mDataset.mInterleave, inMemory));
+   if (pRaster.get() == NULL)
+   {
+      return NULL;
+   }
+
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   const vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+
+   // BSQ data is written one band at a time, all other interleaves one row of every band at a time
+   unsigned int bandsPerRow = (mDataset.mInterleave == BSQ) ? 1 : mDataset.mBands;
+   unsigned int state = mDataset.mSeed;
+   for (unsigned int firstBand = 0; firstBand < mDataset.mBands; firstBand += bandsPerRow)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setWritable(true);
+      if (mDataset.mInterleave == BSQ)
+      {
+         pRequest->setBands(bands[firstBand], bands[firstBand]);
+      }
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < mDataset.mRows; ++row)
+      {
+         if (!da.isValid())
+         {
+            return NULL;
+         }
+         switchOnEncoding(mDataset.mEncoding, fillRow, da->getRow(), row, firstBand, bandsPerRow,
+            mDataset.mColumns, mDataset.mInterleave, state);
+         da->nextRow();
+      }
+   }
+
+   return pRaster.release();
+}
+
+RasterElement* RasterBenchmarks::loadRaster(const PagerConfiguration& pager, RasterElement* pSource,
+                                            vector<string>& files, string& message)
+{
+   if (Service<PlugInManagerServices>()->getPlugInDescriptor(pager.mpExporter) == NULL ||
+      Service<PlugInManagerServices>()->getPlugInDescriptor(pager.mpImporter) == NULL)
+   {
+      message = string("The ") + pager.mpExporter + " or " + pager.mpImporter + " plug-in is not available.";
+      return NULL;
+   }
+
+   string baseName = mTemporaryPath + "/OpticksBenchmark_" + pager.mpPager;
+   string filename = baseName + pager.mpExtension;
+   files.push_back(filename);
+   if (pager.mImportDataFile)
+   {
+      files.push_back(baseName);
+   }
+   if (exportRaster(pSource, pager.mpExporter, filename, message) == false)
+   {
+      return NULL;
+   }
+
+   ImporterResource pImporter(pager.mpImporter, pager.mImportDataFile ? baseName : filename, mpProgress, true);
+   vector<ImportDescriptor*> descriptors = pImporter->getImportDescriptors();
+   bool foundDataset = false;
+   for (vector<ImportDescriptor*>::iterator iter = descriptors.begin(); iter != descriptors.end(); ++iter)
+   {
+      ImportDescriptor* pImportDescriptor = *iter;
+      if (pImportDescriptor == NULL)
+      {
+         continue;
+      }
+
+      RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pImportDescriptor->getDataDescriptor());
+      pImportDescriptor->setImported(pDescriptor != NULL && foundDataset == false);
+      if (pDescriptor != NULL && foundDataset == false)
+      {
+         pDescriptor->setProcessingLocation(ON_DISK_READ_ONLY);
+         foundDataset = true;
+      }
+   }
+
+   if (foundDataset == false || pImporter->execute() == false)
+   {
+      message = string("Unable to import the dataset with the ") + pager.mpImporter + ".";
+      return NULL;
+   }
+
+   vector<DataElement*> elements = pImporter->getImportedElements();
+   RasterElement* pRaster = elements.empty() ? NULL : dynamic_cast<RasterElement*>(elements.front());
+   if (pRaster == NULL)
+   {
+      message = string("The ") + pager.mpImporter + " did not create a raster element.";
+      for (vector<DataElement*>::iterator iter = elements.begin(); iter != elements.end(); ++iter)
+      {
+         Service<ModelServices>()->destroyElement(*iter);
+      }
+   }
+
+   return pRaster;
+}
+
+bool RasterBenchmarks::exportRaster(RasterElement* pRaster, const string& exporter, const string& filename,
+                                    string& message)
+{
+   FactoryResource<FileDescriptor> pFileDescriptor(
+      RasterUtilities::generateFileDescriptorForExport(pRaster->getDataDescriptor(), filename));
+   if (pFileDescriptor.get() == NULL)
+   {
+      message = "Unable to create a file descriptor for " + filename + ".";
+      return false;
+   }
+
+   ExporterResource pExporter(exporter, pRaster, pFileDescriptor.get(), mpProgress, true);
+   if (pExporter->execute() == false)
+   {
+      message = "Unable to export the dataset with the " + exporter + ".";
+      return false;
+   }
+
+   return true;
+}
+
+void RasterBenchmarks::removeFiles(const vector<string>& files) const
+{
+   for (vector<string>::const_iterator iter = files.begin(); iter != files.end(); ++iter)
+   {
+      QFile::remove(QString::fromStdString(*iter));
+   }
+}
+
+bool RasterBenchmarks::isSuiteSelected(const string& suite) const
+{
+   return mSuites.empty() || find(mSuites.begin(), mSuites.end(), suite) != mSuites.end();
+}
+
+bool RasterBenchmarks::isPagerSelected(const string& pager) const
+{
+   return mPagers.empty() || find(mPagers.begin(), mPagers.end(), pager) != mPagers.end();
+}
+
+void RasterBenchmarks::runBenchmark(const string& suite, const string& name, const string& pager,
+                                    RasterElement* pRaster, BenchmarkMethod method)
+{
+   if (isSuiteSelected(suite) == false)
+   {
+      return;
+   }
+
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("Running the " + suite + " " + name + " benchmark with the " + pager + "...", 0,
+         NORMAL);
+   }
+
+   BenchmarkResult result;
+   result.mSuite = suite;
+   result.mName = name;
+   result.mPager = pager;
+   result.mDataset = mDataset.toString();
+
+   double totalSeconds = 0.0;
+   for (unsigned int iteration = 0; iteration < mIterations; ++iteration)
+   {
+      double bytes = 0.0;
+      string message;
+
+      QElapsedTimer timer;
+      timer.start();
+      bool success = (this->*method)(pRaster, bytes, message);
+      double seconds = static_cast<double>(timer.nsecsElapsed()) / 1.0e9;
+
+      if (success == false)
+      {
+         result.mIterations = 0;
+         result.mMessage = message.empty() ? "The benchmark failed." : message;
+         break;
+      }
+
+      result.mMinSeconds = (iteration == 0) ? seconds : min(result.mMinSeconds, seconds);
+      result.mMaxSeconds = max(result.mMaxSeconds, seconds);
+      result.mBytes = bytes;
+      result.mMessage = message;
+      totalSeconds += seconds;
+      ++result.mIterations;
+   }
+
+   if (result.mIterations > 0)
+   {
+      result.mMeanSeconds = totalSeconds / result.mIterations;
+   }
+   else if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("The " + suite + " " + name + " benchmark failed with the " + pager + ": " +
+         result.mMessage, 0, WARNING);
+   }
+
+   mResults.addResult(result);
+}
+
+bool RasterBenchmarks::readRows(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   unsigned int bytesPerElement = pDescriptor->getBytesPerElement();
+   unsigned int numRows = pDescriptor->getRowCount();
+   unsigned int numColumns = pDescriptor->getColumnCount();
+   const vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+
+   // Read one band at a time for BSQ data so that the whole cube is touched in every interleave
+   unsigned int bandsPerRow = (pDescriptor->getInterleaveFormat() == BSQ) ? 1 : pDescriptor->getBandCount();
+   size_t rowBytes = static_cast<size_t>(numColumns) * bandsPerRow * bytesPerElement;
+   for (unsigned int band = 0; band < bands.size(); band += bandsPerRow)
+   {
+      FactoryResource<DataRequest> pRequest;
+      if (bandsPerRow == 1)
+      {
+         pRequest->setBands(bands[band], bands[band]);
+      }
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         if (!da.isValid())
+         {
+            message = "Unable to access row " + ::toString(row) + ".";
+            return false;
+         }
+         const unsigned char* pRow = reinterpret_cast<const unsigned char*>(da->getRow());
+         mChecksum += pRow[0] + pRow[rowBytes - 1];
+         da->nextRow();
+      }
+   }
+
+   bytes = mDataset.getSize();
+   return true;
+}
+
+bool RasterBenchmarks::readColumns(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   unsigned int numRows = pDescriptor->getRowCount();
+   unsigned int numColumns = pDescriptor->getColumnCount();
+
+   // Walk down each column of the first band, which is the worst case for row oriented pagers
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(0));
+   DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+   for (unsigned int column = 0; column < numColumns; ++column)
+   {
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         da->toPixel(row, column);
+         if (!da.isValid())
+         {
+            message = "Unable to access column " + ::toString(column) + ".";
+            return false;
+         }
+         mChecksum += *reinterpret_cast<const unsigned char*>(da->getColumn());
+      }
+   }
+
+   bytes = static_cast<double>(numRows) * numColumns * pDescriptor->getBytesPerElement();
+   return true;
+}
+
+bool RasterBenchmarks::readTiles(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   unsigned int bytesPerElement = pDescriptor->getBytesPerElement();
+   unsigned int numRows = pDescriptor->getRowCount();
+   unsigned int numColumns = pDescriptor->getColumnCount();
+   const unsigned int tileSize = 256;
+
+   // Read the first band in square tiles, the way the display requests data. Only BIP rows
+   // contain the bands which were not requested, since every pixel holds all of the bands.
+   unsigned int bandsPerColumn = (pDescriptor->getInterleaveFormat() == BIP) ? pDescriptor->getBandCount() : 1;
+   for (unsigned int startRow = 0; startRow < numRows; startRow += tileSize)
+   {
+      unsigned int stopRow = min(startRow + tileSize, numRows) - 1;
+      for (unsigned int startColumn = 0; startColumn < numColumns; startColumn += tileSize)
+      {
+         unsigned int stopColumn = min(startColumn + tileSize, numColumns) - 1;
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow),
+            stopRow - startRow + 1);
+         pRequest->setColumns(pDescriptor->getActiveColumn(startColumn), pDescriptor->getActiveColumn(stopColumn),
+            stopColumn - startColumn + 1);
+         pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(0));
+         DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+         for (unsigned int row = startRow; row <= stopRow; ++row)
+         {
+            if (!da.isValid())
+            {
+               message = "Unable to access the tile at row " + ::toString(startRow) + ", column " +
+                  ::toString(startColumn) + ".";
+               return false;
+            }
+            const unsigned char* pRow = reinterpret_cast<const unsigned char*>(da->getRow());
+            mChecksum += pRow[0] + pRow[(stopColumn - startColumn) * bandsPerColumn * bytesPerElement];
+            da->nextRow();
+         }
+      }
+   }
+
+   bytes = static_cast<double>(numRows) * numColumns * bytesPerElement;
+   return true;
+}
+
+bool RasterBenchmarks::readRandomPixels(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   unsigned int numRows = pDescriptor->getRowCount();
+   unsigned int numColumns = pDescriptor->getColumnCount();
+
+   // The same pixels are visited in the same order on every run
+   unsigned int state = mDataset.mSeed;
+   const unsigned int numPixels = max(numRows, numColumns) * 64;
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(0));
+   DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+   for (unsigned int pixel = 0; pixel < numPixels; ++pixel)
+   {
+      unsigned int row = ((nextRandom(state) << 15) | nextRandom(state)) % numRows;
+      unsigned int column = ((nextRandom(state) << 15) | nextRandom(state)) % numColumns;
+      da->toPixel(row, column);
+      if (!da.isValid())
+      {
+         message = "Unable to access pixel (" + ::toString(row) + ", " + ::toString(column) + ").";
+         return false;
+      }
+      mChecksum += *reinterpret_cast<const unsigned char*>(da->getColumn());
+   }
+
+   bytes = static_cast<double>(numPixels) * pDescriptor->getBytesPerElement();
+   return true;
+}
+
+bool RasterBenchmarks::readAsBip(RasterElement* pRaster, double& bytes, string& message)
+{
+   return readConverted(pRaster, BIP, bytes, message);
+}
+
+bool RasterBenchmarks::readAsBil(RasterElement* pRaster, double& bytes, string& message)
+{
+   return readConverted(pRaster, BIL, bytes, message);
+}
+
+bool RasterBenchmarks::readAsBsq(RasterElement* pRaster, double& bytes, string& message)
+{
+   return readConverted(pRaster, BSQ, bytes, message);
+}
+
+bool RasterBenchmarks::readConverted(RasterElement* pRaster, InterleaveFormatType interleave, double& bytes,
+                                     string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   unsigned int numRows = pDescriptor->getRowCount();
+   unsigned int numColumns = pDescriptor->getColumnCount();
+   const vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+
+   unsigned int bandsPerRow = (interleave == BSQ) ? 1 : pDescriptor->getBandCount();
+   size_t rowElements = static_cast<size_t>(numColumns) * bandsPerRow;
+   for (unsigned int band = 0; band < bands.size(); band += bandsPerRow)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      if (interleave == BSQ)
+      {
+         pRequest->setBands(bands[band], bands[band]);
+      }
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         if (!da.isValid())
+         {
+            message = "Unable to access row " + ::toString(row) + " as " + StringUtilities::toXmlString(interleave) +
+               ".";
+            return false;
+         }
+         switchOnEncoding(mDataset.mEncoding, sumElements, da->getRow(), rowElements, mChecksum);
+         da->nextRow();
+      }
+   }
+
+   bytes = mDataset.getSize();
+   return true;
+}
+
+bool RasterBenchmarks::computeStatistics(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   const vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+   for (vector<DimensionDescriptor>::const_iterator iter = bands.begin(); iter != bands.end(); ++iter)
+   {
+      Statistics* pStatistics = pRaster->getStatistics(*iter);
+      if (pStatistics == NULL)
+      {
+         message = "Unable to access the band statistics.";
+         return false;
+      }
+
+      // Changing the resolution discards previously calculated statistics
+      int resolution = pStatistics->getStatisticsResolution();
+      pStatistics->setStatisticsResolution(resolution + 1);
+      pStatistics->setStatisticsResolution(resolution);
+      mChecksum += static_cast<unsigned int>(pStatistics->getAverage());
+   }
+
+   bytes = mDataset.getSize();
+   return true;
+}
+
+bool RasterBenchmarks::convolve(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+
+   NEWMAT::Matrix kernel(3, 3);
+   kernel = 1.0 / 9.0;
+   vector<unsigned int> bandNumbers(1, 0);
+   string resultName = pRaster->getName() + " Benchmark Convolution";
+
+   ExecutableResource pConvolution("Generic Convolution", string(), mpProgress, true);
+   if (pConvolution->getPlugIn() == NULL)
+   {
+      message = "The Generic Convolution plug-in is not available.";
+      return false;
+   }
+   pConvolution->getInArgList().setPlugInArgValue(Executable::DataElementArg(), pRaster);
+   pConvolution->getInArgList().setPlugInArgValueLoose("Kernel", &kernel);
+   pConvolution->getInArgList().setPlugInArgValue("Band Numbers", &bandNumbers);
+   pConvolution->getInArgList().setPlugInArgValue("Result Name", &resultName);
+   bool success = pConvolution->execute();
+
+   RasterElement* pResult = pConvolution->getOutArgList().getPlugInArgValue<RasterElement>("Data Element");
+   if (pResult != NULL)
+   {
+      Service<ModelServices>()->destroyElement(pResult);
+   }
+   if (success == false || pResult == NULL)
+   {
+      message = "Generic Convolution failed.";
+      return false;
+   }
+
+   bytes = static_cast<double>(pDescriptor->getRowCount()) * pDescriptor->getColumnCount() *
+      pDescriptor->getBytesPerElement();
+   return true;
+}
+
+bool RasterBenchmarks::bandMath(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor->getBandCount() < 2)
+   {
+      message = "Band Math requires at least two bands.";
+      return false;
+   }
+
+   string expression = "b1 + b2";
+   bool displayResults = false;
+   ExecutableResource pBandMath("Band Math", string(), mpProgress, true);
+   if (pBandMath->getPlugIn() == NULL)
+   {
+      message = "The Band Math plug-in is not available.";
+      return false;
+   }
+   pBandMath->getInArgList().setPlugInArgValue(Executable::DataElementArg(), pRaster);
+   pBandMath->getInArgList().setPlugInArgValue("Input Expression", &expression);
+   pBandMath->getInArgList().setPlugInArgValue("Display Results", &displayResults);
+   bool success = pBandMath->execute();
+
+   RasterElement* pResult = pBandMath->getOutArgList().getPlugInArgValue<RasterElement>("Band Math Result");
+   if (pResult != NULL)
+   {
+      Service<ModelServices>()->destroyElement(pResult);
+   }
+   if (success == false || pResult == NULL)
+   {
+      message = "Band Math failed.";
+      return false;
+   }
+
+   bytes = 2.0 * pDescriptor->getRowCount() * pDescriptor->getColumnCount() * pDescriptor->getBytesPerElement();
+   return true;
+}
+
+bool RasterBenchmarks::principalComponents(RasterElement* pRaster, double& bytes, string& message)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+
+   string transformType = "Second Moment";
+   bool useTransformFile = false;
+   int components = static_cast<int>(min(pDescriptor->getBandCount(), 3U));
+   EncodingType outputEncoding = FLT4BYTES;
+   int maxScaleValue = 255;
+   int minScaleValue = 0;
+   bool displayResults = false;
+
+   ExecutableResource pPca("Principal Component Analysis", string(), mpProgress, true);
+   if (pPca->getPlugIn() == NULL)
+   {
+      message = "The Principal Component Analysis plug-in is not available.";
+      return false;
+   }
+   PlugInArgList& inArgs = pPca->getInArgList();
+   inArgs.setPlugInArgValue(Executable::DataElementArg(), pRaster);
+   inArgs.setPlugInArgValue("Transform Type", &transformType);
+   inArgs.setPlugInArgValue("Use Transform File", &useTransformFile);
+   inArgs.setPlugInArgValue("Components", &components);
+   inArgs.setPlugInArgValue("Output Encoding Type", &outputEncoding);
+   inArgs.setPlugInArgValue("Max Scale Value", &maxScaleValue);
+   inArgs.setPlugInArgValue("Min Scale Value", &minScaleValue);
+   inArgs.setPlugInArgValue("Display Results", &displayResults);
+   bool success = pPca->execute();
+
+   RasterElement* pResult = pPca->getOutArgList().getPlugInArgValue<RasterElement>("Corrected Data Cube");
+   if (pResult != NULL)
+   {
+      Service<ModelServices>()->destroyElement(pResult);
+   }
+
+   if (success == false || pResult == NULL)
+   {
+      message = "Principal Component Analysis failed.";
+      return false;
+   }
+
+   bytes = mDataset.getSize();
+   return true;
+}
+
+bool RasterBenchmarks::exportEnvi(RasterElement* pRaster, double& bytes, string& message)
+{
+   string filename = mTemporaryPath + "/OpticksBenchmark_Export.hdr";
+   bool success = exportRaster(pRaster, "ENVI Exporter", filename, message);
+
+   vector<string> files;
+   files.push_back(filename);
+   files.push_back(mTemporaryPath + "/OpticksBenchmark_Export");
+   removeFiles(files);
+
+   bytes = mDataset.getSize();
+   return success;
+}
+
+namespace
+{
+   const RasterBenchmarks::PagerConfiguration* getPagerConfigurations(unsigned int& count)
+   {
+      // The CachedPager subclasses are reached by exporting the synthetic dataset in a format
+      // the pager reads and importing it on-disk read-only
+      static const RasterBenchmarks::PagerConfiguration sConfigurations[] =
+      {
+         { "InMemoryPager", NULL, NULL, NULL, false, true },
+         { "MemoryMappedPager", NULL, NULL, NULL, false, false },
+         { "Hdf5Pager", "Ice Exporter", ".ice.h5", "Ice Importer", false, false },
+         { "NitfPager", "NITF Exporter", ".ntf", "NITF Importer", false, false },
+         { "GdalRasterPager", "ENVI Exporter", ".hdr", "Generic GDAL Importer", true, false },
+         { "FitsRasterPager", NULL, ".fits", "FITS Importer", false, false },
+         { "Jpeg2000Pager", "JPEG2000 Exporter", ".jp2", "JPEG2000 Importer", false, false },
+         { "ModisPager", NULL, ".hdf", "MODIS L1B Importer", false, false }
+      };
+
+      count = sizeof(sConfigurations) / sizeof(sConfigurations[0]);
+      return sConfigurations;
+   }
+}
@@ -0,0 +1,122 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RASTERBENCHMARKS_H
+#define RASTERBENCHMARKS_H
+
+#include "TypesFile.h"
+
+#include <string>
+#include <vector>
+
+class BenchmarkResults;
+class Progress;
+class RasterElement;
+
+/**
+ * Describes the synthetic raster generated for a benchmark run.  The same
+ * dimensions, encoding, interleave and seed always generate the same data.
+ */
+struct DatasetSpec
+{
+   DatasetSpec() :
+      mRows(2048),
+      mColumns(2048),
+      mBands(8),
+      mEncoding(INT2UBYTES),
+      mInterleave(BIP),
+      mSeed(1)
+   {
+   }
+
+   std::string toString() const;
+   double getSize() const;
+
+   unsigned int mRows;
+   unsigned int mColumns;
+   unsigned int mBands;
+   EncodingType mEncoding;
+   InterleaveFormatType mInterleave;
+   unsigned int mSeed;
+};
+
+/**
+ * Runs the raster I/O and algorithm benchmarks against a synthetic dataset
+ * loaded through each of the selected pagers.
+ */
+class RasterBenchmarks
+{
+public:
+   struct PagerConfiguration;
+
+   RasterBenchmarks(const DatasetSpec& dataset, Progress* pProgress, BenchmarkResults& results);
+
+   /**
+    * Selects the benchmark suites to run.  An empty list runs every suite.
+    * Valid suites are "access", "interleave", "statistics", "convolution",
+    * "bandmath", "pca" and "export".
+    */
+   void setSuites(const std::vector<std::string>& suites);
+
+   /**
+    * Selects the pagers to load the dataset through.  An empty list uses
+    * every pager.
+    */
+   void setPagers(const std::vector<std::string>& pagers);
+
+   void setIterations(unsigned int iterations);
+   void setTemporaryPath(const std::string& path);
+
+   static std::vector<std::string> getSuiteNames();
+   static std::vector<std::string> getPagerNames();
+
+   bool run();
+
+private:
+   RasterBenchmarks& operator=(const RasterBenchmarks& rhs);
+
+   typedef bool (RasterBenchmarks::*BenchmarkMethod)(RasterElement* pRaster, double& bytes, std::string& message);
+
+   RasterElement* createSyntheticRaster(const std::string& name, bool inMemory);
+   RasterElement* loadRaster(const PagerConfiguration& pager, RasterElement* pSource,
+      std::vector<std::string>& files, std::string& message);
+   bool exportRaster(RasterElement* pRaster, const std::string& exporter, const std::string& filename,
+      std::string& message);
+   void removeFiles(const std::vector<std::string>& files) const;
+
+   bool isSuiteSelected(const std::string& suite) const;
+   bool isPagerSelected(const std::string& pager) const;
+   void runBenchmark(const std::string& suite, const std::string& name, const std::string& pager,
+      RasterElement* pRaster, BenchmarkMethod method);
+
+   bool readRows(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readColumns(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readTiles(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readRandomPixels(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readAsBip(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readAsBil(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readAsBsq(RasterElement* pRaster, double& bytes, std::string& message);
+   bool readConverted(RasterElement* pRaster, InterleaveFormatType interleave, double& bytes, std::string& message);
+   bool computeStatistics(RasterElement* pRaster, double& bytes, std::string& message);
+   bool convolve(RasterElement* pRaster, double& bytes, std::string& message);
+   bool bandMath(RasterElement* pRaster, double& bytes, std::string& message);
+   bool principalComponents(RasterElement* pRaster, double& bytes, std::string& message);
+   bool exportEnvi(RasterElement* pRaster, double& bytes, std::string& message);
+
+   DatasetSpec mDataset;
+   Progress* mpProgress;
+   BenchmarkResults& mResults;
+   std::vector<std::string> mSuites;
+   std::vector<std::string> mPagers;
+   unsigned int mIterations;
+   std::string mTemporaryPath;
+   unsigned int mChecksum;
+};
+
+#endif
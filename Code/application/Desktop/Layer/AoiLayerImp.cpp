@@ -36,6 +36,8 @@
 #include "PixelObjectImp.h"
 #include "PolygonObject.h"
 #include "PropertiesAoiLayer.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
 #include "SessionManager.h"
 #include "SpatialDataView.h"
 #include "SpatialDataViewImp.h"
@@ -57,12 +59,27 @@ XERCES_CPP_NAMESPACE_USE
 
 unsigned int AoiLayerImp::sNumLayers = 0;
 
+namespace
+{
+   // Mask textures are square tiles of this many texels, stored as one bit per pixel at full resolution
+   const int sMaskTileSize = 256;
+   const int sMaskTileRowWords = sMaskTileSize / 32;
+   const unsigned int sMaxMaskTextureLevel = 4;
+
+   enum MaskTileState { MASK_TILE_DIRTY, MASK_TILE_EMPTY, MASK_TILE_CURRENT };
+}
+
 AoiLayerImp::AoiLayerImp(const string& id, const string& layerName, DataElement* pElement) :
    GraphicLayerImp(id, layerName, pElement),
    mSymbol(AoiLayer::getSettingMarkerSymbol()),
    mLabelHandleSize(4.0),
    mLabelHandleDrawn(false),
-   mLabelMoving(false)
+   mLabelMoving(false),
+   mpTextureMask(NULL),
+   mTextureMaskModification(0),
+   mTextureRows(0),
+   mTextureColumns(0),
+   mMaskTextures(0)
 {
    addAcceptableGraphicType(LINE_OBJECT);
    addAcceptableGraphicType(HLINE_OBJECT);
@@ -401,22 +418,51 @@ void AoiLayerImp::objectWasAdded(GraphicObject *pObject)
 
 void AoiLayerImp::drawGroup()
 {
-   if (mustDrawAsBitmask())
+   if (mustDrawAsBitmask() || containsOnlyBitMasks())
    {
-      PerspectiveView* pView = dynamic_cast<PerspectiveView*>(getView());
-      double zoomPercent = 100;
-      if (pView != NULL)
+      AoiElement* pAoi = static_cast<AoiElement*>(getDataElement());
+      VERIFYNRV(pAoi != NULL);
+
+      const BitMask* pMask = pAoi->getSelectedPoints();
+
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(pAoi->getParent());
+      if (pRaster == NULL)
       {
-         zoomPercent = pView->getZoomPercentage();
+         SpatialDataView* pView = dynamic_cast<SpatialDataView*>(getView());
+         if (pView != NULL && pView->getLayerList() != NULL)
+         {
+            pRaster = pView->getLayerList()->getPrimaryRasterElement();
+         }
       }
 
-      AoiElement* pAoi = static_cast<AoiElement*>(getDataElement());
-      VERIFYNRV(pAoi != NULL);
-      GraphicResource<BitMaskObjectImp> pMaskObj(BITMASK_OBJECT, dynamic_cast<AoiLayer*>(this));
-      pMaskObj->setFillColor(ColorType(mColor.red(), mColor.green(), mColor.blue()));
-      pMaskObj->setPixelSymbol(mSymbol);
-      pMaskObj->setBitMask(pAoi->getSelectedPoints(), false);
-      pMaskObj->draw(zoomPercent / 100);
+      int rows = 0;
+      int columns = 0;
+      if (pRaster != NULL)
+      {
+         const RasterDataDescriptor* pDescriptor =
+            dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+         if (pDescriptor != NULL)
+         {
+            rows = static_cast<int>(pDescriptor->getRowCount());
+            columns = static_cast<int>(pDescriptor->getColumnCount());
+         }
+      }
+
+      if (drawMaskTextures(dynamic_cast<const BitMaskImp*>(pMask), rows, columns) == false)
+      {
+         PerspectiveView* pView = dynamic_cast<PerspectiveView*>(getView());
+         double zoomPercent = 100;
+         if (pView != NULL)
+         {
+            zoomPercent = pView->getZoomPercentage();
+         }
+
+         GraphicResource<BitMaskObjectImp> pMaskObj(BITMASK_OBJECT, dynamic_cast<AoiLayer*>(this));
+         pMaskObj->setFillColor(ColorType(mColor.red(), mColor.green(), mColor.blue()));
+         pMaskObj->setPixelSymbol(mSymbol);
+         pMaskObj->setBitMask(pMask, false);
+         pMaskObj->draw(zoomPercent / 100);
+      }
 
       if (getShowLabels())
       {
@@ -440,6 +486,262 @@ void AoiLayerImp::drawGroup()
    }
 }
 
+bool AoiLayerImp::drawMaskTextures(const BitMaskImp* pMask, int rows, int columns)
+{
+   if (pMask == NULL || rows <= 0 || columns <= 0)
+   {
+      return false;
+   }
+
+   int visStartColumn = 0;
+   int visStartRow = 0;
+   int visEndColumn = columns - 1;
+   int visEndRow = rows - 1;
+   DrawUtil::restrictToViewport(visStartColumn, visStartRow, visEndColumn, visEndRow);
+   double pixelSize = DrawUtil::getPixelSize(visStartColumn, visStartRow, visEndColumn, visEndRow);
+
+   // Symbols are drawn on each pixel once the pixels are large enough to see them
+   if (mSymbol != SOLID && (mSymbol == BOX || pixelSize >= 2.0))
+   {
+      return false;
+   }
+
+   // The textures belong to a single context, so other views sharing the layer draw the pixels directly
+   const QGLContext* pContext = QGLContext::currentContext();
+   if (pContext == NULL || (mMaskTextures.get() != NULL && mMaskTextures.getContext() != pContext))
+   {
+      return false;
+   }
+
+   updateMaskTiles(*pMask, rows, columns);
+   if (mMaskTextures.get() == NULL)
+   {
+      return false;
+   }
+
+   // Use the coarsest level whose texels are no larger than a screen pixel
+   unsigned int level = 0;
+   while (level + 1 < mMaskTextureLevels.size() && pixelSize * (1 << (level + 1)) <= 1.0)
+   {
+      ++level;
+   }
+
+   MaskTextureLevel& textureLevel = mMaskTextureLevels[level];
+   const int tilePixels = sMaskTileSize << level;
+
+   glEnable(GL_TEXTURE_2D);
+   glEnable(GL_BLEND);
+   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+   glColor4ub(mColor.red(), mColor.green(), mColor.blue(), 0xff);
+
+   for (int tileRow = visStartRow / tilePixels; tileRow <= visEndRow / tilePixels; ++tileRow)
+   {
+      for (int tileColumn = visStartColumn / tilePixels; tileColumn <= visEndColumn / tilePixels; ++tileColumn)
+      {
+         unsigned int index = tileRow * textureLevel.mTileColumns + tileColumn;
+         if (textureLevel.mTileStates[index] == MASK_TILE_DIRTY)
+         {
+            updateMaskTexture(level, tileColumn, tileRow);
+         }
+
+         if (textureLevel.mTileStates[index] == MASK_TILE_EMPTY)
+         {
+            continue;
+         }
+
+         int x1 = tileColumn * tilePixels;
+         int y1 = tileRow * tilePixels;
+         int x2 = x1 + tilePixels;
+         int y2 = y1 + tilePixels;
+
+         glBindTexture(GL_TEXTURE_2D, mMaskTextures.get()[textureLevel.mFirstTexture + index]);
+         glBegin(GL_QUADS);
+         glTexCoord2f(0.0f, 0.0f);
+         glVertex2i(x1, y1);
+         glTexCoord2f(1.0f, 0.0f);
+         glVertex2i(x2, y1);
+         glTexCoord2f(1.0f, 1.0f);
+         glVertex2i(x2, y2);
+         glTexCoord2f(0.0f, 1.0f);
+         glVertex2i(x1, y2);
+         glEnd();
+      }
+   }
+
+   glBindTexture(GL_TEXTURE_2D, 0);
+   glDisable(GL_BLEND);
+   glDisable(GL_TEXTURE_2D);
+   return true;
+}
+
+void AoiLayerImp::updateMaskTiles(const BitMaskImp& mask, int rows, int columns)
+{
+   if (&mask != mpTextureMask || rows != mTextureRows || columns != mTextureColumns || mMaskTextures.get() == NULL)
+   {
+      mpTextureMask = &mask;
+      mTextureRows = rows;
+      mTextureColumns = columns;
+
+      mMaskTextureLevels.clear();
+      unsigned int textureCount = 0;
+      for (unsigned int level = 0; level <= sMaxMaskTextureLevel; ++level)
+      {
+         const int tilePixels = sMaskTileSize << level;
+
+         MaskTextureLevel textureLevel;
+         textureLevel.mTileColumns = (columns + tilePixels - 1) / tilePixels;
+         textureLevel.mTileRows = (rows + tilePixels - 1) / tilePixels;
+         textureLevel.mFirstTexture = textureCount;
+         textureLevel.mTileStates.assign(textureLevel.mTileColumns * textureLevel.mTileRows, MASK_TILE_DIRTY);
+         textureCount += textureLevel.mTileStates.size();
+         mMaskTextureLevels.push_back(textureLevel);
+
+         if (textureLevel.mTileStates.size() == 1)
+         {
+            break;
+         }
+      }
+
+      mMaskTextures = GlTextureResource(textureCount);
+      mMaskTileBits.assign(mMaskTextureLevels.front().mTileStates.size(), vector<unsigned int>());
+
+      // Force every tile to be read from the mask
+      mTextureMaskModification = mask.getModificationCount() - 1;
+   }
+
+   if (mask.getModificationCount() == mTextureMaskModification)
+   {
+      return;
+   }
+
+   mTextureMaskModification = mask.getModificationCount();
+
+   // Read the mask into the full resolution tiles and only mark the tiles which changed as dirty
+   const bool outside = mask.isOutsideSelected();
+   const bool empty = (outside == false && mask.getCount() == 0);
+   int boxStartColumn = 0;
+   int boxStartRow = 0;
+   int boxEndColumn = 0;
+   int boxEndRow = 0;
+   mask.getBoundingBox(boxStartColumn, boxStartRow, boxEndColumn, boxEndRow);
+
+   const MaskTextureLevel& baseLevel = mMaskTextureLevels.front();
+   vector<unsigned int> bits;
+   for (int tileRow = 0; tileRow < baseLevel.mTileRows; ++tileRow)
+   {
+      for (int tileColumn = 0; tileColumn < baseLevel.mTileColumns; ++tileColumn)
+      {
+         const int startColumn = tileColumn * sMaskTileSize;
+         const int startRow = tileRow * sMaskTileSize;
+         const int endColumn = min(startColumn + sMaskTileSize, columns) - 1;
+         const int endRow = min(startRow + sMaskTileSize, rows) - 1;
+
+         bits.clear();
+         bool inBox = (empty == false && startColumn <= boxEndColumn && endColumn >= boxStartColumn &&
+            startRow <= boxEndRow && endRow >= boxStartRow);
+         if (inBox || outside)
+         {
+            for (int row = startRow; row <= endRow; ++row)
+            {
+               for (int column = startColumn; column <= endColumn; ++column)
+               {
+                  if (mask.getPixel(column, row))
+                  {
+                     if (bits.empty())
+                     {
+                        bits.assign(sMaskTileSize * sMaskTileRowWords, 0);
+                     }
+
+                     int tileX = column - startColumn;
+                     bits[(row - startRow) * sMaskTileRowWords + tileX / 32] |= 1U << (tileX % 32);
+                  }
+               }
+            }
+         }
+
+         vector<unsigned int>& tileBits = mMaskTileBits[tileRow * baseLevel.mTileColumns + tileColumn];
+         if (bits != tileBits)
+         {
+            tileBits.swap(bits);
+            for (unsigned int level = 0; level < mMaskTextureLevels.size(); ++level)
+            {
+               MaskTextureLevel& textureLevel = mMaskTextureLevels[level];
+               textureLevel.mTileStates[(tileRow >> level) * textureLevel.mTileColumns + (tileColumn >> level)] =
+                  MASK_TILE_DIRTY;
+            }
+         }
+      }
+   }
+}
+
+void AoiLayerImp::updateMaskTexture(unsigned int level, int tileColumn, int tileRow)
+{
+   MaskTextureLevel& textureLevel = mMaskTextureLevels[level];
+   const unsigned int index = tileRow * textureLevel.mTileColumns + tileColumn;
+
+   // Decimate the full resolution tiles covered by this tile, setting a texel if any covered pixel is selected
+   const MaskTextureLevel& baseLevel = mMaskTextureLevels.front();
+   const int scale = 1 << level;
+   const int baseTileTexels = sMaskTileSize >> level;
+   const int firstBaseColumn = tileColumn * scale;
+   const int firstBaseRow = tileRow * scale;
+   const int lastBaseColumn = min(firstBaseColumn + scale, baseLevel.mTileColumns) - 1;
+   const int lastBaseRow = min(firstBaseRow + scale, baseLevel.mTileRows) - 1;
+
+   vector<unsigned char> texels;
+   for (int baseRow = firstBaseRow; baseRow <= lastBaseRow; ++baseRow)
+   {
+      for (int baseColumn = firstBaseColumn; baseColumn <= lastBaseColumn; ++baseColumn)
+      {
+         const vector<unsigned int>& bits = mMaskTileBits[baseRow * baseLevel.mTileColumns + baseColumn];
+         if (bits.empty())
+         {
+            continue;
+         }
+
+         if (texels.empty())
+         {
+            texels.assign(sMaskTileSize * sMaskTileSize, 0);
+         }
+
+         const int texelColumn = (baseColumn - firstBaseColumn) * baseTileTexels;
+         const int texelRow = (baseRow - firstBaseRow) * baseTileTexels;
+         for (int y = 0; y < sMaskTileSize; ++y)
+         {
+            unsigned char* pTexels = &texels[(texelRow + (y >> level)) * sMaskTileSize + texelColumn];
+            for (int word = 0; word < sMaskTileRowWords; ++word)
+            {
+               unsigned int values = bits[y * sMaskTileRowWords + word];
+               for (int x = word * 32; values != 0; ++x, values >>= 1)
+               {
+                  if (values & 1)
+                  {
+                     pTexels[x >> level] = 0xff;
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   if (texels.empty())
+   {
+      textureLevel.mTileStates[index] = MASK_TILE_EMPTY;
+      return;
+   }
+
+   glBindTexture(GL_TEXTURE_2D, mMaskTextures.get()[textureLevel.mFirstTexture + index]);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, sMaskTileSize, sMaskTileSize, 0, GL_ALPHA, GL_UNSIGNED_BYTE,
+      &texels.front());
+   textureLevel.mTileStates[index] = MASK_TILE_CURRENT;
+}
+
 void AoiLayerImp::draw()
 {
    GraphicLayerImp::draw();
@@ -634,6 +936,29 @@ bool AoiLayerImp::mustDrawAsBitmask() const
    return false;
 }
 
+bool AoiLayerImp::containsOnlyBitMasks() const
+{
+   const GraphicGroup* pGroup = getGroup();
+   VERIFY(pGroup != NULL);
+
+   const list<GraphicObject*>& objects = pGroup->getObjects();
+   if (objects.empty())
+   {
+      return false;
+   }
+
+   for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
+   {
+      GraphicObject* pObj = *iter;
+      if (pObj == NULL || pObj->getGraphicObjectType() != BITMASK_OBJECT)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
 bool AoiLayerImp::mayDrawAsPixels() const
 {
    return true;
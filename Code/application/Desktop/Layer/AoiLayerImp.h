@@ -15,9 +15,14 @@
 #include <QtGui/QFont>
 
 #include "ColorType.h"
+#include "GlTextureResource.h"
 #include "GraphicLayerImp.h"
 #include "TypesFile.h"
 
+#include <vector>
+
+class BitMaskImp;
+
 class AoiLayerImp : public GraphicLayerImp
 {
    Q_OBJECT
@@ -88,6 +93,24 @@ private:
    AoiLayerImp(const AoiLayerImp& rhs);
 
    bool mustDrawAsBitmask() const;
+   bool containsOnlyBitMasks() const;
+
+   /**
+    * The selected pixels of the AOI are cached as alpha textures in square tiles.  Each level
+    * halves the resolution of the level below it so zoomed out views draw a small number of
+    * textures.  A decimated texel is set if any of the pixels it covers are selected.
+    */
+   struct MaskTextureLevel
+   {
+      int mTileColumns;
+      int mTileRows;
+      unsigned int mFirstTexture;
+      std::vector<unsigned char> mTileStates;
+   };
+
+   bool drawMaskTextures(const BitMaskImp* pMask, int rows, int columns);
+   void updateMaskTiles(const BitMaskImp& mask, int rows, int columns);
+   void updateMaskTexture(unsigned int level, int tileColumn, int tileRow);
 
    double mLabelHandleSize;
    LocationType mLabelOffset;
@@ -97,6 +120,14 @@ private:
    ModeType mCurrentMode;
    QFont mFont;
 
+   const BitMaskImp* mpTextureMask;
+   unsigned int mTextureMaskModification;
+   int mTextureRows;
+   int mTextureColumns;
+   std::vector<std::vector<unsigned int> > mMaskTileBits;
+   std::vector<MaskTextureLevel> mMaskTextureLevels;
+   GlTextureResource mMaskTextures;
+
    static unsigned int sNumLayers;
 };
 
@@ -55,6 +55,144 @@ XERCES_CPP_NAMESPACE_USE
 static double computeSpacing(double range);
 static double getStep(double diff);
 
+namespace
+{
+   // Gridlines are traced over the visible geocoord range padded by this fraction on each side so that
+   // panning does not retrace them
+   const double sGridlinePadding = 0.5;
+
+   // Gridlines are retraced once the view zooms in by this factor from when they were traced
+   const double sGridlineZoomThreshold = 4.0;
+
+   // The maximum distance in screen pixels between a traced gridline and its segments
+   const double sGridlineTolerance = 0.5;
+
+   const int sGridlineSegments = 64;
+   const unsigned int sMaxGridlineDepth = 8;
+
+   /**
+    * Traces a line of constant latitude or longitude through the georeference.  Segments are bisected
+    * where the line curves more than the tolerance or where the georeference becomes invalid.
+    */
+   class GridlineTracer
+   {
+   public:
+      GridlineTracer(RasterElement* pRaster, bool lat, double value, bool extrapolate, double tolerance,
+         vector<LocationType>& vertices) :
+         mpRaster(pRaster),
+         mLat(lat),
+         mValue(value),
+         mExtrapolate(extrapolate),
+         mTolerance(tolerance),
+         mVertices(vertices),
+         mInvalidVertex(numeric_limits<double>::infinity(), numeric_limits<double>::infinity())
+      {}
+
+      void trace(double start, double stop)
+      {
+         bool startValid = false;
+         LocationType startPixel = convert(start, startValid);
+         mVertices.push_back(startValid ? startPixel : mInvalidVertex);
+
+         for (int i = 1; i <= sGridlineSegments; ++i)
+         {
+            double end = start + (stop - start) * i / sGridlineSegments;
+            bool endValid = false;
+            LocationType endPixel = convert(end, endValid);
+            refine(start, startPixel, startValid, end, endPixel, endValid, 0);
+
+            start = end;
+            startPixel = endPixel;
+            startValid = endValid;
+         }
+      }
+
+   private:
+      LocationType convert(double offAxis, bool& valid) const
+      {
+         LocationType geoVertex = (mLat ? LocationType(mValue, offAxis) : LocationType(offAxis, mValue));
+         LocationType pixelVertex = mpRaster->convertGeocoordToPixel(geoVertex, false, &valid);
+         valid |= mExtrapolate;
+         return pixelVertex;
+      }
+
+      void refine(double start, const LocationType& startPixel, bool startValid, double end,
+         const LocationType& endPixel, bool endValid, unsigned int depth)
+      {
+         if (depth < sMaxGridlineDepth && (startValid || endValid))
+         {
+            double middle = (start + end) / 2.0;
+            bool middleValid = false;
+            LocationType middlePixel = convert(middle, middleValid);
+
+            bool split = (middleValid != startValid || middleValid != endValid);
+            if (split == false && middleValid == true)
+            {
+               LocationType chord = endPixel - startPixel;
+               LocationType offset = middlePixel - startPixel;
+               double chordLength = chord.length();
+               double distance = offset.length();
+               if (chordLength > 0.0)
+               {
+                  distance = fabs(chord.mX * offset.mY - chord.mY * offset.mX) / chordLength;
+               }
+
+               split = (distance > mTolerance);
+            }
+
+            if (split == true)
+            {
+               refine(start, startPixel, startValid, middle, middlePixel, middleValid, depth + 1);
+               refine(middle, middlePixel, middleValid, end, endPixel, endValid, depth + 1);
+               return;
+            }
+         }
+
+         mVertices.push_back(endValid ? endPixel : mInvalidVertex);
+      }
+
+      RasterElement* mpRaster;
+      bool mLat;
+      double mValue;
+      bool mExtrapolate;
+      double mTolerance;
+      vector<LocationType>& mVertices;
+      LocationType mInvalidVertex;
+   };
+
+   /**
+    * Returns the fraction along a segment with one end inside a rectangle at which it crosses the rectangle.
+    */
+   double clipToRectangle(double x1, double y1, double x2, double y2, double width, double height,
+      bool startInside)
+   {
+      double p[4] = {x1 - x2, x2 - x1, y1 - y2, y2 - y1};
+      double q[4] = {x1, width - x1, y1, height - y1};
+
+      double enter = 0.0;
+      double exit = 1.0;
+      for (int i = 0; i < 4; ++i)
+      {
+         if (p[i] == 0.0)
+         {
+            continue;
+         }
+
+         double t = q[i] / p[i];
+         if (p[i] < 0.0)
+         {
+            enter = max(enter, t);
+         }
+         else
+         {
+            exit = min(exit, t);
+         }
+      }
+
+      return (startInside ? exit : enter);
+   }
+}
+
 LatLonLayerImp::LatLonLayerImp(const string& id, const string& layerName, DataElement* pElement) :
    LayerImp(id, layerName, pElement),
    mGeocoordType(GeoreferenceDescriptor::getSettingGeocoordType()),
@@ -70,6 +208,8 @@ LatLonLayerImp::LatLonLayerImp(const string& id, const string& layerName, DataEl
    mComputedTickSpacing(0.0, 0.0),
    mComputedTickSpacingDirty(true),
    mBorderDirty(true),
+   mGridlineTolerance(0.0),
+   mGridlinesDirty(true),
    mFont(LatLonLayerImp::getDefaultFont())
 {
    mpElement.addSignal(SIGNAL_NAME(RasterElement, GeoreferenceModified),
@@ -111,6 +251,7 @@ void LatLonLayerImp::georeferenceModified(Subject& subject, const string& signal
 {
    setBorderDirty(true);
    setTickSpacingDirty(true);
+   mGridlinesDirty = true;
 }
 
 bool LatLonLayerImp::isKindOfLayer(const string& className)
@@ -143,6 +284,7 @@ LatLonLayerImp& LatLonLayerImp::operator=(const LatLonLayerImp& latLonLayer)
       mFont = latLonLayer.mFont;
       mGeocoordType = latLonLayer.mGeocoordType;
       mFormat = latLonLayer.mFormat;
+      mGridlinesDirty = true;
    }
 
    return *this;
@@ -169,23 +311,16 @@ vector<ColorType> LatLonLayerImp::getColors() const
 
 void LatLonLayerImp::draw()
 {
-   const int stepCount = 100;
    LocationType tickSpacing;
    LocationType start;
    LocationType stop;
-   LocationType stepSize;
    int xCount;
    int yCount;
    int i;
    int j;
-   double stepValuesX[stepCount];
-   double stepValuesY[stepCount];
    LocationType geoVertex;
    LocationType pixelVertex;
-   LocationType lastGeoVertex;
    LocationType badVertex(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
-   LocationType lastPixelVertex;
-   LocationType firstGoodPixelVertex;
    bool haveX = false;
    bool haveY = false;
 
@@ -306,15 +441,11 @@ void LatLonLayerImp::draw()
    stop.mX = floor(mMaxCoord.mX / tickSpacing.mX) * tickSpacing.mX;
    stop.mY = floor(mMaxCoord.mY / tickSpacing.mY) * tickSpacing.mY;
 
-   stepSize.mX = (mMaxCoord.mX - mMinCoord.mX) / static_cast<double>(stepCount - 1);
-   stepSize.mY = (mMaxCoord.mY - mMinCoord.mY) / static_cast<double>(stepCount - 1);
-
    xCount = 1.5 + (stop.mX - start.mX) / tickSpacing.mX;
    yCount = 1.5 + (stop.mY - start.mY) / tickSpacing.mY;
 
    //Vertices array will be populated wtih vertexes for drawing each lat/lon line
    vector<LocationType> vertices;
-   vertices.reserve(stepCount);
    bool vertexValid;
 
    if (mStyle == LATLONSTYLE_DASHED)
@@ -325,14 +456,17 @@ void LatLonLayerImp::draw()
 
    if (mStyle == LATLONSTYLE_SOLID || mStyle == LATLONSTYLE_DASHED)
    {
-      LocationType oldVertex;
-
-      for (j = 0; j < stepCount; ++j)
+      //The gridlines are traced through the georeference in pixel coordinates and cached, so only clipping
+      //them to the view is done on each draw.  Trace them to within a fraction of a screen pixel.
+      double tolerance = sGridlineTolerance;
+      double dataWidth = (dataUpperRight - dataUpperLeft).length();
+      if (dataWidth > 0.0 && pView->width() > 0)
       {
-         stepValuesX[j] = mMinCoord.mX + static_cast<double>(j) * stepSize.mX;  //lat points for drawing lon lines
-         stepValuesY[j] = mMinCoord.mY + static_cast<double>(j) * stepSize.mY;  //lon points for drawing lat lines
+         tolerance *= dataWidth / pView->width();
       }
 
+      updateGridlines(LocationType(haveX ? tickSpacing.mX : 0.0, haveY ? tickSpacing.mY : 0.0), tolerance);
+
       BorderType startXBorderType = LEFT_BORDER;
       BorderType endXBorderType = RIGHT_BORDER;
       BorderType startYBorderType = TOP_BORDER;
@@ -353,7 +487,6 @@ void LatLonLayerImp::draw()
     
       LocationType startLabel;
       LocationType endLabel;
-      LocationType clippedLabel;
 
       bool bDrewLatLine = false;
       bool bDrewLonLine = false;
@@ -366,221 +499,121 @@ void LatLonLayerImp::draw()
          {
             lat = false;
          }
-         bool& haveAxis = (lat ? haveX : haveY);
-         int& count = (lat ? xCount : yCount);
-         double& geoVertexAxis = (lat ? geoVertex.mX : geoVertex.mY);
-         double& geoVertexOffAxis = (lat ? geoVertex.mY : geoVertex.mX);
-         double& lastGeoVertexAxis = (lat ? lastGeoVertex.mX : lastGeoVertex.mY);
-         double& lastGeoVertexOffAxis = (lat ? lastGeoVertex.mY : lastGeoVertex.mX);
-         double& startAxis = (lat ? start.mX : start.mY);
-         double& tickSpacingAxis = (lat ? tickSpacing.mX : tickSpacing.mY);
-         double* stepValuesOffAxis = (lat ? stepValuesY : stepValuesX);
          BorderType& startBorderType = (lat ? startXBorderType : startYBorderType);
          BorderType& endBorderType = (lat ? endXBorderType : endYBorderType);
          bool& bDrewLine = (lat ? bDrewLatLine : bDrewLonLine);
 
-         if (haveAxis)
+         for (vector<Gridline>::const_iterator lineIter = mGridlines.begin(); lineIter != mGridlines.end(); ++lineIter)
          {
-            //Loop for each lat or lon line that needs potentially drawn
-            for (i = 0; i < count; ++i)
+            if (lineIter->mLatitude != lat)
             {
-               //Fix lat or lon used for the current line being drawn.  This will not change during this iteration
-               //of the loop.
-               geoVertexAxis = startAxis + static_cast<double>(i) * tickSpacingAxis;
-               geoVertexOffAxis = 0.0;
-               vertices.clear();
+               continue;
+            }
 
-               if (lat)
-               {
-                  if (mGeocoordType == GEOCOORD_LATLON)
-                  {
-                     if (geoVertexAxis < LAT_MIN || geoVertexAxis > LAT_MAX)
-                     {
-                        continue;
-                     }
-                  }
-                  else
-                  {
-                     //UTM/MGRS only defined between S80 and N84
-                     if (geoVertexAxis < LAT_UTMMIN || geoVertexAxis > LAT_UTMMAX)
-                     {
-                        continue;
-                     }
-                  }
-               }
-               else
+            //Clip the cached line to the view.  Vertices outside the view are not drawn and a vertex is
+            //inserted where the line crosses the edge of the view.
+            vertices.clear();
+            LocationType lastPixelVertex = badVertex;
+            bool lastVertexValid = false;
+            double lastScreenX = 0.0;
+            double lastScreenY = 0.0;
+            for (vector<LocationType>::const_iterator vertexIter = lineIter->mVertices.begin();
+               vertexIter != lineIter->mVertices.end(); ++vertexIter)
+            {
+               pixelVertex = *vertexIter;
+
+               double screenX = 0.0;
+               double screenY = 0.0;
+               vertexValid = false;
+               if (pixelVertex != badVertex)
                {
-                  if (geoVertexAxis < LON_MIN || geoVertexAxis > LON_MAX)
-                  {
-                     continue;
-                  }
+                  translateDataToScreen(pixelVertex.mX, pixelVertex.mY, screenX, screenY);
+                  vertexValid = (screenX > 0.0 && screenY > 0.0 &&
+                     screenX < pView->width() && screenY < pView->height());
                }
 
-               //Loop for each vertex point, drawing the line segment if it should be displayed
-               bool bVertexGoneValid = false;
-               for (int loc = 0; loc < stepCount; ++loc)
+               if (vertexValid != lastVertexValid && pixelVertex != badVertex && lastPixelVertex != badVertex)
                {
-                  double screenX1;
-                  double screenY1;
-                  double screenX2;
-                  double screenY2;
-
-                  //Latch the geo point along the line into geoVertex
-                  //Vertex is NOT valid if the geo reference says it is not.  Will not be drawn if not valid
-                  geoVertexOffAxis = stepValuesOffAxis[loc];
-
-                  if (lat)
-                  {
-                     if (geoVertexOffAxis < LON_MIN || geoVertexOffAxis > LON_MAX)
-                     {
-                        continue;
-                     }
-                  }
-                  else
-                  {
-                     if (mGeocoordType == GEOCOORD_LATLON)
-                     {
-                        if (geoVertexOffAxis < LAT_MIN || geoVertexOffAxis > LAT_MAX)
-                        {
-                           continue;
-                        }
-                     }
-                     else
-                     {
-                        //UTM/MGRS only defined between S80 and N84
-                        if (geoVertexOffAxis < LAT_UTMMIN || geoVertexOffAxis > LAT_UTMMAX)
-                        {
-                           continue;
-                        }
-                     }
-                  }
-
-                  pixelVertex = pRaster->convertGeocoordToPixel(geoVertex, false, &vertexValid);
-                  vertexValid |= mbExtrapolate;
+                  double t = clipToRectangle(lastScreenX, lastScreenY, screenX, screenY, pView->width(),
+                     pView->height(), lastVertexValid);
+                  vertices.push_back(lastPixelVertex + (pixelVertex - lastPixelVertex) * t);
+               }
 
-                  //Check if pixel loc is in bounding box, if not it's invalid regardless of geo reference validity.
-                  if (vertexValid)
-                  {
-                     translateDataToScreen(pixelVertex.mX, pixelVertex.mY, screenX1, screenY1);
-                     vertexValid = (screenX1 > 0.0 && screenY1 > 0.0 &&
-                        screenX1 < pView->width() && screenY1 < pView->height());
-                  }
+               vertices.push_back(vertexValid ? pixelVertex : badVertex);
 
-                  if ((vertexValid != bVertexGoneValid) && loc != 0)
-                  {
-                     //The vertex is transitioning between invalid and valid, need to determine
-                     //where along the segment it changed and insert vertex there...
-                     lastGeoVertexAxis = geoVertexAxis;
-                     lastGeoVertexOffAxis = stepValuesOffAxis[loc-1];
-                     lastPixelVertex = pRaster->convertGeocoordToPixel(lastGeoVertex);
-                     translateDataToScreen(pixelVertex.mX, pixelVertex.mY, screenX1, screenY1);
-                     translateDataToScreen(lastPixelVertex.mX, lastPixelVertex.mY, screenX2, screenY2);
-                     //Start at valid vertex and work back one pixel at a time until bad vertex found...
-                     double geoPerPixel = (geoVertexOffAxis - lastGeoVertexOffAxis)/sqrt(pow((screenX1 - screenX2), 2) +
-                        pow((screenY1 - screenY2), 2));
-                     lastPixelVertex = pixelVertex;
-                     bool valid = vertexValid;
-                     while ((valid != bVertexGoneValid) && (geoVertexOffAxis > lastGeoVertexOffAxis))
-                     {
-                        firstGoodPixelVertex = lastPixelVertex;
-                        geoVertexOffAxis -= geoPerPixel;
-                        lastPixelVertex = pRaster->convertGeocoordToPixel(geoVertex, false, &valid);
-                        valid |= mbExtrapolate;
-
-                        if (valid)
-                        {
-                           //Georeference says it's valid, now check if it's in the view
-                           translateDataToScreen(lastPixelVertex.mX, lastPixelVertex.mY, screenX1, screenY1);
-                           valid = (screenX1 > 0.0 && screenY1 > 0.0 &&
-                              screenX1 < pView->width() && screenY1 < pView->height());
-                        }
-                     }
-                     //Found which pixel along the line segment was the first valid one, add it to the vertex array.
-                     vertices.push_back(firstGoodPixelVertex);
-                  }
+               lastPixelVertex = pixelVertex;
+               lastVertexValid = vertexValid;
+               lastScreenX = screenX;
+               lastScreenY = screenY;
+            }
 
-                  if (vertexValid)
-                  {
-                     //Mark that we have seen a valid vertex and add it to the vertex array for drawing.
-                     bVertexGoneValid = true;
-                     vertices.push_back(pixelVertex);
-                  }
-                  else //vertex not valid
+            // now draw the grid line
+            startLabel = badVertex;
+            endLabel = badVertex;
+ 
+            if (bProductView)
+            {
+               // project vertices to screen coordinates
+               GLdouble winZ;
+               for (vector<LocationType>::iterator it = vertices.begin(); it != vertices.end(); ++it)
+               {
+                  if (*it != badVertex)
                   {
-                     //Mark this vertex as bad (don't draw to this vertex)
-                     bVertexGoneValid = false;
-                     vertices.push_back(badVertex);
+                     gluProject((*it).mX, (*it).mY, 0.0, modelMatrix, projectionMatrix, viewPort,
+                        &(*it).mX, &(*it).mY, &winZ);
                   }
                }
+            }
 
-               // now draw the grid line
-               startLabel = badVertex;
-               endLabel = badVertex;
- 
-               if (bProductView)
+            if (!vertices.empty())
+            {
+               glLineWidth(1);
+               glLineWidth(mWidth);
+               glBegin (GL_LINE_STRIP);
+               vector<LocationType>::iterator it;
+               for (it = vertices.begin(); it != vertices.end(); ++it)
                {
-                  // project vertices to screen coordinates
-                  GLdouble winZ;
-                  for (vector<LocationType>::iterator it = vertices.begin(); it != vertices.end(); ++it)
+                  if (*it != badVertex)
                   {
-                     if (*it != badVertex)
+                     if (startLabel == badVertex)
                      {
-                        gluProject((*it).mX, (*it).mY, 0.0, modelMatrix, projectionMatrix, viewPort,
-                           &(*it).mX, &(*it).mY, &winZ);
+                        //First good vertex, save label position
+                        startLabel = *it;
+
                      }
+                     glVertex2f(it->mX, it->mY);
+                     bDrewLine = true;
+                     endLabel = *it;  //End label will be drawn at last good vertex
                   }
                }
+               glEnd();
 
-               if (!vertices.empty())
+               if (startLabel != badVertex)
                {
-                  glLineWidth(1);
-                  glLineWidth(mWidth);
-                  glBegin (GL_LINE_STRIP);
-                  vector<LocationType>::iterator it;
-                  for (it = vertices.begin(); it != vertices.end(); ++it)
+                  if (bProductView)
                   {
-                     if (*it != badVertex)
-                     {
-                        if (startLabel == badVertex)
-                        {
-                           //First good vertex, save label position
-                           startLabel = *it;
-
-                        }
-                        glVertex2f(it->mX, it->mY);
-                        bDrewLine = true;
-                        endLabel = *it;  //End label will be drawn at last good vertex
-                     }
+                     DrawUtil::unProjectToZero(startLabel.mX, startLabel.mY, modelMatrix,
+                        projectionMatrix, viewPort, &startLabel.mX, &startLabel.mY);
                   }
-                  glEnd();
 
-                  if (startLabel != badVertex)
-                  {
-                     if (bProductView)
-                     {
-                        DrawUtil::unProjectToZero(startLabel.mX, startLabel.mY, modelMatrix,
-                           projectionMatrix, viewPort, &startLabel.mX, &startLabel.mY);
-                     }
-
-                     LocationType geoCoord = pRaster->convertPixelToGeocoord(startLabel);
+                  LocationType geoCoord = pRaster->convertPixelToGeocoord(startLabel);
 
-                     drawLabel(startLabel, textOffset, geoCoord, lat, startBorderType, modelMatrix,
-                        projectionMatrix, viewPort, bProductView);
-                  }
+                  drawLabel(startLabel, textOffset, geoCoord, lat, startBorderType, modelMatrix,
+                     projectionMatrix, viewPort, bProductView);
+               }
  
-                  if (endLabel != badVertex)
+               if (endLabel != badVertex)
+               {
+                  if (bProductView)
                   {
-                     if (bProductView)
-                     {
-                        DrawUtil::unProjectToZero(endLabel.mX, endLabel.mY, modelMatrix,
-                           projectionMatrix, viewPort, &endLabel.mX, &endLabel.mY);
-                     }
+                     DrawUtil::unProjectToZero(endLabel.mX, endLabel.mY, modelMatrix,
+                        projectionMatrix, viewPort, &endLabel.mX, &endLabel.mY);
+                  }
 
-                     LocationType geoCoord = pRaster->convertPixelToGeocoord(endLabel);
+                  LocationType geoCoord = pRaster->convertPixelToGeocoord(endLabel);
 
-                     drawLabel(endLabel, textOffset, geoCoord, lat, endBorderType, modelMatrix,
-                        projectionMatrix, viewPort, bProductView);
-                  }
+                  drawLabel(endLabel, textOffset, geoCoord, lat, endBorderType, modelMatrix,
+                     projectionMatrix, viewPort, bProductView);
                }
             }
          }
@@ -1309,6 +1342,7 @@ void LatLonLayerImp::setExtrapolation(bool bExtrapolate)
    if (mbLinking == false)
    {
       mbExtrapolate = bExtrapolate;
+      mGridlinesDirty = true;
       emit extrapolationChanged(mbExtrapolate);
 
       mbLinking = true;
@@ -1501,6 +1535,81 @@ void LatLonLayerImp::computeTickSpacing(bool bDrawing)
    }
 }
 
+void LatLonLayerImp::updateGridlines(const LocationType& tickSpacing, double tolerance)
+{
+   if (mGridlinesDirty == false && tickSpacing == mGridlineTickSpacing &&
+      tolerance * sGridlineZoomThreshold >= mGridlineTolerance &&
+      mMinCoord.mX >= mGridlineMinCoord.mX && mMaxCoord.mX <= mGridlineMaxCoord.mX &&
+      mMinCoord.mY >= mGridlineMinCoord.mY && mMaxCoord.mY <= mGridlineMaxCoord.mY)
+   {
+      return;
+   }
+
+   mGridlines.clear();
+   mGridlinesDirty = false;
+   mGridlineTickSpacing = tickSpacing;
+   mGridlineTolerance = tolerance;
+
+   LocationType range = mMaxCoord - mMinCoord;
+   mGridlineMinCoord.mX = max(mMinCoord.mX - range.mX * sGridlinePadding, LAT_MIN);
+   mGridlineMinCoord.mY = max(mMinCoord.mY - range.mY * sGridlinePadding, LON_MIN);
+   mGridlineMaxCoord.mX = min(mMaxCoord.mX + range.mX * sGridlinePadding, LAT_MAX);
+   mGridlineMaxCoord.mY = min(mMaxCoord.mY + range.mY * sGridlinePadding, LON_MAX);
+
+   RasterElement* pRaster = dynamic_cast<RasterElement*>(getDataElement());
+   if (pRaster == NULL)
+   {
+      return;
+   }
+
+   //UTM/MGRS only defined between S80 and N84
+   double latMin = LAT_MIN;
+   double latMax = LAT_MAX;
+   if (mGeocoordType != GEOCOORD_LATLON)
+   {
+      latMin = LAT_UTMMIN;
+      latMax = LAT_UTMMAX;
+   }
+
+   //Loop twice, once for lat once for lon
+   for (int axis = 0; axis < 2; ++axis)
+   {
+      bool lat = (axis == 0);
+      double spacing = (lat ? tickSpacing.mX : tickSpacing.mY);
+      if (spacing <= 0.0)
+      {
+         continue;
+      }
+
+      double minAxis = (lat ? mGridlineMinCoord.mX : mGridlineMinCoord.mY);
+      double maxAxis = (lat ? mGridlineMaxCoord.mX : mGridlineMaxCoord.mY);
+      double minOffAxis = (lat ? mGridlineMinCoord.mY : max(mGridlineMinCoord.mX, latMin));
+      double maxOffAxis = (lat ? mGridlineMaxCoord.mY : min(mGridlineMaxCoord.mX, latMax));
+      if (minOffAxis >= maxOffAxis)
+      {
+         continue;
+      }
+
+      double startAxis = ceil(minAxis / spacing) * spacing;
+      int count = static_cast<int>(1.5 + (floor(maxAxis / spacing) * spacing - startAxis) / spacing);
+      for (int i = 0; i < count; ++i)
+      {
+         double value = startAxis + static_cast<double>(i) * spacing;
+         if (lat == true && (value < latMin || value > latMax))
+         {
+            continue;
+         }
+
+         mGridlines.push_back(Gridline());
+         Gridline& gridline = mGridlines.back();
+         gridline.mLatitude = lat;
+
+         GridlineTracer tracer(pRaster, lat, value, mbExtrapolate, tolerance, gridline.mVertices);
+         tracer.trace(minOffAxis, maxOffAxis);
+      }
+   }
+}
+
 /**
   * Computes the tick spacing that will give a pleasing number of grid
   * lines over the range of values specified. It assumes DMS type data.
@@ -1628,6 +1737,7 @@ void LatLonLayerImp::setGeocoordType(const GeocoordType& eGeocoord)
       mGeocoordType = eGeocoord;
       setBorderDirty(true);
       setTickSpacingDirty(true);
+      mGridlinesDirty = true;
       emit coordTypeChanged(mGeocoordType);
       notify(SIGNAL_NAME(LatLonLayer, CoordTypeChanged), boost::any(mGeocoordType));
 
@@ -188,6 +188,12 @@ protected:
      */
    void computeTickSpacing(bool bDrawing = false);
 
+   /**
+     * Retraces mGridlines if they are dirty, were traced with a different tick spacing, do not cover
+     * mMinCoord and mMaxCoord, or were traced too coarsely for the current zoom level.
+     */
+   void updateGridlines(const LocationType& tickSpacing, double tolerance);
+
    void setBoundingBox(const std::vector<LocationType> &boundingBox);
    const FontImp& getFontImp() const;
 
@@ -211,6 +217,19 @@ private:
    bool mBorderDirty;                  // whether the border needs updating
    std::vector<LocationType> mBoundingBox;
 
+   struct Gridline
+   {
+      bool mLatitude;                  // whether the line is at a constant latitude
+      std::vector<LocationType> mVertices;   // pixel coordinates, infinite where the georeference is invalid
+   };
+
+   std::vector<Gridline> mGridlines;   // the solid and dashed gridlines traced in pixel coordinates
+   LocationType mGridlineMinCoord;     // the minimum geocoord covered by mGridlines
+   LocationType mGridlineMaxCoord;     // the maximum geocoord covered by mGridlines
+   LocationType mGridlineTickSpacing;  // the tick spacing mGridlines were traced with
+   double mGridlineTolerance;          // the tolerance in pixels mGridlines were traced with
+   bool mGridlinesDirty;               // whether mGridlines needs retracing
+
    FontImp mFont;
 
    enum BorderTypeEnum {LEFT_BORDER, RIGHT_BORDER, BOTTOM_BORDER, TOP_BORDER};
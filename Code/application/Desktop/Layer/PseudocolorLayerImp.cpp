@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
 
 #if defined(CG_SUPPORTED)
 #include "CgContext.h"
@@ -63,7 +64,8 @@ private:
 PseudocolorLayerImp::PseudocolorLayerImp(const string& id, const string& layerName, DataElement* pElement) :
    LayerImp(id, layerName, pElement),
    mNextID(0),
-   mpImage(NULL)
+   mpImage(NULL),
+   mClassIndexValid(false)
 {
    mpElement.addSignal(SIGNAL_NAME(RasterElement, DataModified),
       Slot(this, &PseudocolorLayerImp::rasterElementDataModified));
@@ -100,6 +102,7 @@ bool PseudocolorLayerImp::isKindOf(const string& className) const
 
 void PseudocolorLayerImp::rasterElementDataModified(Subject& subject, const string& signal, const boost::any& v)
 {
+   invalidateClassIndex();
    invalidateImage();
 }
 
@@ -125,6 +128,7 @@ PseudocolorLayerImp& PseudocolorLayerImp::operator= (const PseudocolorLayerImp&
    {
       LayerImp::operator =(pseudocolorLayer);
       clear();
+      invalidateClassIndex();
 
       QMap<int, PseudocolorClass*>::ConstIterator iter = pseudocolorLayer.mClasses.begin();
       while (iter != pseudocolorLayer.mClasses.end())
@@ -621,66 +625,188 @@ void PseudocolorLayerImp::getBoundingBox(int& x1, int& y1, int& x2, int& y2) con
    }
 }
 
-template<class T, class Drawer>
-void fillRegion(T* pData, DataAccessor& da, Drawer drawer, int classValue, unsigned int numRows,
-                unsigned int numColumns)
+namespace
 {
+   inline void addClassRun(map<int, vector<unsigned int> >& classRuns, int classValue, unsigned int row,
+                           unsigned int startColumn, unsigned int endColumn)
+   {
+      map<int, vector<unsigned int> >::iterator iter = classRuns.find(classValue);
+      if (iter != classRuns.end())
+      {
+         iter->second.push_back(row);
+         iter->second.push_back(startColumn);
+         iter->second.push_back(endColumn);
+      }
+   }
+}
+
+template<class T>
+void indexClassRuns(T* pData, DataAccessor& da, map<int, vector<unsigned int> >& classRuns, unsigned int numRows,
+                    unsigned int numColumns)
+{
+   if (numColumns == 0)
+   {
+      return;
+   }
+
    for (unsigned int uiRow = 0; uiRow < numRows; ++uiRow)
    {
-      for (unsigned int uiColumn = 0; uiColumn < numColumns; ++uiColumn)
+      VERIFYNRV(da.isValid());
+
+      int runValue = static_cast<int>(ModelServices::getDataValue(*((T*)da->getColumn()), COMPLEX_MAGNITUDE));
+      unsigned int runStart = 0;
+      da->nextColumn();
+
+      for (unsigned int uiColumn = 1; uiColumn < numColumns; ++uiColumn)
       {
          VERIFYNRV(da.isValid());
-         int iValue = ModelServices::getDataValue(*((T*)da->getColumn()), COMPLEX_MAGNITUDE);
-         if (classValue == iValue)
+         int iValue = static_cast<int>(ModelServices::getDataValue(*((T*)da->getColumn()), COMPLEX_MAGNITUDE));
+         if (iValue != runValue)
          {
-            drawer(uiColumn, uiRow);
+            addClassRun(classRuns, runValue, uiRow, runStart, uiColumn - 1);
+            runValue = iValue;
+            runStart = uiColumn;
          }
 
          da->nextColumn();
       }
 
+      addClassRun(classRuns, runValue, uiRow, runStart, numColumns - 1);
       da->nextRow();
    }
 }
 
-const BitMask* PseudocolorLayerImp::getSelectedPixels() const
+/**
+ *  Updates the run-length index of the class values.
+ *
+ *  The index holds the pixel runs of each class value and is built with a
+ *  single pass over the first band of the raster element.  Only values for
+ *  which a class exists are indexed, so the raster is only read again when the
+ *  element data is modified or a class is set to a value that is not indexed.
+ *
+ *  @return  TRUE if the index is current.  FALSE if the layer does not display a
+ *           raster element or the data could not be accessed.
+ */
+bool PseudocolorLayerImp::updateClassIndex() const
 {
+   bool bIndexCurrent = mClassIndexValid;
+
+   QMap<int, PseudocolorClass*>::const_iterator iter = mClasses.begin();
+   while (iter != mClasses.end() && bIndexCurrent == true)
+   {
+      PseudocolorClass* pClass = iter.value();
+      if (pClass != NULL && mClassRuns.find(pClass->getValue()) == mClassRuns.end())
+      {
+         bIndexCurrent = false;
+      }
+      ++iter;
+   }
+
+   if (bIndexCurrent == true)
+   {
+      return true;
+   }
+
+   invalidateClassIndex();
+
    const RasterElement* pRasterElement = dynamic_cast<const RasterElement*>(getDataElement());
-   if (pRasterElement != NULL)
+   if (pRasterElement == NULL)
    {
-      const RasterDataDescriptor* pDescriptor =
-         dynamic_cast<const RasterDataDescriptor*>(pRasterElement->getDataDescriptor());
-      if (pDescriptor != NULL)
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pRasterElement->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   DataAccessor da = pRasterElement->getDataAccessor();
+   if (da.isValid() == false)
+   {
+      return false;
+   }
+
+   for (iter = mClasses.begin(); iter != mClasses.end(); ++iter)
+   {
+      PseudocolorClass* pClass = iter.value();
+      if (pClass != NULL)
       {
-         unsigned int uiNumColumns = pDescriptor->getColumnCount();
-         unsigned int uiNumRows = pDescriptor->getRowCount();
-         EncodingType eEncoding = pDescriptor->getDataType();
+         mClassRuns[pClass->getValue()];
+      }
+   }
 
-         DataAccessor da = pRasterElement->getDataAccessor();
-         if (da.isValid() == false)
-         {
-            return NULL;
-         }
+   switchOnEncoding(pDescriptor->getDataType(), indexClassRuns, NULL, da, mClassRuns, pDescriptor->getRowCount(),
+      pDescriptor->getColumnCount());
+   mClassIndexValid = true;
+   return true;
+}
 
-         mpMask->clear();
-         DrawUtil::BitMaskPixelDrawer drawer(mpMask.get());
+void PseudocolorLayerImp::invalidateClassIndex() const
+{
+   mClassRuns.clear();
+   mClassIndexValid = false;
+}
 
-         QMap<int, PseudocolorClass*>::const_iterator iter = mClasses.begin();
-         while (iter != mClasses.end())
+unsigned int PseudocolorLayerImp::getPixelCount(int iValue) const
+{
+   if (getClass(iValue) == NULL)
+   {
+      return 0;
+   }
+
+   updateClassIndex();
+
+   unsigned int uiCount = 0;
+
+   map<int, vector<unsigned int> >::const_iterator runs = mClassRuns.find(iValue);
+   if (runs != mClassRuns.end())
+   {
+      const vector<unsigned int>& classRuns = runs->second;
+      for (vector<unsigned int>::size_type i = 0; i + 2 < classRuns.size(); i += 3)
+      {
+         uiCount += classRuns[i + 2] - classRuns[i + 1] + 1;
+      }
+   }
+
+   return uiCount;
+}
+
+const BitMask* PseudocolorLayerImp::getSelectedPixels() const
+{
+   if (updateClassIndex() == false)
+   {
+      return NULL;
+   }
+
+   mpMask->clear();
+
+   DrawUtil::BitMaskPixelDrawer drawer(mpMask.get());
+
+   QMap<int, PseudocolorClass*>::const_iterator iter = mClasses.begin();
+   while (iter != mClasses.end())
+   {
+      PseudocolorClass* pClass = iter.value();
+      if (pClass != NULL)
+      {
+         if (pClass->isDisplayed())
          {
-            PseudocolorClass* pClass = iter.value();
-            if (pClass != NULL)
+            map<int, vector<unsigned int> >::const_iterator runs = mClassRuns.find(pClass->getValue());
+            if (runs != mClassRuns.end())
             {
-               if (pClass->isDisplayed())
+               const vector<unsigned int>& classRuns = runs->second;
+               for (vector<unsigned int>::size_type i = 0; i + 2 < classRuns.size(); i += 3)
                {
-                  int classValue = pClass->getValue();
-                  da->toPixel(0, 0);
-                  switchOnEncoding(eEncoding, fillRegion, NULL, da, drawer, classValue, uiNumRows, uiNumColumns);
+                  for (unsigned int uiColumn = classRuns[i + 1]; uiColumn <= classRuns[i + 2]; ++uiColumn)
+                  {
+                     drawer(uiColumn, classRuns[i]);
+                  }
                }
             }
-            ++iter;
          }
       }
+      ++iter;
    }
 
    return mpMask.get();
@@ -19,6 +19,7 @@
 #include "ObjectResource.h"
 #include "PseudocolorClass.h"
 
+#include <map>
 #include <vector>
 
 class Image;
@@ -67,6 +68,7 @@ public:
    unsigned int getClassCount() const;
    bool removeClass(PseudocolorClass* pClass);
    void clear();
+   unsigned int getPixelCount(int iValue) const;
 
    virtual void getBoundingBox(int& x1, int& y1, int& x2, int& y2) const;
 
@@ -91,6 +93,8 @@ protected:
    std::pair<int, int> getValueRange(bool onlyDisplayed) const;
    void generateImage();
    bool isGpuImageSupported() const;
+   bool updateClassIndex() const;
+   void invalidateClassIndex() const;
 
 protected slots:
    void invalidateImage();
@@ -105,6 +109,10 @@ private:
    mutable FactoryResource<BitMask> mpMask;
    int mNextID;
    Image* mpImage;
+
+   // Pixel runs of each class value, stored as row, first column and last column triplets
+   mutable std::map<int, std::vector<unsigned int> > mClassRuns;
+   mutable bool mClassIndexValid;
 };
 
 #define PSEUDOCOLORLAYERADAPTEREXTENSION_CLASSES \
@@ -346,6 +354,18 @@ private:
    void setSymbol(SymbolType symbol) \
    { \
       return impClass::setSymbol(symbol); \
+   } \
+   unsigned int getClassPixelCount(int iID) const \
+   { \
+      unsigned int uiCount = 0; \
+      \
+      PseudocolorClass* pClass = impClass::getClassById(iID); \
+      if (pClass != NULL) \
+      { \
+         uiCount = impClass::getPixelCount(pClass->getValue()); \
+      } \
+      \
+      return uiCount; \
    }
 
 #endif
@@ -15,12 +15,16 @@
 #include "ColormapEditor.h"
 #include "ContextMenuAction.h"
 #include "ContextMenuActions.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
 #include "DataElement.h"
+#include "DataRequest.h"
 #include "DesktopServices.h"
 #include "DimensionDescriptor.h"
 #include "HistogramAdapter.h"
 #include "HistogramPlotImp.h"
 #include "HistogramPlotAdapter.h"
+#include "ModelServices.h"
 #include "MouseModeImp.h"
 #include "ObjectResource.h"
 #include "PropertiesHistogramPlot.h"
@@ -40,9 +44,13 @@
 #include "XercesIncludes.h"
 #include "xmlreader.h"
 
+#include <algorithm>
 #include <math.h>
 #include <vector>
 
+#include <QtCore/QTime>
+#include <QtCore/QTimer>
+
 #include <QtGui/QApplication>
 #include <QtGui/QDialog>
 #include <QtGui/QDialogButtonBox>
@@ -63,6 +71,10 @@ using XERCES_CPP_NAMESPACE_QUALIFIER XMLString;
 static void ShowRangeValues(const std::string& text, double lower, double upper);
 static void ShowRangeValues(const std::string& text, double value);
 
+// The number of rows and columns sampled for the approximate histogram shown while statistics are calculated
+static const unsigned int sApproximateHistogramSamples = 256;
+static const int sRefineInterval = 50;   // milliseconds of statistics calculation between events
+
 HistogramPlotImp::HistogramPlotImp(const string& id, const string& viewName, QGLContext* pDrawContext,
                                    QWidget* pParent) :
    CartesianPlotImp(id, viewName, pDrawContext, pParent),
@@ -77,6 +89,15 @@ HistogramPlotImp::HistogramPlotImp(const string& id, const string& viewName, QGL
    mpElement(NULL),
    mAutoZoom(true),
    mpStats(NULL),
+   mHistogramApproximate(false),
+   mpRefineCalculation(NULL),
+   mpRefineStatistics(NULL),
+   mRefineComponent(COMPLEX_MAGNITUDE),
+   mpRefineTimer(NULL),
+   mApproximateMin(0.0),
+   mApproximateMax(0.0),
+   mApproximateAverage(0.0),
+   mApproximateStdDev(0.0),
    mpLessThanAction(NULL),
    mpGreaterThanAction(NULL),
    mpBetweenAction(NULL),
@@ -522,7 +543,11 @@ HistogramPlotImp::HistogramPlotImp(const string& id, const string& viewName, QGL
    updateLocatorModeText();
    addPropertiesPage(PropertiesHistogramPlot::getName());
 
+   mpRefineTimer = new QTimer(this);
+   mpRefineTimer->setInterval(0);
+
    // Connections
+   VERIFYNR(connect(mpRefineTimer, SIGNAL(timeout()), this, SLOT(refineHistogramValues())));
    mpElement.addSignal(SIGNAL_NAME(Subject, Deleted), Slot(this, &HistogramPlotImp::elementDeleted));
    mpElement.addSignal(SIGNAL_NAME(Subject, Modified), Slot(this, &HistogramPlotImp::elementModified));
 
@@ -532,6 +557,7 @@ HistogramPlotImp::HistogramPlotImp(const string& id, const string& viewName, QGL
 
 HistogramPlotImp::~HistogramPlotImp()
 {
+   stopRefine();
    setHistogram(NULL);
 }
 
@@ -1806,6 +1832,14 @@ void HistogramPlotImp::mouseReleaseEvent(QMouseEvent* pEvent)
 
 bool HistogramPlotImp::getDataMinMax(double& minValue, double& maxValue) const
 {
+   // Do not calculate the statistics while the approximate histogram is displayed
+   if (mHistogramApproximate)
+   {
+      minValue = mApproximateMin;
+      maxValue = mApproximateMax;
+      return true;
+   }
+
    Statistics* pStatistics = getStatistics();
    if (pStatistics != NULL)
    {
@@ -1836,7 +1870,13 @@ bool HistogramPlotImp::getDataLowerUpper(double& lowerLimit, double& upperLimit)
          pRasterLayer->getStretchValues(mRasterChannelType, lowerLimit, upperLimit);
 
          RegionUnits eUnits = pRasterLayer->getStretchUnits(mRasterChannelType);
-         if (eUnits != RAW_VALUE)
+         if (mHistogramApproximate && eUnits != RAW_VALUE)
+         {
+            // Do not calculate the statistics to convert the values while the approximate histogram is displayed
+            lowerLimit = convertApproximateValue(lowerLimit, eUnits);
+            upperLimit = convertApproximateValue(upperLimit, eUnits);
+         }
+         else if (eUnits != RAW_VALUE)
          {
             lowerLimit = pRasterLayer->convertStretchValue(mRasterChannelType, lowerLimit, RAW_VALUE);
             upperLimit = pRasterLayer->convertStretchValue(mRasterChannelType, upperLimit, RAW_VALUE);
@@ -1871,24 +1911,11 @@ Statistics* HistogramPlotImp::getStatistics() const
    }
    if (mpElement.get() != NULL)
    {
-      const RasterLayer* pRasterLayer = dynamic_cast<const RasterLayer*>(mpLayer.get());
-      const ThresholdLayerImp* pThresholdLayer = dynamic_cast<const ThresholdLayerImp*>(mpLayer.get());
-      if (pRasterLayer != NULL)
+      // Only get the statistics of the displayed band if it is valid
+      DimensionDescriptor bandDim = getDisplayedBand();
+      if (bandDim.isValid())
       {
-         // Only get the statistics if the displayed band is valid
-         DimensionDescriptor bandDim = pRasterLayer->getDisplayedBand(mRasterChannelType);
-         if (bandDim.isValid())
-         {
-            return mpElement->getStatistics(bandDim);
-         }
-      }
-      if (pThresholdLayer != NULL)
-      {
-         DimensionDescriptor bandDim = pThresholdLayer->getDisplayedBand();
-         if (bandDim.isValid())
-         {
-            return mpElement->getStatistics(bandDim);
-         }
+         return mpElement->getStatistics(bandDim);
       }
       return mpElement->getStatistics();
    }
@@ -1896,6 +1923,23 @@ Statistics* HistogramPlotImp::getStatistics() const
    return NULL;
 }
 
+DimensionDescriptor HistogramPlotImp::getDisplayedBand() const
+{
+   const RasterLayer* pRasterLayer = dynamic_cast<const RasterLayer*>(mpLayer.get());
+   if (pRasterLayer != NULL)
+   {
+      return pRasterLayer->getDisplayedBand(mRasterChannelType);
+   }
+
+   const ThresholdLayerImp* pThresholdLayer = dynamic_cast<const ThresholdLayerImp*>(mpLayer.get());
+   if (pThresholdLayer != NULL)
+   {
+      return pThresholdLayer->getDisplayedBand();
+   }
+
+   return DimensionDescriptor();
+}
+
 bool HistogramPlotImp::ownsStatistics() const
 {
    return mpStats != NULL;
@@ -3133,7 +3177,7 @@ void HistogramPlotImp::updateHistogramName(bool force)
    }
    else
    {
-      mUpdater.initialize();
+      mUpdater.initialize(HistogramUpdater::UPDATE_NAME);
    }
 }
 
@@ -3142,7 +3186,7 @@ void HistogramPlotImp::updateHistogramValues()
    updateHistogramValues(false);
 }
 
-void HistogramPlotImp::updateHistogramValues(bool force)
+void HistogramPlotImp::updateHistogramValues(bool force, bool approximate)
 {
    if (mpLayer.get() == NULL)
    {
@@ -3155,6 +3199,8 @@ void HistogramPlotImp::updateHistogramValues(bool force)
       const unsigned int* pHistogramCounts = NULL;
       const double* pHistogramLocations = NULL;
 
+      mHistogramApproximate = false;
+
       Statistics* pStatistics = getStatistics();
       if (pStatistics != NULL)
       {
@@ -3166,9 +3212,19 @@ void HistogramPlotImp::updateHistogramValues(bool force)
             eComponent = pRasterLayer->getComplexComponent();
          }
 
+         // Show an approximate histogram right away and calculate the statistics in the background
+         if (approximate && pStatistics->areStatisticsCalculated(eComponent) == false &&
+            updateApproximateHistogram(pStatistics, eComponent) == true)
+         {
+            updateHistogramRegions(force);
+            return;
+         }
+
          pStatistics->getHistogram(pHistogramLocations, pHistogramCounts, eComponent);
       }
 
+      stopRefine();
+
       if ((pHistogramLocations != NULL) && (pHistogramCounts != NULL))
       {
          unsigned int uiCount = 256;
@@ -3194,7 +3250,271 @@ void HistogramPlotImp::updateHistogramValues(bool force)
    }
    else
    {
-      mUpdater.initialize();
+      mUpdater.initialize(HistogramUpdater::UPDATE_VALUES);
+   }
+}
+
+bool HistogramPlotImp::updateApproximateHistogram(Statistics* pStatistics, ComplexComponent eComponent)
+{
+   // Statistics set on the plot may cover an AOI or several bands, so only approximate the displayed band
+   if (pStatistics == NULL || mpStats != NULL || mpElement.get() == NULL)
+   {
+      return false;
+   }
+
+   DimensionDescriptor band = getDisplayedBand();
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(mpElement->getDataDescriptor());
+   if (band.isValid() == false || pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   unsigned int rowCount = pDescriptor->getRowCount();
+   unsigned int columnCount = pDescriptor->getColumnCount();
+   unsigned int rowStep = max(1U, rowCount / sApproximateHistogramSamples);
+   unsigned int columnStep = max(1U, columnCount / sApproximateHistogramSamples);
+   if (rowStep == 1 && columnStep == 1)
+   {
+      // Small data sets are calculated quickly enough to display the statistics directly
+      return false;
+   }
+
+   // Starting the calculation also determines the statistics resolution used to scale the counts below
+   startRefine(pStatistics, eComponent);
+
+   // Sample a grid of pixels from the displayed band
+   bool isBip = pDescriptor->getInterleaveFormat() == BIP;
+   FactoryResource<DataRequest> pRequest;
+   if (isBip)
+   {
+      pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(pDescriptor->getBandCount() - 1),
+         pDescriptor->getBandCount());
+   }
+   else
+   {
+      pRequest->setBands(band, band, 1);
+   }
+
+   DataAccessor da = mpElement->getDataAccessor(pRequest.release());
+   if (da.isValid() == false)
+   {
+      return false;
+   }
+
+   EncodingType encoding = pDescriptor->getDataType();
+   int bandIndex = isBip ? band.getActiveNumber() : 0;
+   const BadValues* pBadValues = pStatistics->getBadValues();
+
+   vector<double> values;
+   values.reserve((rowCount / rowStep + 1) * (columnCount / columnStep + 1));
+   unsigned int sampleCount = 0;
+   for (unsigned int row = 0; row < rowCount; row += rowStep)
+   {
+      for (unsigned int column = 0; column < columnCount; column += columnStep)
+      {
+         da->toPixel(row, column);
+         VERIFY(da.isValid());
+         ++sampleCount;
+
+         double value = ModelServices::getDataValue(encoding, da->getColumn(), eComponent, bandIndex);
+         if (pBadValues == NULL || pBadValues->isBadValue(value) == false)
+         {
+            values.push_back(value);
+         }
+      }
+   }
+
+   if (values.empty() == true)
+   {
+      return false;
+   }
+
+   // Sort the samples to approximate the percentiles used to convert the stretch values
+   sort(values.begin(), values.end());
+   double minValue = values.front();
+   double maxValue = values.back();
+
+   mApproximatePercentiles.resize(1001);
+   for (unsigned int i = 0; i < mApproximatePercentiles.size(); ++i)
+   {
+      mApproximatePercentiles[i] = values[(i * (values.size() - 1)) / 1000];
+   }
+
+   double sum = 0.0;
+   double sumSquares = 0.0;
+   for (vector<double>::const_iterator iter = values.begin(); iter != values.end(); ++iter)
+   {
+      sum += *iter;
+      sumSquares += *iter * *iter;
+   }
+
+   mApproximateAverage = sum / values.size();
+   mApproximateStdDev = sqrt(max(0.0, sumSquares / values.size() - mApproximateAverage * mApproximateAverage));
+   double binWidth = (maxValue - minValue) / 256.0;
+   if (binWidth <= 0.0)
+   {
+      binWidth = 1.0;
+   }
+
+   vector<double> binCenters(256);
+   vector<double> binCounts(256, 0.0);
+   for (unsigned int i = 0; i < binCenters.size(); ++i)
+   {
+      binCenters[i] = minValue + (i + 0.5) * binWidth;
+   }
+
+   // Scale the counts to the number of pixels included in the statistics so that
+   // the plot does not rescale when the approximate bins are replaced
+   double pixelCount = static_cast<double>(rowCount) * columnCount;
+   int resolution = pStatistics->getStatisticsResolution();
+   if (resolution > 1)
+   {
+      pixelCount /= resolution;
+   }
+
+   double sampleWeight = pixelCount / sampleCount;
+   for (vector<double>::const_iterator iter = values.begin(); iter != values.end(); ++iter)
+   {
+      int bin = static_cast<int>((*iter - minValue) / binWidth);
+      binCounts[max(0, min(bin, 255))] += sampleWeight;
+   }
+
+   setHistogram(256, &binCenters.front(), &binCounts.front());
+
+   mApproximateMin = minValue;
+   mApproximateMax = maxValue;
+   mHistogramApproximate = true;
+   return true;
+}
+
+void HistogramPlotImp::startRefine(Statistics* pStatistics, ComplexComponent eComponent)
+{
+   if (mpRefineCalculation != NULL && mpRefineCalculation->isCancelled() == false &&
+      mpRefineStatistics == pStatistics && mRefineComponent == eComponent)
+   {
+      return;
+   }
+
+   stopRefine();
+
+   StatisticsImp* pStatisticsImp = dynamic_cast<StatisticsImp*>(pStatistics);
+   if (pStatisticsImp != NULL)
+   {
+      mpRefineCalculation = new StatisticsCalculation(*pStatisticsImp, eComponent);
+      if (mpRefineCalculation->isCancelled() == true)
+      {
+         stopRefine();
+         return;
+      }
+
+      mpRefineStatistics = pStatistics;
+      mRefineComponent = eComponent;
+      mpRefineTimer->start();
+   }
+}
+
+void HistogramPlotImp::stopRefine()
+{
+   if (mpRefineTimer != NULL)
+   {
+      mpRefineTimer->stop();
+   }
+
+   delete mpRefineCalculation;
+   mpRefineCalculation = NULL;
+   mpRefineStatistics = NULL;
+}
+
+double HistogramPlotImp::convertApproximateValue(double value, RegionUnits eUnits) const
+{
+   switch (eUnits)
+   {
+      case PERCENTAGE:
+         return (((mApproximateMax - mApproximateMin) * value) / 100) + mApproximateMin;
+
+      case PERCENTILE:
+      {
+         if (mApproximatePercentiles.size() != 1001)
+         {
+            return mApproximateMin;
+         }
+
+         if (value < 0.0 || value > 100.0)
+         {
+            return mApproximatePercentiles[0] +
+               value * (mApproximatePercentiles[1000] - mApproximatePercentiles[0]) / 100.0;
+         }
+
+         int lower = static_cast<int>(10.0 * value);
+         if (lower < 0)
+         {
+            return mApproximatePercentiles[0];
+         }
+         else if (lower > 999)
+         {
+            return mApproximatePercentiles[1000];
+         }
+
+         return mApproximatePercentiles[lower] + (mApproximatePercentiles[lower + 1] -
+            mApproximatePercentiles[lower]) * (10.0 * value - static_cast<double>(lower));
+      }
+
+      case STD_DEV:
+         return (value * mApproximateStdDev) + mApproximateAverage;
+
+      default:
+         break;
+   }
+
+   return value;
+}
+
+void HistogramPlotImp::refineHistogramValues()
+{
+   if (mpRefineCalculation == NULL)
+   {
+      mpRefineTimer->stop();
+      return;
+   }
+
+   // The statistics may have been calculated elsewhere, so display them instead of finishing the calculation
+   if (mpRefineCalculation->isCancelled() == false &&
+      mpRefineStatistics->areStatisticsCalculated(mRefineComponent) == true)
+   {
+      stopRefine();
+      if (mHistogramApproximate)
+      {
+         updateHistogramValues(false, false);
+      }
+
+      return;
+   }
+
+   // Calculate blocks of rows for a short time and then return to the event loop
+   QTime time;
+   time.start();
+   while (mpRefineCalculation->calculateNextBlock() == true && time.elapsed() < sRefineInterval)
+   {
+   }
+
+   if (mpRefineCalculation->isComplete() == true)
+   {
+      // The statistics are now calculated, so the exact histogram is displayed
+      stopRefine();
+      if (mHistogramApproximate)
+      {
+         updateHistogramValues(false, false);
+      }
+   }
+   else if (mpRefineCalculation->isCancelled() == true)
+   {
+      // The statistics were reset, so start again with the current statistics
+      stopRefine();
+      if (mHistogramApproximate)
+      {
+         updateHistogramValues(false, true);
+      }
    }
 }
 
@@ -3233,7 +3553,7 @@ void HistogramPlotImp::updateHistogramRegions(bool force)
    }
    else
    {
-      mUpdater.initialize();
+      mUpdater.initialize(HistogramUpdater::UPDATE_REGIONS);
    }
 }
 
@@ -3854,27 +4174,38 @@ void HistogramPlotImp::previousBand()
 
 HistogramPlotImp::HistogramUpdater::HistogramUpdater(HistogramPlotImp* pPlot) :
    mpPlot(pPlot),
-   mNeedsUpdated(false)
+   mUpdateTypes(0)
 {
 }
 
-void HistogramPlotImp::HistogramUpdater::initialize()
+void HistogramPlotImp::HistogramUpdater::initialize(unsigned int updateTypes)
 {
-   mNeedsUpdated = true;
+   mUpdateTypes |= updateTypes;
 }
 
 void HistogramPlotImp::HistogramUpdater::update()
 {
-   if (mpPlot != NULL && mNeedsUpdated && Service<SessionManager>()->isSessionLoading() == false)
+   if (mpPlot != NULL && mUpdateTypes != 0 && Service<SessionManager>()->isSessionLoading() == false)
    {
-      mpPlot->updateHistogramValues(true);
-      mpPlot->updateHistogramRegions(true);
-      if (mpPlot->ownsStatistics() == false)    // Since the user can set a custom name for a statistics plot, the
+      unsigned int updateTypes = mUpdateTypes;
+      mUpdateTypes = 0;
+
+      // Updating the values also updates the regions, and a stretch change only needs the regions redrawn
+      // over the existing bins
+      if ((updateTypes & UPDATE_VALUES) != 0)
+      {
+         mpPlot->updateHistogramValues(true);
+      }
+      else if ((updateTypes & UPDATE_REGIONS) != 0)
+      {
+         mpPlot->updateHistogramRegions(true);
+      }
+
+      if ((updateTypes & UPDATE_NAME) != 0 &&
+         mpPlot->ownsStatistics() == false)     // Since the user can set a custom name for a statistics plot, the
                                                 // plot name should not be updated or the statistics info will be lost
       {
          mpPlot->updateHistogramName(true);
       }
-
-      mNeedsUpdated = false;
    }
 }
@@ -26,11 +26,14 @@
 #include "TypesFile.h"
 
 #include <map>
+#include <vector>
 
 class ColorMap;
 class HistogramImp;
 class Layer;
+class QTimer;
 class RegionObjectAdapter;
+class StatisticsCalculation;
 
 Q_DECLARE_METATYPE(RasterElement*)
 
@@ -159,19 +162,31 @@ private:
    bool setHistogram(Layer* pLayer, RasterElement* pElement, Statistics* pStatistics, RasterChannelType color);
    void updateLocatorModeText();
    void updateMouseCursor();
+   DimensionDescriptor getDisplayedBand() const;
 
    class HistogramUpdater
    {
    public:
+      enum UpdateTypeEnum
+      {
+         UPDATE_NAME = 0x01,
+         UPDATE_VALUES = 0x02,
+         UPDATE_REGIONS = 0x04
+      };
+
       HistogramUpdater(HistogramPlotImp *pPlot);
-      void initialize();
+      void initialize(unsigned int updateTypes);
       void update();
    private:
       HistogramPlotImp* mpPlot;
-      bool mNeedsUpdated;
+      unsigned int mUpdateTypes;
    };
 
-   void updateHistogramValues(bool force);
+   void updateHistogramValues(bool force, bool approximate = true);
+   bool updateApproximateHistogram(Statistics* pStatistics, ComplexComponent eComponent);
+   void startRefine(Statistics* pStatistics, ComplexComponent eComponent);
+   void stopRefine();
+   double convertApproximateValue(double value, RegionUnits eUnits) const;
    void updateHistogramRegions(bool force);
    void updateHistogramName(bool force);
 
@@ -204,6 +219,16 @@ private:
    bool mAutoZoom;
 
    Statistics* mpStats;
+   bool mHistogramApproximate;
+   StatisticsCalculation* mpRefineCalculation;
+   Statistics* mpRefineStatistics;
+   ComplexComponent mRefineComponent;
+   QTimer* mpRefineTimer;
+   double mApproximateMin;
+   double mApproximateMax;
+   double mApproximateAverage;
+   double mApproximateStdDev;
+   std::vector<double> mApproximatePercentiles;
 
    QAction* mpLinearXAxisAction;
    QAction* mpLogXAxisAction;
@@ -258,6 +283,7 @@ private:
 private slots:
    void nextBand();
    void previousBand();
+   void refineHistogramValues();
 };
 
 #define HISTOGRAMPLOTADAPTEREXTENSION_CLASSES \
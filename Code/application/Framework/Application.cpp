@@ -27,6 +27,7 @@
 #include "FileFinderImp.h"
 #include "Filename.h"
 #include "InstallerServicesImp.h"
+#include "InstrumentationImp.h"
 #include "MessageLogMgrImp.h"
 #include "ModelServicesImp.h"
 #include "ObjectFactoryImp.h"
@@ -77,6 +78,7 @@ Application::~Application()
    UtilityServicesImp::destroy();
    SessionManagerImp::destroy();
    MessageLogMgrImp::destroy();
+   InstrumentationImp::destroy();
 }
 
 int Application::run(int argc, char** argv)
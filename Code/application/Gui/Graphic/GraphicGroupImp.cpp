@@ -38,10 +38,44 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 using namespace std;
 
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   // Groups with fewer objects than this are drawn and hit tested without the spatial index
+   const unsigned int MIN_INDEXED_OBJECTS = 64;
+
+   // Extra distance, in screen pixels, around hit points and the visible area to account for
+   // line widths, hit tolerances, arrow heads and labels which are drawn outside of an object's bounding box
+   const double HIT_MARGIN = 8.0;
+   const double DRAW_MARGIN = 64.0;
+
+   bool isObjectHit(GraphicObject* pObject, const LocationType& pixelCoord)
+   {
+      GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
+      VERIFY(pObjectImp != NULL);
+
+      double dRotation = pObject->getRotation();
+      if (dRotation != 0.0)
+      {
+         LocationType llCorner = pObject->getLlCorner();
+         LocationType urCorner = pObject->getUrCorner();
+
+         LocationType center;
+         center.mX = (llCorner.mX + urCorner.mX) / 2.0;
+         center.mY = (llCorner.mY + urCorner.mY) / 2.0;
+
+         LocationType adjustedCoord = DrawUtil::getRotatedCoordinate(pixelCoord, center, -dRotation);
+         return pObjectImp->hit(adjustedCoord);
+      }
+
+      return pObjectImp->hit(pixelCoord);
+   }
+}
+
 GraphicGroupImp::GraphicGroupImp(const string& id, GraphicObjectType type, GraphicLayer* pLayer,
                                  LocationType pixelCoord) :
    GraphicObjectImp(id, type, pLayer, pixelCoord),
@@ -93,14 +127,38 @@ void GraphicGroupImp::draw(double zoomFactor) const
       pParentWidget = dynamic_cast<ViewImp*>(pLayer->getView());
    }
 
-   int iBadObjects = 0;
+   // Only draw the objects in the visible area of the layer's top level group
+   vector<GraphicObject*> objects;
+   double pixelSize = getScreenPixelSize();
+   GraphicLayerImp* pLayerImp = dynamic_cast<GraphicLayerImp*>(pLayer);
+   if (mObjects.size() >= MIN_INDEXED_OBJECTS && pParentWidget != NULL && pLayerImp != NULL && pixelSize > 0.0 &&
+      getRotation() == 0.0 && dynamic_cast<const GraphicGroupImp*>(pLayerImp->getGroup()) == this)
+   {
+      LocationType llCorner(numeric_limits<double>::max(), numeric_limits<double>::max());
+      LocationType urCorner(-numeric_limits<double>::max(), -numeric_limits<double>::max());
+      LocationType corners[4];
+      pParentWidget->getVisibleCorners(corners[0], corners[1], corners[2], corners[3]);
+      for (int i = 0; i < 4; ++i)
+      {
+         LocationType dataCoord;
+         pLayer->translateWorldToData(corners[i].mX, corners[i].mY, dataCoord.mX, dataCoord.mY);
+         llCorner.mX = min(llCorner.mX, dataCoord.mX - DRAW_MARGIN * pixelSize);
+         llCorner.mY = min(llCorner.mY, dataCoord.mY - DRAW_MARGIN * pixelSize);
+         urCorner.mX = max(urCorner.mX, dataCoord.mX + DRAW_MARGIN * pixelSize);
+         urCorner.mY = max(urCorner.mY, dataCoord.mY + DRAW_MARGIN * pixelSize);
+      }
 
-   list<GraphicObject*>::const_iterator iter;
-   iter = mObjects.begin();
-   while (iter != mObjects.end())
+      getObjectIndex().getObjects(llCorner, urCorner, objects);
+   }
+   else
+   {
+      objects.assign(mObjects.begin(), mObjects.end());
+   }
+
+   int iBadObjects = 0;
+   for (vector<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
    {
       GraphicObject* pObject = *iter;
-      ++iter;
       GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
       if (pObject != NULL && pObjectImp != NULL)
       {
@@ -192,57 +250,15 @@ void GraphicGroupImp::updateBoundingBox()
    double dMaxY = -1e30;
    double dMinY = 1e30;
 
-   for (list<GraphicObject*>::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
+   // The index holds the rotated bounding box of each object
+   LocationType llCorner;
+   LocationType urCorner;
+   if (getObjectIndex().getExtents(llCorner, urCorner) == true)
    {
-      GraphicObject* pObject = *iter;
-      if (pObject == NULL)
-      {
-         continue;
-      }
-
-      LocationType llCorner = pObject->getLlCorner();
-      LocationType urCorner = pObject->getUrCorner();
-      LocationType center((llCorner.mX + urCorner.mX) / 2.0, (llCorner.mY + urCorner.mY) / 2.0);
-
-      double angle = pObject->getRotation();
-      double cosTheta = cos(PI / 180.0 * angle);
-      double sinTheta = sin(PI / 180.0 * angle);
-
-      vector<LocationType> corners;
-      corners.push_back(llCorner);
-      corners.push_back(LocationType(llCorner.mX, urCorner.mY));
-      corners.push_back(urCorner);
-      corners.push_back(LocationType(urCorner.mX, llCorner.mY));
-
-      vector<LocationType>::const_iterator pit;
-      for (pit = corners.begin(); pit != corners.end(); ++pit)
-      {
-         LocationType realPoint
-         (
-            center.mX + (pit->mX - center.mX) * cosTheta - (pit->mY - center.mY) * sinTheta,
-            center.mY + (pit->mX - center.mX) * sinTheta + (pit->mY - center.mY) * cosTheta
-         );
-
-         if (realPoint.mX > dMaxX)
-         {
-            dMaxX = realPoint.mX;
-         }
-
-         if (realPoint.mX < dMinX)
-         {
-            dMinX = realPoint.mX;
-         }
-
-         if (realPoint.mY > dMaxY)
-         {
-            dMaxY = realPoint.mY;
-         }
-
-         if (realPoint.mY < dMinY)
-         {
-            dMinY = realPoint.mY;
-         }
-      }
+      dMinX = llCorner.mX;
+      dMinY = llCorner.mY;
+      dMaxX = urCorner.mX;
+      dMaxY = urCorner.mY;
    }
 
    LocationType groupLlCorner;
@@ -358,6 +374,7 @@ void GraphicGroupImp::updateLayout()
    }
 
    for_each(mObjects.begin(), mObjects.end(), ConnectObject(this));
+   mObjectIndex.invalidate();
 
    mbNeedsLayout = false;
    mLlCorner = llCorner;
@@ -391,38 +408,33 @@ bool GraphicGroupImp::hit(LocationType pixelCoord) const
 
 GraphicObject* GraphicGroupImp::hitObject(const LocationType& pixelCoord) const
 {
-   list<GraphicObject*>::const_reverse_iterator iter;
-   for (iter = mObjects.rbegin(); iter != mObjects.rend(); ++iter)
+   if (mObjects.size() < MIN_INDEXED_OBJECTS)
    {
-      GraphicObject* pObject = *iter;
-      GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
-      VERIFY(pObjectImp != NULL);
-      if (pObject != NULL)
+      list<GraphicObject*>::const_reverse_iterator iter;
+      for (iter = mObjects.rbegin(); iter != mObjects.rend(); ++iter)
       {
-         bool bHit = false;
-
-         double dRotation = pObject->getRotation();
-         if (dRotation != 0.0)
+         GraphicObject* pObject = *iter;
+         if (pObject != NULL && isObjectHit(pObject, pixelCoord) == true)
          {
-            LocationType llCorner = pObject->getLlCorner();
-            LocationType urCorner = pObject->getUrCorner();
+            return pObject;
+         }
+      }
 
-            LocationType center;
-            center.mX = (llCorner.mX + urCorner.mX) / 2.0;
-            center.mY = (llCorner.mY + urCorner.mY) / 2.0;
+      return NULL;
+   }
 
-            LocationType adjustedCoord = DrawUtil::getRotatedCoordinate(pixelCoord, center, -dRotation);
-            bHit = pObjectImp->hit(adjustedCoord);
-         }
-         else
-         {
-            bHit = pObjectImp->hit(pixelCoord);
-         }
+   // Only test the objects near the point, starting with the front object
+   double margin = 1.0 + HIT_MARGIN * getScreenPixelSize();
+   vector<GraphicObject*> objects;
+   getObjectIndex().getObjects(LocationType(pixelCoord.mX - margin, pixelCoord.mY - margin),
+      LocationType(pixelCoord.mX + margin, pixelCoord.mY + margin), objects);
 
-         if (bHit == true)
-         {
-            return pObject;
-         }
+   vector<GraphicObject*>::const_reverse_iterator iter;
+   for (iter = objects.rbegin(); iter != objects.rend(); ++iter)
+   {
+      if (isObjectHit(*iter, pixelCoord) == true)
+      {
+         return *iter;
       }
    }
 
@@ -612,6 +624,7 @@ void GraphicGroupImp::insertObject(GraphicObject* pObject)
       if (pObject->isVisible())
       {
          mObjects.push_back(pObject);
+         mObjectIndex.insertObject(pObject);
       }
       ConnectObject(this)(pObject);
       notify(SIGNAL_NAME(GraphicGroup, ObjectAdded), boost::any(pObject));
@@ -628,6 +641,12 @@ void GraphicGroupImp::insertObjects(const list<GraphicObject*>& objects, Progres
       return;
    }
 
+   // Rebuild the index when it is next needed instead of updating it for each object
+   mObjectIndex.invalidate();
+
+   // Each added object is still notified, but Subject::Modified is only notified once
+   SignalBatch batch(*this, true);
+
    int i = 0;
    for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter, ++i)
    {
@@ -696,6 +715,12 @@ list<GraphicObject*> GraphicGroupImp::getObjects(GraphicObjectType objectType) c
    return objects;
 }
 
+void GraphicGroupImp::getObjects(const LocationType& llCorner, const LocationType& urCorner,
+                                 vector<GraphicObject*>& objects) const
+{
+   getObjectIndex().getObjects(llCorner, urCorner, objects);
+}
+
 unsigned int GraphicGroupImp::getNumObjects() const
 {
    return mObjects.size();
@@ -719,6 +744,7 @@ bool GraphicGroupImp::moveObjectToBack(GraphicObject* pObject)
    {
       mObjects.erase(iter);
       mObjects.push_front(pObject);
+      mObjectIndex.moveObjectToBack(pObject);
       return true;
    }
 
@@ -737,6 +763,7 @@ bool GraphicGroupImp::moveObjectToFront(GraphicObject* pObject)
    {
       mObjects.erase(iter);
       mObjects.push_back(pObject);
+      mObjectIndex.moveObjectToFront(pObject);
       return true;
    }
 
@@ -770,6 +797,7 @@ void GraphicGroupImp::setObjectStackingIndex(GraphicObject* pObject, int index)
          index--;
       }
       mObjects.insert(iter, pObject);
+      mObjectIndex.invalidate();
    }
 }
 
@@ -791,6 +819,7 @@ bool GraphicGroupImp::removeObject(GraphicObject* pObject, bool bDelete)
    if (it != mObjects.end())
    {
       mObjects.erase(it);
+      mObjectIndex.removeObject(pObject);
       DisconnectObject(this)(pObject);
       notify(SIGNAL_NAME(GraphicGroup, ObjectRemoved), boost::any(pObject));
 
@@ -846,6 +875,9 @@ void GraphicGroupImp::removeAllObjects(bool bDelete)
    }
 
    for_each(mObjects.begin(), mObjects.end(), DisconnectObject(this));
+   mObjectIndex.invalidate();
+
+   SignalBatch batch(*this, true);
 
    // Remove each object while iterating the loop to avoid stale pointers within mObjects.
    // The stale pointers can cause crashes if code attached to GraphicGroup, ObjectRemoved calls methods on this class.
@@ -1241,6 +1273,11 @@ void GraphicGroupImp::setLayer(GraphicLayer* pLayer)
 
 void GraphicGroupImp::updateFromProperty(GraphicProperty* pProperty)
 {
+   if (dynamic_cast<BoundingBoxProperty*>(pProperty) != NULL || dynamic_cast<RotationProperty*>(pProperty) != NULL)
+   {
+      mObjectIndex.updateObject(dynamic_cast<GraphicObject*>(sender()));
+   }
+
    if (dynamic_cast<BoundingBoxProperty*>(pProperty) != NULL)
    {
       updateBoundingBox();
@@ -1248,3 +1285,33 @@ void GraphicGroupImp::updateFromProperty(GraphicProperty* pProperty)
 
    notify(SIGNAL_NAME(GraphicGroup, ObjectChanged), boost::any(pProperty));
 }
+
+const GraphicObjectIndex& GraphicGroupImp::getObjectIndex() const
+{
+   if (mObjectIndex.isValid() == false)
+   {
+      mObjectIndex.rebuild(mObjects);
+   }
+
+   return mObjectIndex;
+}
+
+double GraphicGroupImp::getScreenPixelSize() const
+{
+   GraphicLayer* pLayer = getLayer();
+   if (pLayer == NULL || pLayer->getView() == NULL)
+   {
+      return 0.0;
+   }
+
+   LocationType origin;
+   LocationType xStep;
+   LocationType yStep;
+   pLayer->translateScreenToData(0.0, 0.0, origin.mX, origin.mY);
+   pLayer->translateScreenToData(1.0, 0.0, xStep.mX, xStep.mY);
+   pLayer->translateScreenToData(0.0, 1.0, yStep.mX, yStep.mY);
+
+   double xSize = sqrt(pow(xStep.mX - origin.mX, 2) + pow(xStep.mY - origin.mY, 2));
+   double ySize = sqrt(pow(yStep.mX - origin.mX, 2) + pow(yStep.mY - origin.mY, 2));
+   return max(xSize, ySize);
+}
@@ -11,6 +11,7 @@
 #define GRAPHICGROUPIMP_H
 
 #include "GraphicObjectImp.h"
+#include "GraphicObjectIndex.h"
 #include "GraphicProperty.h"
 #include "LocationType.h"
 #include "TypesFile.h"
@@ -52,6 +53,8 @@ public:
    bool hasObject(GraphicObject* pObject) const;
    const std::list<GraphicObject*>& getObjects() const;
    std::list<GraphicObject*> getObjects(GraphicObjectType objectType) const;
+   void getObjects(const LocationType& llCorner, const LocationType& urCorner,
+      std::vector<GraphicObject*>& objects) const;
    unsigned int getNumObjects() const;
    unsigned int getNumObjects(GraphicObjectType objectType) const;
    bool moveObjectToBack(GraphicObject* pObject);
@@ -89,6 +92,10 @@ protected slots:
 
 private:
    GraphicGroupImp(const GraphicGroupImp& rhs);
+   const GraphicObjectIndex& getObjectIndex() const;
+   double getScreenPixelSize() const;
+
+   mutable GraphicObjectIndex mObjectIndex;
    bool mbNeedsLayout;
    LocationType mLlCorner;
    LocationType mUrCorner;
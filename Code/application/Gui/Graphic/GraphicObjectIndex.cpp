@@ -0,0 +1,611 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "GraphicObject.h"
+#include "GraphicObjectIndex.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int MAX_NODE_ENTRIES = 16;
+   const unsigned int MIN_NODE_ENTRIES = 4;
+}
+
+struct GraphicObjectIndex::Box
+{
+   Box() :
+      mMinX(numeric_limits<double>::max()),
+      mMinY(numeric_limits<double>::max()),
+      mMaxX(-numeric_limits<double>::max()),
+      mMaxY(-numeric_limits<double>::max())
+   {}
+
+   bool isEmpty() const
+   {
+      return mMinX > mMaxX || mMinY > mMaxY;
+   }
+
+   void expand(double x, double y)
+   {
+      mMinX = min(mMinX, x);
+      mMinY = min(mMinY, y);
+      mMaxX = max(mMaxX, x);
+      mMaxY = max(mMaxY, y);
+   }
+
+   void expand(const Box& box)
+   {
+      if (box.isEmpty() == false)
+      {
+         expand(box.mMinX, box.mMinY);
+         expand(box.mMaxX, box.mMaxY);
+      }
+   }
+
+   bool intersects(const Box& box) const
+   {
+      return mMinX <= box.mMaxX && box.mMinX <= mMaxX && mMinY <= box.mMaxY && box.mMinY <= mMaxY;
+   }
+
+   double getArea() const
+   {
+      return isEmpty() ? 0.0 : (mMaxX - mMinX) * (mMaxY - mMinY);
+   }
+
+   double getEnlargement(const Box& box) const
+   {
+      Box combined = *this;
+      combined.expand(box);
+      return combined.getArea() - getArea();
+   }
+
+   double getCenter(bool xAxis) const
+   {
+      return xAxis ? (mMinX + mMaxX) / 2.0 : (mMinY + mMaxY) / 2.0;
+   }
+
+   double mMinX;
+   double mMinY;
+   double mMaxX;
+   double mMaxY;
+};
+
+struct GraphicObjectIndex::Item
+{
+   Item(GraphicObject* pObject, const Box& box, double order) :
+      mpObject(pObject),
+      mBox(box),
+      mOrder(order),
+      mpLeaf(NULL)
+   {}
+
+   GraphicObject* mpObject;
+   Box mBox;
+   double mOrder;
+   Node* mpLeaf;
+};
+
+struct GraphicObjectIndex::Node
+{
+   Node(Node* pParent, bool leaf) :
+      mpParent(pParent),
+      mLeaf(leaf)
+   {}
+
+   unsigned int getNumEntries() const
+   {
+      return static_cast<unsigned int>(mLeaf ? mItems.size() : mChildren.size());
+   }
+
+   void updateBox()
+   {
+      mBox = Box();
+      for (vector<Item*>::const_iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
+      {
+         mBox.expand((*iter)->mBox);
+      }
+      for (vector<Node*>::const_iterator iter = mChildren.begin(); iter != mChildren.end(); ++iter)
+      {
+         mBox.expand((*iter)->mBox);
+      }
+   }
+
+   Node* mpParent;
+   bool mLeaf;
+   Box mBox;
+   vector<Node*> mChildren;
+   vector<Item*> mItems;
+};
+
+namespace
+{
+   template<typename T>
+   class CenterLess
+   {
+   public:
+      CenterLess(bool xAxis) :
+         mXAxis(xAxis)
+      {}
+
+      bool operator()(const T* pFirst, const T* pSecond) const
+      {
+         return pFirst->mBox.getCenter(mXAxis) < pSecond->mBox.getCenter(mXAxis);
+      }
+
+   private:
+      bool mXAxis;
+   };
+
+   template<typename T>
+   bool OrderLess(const T* pFirst, const T* pSecond)
+   {
+      return pFirst->mOrder < pSecond->mOrder;
+   }
+
+   // Sorts the entries of an overflowing node along the axis in which their centers are most spread out
+   template<typename T>
+   void sortEntries(vector<T*>& entries)
+   {
+      double minX = numeric_limits<double>::max();
+      double maxX = -numeric_limits<double>::max();
+      double minY = numeric_limits<double>::max();
+      double maxY = -numeric_limits<double>::max();
+      for (typename vector<T*>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+      {
+         minX = min(minX, (*iter)->mBox.getCenter(true));
+         maxX = max(maxX, (*iter)->mBox.getCenter(true));
+         minY = min(minY, (*iter)->mBox.getCenter(false));
+         maxY = max(maxY, (*iter)->mBox.getCenter(false));
+      }
+
+      sort(entries.begin(), entries.end(), CenterLess<T>(maxX - minX >= maxY - minY));
+   }
+}
+
+GraphicObjectIndex::GraphicObjectIndex() :
+   mpRoot(NULL),
+   mBackOrder(0.0),
+   mFrontOrder(-1.0),
+   mValid(false)
+{
+}
+
+GraphicObjectIndex::~GraphicObjectIndex()
+{
+   clear();
+}
+
+bool GraphicObjectIndex::isValid() const
+{
+   return mValid;
+}
+
+void GraphicObjectIndex::invalidate()
+{
+   clear();
+   mValid = false;
+}
+
+void GraphicObjectIndex::rebuild(const list<GraphicObject*>& objects)
+{
+   clear();
+
+   double order = 0.0;
+   for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
+   {
+      GraphicObject* pObject = *iter;
+      if (pObject != NULL && mItems.find(pObject) == mItems.end())
+      {
+         addItem(pObject, order);
+         order += 1.0;
+      }
+   }
+
+   mBackOrder = 0.0;
+   mFrontOrder = order - 1.0;
+   mValid = true;
+}
+
+void GraphicObjectIndex::insertObject(GraphicObject* pObject)
+{
+   if (mValid == false || pObject == NULL || mItems.find(pObject) != mItems.end())
+   {
+      return;
+   }
+
+   mFrontOrder += 1.0;
+   addItem(pObject, mFrontOrder);
+}
+
+void GraphicObjectIndex::removeObject(GraphicObject* pObject)
+{
+   map<GraphicObject*, Item*>::iterator iter = mItems.find(pObject);
+   if (mValid == false || iter == mItems.end())
+   {
+      return;
+   }
+
+   Item* pItem = iter->second;
+   if (pItem->mpLeaf != NULL)
+   {
+      eraseItem(pItem);
+   }
+   else
+   {
+      mUnboundedItems.erase(find(mUnboundedItems.begin(), mUnboundedItems.end(), pItem));
+   }
+
+   mItems.erase(iter);
+   delete pItem;
+}
+
+void GraphicObjectIndex::updateObject(GraphicObject* pObject)
+{
+   map<GraphicObject*, Item*>::iterator iter = mItems.find(pObject);
+   if (mValid == false || iter == mItems.end())
+   {
+      return;
+   }
+
+   Item* pItem = iter->second;
+   if (pItem->mpLeaf != NULL)
+   {
+      eraseItem(pItem);
+      pItem->mBox = getBox(pObject);
+      insertItem(pItem);
+   }
+   else
+   {
+      pItem->mBox = getBox(pObject);
+   }
+}
+
+void GraphicObjectIndex::moveObjectToBack(GraphicObject* pObject)
+{
+   map<GraphicObject*, Item*>::iterator iter = mItems.find(pObject);
+   if (mValid == true && iter != mItems.end())
+   {
+      mBackOrder -= 1.0;
+      iter->second->mOrder = mBackOrder;
+   }
+}
+
+void GraphicObjectIndex::moveObjectToFront(GraphicObject* pObject)
+{
+   map<GraphicObject*, Item*>::iterator iter = mItems.find(pObject);
+   if (mValid == true && iter != mItems.end())
+   {
+      mFrontOrder += 1.0;
+      iter->second->mOrder = mFrontOrder;
+   }
+}
+
+bool GraphicObjectIndex::getExtents(LocationType& llCorner, LocationType& urCorner) const
+{
+   Box extents;
+   if (mpRoot != NULL)
+   {
+      extents = mpRoot->mBox;
+   }
+
+   for (vector<Item*>::const_iterator iter = mUnboundedItems.begin(); iter != mUnboundedItems.end(); ++iter)
+   {
+      extents.expand((*iter)->mBox);
+   }
+
+   if (extents.isEmpty())
+   {
+      return false;
+   }
+
+   llCorner = LocationType(extents.mMinX, extents.mMinY);
+   urCorner = LocationType(extents.mMaxX, extents.mMaxY);
+   return true;
+}
+
+void GraphicObjectIndex::getObjects(const LocationType& llCorner, const LocationType& urCorner,
+                                    vector<GraphicObject*>& objects) const
+{
+   Box area;
+   area.expand(llCorner.mX, llCorner.mY);
+   area.expand(urCorner.mX, urCorner.mY);
+
+   vector<Item*> items(mUnboundedItems);
+   vector<const Node*> nodes;
+   if (mpRoot != NULL)
+   {
+      nodes.push_back(mpRoot);
+   }
+
+   while (nodes.empty() == false)
+   {
+      const Node* pNode = nodes.back();
+      nodes.pop_back();
+      if (pNode->mBox.intersects(area) == false)
+      {
+         continue;
+      }
+
+      if (pNode->mLeaf)
+      {
+         for (vector<Item*>::const_iterator iter = pNode->mItems.begin(); iter != pNode->mItems.end(); ++iter)
+         {
+            if ((*iter)->mBox.intersects(area))
+            {
+               items.push_back(*iter);
+            }
+         }
+      }
+      else
+      {
+         nodes.insert(nodes.end(), pNode->mChildren.begin(), pNode->mChildren.end());
+      }
+   }
+
+   sort(items.begin(), items.end(), OrderLess<Item>);
+
+   objects.clear();
+   objects.reserve(items.size());
+   for (vector<Item*>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+   {
+      objects.push_back((*iter)->mpObject);
+   }
+}
+
+unsigned int GraphicObjectIndex::getNumObjects() const
+{
+   return static_cast<unsigned int>(mItems.size());
+}
+
+bool GraphicObjectIndex::isBounded(GraphicObject* pObject)
+{
+   // These objects draw text, infinite lines or other objects outside of their bounding box
+   switch (pObject->getGraphicObjectType())
+   {
+   case TEXT_OBJECT:             // Fall through
+   case FRAME_LABEL_OBJECT:      // Fall through
+   case SCALEBAR_OBJECT:         // Fall through
+   case GROUP_OBJECT:            // Fall through
+   case CGM_OBJECT:              // Fall through
+   case LATLONINSERT_OBJECT:     // Fall through
+   case NORTHARROW_OBJECT:       // Fall through
+   case EASTARROW_OBJECT:        // Fall through
+   case VIEW_OBJECT:             // Fall through
+   case MEASUREMENT_OBJECT:      // Fall through
+   case HLINE_OBJECT:            // Fall through
+   case VLINE_OBJECT:            // Fall through
+   case ROW_OBJECT:              // Fall through
+   case COLUMN_OBJECT:           // Fall through
+   case TRAIL_OBJECT:
+      return false;
+
+   default:
+      break;
+   }
+
+   return true;
+}
+
+GraphicObjectIndex::Box GraphicObjectIndex::getBox(GraphicObject* pObject)
+{
+   LocationType llCorner = pObject->getLlCorner();
+   LocationType urCorner = pObject->getUrCorner();
+   LocationType center((llCorner.mX + urCorner.mX) / 2.0, (llCorner.mY + urCorner.mY) / 2.0);
+
+   double angle = pObject->getRotation();
+   double cosTheta = cos(PI / 180.0 * angle);
+   double sinTheta = sin(PI / 180.0 * angle);
+
+   LocationType corners[4] =
+   {
+      llCorner,
+      LocationType(llCorner.mX, urCorner.mY),
+      urCorner,
+      LocationType(urCorner.mX, llCorner.mY)
+   };
+
+   Box box;
+   for (int i = 0; i < 4; ++i)
+   {
+      box.expand(center.mX + (corners[i].mX - center.mX) * cosTheta - (corners[i].mY - center.mY) * sinTheta,
+         center.mY + (corners[i].mX - center.mX) * sinTheta + (corners[i].mY - center.mY) * cosTheta);
+   }
+
+   return box;
+}
+
+void GraphicObjectIndex::clear()
+{
+   if (mpRoot != NULL)
+   {
+      deleteNodes(mpRoot, NULL);
+      mpRoot = NULL;
+   }
+
+   for (map<GraphicObject*, Item*>::iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
+   {
+      delete iter->second;
+   }
+
+   mItems.clear();
+   mUnboundedItems.clear();
+   mBackOrder = 0.0;
+   mFrontOrder = -1.0;
+}
+
+void GraphicObjectIndex::addItem(GraphicObject* pObject, double order)
+{
+   Item* pItem = new Item(pObject, getBox(pObject), order);
+   mItems[pObject] = pItem;
+   if (isBounded(pObject))
+   {
+      insertItem(pItem);
+   }
+   else
+   {
+      mUnboundedItems.push_back(pItem);
+   }
+}
+
+void GraphicObjectIndex::insertItem(Item* pItem)
+{
+   if (mpRoot == NULL)
+   {
+      mpRoot = new Node(NULL, true);
+   }
+
+   // Descend to the leaf whose box needs the least enlargement
+   Node* pNode = mpRoot;
+   while (pNode->mLeaf == false)
+   {
+      pNode->mBox.expand(pItem->mBox);
+
+      Node* pBest = NULL;
+      double bestEnlargement = 0.0;
+      double bestArea = 0.0;
+      for (vector<Node*>::const_iterator iter = pNode->mChildren.begin(); iter != pNode->mChildren.end(); ++iter)
+      {
+         double enlargement = (*iter)->mBox.getEnlargement(pItem->mBox);
+         double area = (*iter)->mBox.getArea();
+         if (pBest == NULL || enlargement < bestEnlargement || (enlargement == bestEnlargement && area < bestArea))
+         {
+            pBest = *iter;
+            bestEnlargement = enlargement;
+            bestArea = area;
+         }
+      }
+
+      pNode = pBest;
+   }
+
+   pNode->mBox.expand(pItem->mBox);
+   pNode->mItems.push_back(pItem);
+   pItem->mpLeaf = pNode;
+   if (pNode->getNumEntries() > MAX_NODE_ENTRIES)
+   {
+      splitNode(pNode);
+   }
+}
+
+void GraphicObjectIndex::eraseItem(Item* pItem)
+{
+   Node* pNode = pItem->mpLeaf;
+   pNode->mItems.erase(find(pNode->mItems.begin(), pNode->mItems.end(), pItem));
+   pItem->mpLeaf = NULL;
+
+   // Remove underfull nodes and reinsert their items
+   vector<Item*> orphans;
+   while (pNode != mpRoot)
+   {
+      Node* pParent = pNode->mpParent;
+      if (pNode->getNumEntries() < MIN_NODE_ENTRIES)
+      {
+         pParent->mChildren.erase(find(pParent->mChildren.begin(), pParent->mChildren.end(), pNode));
+         deleteNodes(pNode, &orphans);
+      }
+      else
+      {
+         pNode->updateBox();
+      }
+
+      pNode = pParent;
+   }
+
+   mpRoot->updateBox();
+   while (mpRoot->mLeaf == false && mpRoot->mChildren.size() == 1)
+   {
+      Node* pChild = mpRoot->mChildren.front();
+      pChild->mpParent = NULL;
+      delete mpRoot;
+      mpRoot = pChild;
+   }
+
+   if (mpRoot->mLeaf == false && mpRoot->mChildren.empty())
+   {
+      mpRoot->mLeaf = true;
+   }
+
+   for (vector<Item*>::const_iterator iter = orphans.begin(); iter != orphans.end(); ++iter)
+   {
+      insertItem(*iter);
+   }
+}
+
+void GraphicObjectIndex::splitNode(Node* pNode)
+{
+   Node* pSibling = new Node(pNode->mpParent, pNode->mLeaf);
+   if (pNode->mLeaf)
+   {
+      sortEntries(pNode->mItems);
+      pSibling->mItems.assign(pNode->mItems.begin() + pNode->mItems.size() / 2, pNode->mItems.end());
+      pNode->mItems.resize(pNode->mItems.size() / 2);
+      for (vector<Item*>::const_iterator iter = pSibling->mItems.begin(); iter != pSibling->mItems.end(); ++iter)
+      {
+         (*iter)->mpLeaf = pSibling;
+      }
+   }
+   else
+   {
+      sortEntries(pNode->mChildren);
+      pSibling->mChildren.assign(pNode->mChildren.begin() + pNode->mChildren.size() / 2, pNode->mChildren.end());
+      pNode->mChildren.resize(pNode->mChildren.size() / 2);
+      for (vector<Node*>::const_iterator iter = pSibling->mChildren.begin(); iter != pSibling->mChildren.end(); ++iter)
+      {
+         (*iter)->mpParent = pSibling;
+      }
+   }
+
+   pNode->updateBox();
+   pSibling->updateBox();
+
+   Node* pParent = pNode->mpParent;
+   if (pParent == NULL)
+   {
+      pParent = new Node(NULL, false);
+      pParent->mChildren.push_back(pNode);
+      pParent->mChildren.push_back(pSibling);
+      pParent->updateBox();
+      pNode->mpParent = pParent;
+      pSibling->mpParent = pParent;
+      mpRoot = pParent;
+   }
+   else
+   {
+      pParent->mChildren.push_back(pSibling);
+      if (pParent->getNumEntries() > MAX_NODE_ENTRIES)
+      {
+         splitNode(pParent);
+      }
+   }
+}
+
+void GraphicObjectIndex::deleteNodes(Node* pNode, vector<Item*>* pItems)
+{
+   if (pItems != NULL)
+   {
+      for (vector<Item*>::const_iterator iter = pNode->mItems.begin(); iter != pNode->mItems.end(); ++iter)
+      {
+         (*iter)->mpLeaf = NULL;
+         pItems->push_back(*iter);
+      }
+   }
+
+   for (vector<Node*>::const_iterator iter = pNode->mChildren.begin(); iter != pNode->mChildren.end(); ++iter)
+   {
+      deleteNodes(*iter, pItems);
+   }
+
+   delete pNode;
+}
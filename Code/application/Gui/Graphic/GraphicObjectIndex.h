@@ -0,0 +1,89 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GRAPHICOBJECTINDEX_H
+#define GRAPHICOBJECTINDEX_H
+
+#include "LocationType.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+class GraphicObject;
+
+/**
+ * An R-tree of the rotated bounding boxes of the objects in a graphic group
+ * along with their stacking order.
+ *
+ * The index is built from the group's object list the first time it is
+ * queried and is then updated incrementally as objects are inserted, removed,
+ * restacked or change their bounding box.  Objects whose drawn extents are not
+ * limited to their bounding box (text, scale bars, infinite lines, nested
+ * groups, etc.) are kept outside of the tree and are always returned by a query.
+ */
+class GraphicObjectIndex
+{
+public:
+   GraphicObjectIndex();
+   ~GraphicObjectIndex();
+
+   bool isValid() const;
+   void invalidate();
+   void rebuild(const std::list<GraphicObject*>& objects);
+
+   void insertObject(GraphicObject* pObject);
+   void removeObject(GraphicObject* pObject);
+   void updateObject(GraphicObject* pObject);
+   void moveObjectToBack(GraphicObject* pObject);
+   void moveObjectToFront(GraphicObject* pObject);
+
+   /**
+    * Gets the union of the rotated bounding boxes of all indexed objects.
+    *
+    * @return Returns \c false if no objects are indexed.
+    */
+   bool getExtents(LocationType& llCorner, LocationType& urCorner) const;
+
+   /**
+    * Gets the objects which may intersect an area, ordered from the back to
+    * the front of the stacking order.
+    */
+   void getObjects(const LocationType& llCorner, const LocationType& urCorner,
+      std::vector<GraphicObject*>& objects) const;
+
+   unsigned int getNumObjects() const;
+
+private:
+   GraphicObjectIndex(const GraphicObjectIndex& rhs);
+   GraphicObjectIndex& operator=(const GraphicObjectIndex& rhs);
+
+   struct Box;
+   struct Item;
+   struct Node;
+
+   static bool isBounded(GraphicObject* pObject);
+   static Box getBox(GraphicObject* pObject);
+
+   void clear();
+   void addItem(GraphicObject* pObject, double order);
+   void insertItem(Item* pItem);
+   void eraseItem(Item* pItem);
+   void splitNode(Node* pNode);
+   void deleteNodes(Node* pNode, std::vector<Item*>* pItems);
+
+   std::map<GraphicObject*, Item*> mItems;
+   std::vector<Item*> mUnboundedItems;
+   Node* mpRoot;
+   double mBackOrder;
+   double mFrontOrder;
+   bool mValid;
+};
+
+#endif
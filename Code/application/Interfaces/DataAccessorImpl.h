@@ -387,6 +387,42 @@ public:
       return mConcurrentColumns;
    }
 
+   /**
+    *  Access the number of rows available in the current page.
+    *
+    *  Rows are counted from the first row of the page, which is the first
+    *  row of the accessor until the accessor moves to a later page.
+    *
+    *  @return The number of concurrent rows.
+    */
+   inline size_t getConcurrentRows() const
+   {
+      return mConcurrentRows;
+   }
+
+   /**
+    *  Access the number of bands available concurrently.
+    *
+    *  @return The number of concurrent bands.
+    */
+   inline size_t getConcurrentBands() const
+   {
+      return mConcurrentBands;
+   }
+
+   /**
+    *  Access the number of bytes between the start of consecutive rows
+    *  in the current page.
+    *
+    *  Unlike getRowSize(), this includes any interline bytes.
+    *
+    *  @return The row stride in bytes.
+    */
+   inline size_t getRowStride() const
+   {
+      return mRowSize;
+   }
+
 private:
    friend class RasterElementImp;
 
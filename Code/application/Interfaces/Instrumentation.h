@@ -0,0 +1,196 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "AppConfig.h"
+#include "Service.h"
+
+#include <string>
+#include <vector>
+
+/**
+ *  \ingroup ServiceModule
+ *  Collects timing and count information from hot code paths.
+ *
+ *  Instrumentation is always compiled in but is disabled by default, in which
+ *  case the cost of each instrumentation point is a single flag test.  When
+ *  enabled, values are accumulated into per-thread counters without taking any
+ *  locks, so instrumentation points may be placed in pagers, data accessors and
+ *  multi-threaded algorithms.
+ *
+ *  Each counter is identified by a name which is registered once with
+ *  getCounterId().  A counter accumulates a total and the number of times a
+ *  value was added.  Spans are counters whose values are elapsed times in
+ *  microseconds; when tracing is enabled each span is also recorded as an event
+ *  which can be written in the Chrome trace event format with writeChromeTrace()
+ *  and viewed with chrome://tracing.
+ *
+ *  When instrumentation is enabled, each Step records the counters which changed
+ *  while it was active as properties of the step when it is finalized.
+ *
+ *  Plug-ins will typically use InstrumentationCounter and InstrumentationSpan
+ *  rather than calling these methods directly.
+ */
+class Instrumentation
+{
+public:
+   /**
+    *  Enables or disables instrumentation.
+    *
+    *  @param   enabled
+    *           If \c true, values passed to addToCounter() and addSpan() are
+    *           accumulated.  If \c false, they are ignored.
+    */
+   virtual void setEnabled(bool enabled) = 0;
+
+   /**
+    *  Queries whether instrumentation is enabled.
+    *
+    *  @return  Returns \c true if values are currently being accumulated.
+    */
+   virtual bool isEnabled() const = 0;
+
+   /**
+    *  Enables or disables recording of trace events.
+    *
+    *  Trace events are only recorded while instrumentation is enabled.  Each
+    *  thread keeps a fixed number of the most recent events.
+    *
+    *  @param   tracing
+    *           If \c true, each span is recorded as a trace event.
+    */
+   virtual void setTracing(bool tracing) = 0;
+
+   /**
+    *  Queries whether trace events are being recorded.
+    *
+    *  @return  Returns \c true if spans are recorded as trace events.
+    */
+   virtual bool isTracing() const = 0;
+
+   /**
+    *  Registers a counter.
+    *
+    *  Registering a name which is already registered returns the existing
+    *  identifier.  The identifier should be stored and reused since this
+    *  method takes a lock.
+    *
+    *  @param   name
+    *           The name of the counter.  Names are typically of the form
+    *           "Component::operation", e.g. "RasterPager::getPage".
+    *
+    *  @return  The identifier of the counter or a value greater than or equal
+    *           to getMaxCounters() if no more counters can be registered.
+    */
+   virtual unsigned int getCounterId(const std::string& name) = 0;
+
+   /**
+    *  Returns the maximum number of counters which can be registered.
+    *
+    *  @return  The maximum number of counters.
+    */
+   virtual unsigned int getMaxCounters() const = 0;
+
+   /**
+    *  Adds a value to a counter for the calling thread.
+    *
+    *  @param   id
+    *           The identifier returned by getCounterId().
+    *
+    *  @param   value
+    *           The value to add to the counter total.  The count of the counter
+    *           is incremented by one.
+    */
+   virtual void addToCounter(unsigned int id, int64_t value) = 0;
+
+   /**
+    *  Returns the current time.
+    *
+    *  @return  The number of microseconds since the application started.  This
+    *           is the time base for addSpan().
+    */
+   virtual int64_t getTime() const = 0;
+
+   /**
+    *  Adds a span to a counter for the calling thread.
+    *
+    *  The duration of the span is added to the counter and, if tracing is
+    *  enabled, a trace event is recorded.
+    *
+    *  @param   id
+    *           The identifier returned by getCounterId().
+    *
+    *  @param   start
+    *           The start of the span as returned by getTime().
+    *
+    *  @param   end
+    *           The end of the span as returned by getTime().
+    */
+   virtual void addSpan(unsigned int id, int64_t start, int64_t end) = 0;
+
+   /**
+    *  Returns the names of all registered counters.
+    *
+    *  @return  The counter names in the order they were registered.
+    */
+   virtual std::vector<std::string> getCounterNames() const = 0;
+
+   /**
+    *  Returns the total of a counter summed across all threads.
+    *
+    *  The value may be slightly out of date for threads which are currently
+    *  adding to the counter.
+    *
+    *  @param   name
+    *           The name of the counter.
+    *
+    *  @return  The counter total or zero if the counter is not registered.
+    */
+   virtual int64_t getCounterTotal(const std::string& name) const = 0;
+
+   /**
+    *  Returns the number of values added to a counter across all threads.
+    *
+    *  @param   name
+    *           The name of the counter.
+    *
+    *  @return  The number of values added or zero if the counter is not
+    *           registered.
+    */
+   virtual int64_t getCounterCount(const std::string& name) const = 0;
+
+   /**
+    *  Clears all counter values and trace events.
+    *
+    *  Registered counters remain registered.  This should not be called while
+    *  other threads are adding values.
+    */
+   virtual void reset() = 0;
+
+   /**
+    *  Writes the recorded trace events in the Chrome trace event format.
+    *
+    *  @param   filename
+    *           The name of the JSON file to write.
+    *
+    *  @return  Returns \c true if the file was successfully written.
+    */
+   virtual bool writeChromeTrace(const std::string& filename) const = 0;
+
+protected:
+   /**
+    * This will be cleaned up during application close.  Plug-ins do not
+    * need to destroy it.
+    */
+   virtual ~Instrumentation() {}
+};
+
+#endif
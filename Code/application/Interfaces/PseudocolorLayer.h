@@ -265,6 +265,22 @@ public:
 
   virtual void setSymbol(SymbolType symbol) = 0;
 
+   /**
+    *  Retrieves the number of pixels in a pseudocolor class.
+    *
+    *  The pixels of all classes are located with a single pass over the data,
+    *  which is cached until the raster element data is modified.  Calling this
+    *  method for each class therefore only reads the data once.
+    *
+    *  @param   iID
+    *           The unique ID of the class.
+    *
+    *  @return  The number of pixels whose value matches the class value,
+    *           regardless of whether the class is displayed.  Zero is returned
+    *           if no class exists with the given ID.
+    */
+   virtual unsigned int getClassPixelCount(int iID) const = 0;
+
 protected:
    /**
     * This should be destroyed by calling SpatialDataView::deleteLayer.
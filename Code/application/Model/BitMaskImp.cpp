@@ -55,7 +55,8 @@ BitMaskImp::BitMaskImp() :
    mBufferY1(0),
    mBufferX2(0),
    mBufferY2(0),
-   mBufferNeedsUpdated(true)
+   mBufferNeedsUpdated(true),
+   mModificationCount(0)
 {}
 
 /**
@@ -87,7 +88,8 @@ BitMaskImp::BitMaskImp(const BitMaskImp& rhs) :
    mBufferY1(0),
    mBufferX2(0),
    mBufferY2(0),
-   mBufferNeedsUpdated(true)
+   mBufferNeedsUpdated(true),
+   mModificationCount(0)
 {
    if (rhs.mpMask)
    {
@@ -129,7 +131,8 @@ BitMaskImp::BitMaskImp(const bool** pRegion, int x1, int y1, int x2, int y2) :
    mBufferY1(0),
    mBufferX2(0),
    mBufferY2(0),
-   mBufferNeedsUpdated(true)
+   mBufferNeedsUpdated(true),
+   mModificationCount(0)
 {
    if (pRegion == NULL)
    {
@@ -206,6 +209,7 @@ BitMaskImp::~BitMaskImp()
  */
 BitMaskImp& BitMaskImp::operator=(const BitMaskImp& rhs)
 {
+   ++mModificationCount;
    if (rhs.mpMask != mpMask)
    {
       if (mpMask)
@@ -285,6 +289,7 @@ BitMaskImp& BitMaskImp::operator=(const BitMaskImp& rhs)
  */
 void BitMaskImp::operator|=(const BitMaskImp& rhs)
 {
+   ++mModificationCount;
    if (this == &rhs)
    {
       return;   // OR'ing with self
@@ -395,6 +400,7 @@ void BitMaskImp::operator|=(const BitMaskImp& rhs)
  */
 void BitMaskImp::operator^=(const BitMaskImp& rhs)
 {
+   ++mModificationCount;
    if (this == &rhs) // XOR'ing with self
    {
       clear();
@@ -467,6 +473,7 @@ void BitMaskImp::operator^=(const BitMaskImp& rhs)
  */
 void BitMaskImp::operator&=(const BitMaskImp& rhs)
 {
+   ++mModificationCount;
    int x;
    int y;
 
@@ -724,6 +731,7 @@ bool BitMaskImp::compare(const BitMask& rhs) const
  */
 void BitMaskImp::invert()
 {
+   ++mModificationCount;
    int index = 0;
    for (int j = 0; j < mSize; ++j, ++index)
    {
@@ -741,6 +749,7 @@ void BitMaskImp::invert()
 
 void BitMaskImp::setRegion(int x1, int y1, int x2, int y2, ModeType op)
 {
+   ++mModificationCount;
    if (x1 > x2)
    {
       int temp = x1;
@@ -930,6 +939,7 @@ bool BitMaskImp::isSubsetOf(const BitMask& source) const
  */
 void BitMaskImp::setPixel(int x, int y, bool value)
 {
+   ++mModificationCount;
    if (x > mx2 || x < mx1 || y > my2 || y < my1 || mpMask == NULL)
    {
       if (value == mOutside)
@@ -1055,6 +1065,7 @@ unsigned int BitMaskImp::getPixels(int x, int y) const
  */
 void BitMaskImp::setPixels(int x, int y, unsigned int values)
 {
+   ++mModificationCount;
    if (x > mx2 || x < mx1 || y > my2 || y < my1 || mpMask == NULL)
    {
       if (values == mOutside * 0xffffffff)
@@ -1091,6 +1102,7 @@ bool BitMaskImp::isOutsideSelected() const
 
 void BitMaskImp::clipBoundingBox(int x1, int y1, int x2, int y2)
 {
+   ++mModificationCount;
    bool bOutside = mOutside;
 
    BitMaskImp maskCopy(*this);
@@ -1121,6 +1133,19 @@ int BitMaskImp::getCount() const
    return mCount;
 }
 
+/**
+ *  getModificationCount method.
+ *
+ *  Gets a count which changes every time the mask is modified.
+ *
+ *  @return
+ *         the number of modifications made to the mask
+ */
+unsigned int BitMaskImp::getModificationCount() const
+{
+   return mModificationCount;
+}
+
 /**
  *  getRegion method.
  *
@@ -1489,6 +1514,7 @@ bool BitMaskImp::toXml(XMLWriter* xml) const
 
 bool BitMaskImp::fromXml(DOMNode* document, unsigned int version)
 {
+   ++mModificationCount;
    string outsideVal(A(static_cast<DOMElement*>(document)->getAttribute(X("outside"))));
    string crcString(A(static_cast<DOMElement*>(document)->getAttribute(X("ecc"))));
    if (outsideVal == "1" || outsideVal == "t" || outsideVal == "true")
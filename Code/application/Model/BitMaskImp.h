@@ -280,6 +280,18 @@ public:
     */
    virtual int getCount() const;
 
+   /**
+    *  getModificationCount method.
+    *
+    *  Gets a count which changes every time the mask is modified.  Callers
+    *  which cache data derived from the mask can compare the count to
+    *  determine if the cache is out of date.
+    *
+    *  @return
+    *         the number of modifications made to the mask
+    */
+   unsigned int getModificationCount() const;
+
    /**
     *  getRegion method.
     *
@@ -379,6 +391,7 @@ private:
    int mBufferX2;
    int mBufferY2;          // the pixel coordinate of the upper right corner of the buffer region
    bool mBufferNeedsUpdated;
+   unsigned int mModificationCount;
 
    /**
     *  computeCount member function.
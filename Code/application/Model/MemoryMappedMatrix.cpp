@@ -16,6 +16,7 @@
 #include <sys/stat.h>
 #include <stdexcept>
 #include <stdio.h>
+#include <algorithm>
 #include <limits>
 
 #if defined(WIN_API)
@@ -36,6 +37,9 @@ MemoryMappedMatrix::MemoryMappedMatrix(const string& fileName, unsigned int head
                                        unsigned int rowNum, unsigned int columnNum, unsigned int bandNum,
                                        unsigned int interLineBytes, unsigned int interBandBytes, bool readOnly) :
    mFileName(fileName),
+   mpLayout(NULL),
+   mWindowSize(0),
+   mPoolSize(0),
    mInterleave(interleave),
    mBytesPerElement(bytesPerElement),
    mRowNum(rowNum),
@@ -105,10 +109,19 @@ MemoryMappedMatrix::MemoryMappedMatrix(const string& fileName, unsigned int head
       mGranularity = fileStats.st_blksize;
    }
 #endif
+
+   mpLayout = new MemoryMappedMatrixView(mHandle, mHeaderOffset, 0, mInterleave, mBytesPerElement, mRowNum,
+      mColumnNum, mBandNum, mInterLineBytes, mInterBandBytes, mReadOnly, mGranularity, mFileSize);
 }
 
 MemoryMappedMatrix::~MemoryMappedMatrix()
 {
+   for (map<MemoryMappedMatrixView*, unsigned int>::iterator iter = mViews.begin(); iter != mViews.end(); ++iter)
+   {
+      delete iter->first;
+   }
+   delete mpLayout;
+
 #if defined(WIN_API)
    CloseHandle(mHandle);
    CloseHandle(mFileHandle);
@@ -117,17 +130,68 @@ MemoryMappedMatrix::~MemoryMappedMatrix()
 #endif
 }
 
-MemoryMappedMatrixView* MemoryMappedMatrix::getView(size_t defaultSegmentSize)
+MemoryMappedMatrixView* MemoryMappedMatrix::getView(unsigned int row, unsigned int column, unsigned int band,
+                                                    size_t segmentSize, int64_t& address, bool& exclusive)
 {
-   MemoryMappedMatrixView* pView = new MemoryMappedMatrixView(mHandle, mHeaderOffset, defaultSegmentSize,
+   address = mpLayout->getFileOffset(row, column, band);
+   exclusive = false;
+
+   // reuse a view whose window already contains the segment
+   for (map<MemoryMappedMatrixView*, unsigned int>::iterator iter = mViews.begin(); iter != mViews.end(); ++iter)
+   {
+      MemoryMappedMatrixView* pView = iter->first;
+      if (pView->contains(address, segmentSize) == true)
+      {
+         if (iter->second++ == 0)
+         {
+            mUnusedViews.remove(pView);
+            exclusive = true;
+         }
+         return pView;
+      }
+   }
+
+   MemoryMappedMatrixView* pView = new MemoryMappedMatrixView(mHandle, mHeaderOffset, max(segmentSize, mWindowSize),
       mInterleave, mBytesPerElement, mRowNum, mColumnNum, mBandNum, mInterLineBytes, mInterBandBytes, mReadOnly,
       mGranularity, mFileSize);
+   if (pView->getSegment(address) == NULL)
+   {
+      delete pView;
+      return NULL;
+   }
 
-   mViews.insert(pView);
+   mViews[pView] = 1;
+   exclusive = true;
    return pView;
 }
 
 void MemoryMappedMatrix::release(MemoryMappedMatrixView* pView)
 {
-   mViews.erase(pView);
+   map<MemoryMappedMatrixView*, unsigned int>::iterator iter = mViews.find(pView);
+   if (iter == mViews.end() || iter->second == 0)
+   {
+      return;
+   }
+
+   if (--iter->second == 0)
+   {
+      mUnusedViews.push_front(pView);
+      while (mUnusedViews.size() > mPoolSize)
+      {
+         MemoryMappedMatrixView* pOldView = mUnusedViews.back();
+         mUnusedViews.pop_back();
+         mViews.erase(pOldView);
+         delete pOldView;
+      }
+   }
+}
+
+void MemoryMappedMatrix::setWindowSize(size_t windowSize)
+{
+   mWindowSize = windowSize;
+}
+
+void MemoryMappedMatrix::setPoolSize(unsigned int poolSize)
+{
+   mPoolSize = poolSize;
 }
@@ -21,8 +21,9 @@ typedef struct _iobuf FILE;
 #include "AppConfig.h"
 #include "TypesFile.h"
 
+#include <list>
+#include <map>
 #include <string>
-#include <set>
 
 class MemoryMappedMatrixView;
 
@@ -36,10 +37,48 @@ public:
 
    ~MemoryMappedMatrix();
 
-   MemoryMappedMatrixView* getView(size_t defaultSegmentSize);
-
+   /**
+    * Returns a mapped view containing a segment of the matrix.
+    *
+    * Views are mapped in windows of at least the window size and are reused
+    * for later segments which fall inside a window that is already mapped.
+    * Each view returned must be passed to release() when it is no longer used.
+    *
+    * @param row
+    *        The row at the start of the segment.
+    * @param column
+    *        The column at the start of the segment.
+    * @param band
+    *        The band at the start of the segment.
+    * @param segmentSize
+    *        The number of bytes in the segment.
+    * @param address
+    *        Set to the file offset of the start of the segment, which can
+    *        be passed to MemoryMappedMatrixView::getPointer().
+    * @param exclusive
+    *        Set to \c true if no other page currently uses the view, so
+    *        access hints given for the segment do not affect other readers.
+    *
+    * @return The view, or \c NULL if the segment could not be mapped.
+    */
+   MemoryMappedMatrixView* getView(unsigned int row, unsigned int column, unsigned int band, size_t segmentSize,
+      int64_t& address, bool& exclusive);
+
+   /**
+    * Releases a view returned from getView().
+    *
+    * Views which are no longer used remain mapped until more than the pool
+    * size of unused views exist, at which point the least recently used view
+    * is unmapped.
+    *
+    * @param pView
+    *        The view to release.
+    */
    void release(MemoryMappedMatrixView* pView);
 
+   void setWindowSize(size_t windowSize);
+   void setPoolSize(unsigned int poolSize);
+
 private:
    std::string mFileName;
 
@@ -54,7 +93,11 @@ private:
    int mHandle;
 #endif
 
-   std::set<MemoryMappedMatrixView*> mViews;
+   MemoryMappedMatrixView* mpLayout;                              // unmapped view used to compute offsets
+   std::map<MemoryMappedMatrixView*, unsigned int> mViews;       // mapped views and their reference counts
+   std::list<MemoryMappedMatrixView*> mUnusedViews;              // most recently released first
+   size_t mWindowSize;
+   unsigned int mPoolSize;
 
    InterleaveFormatType mInterleave;
    unsigned int mBytesPerElement;
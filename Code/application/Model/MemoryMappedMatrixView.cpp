@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdio.h>
+#include <algorithm>
 #include <limits>
 
 using namespace std;
@@ -121,8 +122,12 @@ unsigned char* MemoryMappedMatrixView::firstSegment()
 
 unsigned char* MemoryMappedMatrixView::getSegment(unsigned int row, unsigned int column, unsigned int band)
 {
-   int64_t start = 0;
+   return getSegment(getFileOffset(row, column, band));
+}
 
+int64_t MemoryMappedMatrixView::getFileOffset(unsigned int row, unsigned int column, unsigned int band) const
+{
+   int64_t start = 0;
    if (mInterleave == BIP)
    {
       start = row * mMajorSize;
@@ -145,7 +150,67 @@ unsigned char* MemoryMappedMatrixView::getSegment(unsigned int row, unsigned int
       start += mHeaderOffset;
    }
 
-   return getSegment(start);
+   return start;
+}
+
+bool MemoryMappedMatrixView::contains(int64_t address, size_t size) const
+{
+   if (mpBlock == NULL || address < mAddress)
+   {
+      return false;
+   }
+
+   // the mapping is truncated at the end of the file, so only the part of the range inside the file must fit
+   int64_t end = std::min(address + static_cast<int64_t>(size), mFileSize);
+   return end <= mAddress + static_cast<int64_t>(mBlockSize);
+}
+
+unsigned char* MemoryMappedMatrixView::getPointer(int64_t address) const
+{
+   if (mpBlock == NULL)
+   {
+      return NULL;
+   }
+
+   return mpBlock + (address - mAddress);
+}
+
+void MemoryMappedMatrixView::advise(int64_t address, size_t size, AccessAdvice advice) const
+{
+#if !defined(WIN_API)
+   if (mpBlock == NULL)
+   {
+      return;
+   }
+
+   int advisory = MADV_NORMAL;
+   switch (advice)
+   {
+   case SEQUENTIAL_ACCESS:
+      advisory = MADV_SEQUENTIAL;
+      break;
+   case RANDOM_ACCESS:
+      advisory = MADV_RANDOM;
+      break;
+   case WILL_NEED:
+      advisory = MADV_WILLNEED;
+      break;
+   default:
+      break;
+   }
+
+   // madvise() requires a page aligned start, and the mapping itself starts on a page boundary
+   static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+   int64_t start = std::max(address, mAddress);
+   int64_t end = std::min(address + static_cast<int64_t>(size), mAddress + static_cast<int64_t>(mBlockSize));
+   start -= (start - mAddress) % pageSize;
+   if (end <= start)
+   {
+      return;
+   }
+
+   madvise(reinterpret_cast<caddr_t>(mpBlock + (start - mAddress)), static_cast<size_t>(end - start), advisory);
+#endif
 }
 
 unsigned char* MemoryMappedMatrixView::getSegment(int64_t address)
@@ -33,6 +33,17 @@
 class MemoryMappedMatrixView
 {
 public:
+   /**
+    * Hints passed to the operating system about how a mapped range will be accessed.
+    */
+   enum AccessAdvice
+   {
+      NORMAL_ACCESS,       /**< No special treatment. */
+      SEQUENTIAL_ACCESS,   /**< The range will be read in increasing order and can be freed soon after. */
+      RANDOM_ACCESS,       /**< The range will be read in random order so read ahead is not useful. */
+      WILL_NEED            /**< The range will be read soon and should be read ahead now. */
+   };
+
    MemoryMappedMatrixView(HANDLE_TYPE handle, unsigned int headerOffset, size_t segmentSize,
                       InterleaveFormatType interleave, unsigned int bytesPerElement,
                       unsigned int rowNum, unsigned int columnNum, unsigned int bandNum,
@@ -50,6 +61,11 @@ public:
    unsigned char* getSegment(unsigned int row, unsigned int column, unsigned int band);
    unsigned char* getSegment(int64_t address);
 
+   int64_t getFileOffset(unsigned int row, unsigned int column, unsigned int band) const;
+   bool contains(int64_t address, size_t size) const;
+   unsigned char* getPointer(int64_t address) const;
+   void advise(int64_t address, size_t size, AccessAdvice advice) const;
+
    unsigned char* nextSegment();
 
    int64_t ensureGranularity(int64_t suggestedValue);
@@ -21,10 +21,7 @@ MemoryMappedPage::MemoryMappedPage() :
 
 MemoryMappedPage::~MemoryMappedPage()
 {
-   if (mpMatrixView != NULL)
-   {
-      delete mpMatrixView;
-   }
+   // the view is owned by the MemoryMappedMatrix which may share it with other pages
 }
 
 void* MemoryMappedPage::getRawData()
@@ -74,16 +71,6 @@ unsigned int MemoryMappedPage::getInterlineBytes()
 
 void MemoryMappedPage::setMemoryMappedMatrixView(MemoryMappedMatrixView* pView)
 {
-   if (pView == mpMatrixView)
-   {
-      return;
-   }
-
-   if (mpMatrixView != NULL)
-   {
-      delete mpMatrixView;
-   }
-
    mpMatrixView = pView;
 }
 
@@ -7,6 +7,7 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "AppConfig.h"
 #include "AppVersion.h"
 #include "AppVerify.h"
 #include "DataRequest.h"
@@ -26,7 +27,14 @@
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
 
+#if defined(WIN_API)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
 #include <algorithm>
+#include <limits>
 using namespace std;
 
 MemoryMappedPager::MemoryMappedPager() :
@@ -55,6 +63,38 @@ namespace
          delete pMatrix;
       }
    };
+
+   // Largest window mapped by a 32-bit build, which shares a few GB of address space with the rest of the process
+   const size_t sMaxWindowSize32 = 16 * 1024 * 1024;
+
+   // Fraction of the available address space the windows of one pager may keep mapped
+   const int64_t sAddressSpaceFraction = 16;
+
+   int64_t getAvailableAddressSpace()
+   {
+      int64_t available = numeric_limits<int64_t>::max();
+      if (sizeof(void*) < 8)
+      {
+         available = static_cast<int64_t>(numeric_limits<size_t>::max()) / 2;
+      }
+
+#if defined(WIN_API)
+      MEMORYSTATUSEX status;
+      status.dwLength = sizeof(status);
+      if (GlobalMemoryStatusEx(&status) != 0)
+      {
+         available = min(available, static_cast<int64_t>(status.ullAvailVirtual));
+      }
+#else
+      struct rlimit limit;
+      if (getrlimit(RLIMIT_AS, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+      {
+         available = min(available, static_cast<int64_t>(limit.rlim_cur));
+      }
+#endif
+
+      return available;
+   }
 }
 
 MemoryMappedPager::~MemoryMappedPager()
@@ -278,13 +318,38 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
    } 
    VERIFY(!mMatrices.empty());
 
+   // Size the windows and split the pool of unused views between the matrices so that
+   // the mapped windows stay within a small part of the address space of the process
+   int64_t budget = getAvailableAddressSpace() / sAddressSpaceFraction;
+   size_t windowSize = MemoryMappedPager::getSettingWindowSize();
+   if (sizeof(void*) < 8)
+   {
+      windowSize = min(windowSize, sMaxWindowSize32);
+   }
+
+   unsigned int poolSize = MemoryMappedPager::getSettingViewPoolSize();
+   if (windowSize > 0)
+   {
+      int64_t budgetViews = budget / static_cast<int64_t>(windowSize);
+      if (budgetViews < static_cast<int64_t>(poolSize))
+      {
+         poolSize = static_cast<unsigned int>(max(budgetViews, static_cast<int64_t>(1)));
+      }
+   }
+   poolSize = max(1U, poolSize / static_cast<unsigned int>(mMatrices.size()));
+
+   for (vector<MemoryMappedMatrix*>::iterator iter = mMatrices.begin(); iter != mMatrices.end(); ++iter)
+   {
+      (*iter)->setWindowSize(windowSize);
+      (*iter)->setPoolSize(poolSize);
+   }
+
    return true;
 }
 
 RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow,
                                        DimensionDescriptor startColumn, DimensionDescriptor startBand)
 {
-   //ensure only one thread enters this code at a time
    VERIFYRV((mpDataDescriptor != NULL) && (!mMatrices.empty()) && pOriginalRequest != NULL, NULL);
 
    unsigned int bandIndex = startBand.getActiveNumber();
@@ -294,6 +359,7 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
       return NULL;
    }
 
+   //ensure only one thread enters this code at a time
    mta::MutexLock mutex(mMutex);
 
    InterleaveFormatType interleave;
@@ -389,29 +455,54 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
    segmentSize = concurrentRows * rowSize;
    numRows = concurrentRows;
 
-   //get the MemoryMappedMatrixView of a let segmentSize large
-   MemoryMappedMatrixView* pView = NULL;
    MemoryMappedMatrix* pMatrix = mMatrices.front();
    if (mMatrices.size() > 1)
    {
       VERIFYRV(bandIndex < mMatrices.size(), NULL);
       pMatrix = mMatrices[bandIndex];
+      bandIndex = 0;
    }
    VERIFYRV(pMatrix != NULL, NULL);
-   pView = pMatrix->getView(segmentSize);
-   VERIFYRV(pView != NULL, NULL);
 
-   //ask the MemoryMappedMatrixView for a pointer starting
-   //at the given location
-   if (mMatrices.size() > 1)
+   //get a MemoryMappedMatrixView containing the segment, which may already
+   //be mapped for another page
+   int64_t address = 0;
+   bool exclusive = false;
+   MemoryMappedMatrixView* pView = pMatrix->getView(startRow.getActiveNumber() + offsetRow,
+      startColumn.getActiveNumber() + offsetCol, bandIndex, segmentSize, address, exclusive);
+
+   unsigned int& nextRow = mNextRows[startBand.getActiveNumber()];
+   bool sequential = (startRow.getActiveNumber() == pOriginalRequest->getStartRow().getActiveNumber() ||
+      startRow.getActiveNumber() == nextRow);
+   nextRow = startRow.getActiveNumber() + concurrentRows;
+
+   if (pView == NULL)
    {
-      bandIndex = 0;
+      return NULL;
    }
-   char* pRawCubePointer = reinterpret_cast<char*>(pView->getSegment(startRow.getActiveNumber() + offsetRow,
-                                                   startColumn.getActiveNumber() + offsetCol, bandIndex));
-   if (pRawCubePointer == NULL)
+
+   char* pRawCubePointer = reinterpret_cast<char*>(pView->getPointer(address));
+
+   //give the operating system a hint about how the accessor will move through the file,
+   //unless another page is reading from the same window with its own access pattern
+   if (exclusive == true)
    {
-      return NULL;
+      if (startRow.getActiveNumber() + concurrentRows > pOriginalRequest->getStopRow().getActiveNumber())
+      {
+         //the page contains the rest of the request, so all of it will be read
+         pView->advise(address, segmentSize, MemoryMappedMatrixView::WILL_NEED);
+      }
+      else if (sequential == true)
+      {
+         //row sequential accessors and band sequential scans continue into the next page
+         pView->advise(address, 2 * segmentSize, MemoryMappedMatrixView::SEQUENTIAL_ACCESS);
+         pView->advise(address + segmentSize, segmentSize, MemoryMappedMatrixView::WILL_NEED);
+      }
+      else
+      {
+         //accessors repositioned with toPixel() move around the file, so read ahead is wasted
+         pView->advise(address, segmentSize, MemoryMappedMatrixView::RANDOM_ACCESS);
+      }
    }
 
    //we know have a pointer in raw memory that has
@@ -445,9 +536,6 @@ void MemoryMappedPager::releasePage(RasterPage* pPage)
 {
    VERIFYNRV(pPage != NULL);
 
-   //ensure only one thread enters this code at a time
-   mta::MutexLock mutex(mMutex);
-
    if (mSwapEndian)
    {
       delete static_cast<EndianSwapPage*>(pPage);
@@ -456,24 +544,29 @@ void MemoryMappedPager::releasePage(RasterPage* pPage)
    {
       MemoryMappedPage* pOurPage = static_cast<MemoryMappedPage*>(pPage);
 
-      map<MemoryMappedPage*, MemoryMappedMatrix*>::iterator foundIter;
-      foundIter = mCurrentlyLeasedPages.find(pOurPage);
-      if (foundIter != mCurrentlyLeasedPages.end())
       {
+         //only the bookkeeping needs to be protected from other threads
+         mta::MutexLock mutex(mMutex);
+
+         map<MemoryMappedPage*, MemoryMappedMatrix*>::iterator foundIter;
+         foundIter = mCurrentlyLeasedPages.find(pOurPage);
+         if (foundIter == mCurrentlyLeasedPages.end())
+         {
+            return;
+         }
+
          //we leased the page out from this instance,
-         //so now we can release the resources used for it.
-         
-         //destroy the memory mapped section of the file
-         //associated with that page
+         //so now we can return its view to the matrix
+         //which keeps it mapped for reuse
          foundIter->second->release(pOurPage->getMemoryMappedMatrixView());
 
          //remove the page from the vector
          mCurrentlyLeasedPages.erase(foundIter);
-         
-         //delete the actual page that we allocated earlier
-         //in the getPage() method.
-         delete pOurPage;
       }
+
+      //delete the actual page that we allocated earlier
+      //in the getPage() method.
+      delete pOurPage;
    }
 }
 
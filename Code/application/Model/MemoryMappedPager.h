@@ -12,8 +12,9 @@
 #ifndef MEMORYMAPPEDPAGER_H
 #define MEMORYMAPPEDPAGER_H
 
-#include "RasterPagerShell.h"
+#include "ConfigurationSettings.h"
 #include "DMutex.h"
+#include "RasterPagerShell.h"
 
 #include <vector>
 #include <map>
@@ -25,6 +26,9 @@ class MemoryMappedMatrix;
 class MemoryMappedPager : public RasterPagerShell
 {
 public:
+   SETTING(WindowSize, MemoryMappedPager, unsigned int, 64 * 1024 * 1024)
+   SETTING(ViewPoolSize, MemoryMappedPager, unsigned int, 8)
+
    MemoryMappedPager();
    ~MemoryMappedPager();
 
@@ -52,7 +56,10 @@ private:
    // Not all matrices will be represented here at any given time.
    std::map<MemoryMappedPage*, MemoryMappedMatrix*> mCurrentlyLeasedPages;
    std::vector<MemoryMappedMatrix*>      mMatrices;
-   
+
+   // The row following the most recently leased page of each band, used to detect sequential access
+   std::map<unsigned int, unsigned int>  mNextRows;
+
    mta::DMutex                           mMutex;
 
    bool mWritable;
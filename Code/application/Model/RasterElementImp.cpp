@@ -21,6 +21,7 @@
 #include "FileResource.h"
 #include "Georeference.h"
 #include "Importer.h"
+#include "InstrumentationUtilities.h"
 #include "ModelServices.h"
 #include "ObjectResource.h"
 #include "PlugInArg.h"
@@ -52,6 +53,9 @@ XERCES_CPP_NAMESPACE_USE
 
 namespace
 {
+   InstrumentationCounter sGetPageCounter("RasterPager::getPage");
+   InstrumentationCounter sReleasePageCounter("RasterPager::releasePage");
+
    double convert_s1byte_to_double(const void* pValue, int iIndex, ComplexComponent component)
    {
       return *(reinterpret_cast<const signed char*>(pValue) + iIndex);
@@ -1557,6 +1561,7 @@ void RasterElementImp::incrementDataAccessor(DataAccessorImpl& da)
    //release the previous page
    if (da.mpRasterPage != NULL)
    {
+      InstrumentationSpan span(sReleasePageCounter);
       da.mpRasterPager->releasePage(da.mpRasterPage);
    }
 
@@ -1578,6 +1583,7 @@ void RasterElementImp::incrementDataAccessor(DataAccessorImpl& da)
       da.mAccessorColumn < pDescriptor->getColumnCount() &&
       da.mAccessorBand < pDescriptor->getBandCount())
    {
+      InstrumentationSpan span(sGetPageCounter);
       pPage = da.mpRasterPager->getPage(da.mpRequest.get(),
          pDescriptor->getActiveRow(da.mAccessorRow), 
          pDescriptor->getActiveColumn(da.mAccessorColumn), 
@@ -1717,8 +1723,12 @@ DataAccessor RasterElementImp::getDataAccessor(DataRequest* pRequestIn)
    }
 
    //request that the data be mapped from the file on disk into memory.
-   RasterPage* pPage = pPager->getPage(pRequest.get(), pRequest->getStartRow(), pRequest->getStartColumn(),
-      pRequest->getStartBand());
+   RasterPage* pPage = NULL;
+   {
+      InstrumentationSpan span(sGetPageCounter);
+      pPage = pPager->getPage(pRequest.get(), pRequest->getStartRow(), pRequest->getStartColumn(),
+         pRequest->getStartBand());
+   }
    if (pPage != NULL)
    {
       //if we were successful, create a DataAccessorImpl
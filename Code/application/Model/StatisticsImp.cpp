@@ -32,6 +32,19 @@
 using namespace mta;
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   bool isIntegerComponent(EncodingType encoding, ComplexComponent component)
+   {
+      return !((encoding == FLT4BYTES) || (encoding == FLT8COMPLEX) || (encoding == FLT8BYTES) ||
+         ((encoding == INT4SCOMPLEX) && (component == COMPLEX_MAGNITUDE)) ||
+         ((encoding == INT4SCOMPLEX) && (component == COMPLEX_PHASE)));
+   }
+
+   // The number of rows processed by each block of a StatisticsCalculation
+   const int sCalculationBlockRows = 16;
+}
+
 StatisticsImp::StatisticsImp(const RasterElementImp* pRasterElement,
                              DimensionDescriptor band,
                              AoiElement* pAoi) :
@@ -58,7 +71,9 @@ StatisticsImp::StatisticsImp(const RasterElementImp* pRasterElement,
 }
 
 StatisticsImp::~StatisticsImp()
-{}
+{
+   cancelCalculations(true, COMPLEX_MAGNITUDE);
+}
 
 void StatisticsImp::setMin(double dMin)
 {
@@ -449,6 +464,8 @@ bool StatisticsImp::areStatisticsCalculated(ComplexComponent component) const
 
 void StatisticsImp::reset(ComplexComponent component)
 {
+   cancelCalculations(false, component);
+
    mMinValues.erase(component);
    mMaxValues.erase(component);
    mAverageValues.erase(component);
@@ -460,6 +477,8 @@ void StatisticsImp::reset(ComplexComponent component)
 
 void StatisticsImp::resetAll()
 {
+   cancelCalculations(true, COMPLEX_MAGNITUDE);
+
    mMinValues.clear();
    mMaxValues.clear();
    mAverageValues.clear();
@@ -685,51 +704,8 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
    int colNum = pDescriptor->getColumnCount();
    VERIFYNRV(rowNum > 0 && colNum > 0);
 
-   if (mStatisticsResolution < 1)
-   {
-      if (rowNum < colNum)
-      {
-         mStatisticsResolution = rowNum / 500;
-      }
-      else
-      {
-         mStatisticsResolution = colNum / 500;
-      }
-
-      if (mStatisticsResolution < 1)
-      {
-         mStatisticsResolution = 1;
-      }
-   }
-
-   // Create a bitmask for all pixels based on the statistics resolution
    FactoryResource<BitMask> pMask;
-   if (mStatisticsResolution == 1)
-   {
-      pMask->setRegion(0, 0, colNum - 1, rowNum - 1, DRAW);
-   }
-   else
-   {
-      // Increase the size of the bitmask bounding box to the full size so that the bitmask does
-      // not need to resize itself for every pixel that is set
-      pMask->setPixel(0, 0, true);
-      pMask->setPixel(colNum - 1, rowNum - 1, true);
-      pMask->setPixel(0, 0, false);
-      pMask->setPixel(colNum - 1, rowNum - 1, false);
-
-      for (int i = 0; i < rowNum * colNum; i += mStatisticsResolution)
-      {
-         int col = i % colNum;
-         int row = (i - col) / colNum;
-         pMask->setPixel(col, row, true);
-      }
-   }
-
-   // Intersect bitmask pixels based on the AOI
-   if (mpAoi.get() != NULL)
-   {
-      pMask->intersect(*(mpAoi->getSelectedPoints()));
-   }
+   createStatisticsMask(pMask.get());
 
    StatisticsInput statInput(mBands, dynamic_cast<const RasterElement*>(mpRasterElement),
       component, mStatisticsResolution, &mBadValues, pMask.get());
@@ -746,14 +722,7 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
       (getNumRequiredThreads(pDescriptor->getRowCount()), statInput, statOutput, &progressReporter);
    statisticsAlgorithm.run();
 
-   bool bInteger = true;
-   EncodingType encoding = pDescriptor->getDataType();
-   if ((encoding == FLT4BYTES) || (encoding == FLT8COMPLEX) || (encoding == FLT8BYTES) ||
-      ((encoding == INT4SCOMPLEX) && (component == COMPLEX_MAGNITUDE)) ||
-      ((encoding == INT4SCOMPLEX) && (component == COMPLEX_PHASE)))
-   {
-      bInteger = false;
-   }
+   bool bInteger = isIntegerComponent(pDescriptor->getDataType(), component);
 
    progressReporter.setCurrentPhase(1);
 
@@ -788,6 +757,63 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
    }
 }
 
+void StatisticsImp::createStatisticsMask(BitMask* pMask)
+{
+   VERIFYNRV(pMask != NULL && mpRasterElement != NULL);
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(mpRasterElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor);
+
+   int rowNum = pDescriptor->getRowCount();
+   int colNum = pDescriptor->getColumnCount();
+
+   if (mStatisticsResolution < 1)
+   {
+      if (rowNum < colNum)
+      {
+         mStatisticsResolution = rowNum / 500;
+      }
+      else
+      {
+         mStatisticsResolution = colNum / 500;
+      }
+
+      if (mStatisticsResolution < 1)
+      {
+         mStatisticsResolution = 1;
+      }
+   }
+
+   // Create a bitmask for all pixels based on the statistics resolution
+   if (mStatisticsResolution == 1)
+   {
+      pMask->setRegion(0, 0, colNum - 1, rowNum - 1, DRAW);
+   }
+   else
+   {
+      // Increase the size of the bitmask bounding box to the full size so that the bitmask does
+      // not need to resize itself for every pixel that is set
+      pMask->setPixel(0, 0, true);
+      pMask->setPixel(colNum - 1, rowNum - 1, true);
+      pMask->setPixel(0, 0, false);
+      pMask->setPixel(colNum - 1, rowNum - 1, false);
+
+      for (int i = 0; i < rowNum * colNum; i += mStatisticsResolution)
+      {
+         int col = i % colNum;
+         int row = (i - col) / colNum;
+         pMask->setPixel(col, row, true);
+      }
+   }
+
+   // Intersect bitmask pixels based on the AOI
+   if (mpAoi.get() != NULL)
+   {
+      pMask->intersect(*(mpAoi->getSelectedPoints()));
+   }
+}
+
 StatisticsThread::StatisticsThread(const StatisticsInput& input, int threadCount, int threadIndex,
                                    ThreadReporter& reporter) :
    AlgorithmThread(threadIndex, reporter),
@@ -1324,3 +1350,184 @@ void StatisticsImp::badValuesChanged(Subject& subject, const std::string& signal
 {
    resetAll();
 }
+
+void StatisticsImp::cancelCalculations(bool allComponents, ComplexComponent component)
+{
+   std::vector<StatisticsCalculation*> calculations;
+   calculations.swap(mCalculations);
+   for (std::vector<StatisticsCalculation*>::iterator iter = calculations.begin(); iter != calculations.end(); ++iter)
+   {
+      if (allComponents || (*iter)->mComponent == component)
+      {
+         (*iter)->cancel();
+      }
+      else
+      {
+         mCalculations.push_back(*iter);
+      }
+   }
+}
+
+StatisticsCalculation::StatisticsCalculation(StatisticsImp& statistics, ComplexComponent component) :
+   mpStatistics(&statistics),
+   mComponent(component),
+   mBands(statistics.mBands),
+   mStatisticsInput(mBands, dynamic_cast<const RasterElement*>(statistics.mpRasterElement), component,
+      statistics.mStatisticsResolution, &statistics.mBadValues, mpMask.get()),
+   mpHistogramInput(NULL),
+   mpHistogram(NULL),
+   mInteger(true),
+   mBlockCount(0),
+   mBlock(0)
+{
+   const RasterDataDescriptor* pDescriptor = (statistics.mpRasterElement == NULL) ? NULL :
+      dynamic_cast<const RasterDataDescriptor*>(statistics.mpRasterElement->getDataDescriptor());
+   if (pDescriptor == NULL || pDescriptor->getRowCount() == 0 || pDescriptor->getColumnCount() == 0)
+   {
+      mpStatistics = NULL;
+      return;
+   }
+
+   statistics.createStatisticsMask(mpMask.get());
+   mStatisticsInput.mResolution = statistics.mStatisticsResolution;
+   mInteger = isIntegerComponent(pDescriptor->getDataType(), component);
+
+   int rowCount = static_cast<int>(pDescriptor->getRowCount());
+   mBlockCount = (rowCount + sCalculationBlockRows - 1) / sCalculationBlockRows;
+
+   statistics.mCalculations.push_back(this);
+}
+
+StatisticsCalculation::~StatisticsCalculation()
+{
+   detach();
+
+   for (std::vector<StatisticsThread*>::iterator iter = mStatisticsBlocks.begin();
+      iter != mStatisticsBlocks.end();
+      ++iter)
+   {
+      delete *iter;
+   }
+
+   delete mpHistogram;
+   delete mpHistogramInput;
+}
+
+bool StatisticsCalculation::calculateNextBlock()
+{
+   if (isCancelled() || isComplete())
+   {
+      return false;
+   }
+
+   // The first half of the blocks finds the range of the data and the second half bins it
+   if (mBlock < mBlockCount)
+   {
+      StatisticsThread* pBlock = new StatisticsThread(mStatisticsInput, mBlockCount, mBlock, mReporter);
+      mStatisticsBlocks.push_back(pBlock);
+      pBlock->run();
+
+      if (++mBlock == mBlockCount)
+      {
+         finishStatistics();
+      }
+   }
+   else
+   {
+      HistogramThread block(*mpHistogramInput, mBlockCount, mBlock - mBlockCount, mReporter);
+      block.run();
+
+      std::vector<unsigned int>& totalBinCounts = mpHistogram->getBinCounts();
+      const std::vector<unsigned int>& blockBinCounts = block.getBinCounts();
+      std::transform(totalBinCounts.begin(), totalBinCounts.end(), blockBinCounts.begin(), totalBinCounts.begin(),
+         std::plus<unsigned int>());
+
+      if (++mBlock == 2 * mBlockCount)
+      {
+         finishHistogram();
+      }
+   }
+
+   return isComplete() == false;
+}
+
+bool StatisticsCalculation::isComplete() const
+{
+   return mBlockCount > 0 && mBlock == 2 * mBlockCount;
+}
+
+bool StatisticsCalculation::isCancelled() const
+{
+   return mpStatistics == NULL && isComplete() == false;
+}
+
+int StatisticsCalculation::getPercentComplete() const
+{
+   if (mBlockCount == 0)
+   {
+      return 0;
+   }
+
+   return (100 * mBlock) / (2 * mBlockCount);
+}
+
+void StatisticsCalculation::cancel()
+{
+   mpStatistics = NULL;
+}
+
+void StatisticsCalculation::detach()
+{
+   if (mpStatistics != NULL)
+   {
+      std::vector<StatisticsCalculation*>& calculations = mpStatistics->mCalculations;
+      calculations.erase(std::remove(calculations.begin(), calculations.end(), this), calculations.end());
+      mpStatistics = NULL;
+   }
+}
+
+void StatisticsCalculation::finishStatistics()
+{
+   mStatisticsOutput.compileOverallResults(mStatisticsBlocks);
+   if (mStatisticsOutput.mMaxMinSet == false)
+   {
+      mpStatistics->setMin(0.0, mComponent);
+      mpStatistics->setMax(0.0, mComponent);
+      mpStatistics->setAverage(mStatisticsOutput.mAverage, mComponent);
+      mpStatistics->setStandardDeviation(mStatisticsOutput.mStandardDeviation, mComponent);
+      std::vector<double> dzeroes(1001, 0.0); // setPercentiles needs 1001 contiguous values; setHistogram needs 256
+      std::vector<unsigned int> uizeroes(256, 0);
+      mpStatistics->setPercentiles(&dzeroes.front(), mComponent);
+      mpStatistics->setHistogram(&dzeroes.front(), &uizeroes.front(), mComponent);
+
+      mBlock = 2 * mBlockCount;
+      detach();
+      return;
+   }
+
+   // The bins of each block are added to the first block so only one full size histogram is kept
+   mpHistogramInput = new HistogramInput(mStatisticsInput, mStatisticsOutput);
+   mpHistogram = new HistogramThread(*mpHistogramInput, mBlockCount, 0, mReporter);
+   mpHistogram->run();
+   ++mBlock;
+
+   if (mBlock == 2 * mBlockCount)
+   {
+      finishHistogram();
+   }
+}
+
+void StatisticsCalculation::finishHistogram()
+{
+   HistogramOutput histOutput(mInteger, mStatisticsOutput.mMaximum, mStatisticsOutput.mMinimum);
+   histOutput.compileOverallResults(std::vector<HistogramThread*>(1, mpHistogram));
+
+   mpStatistics->setMin(mStatisticsOutput.mMinimum, mComponent);
+   mpStatistics->setMax(mStatisticsOutput.mMaximum, mComponent);
+   mpStatistics->setAverage(mStatisticsOutput.mAverage, mComponent);
+   mpStatistics->setStandardDeviation(mStatisticsOutput.mStandardDeviation, mComponent);
+   mpStatistics->setPercentiles(histOutput.getPercentiles(), mComponent);
+   mpStatistics->setHistogram(histOutput.getBinCenters(), histOutput.getBinCounts(), mComponent);
+
+   detach();
+}
@@ -26,6 +26,7 @@
 
 class RasterElement;
 class RasterElementImp;
+class StatisticsCalculation;
 
 class StatisticsImp : public Statistics
 {
@@ -85,12 +86,16 @@ public:
 
 protected:
    void calculateStatistics(ComplexComponent component);
+   void createStatisticsMask(BitMask* pMask);
    void badValuesChanged(Subject& subject, const std::string& signal, const boost::any& value);
 
 private:
    StatisticsImp(const StatisticsImp& rhs);
    StatisticsImp& operator=(const StatisticsImp& rhs);
 
+   friend class StatisticsCalculation;
+   void cancelCalculations(bool allComponents, ComplexComponent component);
+
    // NOTE: this has to be a RasterElementImp instead of RasterElement as it is populated
    // in the RasterElementImp constructor. At that point, a dynamic_cast to RasterElement
    // is not possible.
@@ -108,6 +113,7 @@ private:
 
    int mStatisticsResolution;
    BadValuesAdapter mBadValues;
+   std::vector<StatisticsCalculation*> mCalculations;
 };
 
 class StatisticsInput
@@ -239,4 +245,69 @@ private:
    std::vector<unsigned int> mBinCounts;
 };
 
+/**
+ * Calculates the statistics of one complex component a block of rows at a time, so that
+ * the calculation can be interleaved with event processing in the main thread.  The same
+ * statistics and histogram threads as StatisticsImp::calculateStatistics() are used, but
+ * each block is run directly instead of in a separate thread.  The calculation is cancelled
+ * if the statistics are reset or destroyed before the last block has been processed.
+ */
+class StatisticsCalculation
+{
+public:
+   StatisticsCalculation(StatisticsImp& statistics, ComplexComponent component);
+   ~StatisticsCalculation();
+
+   /**
+    * Processes the next block of rows.  After the last block, the results are set into
+    * the statistics.
+    *
+    * @return True if more blocks remain to be processed.
+    */
+   bool calculateNextBlock();
+
+   bool isComplete() const;
+   bool isCancelled() const;
+   int getPercentComplete() const;
+
+   void cancel();
+
+private:
+   StatisticsCalculation(const StatisticsCalculation& rhs);
+   StatisticsCalculation& operator=(const StatisticsCalculation& rhs);
+
+   friend class StatisticsImp;
+   void detach();
+   void finishStatistics();
+   void finishHistogram();
+
+   class BlockReporter : public mta::ThreadReporter
+   {
+   public:
+      mta::Result reportProgress(int threadIndex, int percentDone) { return mta::SUCCESS; }
+      mta::Result reportCompletion(int threadIndex) { return mta::SUCCESS; }
+      mta::Result reportError(std::string errorText) { mErrorText = errorText; return mta::SUCCESS; }
+      std::string getErrorText() const { return mErrorText; }
+      int getProgress(int threadIndex) const { return 0; }
+      void runInMainThread(mta::ThreadCommand& command) { command.run(); }
+
+   private:
+      std::string mErrorText;
+   };
+
+   StatisticsImp* mpStatistics;
+   ComplexComponent mComponent;
+   std::vector<DimensionDescriptor> mBands;
+   FactoryResource<BitMask> mpMask;
+   BlockReporter mReporter;
+   StatisticsInput mStatisticsInput;
+   StatisticsOutput mStatisticsOutput;
+   std::vector<StatisticsThread*> mStatisticsBlocks;
+   HistogramInput* mpHistogramInput;
+   HistogramThread* mpHistogram;
+   bool mInteger;
+   int mBlockCount;
+   int mBlock;
+};
+
 #endif
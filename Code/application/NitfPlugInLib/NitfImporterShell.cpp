@@ -663,7 +663,7 @@ ImportDescriptor* Nitf::NitfImporterShell::getImportDescriptor(const string& fil
 
    // Populate the metadata and set applicable values in the data descriptor
    if (Nitf::importMetadata(imageSegment + 1, pFile, pFileHeader, pImageSubheader, pDescriptor, parsers,
-      errorMessage) == true)
+      errorMessage, true) == true)
    {
       // Populate specific fields in the data descriptor or file descriptor from the TREs
       const DynamicObject* pMetadata = pDescriptor->getMetadata();
@@ -10,6 +10,8 @@
 #include "AppVerify.h"
 #include "DateTime.h"
 #include "DynamicObject.h"
+#include "FileDescriptor.h"
+#include "Filename.h"
 #include "MessageLogResource.h"
 #include "NitfConstants.h"
 #include "NitfDesSubheader.h"
@@ -24,7 +26,10 @@
 #include "RasterDataDescriptor.h"
 #include "SpecialMetadata.h"
 #include "StringUtilities.h"
+#include "UInt64.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -44,6 +49,7 @@
 #include <ossim/support_data/ossimNitfFileHeaderV2_X.h>
 #include <ossim/support_data/ossimNitfRpcATag.h>
 #include <ossim/support_data/ossimNitfFile.h>
+#include <ossim/support_data/ossimNitfTagInformation.h>
 #include <ossim/support_data/ossimNitfUnknownTag.h>
 #include <ossim/support_data/ossimNitfTagFactoryRegistry.h>
 
@@ -51,6 +57,63 @@ using namespace Nitf;
 using namespace Nitf::TRE;
 using namespace std;
 
+namespace
+{
+   const string sTagOffset = "Tag Offset";
+   const string sTagLength = "Tag Length";
+
+   /**
+    * Returns whether a TRE may be parsed after the import descriptor is created.
+    *
+    * The TREs listed here are used to populate the data descriptor in
+    * NitfImporterShell::getImportDescriptor() or to georeference the image,
+    * so they are always parsed when the metadata is imported.
+    */
+   bool isDeferrable(const string& tagName)
+   {
+      static const string sRequiredTres[] =
+      {
+         "ACFTA", "ACFTB", "BANDSA", "BANDSB", "BLOCKA", "ICHIPB", "RPC00A", "RPC00B", "STDIDB"
+      };
+      const string* pEnd = sRequiredTres + sizeof(sRequiredTres) / sizeof(sRequiredTres[0]);
+      return find(sRequiredTres, pEnd, tagName) == pEnd;
+   }
+
+   bool parseTagData(const string& tagName, const ossimNitfRegisteredTag& tag, RasterDataDescriptor& descriptor,
+      DynamicObject& tre, map<string, TrePlugInResource>& parsers, string& errorMessage)
+   {
+      // Try to parse the TRE with a specialized parser.
+      // Do NOT make a copy of pParser as it has ownership which gets transferred when the assignment operator is used.
+      // Doing so would cause a stale pointer to remain in the map and could cause a subsequent crash if it is used later.
+      map<string, TrePlugInResource>::iterator pParser = parsers.find(tagName);
+      if (pParser == parsers.end())
+      {
+         pParser = parsers.insert(make_pair(tagName, TrePlugInResource(tagName))).first;
+      }
+
+      if (pParser->second.parseTag(tag, tre, descriptor, errorMessage) == false)
+      {
+         // Failing that, use UnknownTreParser.
+         tre.clear();
+
+         // Again, do NOT make a copy of pParser.
+         pParser = parsers.find("Unknown Tre Parser");
+         if (pParser == parsers.end())
+         {
+            pParser = parsers.insert(make_pair("Unknown Tre Parser", TrePlugInResource("Unknown Tre Parser"))).first;
+         }
+
+         if (pParser->second.parseTag(tag, tre, descriptor, errorMessage) == false)
+         {
+            errorMessage += tagName + " has not been imported.\n";
+            return false;
+         }
+      }
+
+      return true;
+   }
+}
+
 bool Nitf::TrePlugInResource::parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
    RasterDataDescriptor& descriptor, string& errorMessage) const
 {
@@ -201,7 +264,8 @@ bool Nitf::TrePlugInResource::exportMetadata(const RasterDataDescriptor& descrip
 
 bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
    const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
-   RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>& parsers, string& errorMessage)
+   RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>& parsers, string& errorMessage,
+   bool deferTres)
 {
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : Separate the file header parsing " \
 //   "from the subheader parsing (dadkins)")
@@ -254,6 +318,10 @@ bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFil
          errorStream << "Unable to retrieve tag #" << imageTag << " from the image subheader." << endl;
          errorMessage += errorStream.str();
       }
+      else if (deferTres && isDeferrable(tagInfo.getTagName()))
+      {
+         addDeferredTagToMetadata(currentImage, tagInfo, pTreInfo.get());
+      }
       else
       {
          addTagToMetadata(currentImage, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), parsers, errorMessage);
@@ -270,6 +338,11 @@ bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFil
          errorStream << "Unable to retrieve tag #" << fileTag << " from the file header." << endl;
          errorMessage += errorStream.str();
       }
+      else if (deferTres && isDeferrable(tagInfo.getTagName()))
+      {
+         // For file headers, currentImage is always 0.
+         addDeferredTagToMetadata(0, tagInfo, pTreInfo.get());
+      }
       else
       {
          // For file headers, currentImage is always 0.
@@ -420,38 +493,15 @@ bool Nitf::addTagToMetadata(const unsigned int& ownerIndex, const ossimNitfTagIn
    VERIFY(pTres != NULL);
    VERIFY(pTreInfo != NULL);
 
-   // Try to parse the TRE with a specialized parser.
    FactoryResource<DynamicObject> pTag;
    VERIFY(pTag.get() != NULL);
 
    ossimRefPtr<ossimNitfRegisteredTag> pRegTag = tagInfo.getTagData();
    VERIFY(pRegTag.get() != NULL);
 
-   // Do NOT make a copy of pParser as it has ownership which gets transferred when the assignment operator is used.
-   // Doing so would cause a stale pointer to remain in the map and could cause a subsequent crash if it is used later.
-   map<string, TrePlugInResource>::iterator pParser = parsers.find(tagName);
-   if (pParser == parsers.end())
-   {
-      pParser = parsers.insert(make_pair(tagName, TrePlugInResource(tagName))).first;
-   }
-
-   if (pParser->second.parseTag(*pRegTag.get(), *pTag.get(), *pDescriptor, errorMessage) == false)
+   if (parseTagData(tagName, *pRegTag.get(), *pDescriptor, *pTag.get(), parsers, errorMessage) == false)
    {
-      // Failing that, use UnknownTreParser.
-      pTag->clear();
-
-      // Again, do NOT make a copy of pParser.
-      pParser = parsers.find("Unknown Tre Parser");
-      if (pParser == parsers.end())
-      {
-         pParser = parsers.insert(make_pair("Unknown Tre Parser", TrePlugInResource("Unknown Tre Parser"))).first;
-      }
-
-      if (pParser->second.parseTag(*pRegTag.get(), *pTag.get(), *pDescriptor, errorMessage) == false)
-      {
-         errorMessage += tagName + " has not been imported.\n";
-         return false;
-      }
+      return false;
    }
 
    // Parse the TRE info.
@@ -478,6 +528,144 @@ bool Nitf::addTagToMetadata(const unsigned int& ownerIndex, const ossimNitfTagIn
    return true;
 }
 
+bool Nitf::addDeferredTagToMetadata(const unsigned int& ownerIndex, const ossimNitfTagInformation& tagInfo,
+   DynamicObject* pTreInfo)
+{
+   ossimString tagName = tagInfo.getTagName();
+   VERIFY(tagName.empty() == false);
+   VERIFY(pTreInfo != NULL);
+
+   FactoryResource<DynamicObject> pTagInfo;
+   VERIFY(pTagInfo.get() != NULL);
+   VERIFY(pTagInfo->setAttribute("Tag Type", string(tagInfo.getTagType())));
+   VERIFY(pTagInfo->setAttribute("Owner Index", ownerIndex));
+   VERIFY(pTagInfo->setAttribute(sTagOffset, UInt64(tagInfo.getTagOffset())));
+   VERIFY(pTagInfo->setAttribute(sTagLength, static_cast<unsigned int>(tagInfo.getTotalTagLength())));
+
+   // Reserve the instance number the TRE would have had if it was parsed now
+   unsigned int instance = 0;
+   const DynamicObject* pParentDynObj = pTreInfo->getAttribute(tagName).getPointerToValue<DynamicObject>();
+   if (pParentDynObj != NULL)
+   {
+      instance = pParentDynObj->getNumAttributes();
+   }
+
+   stringstream strm;
+   strm << tagName << "/" << instance;
+
+   VERIFY(pTreInfo->setAttributeByPath(strm.str(), *pTagInfo.get()));
+   return true;
+}
+
+bool Nitf::importDeferredMetadata(RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>& parsers,
+   string& errorMessage, const string& tagType)
+{
+   VERIFY(pDescriptor != NULL);
+
+   DynamicObject* pMetadata = pDescriptor->getMetadata();
+   VERIFY(pMetadata != NULL);
+
+   string pTreInfoPath[] = { NITF_METADATA, TRE_INFO_METADATA, END_METADATA_NAME };
+   DynamicObject* pTreInfos = pMetadata->getAttributeByPath(pTreInfoPath).getPointerToValue<DynamicObject>();
+   if (pTreInfos == NULL)
+   {
+      return true;
+   }
+
+   string pTrePath[] = { NITF_METADATA, TRE_METADATA, END_METADATA_NAME };
+   DynamicObject* pTres = pMetadata->getAttributeByPath(pTrePath).getPointerToValue<DynamicObject>();
+   VERIFY(pTres != NULL);
+
+   const FileDescriptor* pFileDescriptor = pDescriptor->getFileDescriptor();
+   VERIFY(pFileDescriptor != NULL);
+
+   // The file is only opened if there are TREs which have not yet been parsed
+   ifstream file;
+
+   vector<string> names;
+   pTreInfos->getAttributeNames(names);
+   for (vector<string>::const_iterator nameIter = names.begin(); nameIter != names.end(); ++nameIter)
+   {
+      if (tagType.empty() == false && *nameIter != tagType)
+      {
+         continue;
+      }
+
+      DynamicObject* pTreInfoInstances = pTreInfos->getAttribute(*nameIter).getPointerToValue<DynamicObject>();
+      if (pTreInfoInstances == NULL)
+      {
+         continue;
+      }
+
+      vector<string> instanceNames;
+      pTreInfoInstances->getAttributeNames(instanceNames);
+      for (vector<string>::const_iterator instanceIter = instanceNames.begin();
+         instanceIter != instanceNames.end(); ++instanceIter)
+      {
+         DynamicObject* pTreInfo = pTreInfoInstances->getAttribute(*instanceIter).getPointerToValue<DynamicObject>();
+         if (pTreInfo == NULL)
+         {
+            continue;
+         }
+
+         const UInt64* pOffset = pTreInfo->getAttribute(sTagOffset).getPointerToValue<UInt64>();
+         if (pOffset == NULL)
+         {
+            continue;
+         }
+
+         if (file.is_open() == false)
+         {
+            file.open(pFileDescriptor->getFilename().getFullPathAndName().c_str(), ios::in | ios::binary);
+            if (file.is_open() == false)
+            {
+               errorMessage += "Unable to open the file to import the remaining TREs.\n";
+               return false;
+            }
+         }
+
+         // Let OSSIM parse the TRE exactly as it does when it reads the header
+         ossimNitfTagInformation tagInfo;
+         file.clear();
+         file.seekg(static_cast<streamoff>(pOffset->get()), ios::beg);
+         tagInfo.parseStream(file);
+
+         unsigned int length = 0;
+         pTreInfo->getAttribute(sTagLength).getValue(length);
+
+         ossimRefPtr<ossimNitfRegisteredTag> pRegTag = tagInfo.getTagData();
+         bool parsed = false;
+         FactoryResource<DynamicObject> pTag;
+         if (file.fail() == false && pRegTag.get() != NULL && string(tagInfo.getTagName()) == *nameIter &&
+            tagInfo.getTotalTagLength() == length)
+         {
+            parsed = parseTagData(*nameIter, *pRegTag.get(), *pDescriptor, *pTag.get(), parsers, errorMessage);
+         }
+         else
+         {
+            errorMessage += *nameIter + " could not be read from the file and has not been imported.\n";
+         }
+
+         if (parsed == false)
+         {
+            pTreInfoInstances->removeAttribute(*instanceIter);
+            continue;
+         }
+
+         VERIFY(pTres->setAttributeByPath(*nameIter + "/" + *instanceIter, *pTag.get()));
+         pTreInfo->removeAttribute(sTagOffset);
+         pTreInfo->removeAttribute(sTagLength);
+      }
+
+      if (pTreInfoInstances->getNumAttributes() == 0)
+      {
+         pTreInfos->removeAttribute(*nameIter);
+      }
+   }
+
+   return true;
+}
+
 bool Nitf::exportMetadata(const RasterDataDescriptor *pDescriptor, 
    const RasterFileDescriptor *pExportDescriptor, ossimNitfWriter *pNitf, Progress *pProgress)
 {
@@ -132,12 +132,18 @@ namespace Nitf
    *        Contains TRE parsers which have already been loaded into memory -- included for improved performance.
    * @param errorMessage
    *        %Message for import errors, etc.
+   * @param deferTres
+   *        If \c true, only the TREs needed to populate the descriptor and to
+   *        georeference the image are parsed.  The location of each remaining
+   *        TRE in the file is recorded with addDeferredTagToMetadata() and the
+   *        TRE is parsed when importDeferredMetadata() is called.
    *
    * @return \c True on success, \c false otherwise.
    */
    bool importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
       const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
-      RasterDataDescriptor* pDescriptor, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage);
+      RasterDataDescriptor* pDescriptor, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage,
+      bool deferTres = false);
 
    /**
     * Adds a single TRE to a RasterDataDescriptor.
@@ -163,6 +169,55 @@ namespace Nitf
       const ossimNitfTagInformation& tagInfo, RasterDataDescriptor* pDescriptor, DynamicObject* pTres,
       DynamicObject* pTreInfo, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage);
 
+   /**
+    * Records the location of a single TRE without parsing it.
+    *
+    * Only the TRE info entry is added.  It contains the offset and length of
+    * the TRE in the file in addition to the usual tag type and owner index.
+    *
+    * @param ownerIndex
+    *        The index of the owner of this TRE.
+    * @param tagInfo
+    *        Information about the TRE.
+    * @param pTreInfo
+    *        The DynamicObject containing the locations of the TREs.
+    *
+    * @return \c True on success, \c false otherwise.
+    *
+    * @see importDeferredMetadata()
+    */
+   bool addDeferredTagToMetadata(const unsigned int& ownerIndex, const ossimNitfTagInformation& tagInfo,
+      DynamicObject* pTreInfo);
+
+   /**
+    * Parses the TREs recorded by addDeferredTagToMetadata().
+    *
+    * Deferred TREs remain in the TRE info metadata of the imported element
+    * until they are parsed.  All of them are parsed when the properties
+    * dialog of the element is first shown and when the element is exported
+    * to NITF.  Other code which reads TRE metadata that was not needed
+    * during import must call this first.  Each TRE is read from the
+    * file named in the file descriptor and added to the metadata as if it
+    * had been parsed by addTagToMetadata().  The offset and length are then
+    * removed from its TRE info entry, so calling this again for the same
+    * TREs does nothing.
+    *
+    * @param pDescriptor
+    *        The RasterDataDescriptor containing the deferred TREs.
+    * @param parsers
+    *        Contains TRE parsers which have already been loaded into memory -- included for performance.
+    * @param errorMessage
+    *        %Message for import errors, etc.
+    * @param tagType
+    *        The type of TRE to parse, such as "ENGRDA".  If empty, all
+    *        deferred TREs are parsed.
+    *
+    * @return \c True on success, \c false if the file could not be read.
+    */
+   bool importDeferredMetadata(RasterDataDescriptor* pDescriptor,
+      std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage,
+      const std::string& tagType = std::string());
+
    /**
     * Exports supported metadata for the specified image into \c pNitf.
     *
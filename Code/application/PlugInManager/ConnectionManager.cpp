@@ -20,6 +20,7 @@
 #include "ApplicationServicesImp.h"
 #include "ConnectionManager.h"
 #include "DesktopServicesImp.h"
+#include "InstrumentationImp.h"
 #include "ModelServicesImp.h"
 #include "PlugInManagerServicesImp.h"
 #include "UtilityServicesImp.h"
@@ -148,6 +149,11 @@ bool ConnectionManager::queryInterface(const char* interfaceName, void** interfa
       *interfaceAddress = static_cast<ApplicationServices*>(ApplicationServicesImp::instance());
    }
 
+   if (strcmp(interfaceName, "Instrumentation1") == 0)
+   {
+      *interfaceAddress = static_cast<Instrumentation*>(InstrumentationImp::instance());
+   }
+
    if (*interfaceAddress != NULL)
    {
       return true;
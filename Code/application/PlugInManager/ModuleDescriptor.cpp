@@ -432,16 +432,51 @@ bool ModuleDescriptor::updateSettings(DynamicObject& settings) const
    return true;
 }
 
-ModuleDescriptor* ModuleDescriptor::fromSettings(const DynamicObject& settings)
+QByteArray ModuleDescriptor::getCachedDetails(const DynamicObject& settings, const string& filename)
 {
    string details;
-   bool hasSetting = settings.getAttribute("details").getValue(details);
-   if (hasSetting == false)
+   if (settings.getAttribute("details").getValue(details) == false)
    {
-      return false;
+      return QByteArray();
    }
+
    QByteArray moduleBlob = QByteArray::fromBase64(QByteArray::fromRawData(details.c_str(), details.size()));
-   QDataStream reader(&moduleBlob, QIODevice::ReadOnly);
+   QDataStream reader(moduleBlob);
+   QString id;
+   quint64 cacheDate;
+   double fileSize;
+   QString fileName;
+   reader >> id >> cacheDate >> fileSize >> fileName;
+   if (reader.status() != QDataStream::Ok || id.isEmpty() || fileName.toStdString() != filename)
+   {
+      return QByteArray();
+   }
+
+   QFileInfo file(fileName);
+   if (file.exists() == false || static_cast<quint64>(file.lastModified().toTime_t()) != cacheDate ||
+      fileSize != file.size())
+   {
+      return QByteArray();
+   }
+
+   QString name;
+   QString version;
+   QString description;
+   unsigned int plugInTotal;
+   QString validationKey;
+   int moduleVersion;
+   reader >> name >> version >> description >> plugInTotal >> validationKey >> moduleVersion;
+   if (reader.status() != QDataStream::Ok || moduleVersion != MOD_THREE)
+   {
+      return QByteArray();
+   }
+
+   return moduleBlob;
+}
+
+ModuleDescriptor* ModuleDescriptor::fromCachedDetails(const QByteArray& details)
+{
+   QDataStream reader(details);
    string id;
    READ_STR_FROM_STREAM(id);
    auto_ptr<ModuleDescriptor> pDescriptor(new ModuleDescriptor(id));
@@ -455,21 +490,11 @@ ModuleDescriptor* ModuleDescriptor::fromSettings(const DynamicObject& settings)
 
 bool ModuleDescriptor::populateFromSettings(QDataStream& reader)
 {
+   // the file date and size have already been checked by getCachedDetails()
    quint64 cacheDate;
    READ_FROM_STREAM(cacheDate);
    READ_FROM_STREAM(mFileSize);
    READ_STR_FROM_STREAM(mFileName);
-   QFileInfo file(QString::fromStdString(mFileName));
-   VERIFYRV(file.exists(), NULL);
-   quint64 modDate = file.lastModified().toTime_t();
-   if (cacheDate != modDate)
-   {
-      return false;
-   }
-   if (mFileSize != file.size())
-   {
-      return false;
-   }
    string name;
    READ_STR_FROM_STREAM(name);
    READ_STR_FROM_STREAM(mVersion);
@@ -23,6 +23,7 @@ class DynamicObject;
 struct OpticksModuleDescriptor;
 class PlugIn;
 class PlugInDescriptorImp;
+class QByteArray;
 class QDataStream;
 
 class ModuleDescriptor : public SessionItem, public SessionItemImp
@@ -101,7 +102,34 @@ public:
       return mCanCache;
    }
 
-   static ModuleDescriptor* fromSettings(const DynamicObject& settings);
+   /**
+    *  Decodes the cached information for a module and checks that it is still
+    *  valid for the module file.
+    *
+    *  This only reads the settings and the size and modification time of the
+    *  module file, so it may be called for several modules at once from
+    *  different threads.
+    *
+    *  @param   settings
+    *           The settings written by updateSettings().
+    *  @param   filename
+    *           The full path and name of the module file.
+    *
+    *  @return  The decoded information, or an empty array if the settings are
+    *           invalid or the module file has changed since they were written.
+    */
+   static QByteArray getCachedDetails(const DynamicObject& settings, const std::string& filename);
+
+   /**
+    *  Creates a module descriptor without loading the module.
+    *
+    *  @param   details
+    *           The information returned by getCachedDetails().
+    *
+    *  @return  The module descriptor or \c NULL if the information could not be
+    *           read.
+    */
+   static ModuleDescriptor* fromCachedDetails(const QByteArray& details);
    bool updateSettings(DynamicObject& settings) const;
 
    SESSIONITEMACCESSOR_METHODS(SessionItemImp)
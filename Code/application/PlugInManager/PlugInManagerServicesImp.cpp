@@ -18,6 +18,7 @@
 #include "FilenameImp.h"
 #include "FileResource.h"
 #include "ModuleDescriptor.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "PlugIn.h"
 #include "PlugInArgImp.h"
@@ -32,6 +33,7 @@
 #include <vector>
 #include <algorithm>
 
+#include <QtCore/QByteArray>
 #include <QtCore/QDateTime>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
@@ -41,6 +43,84 @@ using namespace std;
 
 class SettableSessionItem;
 
+namespace
+{
+   class CacheValidationInput
+   {
+   public:
+      CacheValidationInput(const DynamicObject& cache, const vector<string>& moduleFilenames) :
+         mCache(cache),
+         mModuleFilenames(moduleFilenames)
+      {
+      }
+
+      const DynamicObject& mCache;
+      const vector<string>& mModuleFilenames;
+
+   private:
+      CacheValidationInput& operator=(const CacheValidationInput& rhs);
+   };
+
+   class CacheValidationThread : public mta::AlgorithmThread
+   {
+   public:
+      CacheValidationThread(const CacheValidationInput& input, int threadCount, int threadIndex,
+         mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mModuleFilenames.size())))
+      {
+      }
+
+      void run()
+      {
+         for (int i = mRange.mFirst; i <= mRange.mLast; ++i)
+         {
+            const string& moduleFilename = mInput.mModuleFilenames[i];
+            const DynamicObject* pModuleSettings =
+               mInput.mCache.getAttribute(moduleFilename).getPointerToValue<DynamicObject>();
+            if (pModuleSettings != NULL)
+            {
+               QByteArray details = ModuleDescriptor::getCachedDetails(*pModuleSettings, moduleFilename);
+               if (details.isEmpty() == false)
+               {
+                  mDetails.push_back(make_pair(moduleFilename, details));
+               }
+            }
+         }
+      }
+
+      const vector<pair<string, QByteArray> >& getDetails() const
+      {
+         return mDetails;
+      }
+
+   private:
+      CacheValidationThread& operator=(const CacheValidationThread& rhs);
+
+      const CacheValidationInput& mInput;
+      Range mRange;
+      vector<pair<string, QByteArray> > mDetails;
+   };
+
+   class CacheValidationOutput
+   {
+   public:
+      bool compileOverallResults(const vector<CacheValidationThread*>& threads)
+      {
+         for (vector<CacheValidationThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            const vector<pair<string, QByteArray> >& details = (*iter)->getDetails();
+            mDetails.insert(details.begin(), details.end());
+         }
+
+         return true;
+      }
+
+      map<string, QByteArray> mDetails;
+   };
+}
+
 PlugInManagerServicesImp* PlugInManagerServicesImp::spInstance = NULL;
 bool PlugInManagerServicesImp::mDestroyed = false;
 
@@ -374,36 +454,39 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
    FileFinderImp finder;
 
    // Search plug-in directory for modules
+   vector<string> moduleFilenames;
    finder.findFile(plugInPath, "*"+ dlExtension);
+   while (finder.findNextFile() == true)
+   {
+      string filename;
+      if (finder.getFullPath(filename) == true)
+      {
+         moduleFilenames.push_back(filename);
+      }
+   }
+
+   // Check the cached module information in parallel so that only modules
+   // which are not in the cache or have changed need to be loaded
+   map<string, QByteArray> cachedModules;
+   if (pPlugInCache.get() != NULL)
+   {
+      cachedModules = validatePlugInListCache(*pPlugInCache.get(), moduleFilenames);
+   }
+
+   bool cacheModified = false;
 
    // Remove modules from the list that no longer exist
    vector<ModuleDescriptor*> removedModules;
 
+   set<string> foundFilenames(moduleFilenames.begin(), moduleFilenames.end());
    vector<ModuleDescriptor*>::iterator iter = mModules.begin();
    while (iter != mModules.end())
    {
       ModuleDescriptor* pModule = *iter;
-      if (pModule != NULL)
+      if (pModule != NULL && dynamic_cast<CoreModuleDescriptor*>(pModule) == NULL &&
+         foundFilenames.find(pModule->getFileName()) == foundFilenames.end())
       {
-         string moduleFilename = pModule->getFileName();
-
-         bool bExists = finder.findNextFile();
-         while (bExists == true)
-         {
-            string filename = "";
-            finder.getFullPath(filename);
-            if (filename == moduleFilename)
-            {
-               break;
-            }
-
-            bExists = finder.findNextFile();
-         }
-
-         if (bExists == false)
-         {
-            removedModules.push_back(pModule);
-         }
+         removedModules.push_back(pModule);
       }
 
       iter++;
@@ -413,9 +496,9 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
    while (removeIter != removedModules.end())
    {
       ModuleDescriptor* pModule = *removeIter;
-      if (pModule != NULL)
+      if (pModule != NULL && removeModule(pModule, plugInIds) == true)
       {
-         removeModule(pModule, plugInIds);
+         cacheModified = true;
       }
 
       removeIter++;
@@ -481,15 +564,22 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
          if (bAddModule == true)
          {
             removeModule(pModule, plugInIds);
+            cacheModified = true;
          }
       }
 
       // Add the module if necessary
       if (bAddModule == true)
       {
-         pModule = addModule(moduleFilename, pPlugInCache.get(), plugInIds);
+         pModule = addModule(moduleFilename, cachedModules, plugInIds);
          if (pModule != NULL)
          {
+            // modules which could not be read from the cache were loaded
+            if (pModule->canCache() && cachedModules.find(moduleFilename) == cachedModules.end())
+            {
+               cacheModified = true;
+            }
+
             // disallow multiple modules with the same id
             if (moduleIds.find(pModule->getId()) != moduleIds.end())
             {
@@ -526,11 +616,24 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
          //can't use cache because AutoImporter determines
          //its extensions by querying all of the other
          //loaded importers
-         addModule(autoImporterPath, NULL, plugInIds);
+         addModule(autoImporterPath, map<string, QByteArray>(), plugInIds);
+      }
+   }
+
+   // Only rewrite the cache if it does not match the current modules
+   unsigned int numCachedModules = 0;
+   for (vector<ModuleDescriptor*>::const_iterator ppModule = mModules.begin(); ppModule != mModules.end(); ++ppModule)
+   {
+      if (*ppModule != NULL && (*ppModule)->canCache())
+      {
+         ++numCachedModules;
       }
    }
 
-   savePlugInListCache();
+   if (cacheModified || pPlugInCache.get() == NULL || pPlugInCache->getNumAttributes() != numCachedModules)
+   {
+      savePlugInListCache();
+   }
 
    ConfigurationSettingsImp::instance()->updateProductionStatus();
 }
@@ -797,7 +900,7 @@ const vector<string>& PlugInManagerServicesImp::getArgTypes()
 }
 
 ModuleDescriptor* PlugInManagerServicesImp::addModule(const string& moduleFilename,
-                                                      DynamicObject* pPlugInCache,
+                                                      const map<string, QByteArray>& cachedModules,
                                                       map<string, string>& plugInIds)
 {
    if (moduleFilename.empty() == true)
@@ -813,20 +916,11 @@ ModuleDescriptor* PlugInManagerServicesImp::addModule(const string& moduleFilena
    }
 
    // Read the module information, either from the cache or by loading the shared library
-   // Check the cache first
-   if (pPlugInCache != NULL)
+   // Check the cache first; modules read from the cache are not loaded until one of their plug-ins is created
+   map<string, QByteArray>::const_iterator pCachedModule = cachedModules.find(moduleFilename);
+   if (pCachedModule != cachedModules.end())
    {
-      const DynamicObject* pModuleSettings = pPlugInCache->getAttribute(
-         moduleFilename).getPointerToValue<DynamicObject>();
-      if (pModuleSettings != NULL)
-      {
-         pModule = ModuleDescriptor::fromSettings(*pModuleSettings);
-         if (pModule != NULL && pModule->getFileName() != moduleFilename)
-         {
-            delete pModule;
-            pModule = NULL;
-         }
-      }
+      pModule = ModuleDescriptor::fromCachedDetails(pCachedModule->second);
    }
    if (pModule == NULL)
    {
@@ -1000,6 +1094,27 @@ FactoryResource<DynamicObject> PlugInManagerServicesImp::loadPlugInListCache()
    return pCache;
 }
 
+map<string, QByteArray> PlugInManagerServicesImp::validatePlugInListCache(const DynamicObject& cache,
+                                                                          const vector<string>& moduleFilenames)
+{
+   if (moduleFilenames.empty() == true)
+   {
+      return map<string, QByteArray>();
+   }
+
+   CacheValidationInput input(cache, moduleFilenames);
+   CacheValidationOutput output;
+   mta::ProgressObjectReporter reporter(string(), NULL);
+   mta::MultiThreadedAlgorithm<CacheValidationInput, CacheValidationOutput, CacheValidationThread>
+      algorithm(mta::getNumRequiredThreads(moduleFilenames.size()), input, output, &reporter);
+   if (algorithm.run() != mta::SUCCESS)
+   {
+      return map<string, QByteArray>();
+   }
+
+   return output.mDetails;
+}
+
 void PlugInManagerServicesImp::savePlugInListCache() const
 {
    string plugInCacheFile = getPlugInCacheFilePath();
@@ -32,6 +32,7 @@ class PlugInArgList;
 class PlugInDescriptor;
 class PlugInDescriptorImp;
 class Progress;
+class QByteArray;
 class View;
 class WorkspaceWindow;
 
@@ -78,11 +79,13 @@ protected:
    PlugInManagerServicesImp();
    virtual ~PlugInManagerServicesImp();
 
-   ModuleDescriptor* addModule(const std::string& moduleFilename, DynamicObject* pPlugInCache,
-      std::map<std::string, std::string>& plugInIds);
+   ModuleDescriptor* addModule(const std::string& moduleFilename,
+      const std::map<std::string, QByteArray>& cachedModules, std::map<std::string, std::string>& plugInIds);
    bool containsModule(ModuleDescriptor* pModule);
    bool removeModule(ModuleDescriptor* pModule, std::map<std::string, std::string>& plugInIds);
    static FactoryResource<DynamicObject> loadPlugInListCache();
+   static std::map<std::string, QByteArray> validatePlugInListCache(const DynamicObject& cache,
+      const std::vector<std::string>& moduleFilenames);
    void savePlugInListCache() const;
    static std::string getPlugInCacheFilePath();
 
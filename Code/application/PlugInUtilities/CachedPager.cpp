@@ -13,6 +13,7 @@
 #include "DataRequest.h"
 #include "DMutex.h"
 #include "Filename.h"
+#include "InstrumentationUtilities.h"
 #include "ModelServices.h"
 #include "ObjectResource.h"
 #include "PlugInArg.h"
@@ -23,6 +24,12 @@
 
 using namespace std;
 
+namespace
+{
+   InstrumentationCounter sLockWaitCounter("CachedPager::lockWait");
+   InstrumentationCounter sFetchUnitCounter("CachedPager::fetchUnit");
+}
+
 CachedPager::CachedPager() :
    mCache(10 * 1024 * 1024),
    mpMutex(new mta::DMutex),
@@ -128,8 +135,14 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
 
    VERIFYRV(pOriginalRequest != NULL, NULL);
 
+   // Time spent waiting here shows contention between threads reading through the same pager
+   bool instrumented = sLockWaitCounter.isEnabled();
+   int64_t waitStart = instrumented ? sLockWaitCounter.getTime() : 0;
    mta::MutexLock lock(*mpMutex);
-
+   if (instrumented)
+   {
+      sLockWaitCounter.addSpan(waitStart, sLockWaitCounter.getTime());
+   }
 
    InterleaveFormatType requestedFormat = pOriginalRequest->getInterleaveFormat();
    DimensionDescriptor stopRow = pOriginalRequest->getStopRow();
@@ -168,6 +181,7 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
       pNewRequest->polish(mpDescriptor);
       if (pNewRequest->validate(mpDescriptor) == true)
       {
+         InstrumentationSpan span(sFetchUnitCounter);
          pUnit = fetchUnit(pNewRequest.get());
       }
    }
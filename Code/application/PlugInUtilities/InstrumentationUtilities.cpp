@@ -0,0 +1,90 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "Instrumentation.h"
+#include "InstrumentationUtilities.h"
+
+InstrumentationCounter::InstrumentationCounter(const char* pName) :
+   mpName(pName),
+   mpInstrumentation(NULL),
+   mId(0)
+{
+}
+
+bool InstrumentationCounter::isEnabled() const
+{
+   Instrumentation* pInstrumentation = resolve();
+   return pInstrumentation != NULL && pInstrumentation->isEnabled();
+}
+
+void InstrumentationCounter::add(int64_t value) const
+{
+   Instrumentation* pInstrumentation = resolve();
+   if (pInstrumentation != NULL && pInstrumentation->isEnabled())
+   {
+      pInstrumentation->addToCounter(mId, value);
+   }
+}
+
+int64_t InstrumentationCounter::getTime() const
+{
+   Instrumentation* pInstrumentation = resolve();
+   if (pInstrumentation == NULL)
+   {
+      return 0;
+   }
+
+   return pInstrumentation->getTime();
+}
+
+void InstrumentationCounter::addSpan(int64_t start, int64_t end) const
+{
+   Instrumentation* pInstrumentation = resolve();
+   if (pInstrumentation != NULL && pInstrumentation->isEnabled())
+   {
+      pInstrumentation->addSpan(mId, start, end);
+   }
+}
+
+Instrumentation* InstrumentationCounter::resolve() const
+{
+   Instrumentation* pInstrumentation = mpInstrumentation;
+   if (pInstrumentation == NULL)
+   {
+      pInstrumentation = Service<Instrumentation>().get();
+      if (pInstrumentation == NULL)
+      {
+         return NULL;
+      }
+
+      // Every thread resolves the same identifier, so it can be written before the pointer is published
+      mId = pInstrumentation->getCounterId(mpName == NULL ? "" : mpName);
+      mpInstrumentation.testAndSetOrdered(NULL, pInstrumentation);
+   }
+
+   return pInstrumentation;
+}
+
+InstrumentationSpan::InstrumentationSpan(const InstrumentationCounter& counter) :
+   mCounter(counter),
+   mStart(-1)
+{
+   if (mCounter.isEnabled())
+   {
+      mStart = mCounter.getTime();
+   }
+}
+
+InstrumentationSpan::~InstrumentationSpan()
+{
+   if (mStart >= 0)
+   {
+      mCounter.addSpan(mStart, mCounter.getTime());
+   }
+}
@@ -0,0 +1,132 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef INSTRUMENTATIONUTILITIES_H
+#define INSTRUMENTATIONUTILITIES_H
+
+#include "AppConfig.h"
+
+#include <QtCore/QAtomicPointer>
+#include <string>
+
+class Instrumentation;
+
+/**
+ *  A named Instrumentation counter.
+ *
+ *  The counter is registered the first time it is used, so counters may be
+ *  declared as static variables at file scope before the application services
+ *  are available:
+ *  \code
+ *  namespace
+ *  {
+ *     InstrumentationCounter sTileCounter("MyAlgorithm::processTile");
+ *  }
+ *
+ *  void MyAlgorithm::processTile()
+ *  {
+ *     InstrumentationSpan span(sTileCounter);
+ *     ...
+ *  }
+ *  \endcode
+ *
+ *  When instrumentation is disabled, using a counter costs a single flag test.
+ *
+ *  @see     Instrumentation
+ */
+class InstrumentationCounter
+{
+public:
+   /**
+    *  Creates the counter.
+    *
+    *  @param   pName
+    *           The name of the counter.  This must remain valid for the
+    *           lifetime of the counter, so it is typically a string literal.
+    */
+   explicit InstrumentationCounter(const char* pName);
+
+   /**
+    *  Queries whether instrumentation is enabled.
+    *
+    *  @return  Returns \c true if values added to the counter are accumulated.
+    */
+   bool isEnabled() const;
+
+   /**
+    *  Adds a value to the counter for the calling thread.
+    *
+    *  @param   value
+    *           The value to add.
+    */
+   void add(int64_t value = 1) const;
+
+   /**
+    *  Returns the current time in the time base of addSpan().
+    *
+    *  @return  The current time in microseconds.
+    */
+   int64_t getTime() const;
+
+   /**
+    *  Adds a span to the counter for the calling thread.
+    *
+    *  @param   start
+    *           The start of the span as returned by getTime().
+    *
+    *  @param   end
+    *           The end of the span as returned by getTime().
+    */
+   void addSpan(int64_t start, int64_t end) const;
+
+private:
+   InstrumentationCounter(const InstrumentationCounter& rhs);
+   InstrumentationCounter& operator=(const InstrumentationCounter& rhs);
+
+   Instrumentation* resolve() const;
+
+   const char* mpName;
+   // Resolved lazily.  Concurrent resolution from several threads is harmless
+   // since each thread obtains the same values, and the identifier is written
+   // before the pointer is published so a non-NULL pointer implies a valid identifier.
+   mutable QAtomicPointer<Instrumentation> mpInstrumentation;
+   mutable unsigned int mId;
+};
+
+/**
+ *  Adds the lifetime of this object as a span to an InstrumentationCounter.
+ *
+ *  If instrumentation is disabled when the span is created, nothing is added
+ *  when the span is destroyed.
+ */
+class InstrumentationSpan
+{
+public:
+   /**
+    *  Starts the span.
+    *
+    *  @param   counter
+    *           The counter to which the span is added.
+    */
+   explicit InstrumentationSpan(const InstrumentationCounter& counter);
+
+   /**
+    *  Ends the span and adds it to the counter.
+    */
+   ~InstrumentationSpan();
+
+private:
+   InstrumentationSpan(const InstrumentationSpan& rhs);
+   InstrumentationSpan& operator=(const InstrumentationSpan& rhs);
+
+   const InstrumentationCounter& mCounter;
+   int64_t mStart;
+};
+
+#endif
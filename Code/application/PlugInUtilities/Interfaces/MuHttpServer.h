@@ -18,9 +18,13 @@
 #endif
 #include <ehs.h>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QWaitCondition>
 #include <boost/any.hpp>
+#include <boost/shared_ptr.hpp>
+#include <list>
 
 class QTextStream;
 class QTimer;
@@ -143,7 +147,59 @@ public:
     */
    void registerPath(const QString &path, EHS *pObj);
 
+   /**
+    * Set the number of threads which receive requests.
+    *
+    * This must be called before start() and has no effect on child handlers
+    * added with registerPath(). If the count is greater than one, requests are
+    * received concurrently on worker threads instead of by processServer().
+    * Requests are still processed on the thread which owns the handler unless
+    * the handler's isThreadSafe() returns true for the request.
+    *
+    * @param threadCount
+    *        The number of threads which receive requests.
+    */
+   void setThreadCount(int threadCount);
+
 protected:
+   /**
+    * Query whether a request may be processed on the thread which received it.
+    *
+    * The default behavior is to return false so that getRequest() and
+    * postRequest() are always called on the thread which owns this object
+    * and may safely use application services.
+    *
+    * @param uri
+    *        The URI of the request.
+    * @return True if getRequest() or postRequest() may be called concurrently
+    *         for this request from a worker thread.
+    */
+   virtual bool isThreadSafe(const QString& uri) const;
+
+   /**
+    * Process a request on the thread which owns this object.
+    *
+    * This is called for requests which are not thread safe. A handler whose
+    * isThreadSafe() returned true may also call this from getRequest() if it
+    * finds that it needs application services to complete the request.
+    * The calling thread waits until the request has been processed or the server
+    * is stopped.
+    *
+    * @param get
+    *        True to call getRequest() or false to call postRequest().
+    * @param uri
+    *        The URI of the request.
+    * @param contentType
+    *        The HTTP Content-type of the request.
+    * @param body
+    *        The body of the request.
+    * @param form
+    *        Form data from the request.
+    * @return An HTTP Response.
+    */
+   Response processOnOwnerThread(bool get, const QString& uri, const QString& contentType, const QString& body,
+      const FormValueMap& form);
+
    /**
     * This handles HTTP POST requests.
     *
@@ -236,10 +292,27 @@ protected slots:
       mAllowNonLocal = val;
    }
 
+private slots:
+   void processPendingRequests();
+
 private:
+   struct PendingRequest
+   {
+      bool mGet;
+      QString mUri;
+      QString mContentType;
+      QString mBody;
+      FormValueMap mForm;
+      Response mResponse;
+      bool mProcessed;
+      bool mAbandoned;
+   };
+
    MuHttpServer(const MuHttpServer& rhs);
    MuHttpServer& operator=(const MuHttpServer& rhs);
    ResponseCode HandleRequest(HttpRequest *pHttpRequest, HttpResponse *pHttpResponse);
+   void stopServer();
+   void setStopping(bool stopping);
 
    EHSServerParameters mParams;
    QTimer* mpTimer;
@@ -247,6 +320,12 @@ private:
    bool mServerIsRunning;
    bool mAllowNonLocal;
    AttachmentPtr<SessionManager> mSession;
+   bool mThreaded;
+
+   QMutex mPendingMutex;
+   QWaitCondition mPendingProcessed;
+   std::list<boost::shared_ptr<PendingRequest> > mPendingRequests;
+   bool mStopping;
 };
 
 #endif
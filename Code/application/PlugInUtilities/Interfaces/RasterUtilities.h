@@ -1045,6 +1045,9 @@ namespace RasterUtilities
     *
     *  The original dimensions of the data set are maintained. This means that data clipping and padding may occur.
     *
+    *  The destination is processed in tiles on all available processors and the
+    *  source data for each tile is read with a single request.
+    *
     *  @param pDst
     *         Destination RasterElement. Must be initialized to the same params as pSrc.
     *  @param pSrc
@@ -1055,7 +1058,8 @@ namespace RasterUtilities
     *         Pixels which do not map to anything in the original data set will be set to this value.
     *         This value will be added to the bad values list if it is not already there.
     *  @param interp
-    *         Interpolation type. Only ::INTERP_NEAREST_NEIGHBOR is currently supported.
+    *         Interpolation type. ::INTERP_NEAREST_NEIGHBOR, ::INTERP_BILINEAR and ::INTERP_BICUBIC
+    *         are supported. Complex data can only be rotated with ::INTERP_NEAREST_NEIGHBOR.
     *  @param pProgress
     *         Report progress.
     *  @param pAbort
@@ -38,6 +38,7 @@
  *   \li Service<ConfigurationSettings>
  *   \li Service<DataVariantFactory>
  *   \li Service<DesktopServices>
+ *   \li Service<Instrumentation>
  *   \li Service<MessageLogMgr>
  *   \li Service<ModelServices>
  *   \li Service<ObjectFactory>
@@ -0,0 +1,159 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef STREAMINGRASTERWRITER_H
+#define STREAMINGRASTERWRITER_H
+
+#include "AppConfig.h"
+#include "DimensionDescriptor.h"
+#include "TypesFile.h"
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class LargeFileResource;
+class Progress;
+class RasterElement;
+class RasterFileDescriptor;
+
+/**
+ *  Writes raw raster data to a file in large blocks.
+ *
+ *  The writer reads the rows, columns, and bands selected in a file descriptor
+ *  from a RasterElement and writes them to an open file in the descriptor's
+ *  interleave format without any header, preline, or postline bytes.  Data is
+ *  gathered from the element in blocks of many rows at a time so that both the
+ *  pager and the file see a few large requests instead of one request per row,
+ *  pixel, or element.  Conversions between interleave formats are performed
+ *  in memory on each block.
+ *
+ *  Blocks are written to the file by a background thread while the next block
+ *  is being gathered.  If the element data is loaded in memory and a block is
+ *  laid out in memory exactly as it will be written, the block is written
+ *  directly from the element without being copied.
+ *
+ *  @code
+ *  StreamingRasterWriter writer(pRaster, pFileDescriptor);
+ *  if (writer.write(dataFile, 0, pProgress, "Exporting the data file...", &mAborted) == false)
+ *  {
+ *     std::string message = writer.getErrorMessage();
+ *  }
+ *  @endcode
+ */
+class StreamingRasterWriter
+{
+public:
+   /**
+    *  Creates a writer for the given raster element.
+    *
+    *  @param   pRaster
+    *           The element containing the data to write.
+    *  @param   pFileDescriptor
+    *           The file descriptor specifying the rows, columns, and bands to
+    *           write and the interleave format of the written data.  The
+    *           active numbers of the dimension descriptors refer to the active
+    *           rows, columns, and bands of \em pRaster.
+    */
+   StreamingRasterWriter(const RasterElement* pRaster, const RasterFileDescriptor* pFileDescriptor);
+
+   /**
+    *  Sets the approximate number of bytes gathered for each block.
+    *
+    *  Two blocks of this size are allocated while writing.  A block always
+    *  contains at least one row of every band being written together.
+    *
+    *  @param   bytes
+    *           The block size in bytes.  The default size is 16 MB.
+    */
+   void setBlockSize(size_t bytes);
+
+   /**
+    *  Returns the approximate number of bytes gathered for each block.
+    *
+    *  @return  The block size in bytes.
+    */
+   size_t getBlockSize() const;
+
+   /**
+    *  Writes the data to a file.
+    *
+    *  @param   file
+    *           The file to write, which must be open for writing.
+    *  @param   fileOffset
+    *           The offset in bytes in the file where the first element is written.
+    *  @param   pProgress
+    *           The progress object updated after each block is gathered.  Can be \c NULL.
+    *  @param   progressText
+    *           The text to report in \em pProgress.
+    *  @param   pAbort
+    *           A flag checked before each block is gathered.  Writing stops
+    *           if the flag is \c true.  Can be \c NULL.
+    *
+    *  @return  Returns \c true if all of the data was successfully written.  Returns
+    *           \c false if the data could not be read or written or if writing
+    *           was aborted, in which case getErrorMessage() describes the failure.
+    */
+   bool write(LargeFileResource& file, int64_t fileOffset, Progress* pProgress, const std::string& progressText,
+      const bool* pAbort);
+
+   /**
+    *  Returns a description of the failure if write() returns \c false.
+    *
+    *  @return  The error message, or an empty string if no error occurred or
+    *           writing was aborted.
+    */
+   const std::string& getErrorMessage() const;
+
+private:
+   StreamingRasterWriter& operator=(const StreamingRasterWriter& rhs);
+
+   struct Segment
+   {
+      int64_t mOffset;
+      const char* mpData;
+      size_t mSize;
+   };
+
+   struct Block
+   {
+      std::vector<char> mData;
+      std::vector<Segment> mSegments;
+   };
+
+   class BlockWriterThread;
+
+   bool gatherBlock(Block& block, const std::vector<unsigned int>& groupBands, unsigned int firstRow,
+      unsigned int rowCount, int64_t fileOffset);
+   bool getDirectSegments(Block& block, const std::vector<unsigned int>& groupBands, unsigned int firstRow,
+      unsigned int rowCount, int64_t fileOffset) const;
+   void gatherRow(const std::vector<const char*>& bandStarts, char* pDestination, size_t destinationColumnStride,
+      size_t destinationBandStride) const;
+   bool isContiguous(const std::vector<DimensionDescriptor>& dimensions, unsigned int first, unsigned int count) const;
+
+   const RasterElement* mpRaster;
+   const RasterFileDescriptor* mpFileDescriptor;
+   size_t mBlockSize;
+   std::string mErrorMessage;
+
+   InterleaveFormatType mSourceInterleave;
+   InterleaveFormatType mDestinationInterleave;
+   unsigned int mSourceRowCount;
+   unsigned int mSourceColumnCount;
+   unsigned int mSourceBandCount;
+   unsigned int mBytesPerElement;
+   const char* mpRawData;
+   std::vector<DimensionDescriptor> mRows;
+   std::vector<DimensionDescriptor> mColumns;
+   std::vector<DimensionDescriptor> mBands;
+   std::vector<size_t> mColumnOffsets;
+   bool mColumnsContiguous;
+};
+
+#endif
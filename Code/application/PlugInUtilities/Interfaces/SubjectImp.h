@@ -28,6 +28,7 @@ class SubjectImpPrivate;
 class SubjectImp
 {
    friend class Signal::SignalValue;
+   friend class SignalBatch;
 
 public:
    SubjectImp();
@@ -86,11 +87,88 @@ protected:
     */
    void enableSignals(bool enabled);
 
+   /**
+    *  Starts deferring signals until a matching call to endSignalBatch().
+    *
+    *  @param   modifiedOnly
+    *           If true, only Subject::Modified is deferred and all other signals
+    *           are notified immediately.
+    */
+   void beginSignalBatch(bool modifiedOnly);
+
+   /**
+    *  Ends a batch started with beginSignalBatch().  When the outermost batch
+    *  ends, each deferred signal is notified once with the data from its most
+    *  recent notification.
+    *
+    *  @param   modifiedOnly
+    *           The value that was passed to beginSignalBatch().
+    */
+   void endSignalBatch(bool modifiedOnly);
+
    void clearSlots(const std::string& signal);
 
    SubjectImpPrivate* mpImpPrivate;
 };
 
+/**
+ *  Defers the signals notified by a SubjectImp until the SignalBatch goes out
+ *  of scope.
+ *
+ *  While the batch is active, each signal other than Subject::Deleted is
+ *  queued instead of being notified.  When the outermost batch on the subject
+ *  ends, each queued signal is notified once, in the order it was first
+ *  queued, with the data from its most recent notification, followed by a
+ *  single Subject::Modified.  When only redundant redraws or recomputes are a
+ *  concern, the batch can be restricted to Subject::Modified so that all other
+ *  signals are still notified as they occur:
+ *  \code
+ *  void GraphicGroupImp::insertObjects(const list<GraphicObject*>& objects, Progress* pProgress)
+ *  {
+ *     SignalBatch batch(*this, true);
+ *     ...
+ *  }  // Subject::Modified is notified once here
+ *  \endcode
+ *
+ *  Signals which are suppressed with SignalBlocker or SignalEnabler when they
+ *  are notified are not queued.  The batch must not outlive the subject.
+ */
+class SignalBatch
+{
+public:
+   /**
+    *  Starts deferring signals on the specified subject.
+    *
+    *  @param   subject
+    *           The subject whose signals are deferred.
+    *  @param   modifiedOnly
+    *           If \c true, only Subject::Modified is deferred.  If \c false,
+    *           all signals except Subject::Deleted are deferred.
+    */
+   explicit SignalBatch(SubjectImp& subject, bool modifiedOnly = false) :
+      mSubject(subject),
+      mModifiedOnly(modifiedOnly)
+   {
+      mSubject.beginSignalBatch(mModifiedOnly);
+   }
+
+   /**
+    *  Ends the batch, and notifies the deferred signals if this is the
+    *  outermost batch on the subject.
+    */
+   ~SignalBatch()
+   {
+      mSubject.endSignalBatch(mModifiedOnly);
+   }
+
+private:
+   SignalBatch& operator=(const SignalBatch& rhs);
+   SignalBatch(const SignalBatch& rhs);
+
+   SubjectImp& mSubject;
+   bool mModifiedOnly;
+};
+
 #define SUBJECTADAPTEREXTENSION_CLASSES
 
 #define SUBJECTADAPTER_METHODS(impClass) \
@@ -11,8 +11,11 @@
 #include "Slot.h"
 #include <ehs.h>
 #include <QtCore/QDebug>
+#include <QtCore/QMetaObject>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 
 MuHttpServer::MuHttpServer(int port, QObject *pParent) :
@@ -20,7 +23,9 @@ MuHttpServer::MuHttpServer(int port, QObject *pParent) :
    mpTimer(NULL),
    mServerIsRunning(false),
    mAllowNonLocal(false),
-   mSession(SIGNAL_NAME(SessionManager, Closed), Slot(this, &MuHttpServer::stop))
+   mSession(SIGNAL_NAME(SessionManager, Closed), Slot(this, &MuHttpServer::stop)),
+   mThreaded(false),
+   mStopping(false)
 {
    if (port > 0)
    {
@@ -38,7 +43,7 @@ MuHttpServer::~MuHttpServer()
 {
    if (mServerIsRunning)
    {
-      StopServer();
+      stopServer();
    }
 
    // Destroy registrations here before the EHS class destructor is called
@@ -62,8 +67,12 @@ bool MuHttpServer::start()
 
    try
    {
+      setStopping(false);
       StartServer(mParams);
-      mpTimer->start();
+      if (!mThreaded)
+      {
+         mpTimer->start();
+      }
    }
    catch (...)
    {
@@ -83,12 +92,56 @@ bool MuHttpServer::start()
 
 void MuHttpServer::stop(Subject &subject, const std::string &signal, const boost::any &v)
 {
-   StopServer();
+   stopServer();
    mSession.reset(NULL);
    mServerIsRunning = false;
    mpTimer->stop();
 }
 
+void MuHttpServer::stopServer()
+{
+   // Release any worker threads waiting on this thread before the thread pool is joined
+   setStopping(true);
+   StopServer();
+}
+
+void MuHttpServer::setStopping(bool stopping)
+{
+   {
+      QMutexLocker lock(&mPendingMutex);
+      mStopping = stopping;
+      mPendingProcessed.wakeAll();
+   }
+
+   for (QMap<QString, EHS*>::iterator it = mRegistrations.begin(); it != mRegistrations.end(); ++it)
+   {
+      MuHttpServer* pChild = dynamic_cast<MuHttpServer*>(it.value());
+      if (pChild != NULL)
+      {
+         pChild->setStopping(stopping);
+      }
+   }
+}
+
+void MuHttpServer::setThreadCount(int threadCount)
+{
+   if (mServerIsRunning || mParams.empty())
+   {
+      return;
+   }
+
+   mThreaded = (threadCount > 1);
+   if (mThreaded)
+   {
+      mParams["mode"] = "threadpool";
+      mParams["threadcount"] = threadCount;
+   }
+   else
+   {
+      mParams["mode"] = "singlethreaded";
+   }
+}
+
 void MuHttpServer::registerPath(const QString &path, EHS *pObj)
 {
    if (mServerIsRunning)
@@ -106,6 +159,74 @@ void MuHttpServer::processServer()
    HandleData(0);
 }
 
+bool MuHttpServer::isThreadSafe(const QString& uri) const
+{
+   return false;
+}
+
+MuHttpServer::Response MuHttpServer::processOnOwnerThread(bool get, const QString& uri, const QString& contentType,
+                                                          const QString& body, const FormValueMap& form)
+{
+   if (QThread::currentThread() == thread())
+   {
+      return get ? getRequest(uri, contentType, body, form) : postRequest(uri, contentType, body, form);
+   }
+
+   boost::shared_ptr<PendingRequest> pRequest(new PendingRequest);
+   pRequest->mGet = get;
+   pRequest->mUri = uri;
+   pRequest->mContentType = contentType;
+   pRequest->mBody = body;
+   pRequest->mForm = form;
+   pRequest->mProcessed = false;
+   pRequest->mAbandoned = false;
+
+   QMutexLocker lock(&mPendingMutex);
+   mPendingRequests.push_back(pRequest);
+   QMetaObject::invokeMethod(this, "processPendingRequests", Qt::QueuedConnection);
+   while (!pRequest->mProcessed && !mStopping)
+   {
+      mPendingProcessed.wait(&mPendingMutex, 100);
+   }
+
+   if (!pRequest->mProcessed)
+   {
+      pRequest->mAbandoned = true;
+      return Response();
+   }
+   return pRequest->mResponse;
+}
+
+void MuHttpServer::processPendingRequests()
+{
+   for (;;)
+   {
+      boost::shared_ptr<PendingRequest> pRequest;
+      {
+         QMutexLocker lock(&mPendingMutex);
+         if (mPendingRequests.empty())
+         {
+            return;
+         }
+         pRequest = mPendingRequests.front();
+         mPendingRequests.pop_front();
+         if (pRequest->mAbandoned)
+         {
+            continue;
+         }
+      }
+
+      Response rsp = pRequest->mGet ?
+         getRequest(pRequest->mUri, pRequest->mContentType, pRequest->mBody, pRequest->mForm) :
+         postRequest(pRequest->mUri, pRequest->mContentType, pRequest->mBody, pRequest->mForm);
+
+      QMutexLocker lock(&mPendingMutex);
+      pRequest->mResponse = rsp;
+      pRequest->mProcessed = true;
+      mPendingProcessed.wakeAll();
+   }
+}
+
 ResponseCode MuHttpServer::HandleRequest(HttpRequest *pHttpRequest, HttpResponse *pHttpResponse)
 {
    debug(pHttpRequest);
@@ -125,9 +246,17 @@ ResponseCode MuHttpServer::HandleRequest(HttpRequest *pHttpRequest, HttpResponse
    {
       QString contentType = pHttpRequest->Headers("content-type").c_str();
       QString body = pHttpRequest->Body().c_str();
-      Response rsp = (pHttpRequest->Method() == REQUESTMETHOD_GET) ?
-         getRequest(uri, contentType, body, pHttpRequest->FormValues()) :
-         postRequest(uri, contentType, body, pHttpRequest->FormValues());
+      bool get = (pHttpRequest->Method() == REQUESTMETHOD_GET);
+      Response rsp;
+      if (QThread::currentThread() == thread() || isThreadSafe(uri))
+      {
+         rsp = get ? getRequest(uri, contentType, body, pHttpRequest->FormValues()) :
+            postRequest(uri, contentType, body, pHttpRequest->FormValues());
+      }
+      else
+      {
+         rsp = processOnOwnerThread(get, uri, contentType, body, pHttpRequest->FormValues());
+      }
       if (rsp.mCode != HTTPRESPONSECODE_INVALID && rsp.mEncoding.isValid())
       {
          switch (rsp.mEncoding)
@@ -7,6 +7,7 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "InstrumentationUtilities.h"
 #include "MultiThreadedAlgorithm.h"
 #include "MessageLogMgrImp.h"
 #include "Progress.h"
@@ -14,6 +15,13 @@
 
 using namespace mta;
 
+namespace
+{
+   // Worker threads are busy for the run time less the idle time
+   InstrumentationCounter sThreadRunCounter("mta::AlgorithmThread::run");
+   InstrumentationCounter sThreadIdleCounter("mta::AlgorithmThread::idle");
+}
+
 unsigned int mta::getNumRequiredThreads(unsigned int dataSize)
 {
    unsigned int threadCount = ConfigurationSettings::getSettingThreadCount();
@@ -203,6 +211,7 @@ std::string MultiThreadReporter::getErrorText() const
 
 Result MultiThreadReporter::signalMainThread(ThreadCommand& reportStatus, ReportType type)
 {
+   InstrumentationSpan idleSpan(sThreadIdleCounter);
    MutexLock lock(mSignalMutex);
 
    Result currentResult = SUCCESS;
@@ -250,8 +259,14 @@ Result MultiThreadReporter::signalMainThread(ThreadCommand& reportStatus, Report
 
 void AlgorithmThread::threadFunction(AlgorithmThread *pThreadData)
 {
-   pThreadData->waitForAlgorithmLoop();
-   pThreadData->run();
+   {
+      InstrumentationSpan idleSpan(sThreadIdleCounter);
+      pThreadData->waitForAlgorithmLoop();
+   }
+   {
+      InstrumentationSpan runSpan(sThreadRunCounter);
+      pThreadData->run();
+   }
    if (pThreadData->getReporter().getErrorText() == "")
    {
       if (pThreadData->getReporter().getProgress(pThreadData->getThreadIndex()) != 100)
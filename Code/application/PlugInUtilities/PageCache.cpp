@@ -9,6 +9,7 @@
 
 #include "AppVerify.h"
 #include "DataRequest.h"
+#include "InstrumentationUtilities.h"
 #include "PageCache.h"
 #include "TypesFile.h"
 
@@ -17,6 +18,12 @@
 #include <sstream>
 using namespace std;
 
+namespace
+{
+   InstrumentationCounter sHitCounter("PageCache::hit");
+   InstrumentationCounter sMissCounter("PageCache::miss");
+}
+
 PageCache::PageCache(const size_t maxCacheSize) :
    MAX_CACHE_SIZE(maxCacheSize),
    mCacheSize(0)
@@ -54,6 +61,11 @@ CachedPage::UnitPtr PageCache::getUnit(DataRequest *pOriginalRequest,
       // Remove from the list -- it will be re-added to the end in createPage()
       mUnits.erase(ppMatchingUnit);
       mCacheSize -= pUnit->getSize();
+      sHitCounter.add();
+   }
+   else
+   {
+      sMissCounter.add();
    }
 
    return pUnit;
@@ -17,6 +17,7 @@
 #include "DynamicObject.h"
 #include "Endian.h"
 #include "Int64.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "Progress.h"
 #include "RasterDataDescriptor.h"
@@ -33,6 +34,7 @@
 
 #include <algorithm>
 #include <boost/bind.hpp>
+#include <limits>
 #include <set>
 #include <sstream>
 
@@ -1371,6 +1373,460 @@ int64_t RasterUtilities::calculateFileSize(const RasterFileDescriptor* pDescript
    return fileSize;
 }
 
+namespace
+{
+   // Destination tiles are square and small enough for the source and destination data of a tile to remain in cache
+   const unsigned int sRotateTileSize = 64;
+
+   struct RotateInput
+   {
+      RotateInput() :
+         mpSrc(NULL),
+         mpDst(NULL),
+         mInterp(INTERP_NEAREST_NEIGHBOR),
+         mDefaultValue(0),
+         mRows(0),
+         mColumns(0),
+         mBip(false),
+         mBandPasses(0),
+         mPixelValues(0),
+         mEncoding(),
+         mBytesPerElement(0),
+         mpRowStarts(NULL),
+         mpRowEnds(NULL),
+         mX0(0),
+         mY0(0),
+         mCosA(1.0),
+         mSinA(0.0),
+         mpAbortFlag(NULL)
+      {}
+
+      const RasterElement* mpSrc;
+      RasterElement* mpDst;
+      InterpolationType mInterp;
+      int mDefaultValue;
+      unsigned int mRows;
+      unsigned int mColumns;
+      bool mBip;
+      // BIP data is rotated with all bands at once, other data one band at a time
+      unsigned int mBandPasses;
+      unsigned int mPixelValues;
+      EncodingType mEncoding;
+      unsigned int mBytesPerElement;
+      // The rotated row end points used by nearest neighbor
+      const std::vector<Opticks::PixelLocation>* mpRowStarts;
+      const std::vector<Opticks::PixelLocation>* mpRowEnds;
+      int mX0;
+      int mY0;
+      double mCosA;
+      double mSinA;
+      const bool* mpAbortFlag;
+   };
+
+   // The pixels of a destination tile with their source taps
+   struct RotateTaps
+   {
+      unsigned int mTapCount;
+      // Index of each destination pixel in the tile which maps into the source
+      std::vector<unsigned int> mPixels;
+      // mTapCount columns and rows for each pixel
+      std::vector<int> mColumns;
+      std::vector<int> mRows;
+      // mTapCount weights in each dimension for each pixel
+      std::vector<double> mColumnWeights;
+      std::vector<double> mRowWeights;
+
+      void clear(unsigned int tapCount)
+      {
+         mTapCount = tapCount;
+         mPixels.clear();
+         mColumns.clear();
+         mRows.clear();
+         mColumnWeights.clear();
+         mRowWeights.clear();
+      }
+   };
+
+   void getCubicWeights(double fraction, double* pWeights)
+   {
+      // Catmull-Rom spline for the taps at -1, 0, 1 and 2
+      pWeights[0] = ((-0.5 * fraction + 1.0) * fraction - 0.5) * fraction;
+      pWeights[1] = (1.5 * fraction - 2.5) * fraction * fraction + 1.0;
+      pWeights[2] = ((-1.5 * fraction + 2.0) * fraction + 0.5) * fraction;
+      pWeights[3] = (0.5 * fraction - 0.5) * fraction * fraction;
+   }
+
+   template<typename T>
+   T convertInterpolatedValue(double value)
+   {
+      if (std::numeric_limits<T>::is_integer)
+      {
+         value = std::max(value, static_cast<double>(std::numeric_limits<T>::min()));
+         value = std::min(value, static_cast<double>(std::numeric_limits<T>::max()));
+         return static_cast<T>(value < 0.0 ? value - 0.5 : value + 0.5);
+      }
+
+      return static_cast<T>(value);
+   }
+
+   /**
+    * Interpolates one value of each tap pixel.
+    *
+    * The taps are gathered into contiguous arrays so that the weighted sums are
+    * simple loops which the compiler can vectorize.
+    */
+   template<typename T>
+   void interpolateTile(T* pDst, const void* pSourceData, const RotateTaps& taps, int sourceStartRow,
+                        int sourceStartColumn, unsigned int sourceColumns, unsigned int pixelValues,
+                        unsigned int valueIndex, std::vector<double>& samples, std::vector<double>& rowSums,
+                        std::vector<double>& results)
+   {
+      const unsigned int count = taps.mPixels.size();
+      const unsigned int tapCount = taps.mTapCount;
+      if (count == 0)
+      {
+         return;
+      }
+
+      const T* pSource = reinterpret_cast<const T*>(pSourceData);
+      samples.resize(count);
+      rowSums.resize(count);
+      results.assign(count, 0.0);
+      const int* pColumns = &taps.mColumns[0];
+      const int* pRows = &taps.mRows[0];
+      const double* pColumnWeights = &taps.mColumnWeights[0];
+      const double* pRowWeights = &taps.mRowWeights[0];
+      double* pSamples = &samples[0];
+      double* pRowSums = &rowSums[0];
+      double* pResults = &results[0];
+
+      for (unsigned int j = 0; j < tapCount; ++j)
+      {
+         std::fill(rowSums.begin(), rowSums.end(), 0.0);
+         for (unsigned int i = 0; i < tapCount; ++i)
+         {
+            for (unsigned int k = 0; k < count; ++k)
+            {
+               unsigned int offset = ((pRows[k * tapCount + j] - sourceStartRow) * sourceColumns +
+                  (pColumns[k * tapCount + i] - sourceStartColumn)) * pixelValues + valueIndex;
+               pSamples[k] = static_cast<double>(pSource[offset]);
+            }
+            for (unsigned int k = 0; k < count; ++k)
+            {
+               pRowSums[k] += pColumnWeights[k * tapCount + i] * pSamples[k];
+            }
+         }
+         for (unsigned int k = 0; k < count; ++k)
+         {
+            pResults[k] += pRowWeights[k * tapCount + j] * pRowSums[k];
+         }
+      }
+
+      for (unsigned int k = 0; k < count; ++k)
+      {
+         pDst[taps.mPixels[k] * pixelValues + valueIndex] = convertInterpolatedValue<T>(pResults[k]);
+      }
+   }
+
+   class RotateThread : public mta::AlgorithmThread
+   {
+   public:
+      RotateThread(const RotateInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, (input.mRows + sRotateTileSize - 1) / sRotateTileSize)),
+         mSuccess(true)
+      {}
+
+      void run()
+      {
+         int count = mRange.mLast - mRange.mFirst + 1;
+         for (int strip = mRange.mFirst; strip <= mRange.mLast; ++strip)
+         {
+            getReporter().reportProgress(getThreadIndex(), 100 * (strip - mRange.mFirst) / count);
+
+            unsigned int startRow = strip * sRotateTileSize;
+            unsigned int rowCount = std::min(sRotateTileSize, mInput.mRows - startRow);
+            if (mInput.mInterp == INTERP_NEAREST_NEIGHBOR)
+            {
+               calculateNearestSources(startRow, rowCount);
+            }
+
+            for (unsigned int band = 0; band < mInput.mBandPasses; ++band)
+            {
+               for (unsigned int startColumn = 0; startColumn < mInput.mColumns; startColumn += sRotateTileSize)
+               {
+                  if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+                  {
+                     return;
+                  }
+
+                  unsigned int columnCount = std::min(sRotateTileSize, mInput.mColumns - startColumn);
+                  if (!rotateTile(band, startRow, rowCount, startColumn, columnCount))
+                  {
+                     mSuccess = false;
+                     return;
+                  }
+               }
+            }
+         }
+         getReporter().reportProgress(getThreadIndex(), 100);
+      }
+
+      bool isSuccessful() const
+      {
+         return mSuccess;
+      }
+
+   private:
+      RotateThread& operator=(const RotateThread& rhs);
+
+      /**
+       * Calculates the nearest neighbor source pixel of each pixel in a strip of rows.
+       *
+       * The column coordinates of each row are walked with Bresenham's algorithm between
+       * the rotated row end points, which is how the rotation has always been defined
+       * for nearest neighbor.
+       */
+      void calculateNearestSources(unsigned int startRow, unsigned int rowCount)
+      {
+         mNearestColumns.resize(rowCount * mInput.mColumns);
+         mNearestRows.resize(rowCount * mInput.mColumns);
+         for (unsigned int row = 0; row < rowCount; ++row)
+         {
+            calculateNewPoints((*mInput.mpRowStarts)[startRow + row], (*mInput.mpRowEnds)[startRow + row], mPoints);
+            double mult = mPoints.size() / static_cast<double>(mInput.mColumns);
+            for (unsigned int col = 0; col < mInput.mColumns; ++col)
+            {
+               unsigned int preCol = static_cast<int>(mult * col + 0.5);
+               mNearestColumns[row * mInput.mColumns + col] = mPoints[preCol].mX - mInput.mX0;
+               mNearestRows[row * mInput.mColumns + col] = mPoints[preCol].mY - mInput.mY0;
+            }
+         }
+      }
+
+      void calculateTaps(unsigned int startRow, unsigned int rowCount, unsigned int startColumn,
+                         unsigned int columnCount)
+      {
+         int numColumns = static_cast<int>(mInput.mColumns);
+         int numRows = static_cast<int>(mInput.mRows);
+         if (mInput.mInterp == INTERP_NEAREST_NEIGHBOR)
+         {
+            mTaps.clear(1);
+            for (unsigned int row = 0; row < rowCount; ++row)
+            {
+               for (unsigned int col = 0; col < columnCount; ++col)
+               {
+                  unsigned int index = row * mInput.mColumns + startColumn + col;
+                  int sourceColumn = mNearestColumns[index];
+                  int sourceRow = mNearestRows[index];
+                  if (sourceColumn >= 0 && sourceColumn < numColumns && sourceRow >= 0 && sourceRow < numRows)
+                  {
+                     mTaps.mPixels.push_back(row * columnCount + col);
+                     mTaps.mColumns.push_back(sourceColumn);
+                     mTaps.mRows.push_back(sourceRow);
+                  }
+               }
+            }
+            return;
+         }
+
+         // The source location is calculated incrementally from the rotation of the tile origin
+         unsigned int tapCount = (mInput.mInterp == INTERP_BILINEAR) ? 2 : 4;
+         int firstTap = (mInput.mInterp == INTERP_BILINEAR) ? 0 : -1;
+         mTaps.clear(tapCount);
+
+         double originX = static_cast<double>(startColumn) + mInput.mX0;
+         double originY = static_cast<double>(startRow) + mInput.mY0;
+         double rowX = originX * mInput.mCosA - originY * mInput.mSinA - mInput.mX0;
+         double rowY = originX * mInput.mSinA + originY * mInput.mCosA - mInput.mY0;
+         double weights[4];
+         for (unsigned int row = 0; row < rowCount; ++row)
+         {
+            double sourceX = rowX;
+            double sourceY = rowY;
+            for (unsigned int col = 0; col < columnCount; ++col)
+            {
+               if (sourceX >= 0.0 && sourceX <= numColumns - 1 && sourceY >= 0.0 && sourceY <= numRows - 1)
+               {
+                  mTaps.mPixels.push_back(row * columnCount + col);
+
+                  int baseColumn = static_cast<int>(sourceX);
+                  int baseRow = static_cast<int>(sourceY);
+                  double columnFraction = sourceX - baseColumn;
+                  double rowFraction = sourceY - baseRow;
+
+                  if (tapCount == 2)
+                  {
+                     mTaps.mColumnWeights.push_back(1.0 - columnFraction);
+                     mTaps.mColumnWeights.push_back(columnFraction);
+                     mTaps.mRowWeights.push_back(1.0 - rowFraction);
+                     mTaps.mRowWeights.push_back(rowFraction);
+                  }
+                  else
+                  {
+                     getCubicWeights(columnFraction, weights);
+                     mTaps.mColumnWeights.insert(mTaps.mColumnWeights.end(), weights, weights + 4);
+                     getCubicWeights(rowFraction, weights);
+                     mTaps.mRowWeights.insert(mTaps.mRowWeights.end(), weights, weights + 4);
+                  }
+
+                  // Taps beyond the edge of the data set replicate the edge pixels
+                  for (unsigned int tap = 0; tap < tapCount; ++tap)
+                  {
+                     int offset = firstTap + static_cast<int>(tap);
+                     mTaps.mColumns.push_back(std::max(0, std::min(numColumns - 1, baseColumn + offset)));
+                     mTaps.mRows.push_back(std::max(0, std::min(numRows - 1, baseRow + offset)));
+                  }
+               }
+
+               sourceX += mInput.mCosA;
+               sourceY += mInput.mSinA;
+            }
+
+            rowX -= mInput.mSinA;
+            rowY += mInput.mCosA;
+         }
+      }
+
+      bool readSource(unsigned int band, int startRow, int stopRow, int startColumn, int stopColumn)
+      {
+         const RasterDataDescriptor* pDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpSrc->getDataDescriptor());
+         unsigned int rows = stopRow - startRow + 1;
+         unsigned int rowBytes = (stopColumn - startColumn + 1) * mInput.mPixelValues * mInput.mBytesPerElement;
+
+         FactoryResource<DataRequest> pRequest;
+         VERIFY(pRequest.get() != NULL);
+         pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow), rows);
+         pRequest->setColumns(pDescriptor->getActiveColumn(startColumn), pDescriptor->getActiveColumn(stopColumn));
+         if (!mInput.mBip)
+         {
+            pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band), 1);
+         }
+
+         DataAccessor accessor = mInput.mpSrc->getDataAccessor(pRequest.release());
+         mSource.resize(rows * rowBytes);
+         for (unsigned int row = 0; row < rows; ++row)
+         {
+            if (!accessor.isValid())
+            {
+               getReporter().reportError("Error reading source cube.");
+               return false;
+            }
+            memcpy(&mSource[row * rowBytes], accessor->getRow(), rowBytes);
+            accessor->nextRow();
+         }
+         return true;
+      }
+
+      bool rotateTile(unsigned int band, unsigned int startRow, unsigned int rowCount, unsigned int startColumn,
+                      unsigned int columnCount)
+      {
+         calculateTaps(startRow, rowCount, startColumn, columnCount);
+
+         unsigned int pixelBytes = mInput.mPixelValues * mInput.mBytesPerElement;
+         unsigned int tileRowBytes = columnCount * pixelBytes;
+
+         // initialize the tile...this is faster than checking validity at each
+         // pixel and setting the default value at that pixel
+         mDestination.resize(rowCount * tileRowBytes);
+         switchOnComplexEncoding(mInput.mEncoding, setPixel, &mDestination[0], mInput.mDefaultValue,
+            rowCount * columnCount * mInput.mPixelValues);
+
+         if (mTaps.mPixels.empty() == false)
+         {
+            // read the bounding box of the source taps in a single request
+            int sourceStartRow = *std::min_element(mTaps.mRows.begin(), mTaps.mRows.end());
+            int sourceStopRow = *std::max_element(mTaps.mRows.begin(), mTaps.mRows.end());
+            int sourceStartColumn = *std::min_element(mTaps.mColumns.begin(), mTaps.mColumns.end());
+            int sourceStopColumn = *std::max_element(mTaps.mColumns.begin(), mTaps.mColumns.end());
+            if (!readSource(band, sourceStartRow, sourceStopRow, sourceStartColumn, sourceStopColumn))
+            {
+               return false;
+            }
+            unsigned int sourceColumns = sourceStopColumn - sourceStartColumn + 1;
+
+            if (mInput.mInterp == INTERP_NEAREST_NEIGHBOR)
+            {
+               for (unsigned int k = 0; k < mTaps.mPixels.size(); ++k)
+               {
+                  unsigned int sourceOffset = ((mTaps.mRows[k] - sourceStartRow) * sourceColumns +
+                     (mTaps.mColumns[k] - sourceStartColumn)) * pixelBytes;
+                  memcpy(&mDestination[mTaps.mPixels[k] * pixelBytes], &mSource[sourceOffset], pixelBytes);
+               }
+            }
+            else
+            {
+               for (unsigned int value = 0; value < mInput.mPixelValues; ++value)
+               {
+                  switchOnEncoding(mInput.mEncoding, interpolateTile, &mDestination[0], &mSource[0], mTaps,
+                     sourceStartRow, sourceStartColumn, sourceColumns, mInput.mPixelValues, value, mSamples,
+                     mRowSums, mResults);
+               }
+            }
+         }
+
+         // write the tile
+         const RasterDataDescriptor* pDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpDst->getDataDescriptor());
+         FactoryResource<DataRequest> pRequest;
+         VERIFY(pRequest.get() != NULL);
+         pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(startRow + rowCount - 1),
+            rowCount);
+         pRequest->setColumns(pDescriptor->getActiveColumn(startColumn),
+            pDescriptor->getActiveColumn(startColumn + columnCount - 1));
+         if (!mInput.mBip)
+         {
+            pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band), 1);
+         }
+         pRequest->setWritable(true);
+
+         DataAccessor accessor = mInput.mpDst->getDataAccessor(pRequest.release());
+         for (unsigned int row = 0; row < rowCount; ++row)
+         {
+            if (!accessor.isValid())
+            {
+               getReporter().reportError("Error copying data.");
+               return false;
+            }
+            memcpy(accessor->getRow(), &mDestination[row * tileRowBytes], tileRowBytes);
+            accessor->nextRow();
+         }
+         return true;
+      }
+
+      const RotateInput& mInput;
+      mta::AlgorithmThread::Range mRange;
+      bool mSuccess;
+
+      std::vector<Opticks::PixelLocation> mPoints;
+      std::vector<int> mNearestColumns;
+      std::vector<int> mNearestRows;
+      RotateTaps mTaps;
+      std::vector<char> mSource;
+      std::vector<char> mDestination;
+      std::vector<double> mSamples;
+      std::vector<double> mRowSums;
+      std::vector<double> mResults;
+   };
+
+   struct RotateOutput
+   {
+      bool compileOverallResults(const std::vector<RotateThread*>& threads)
+      {
+         for (std::vector<RotateThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            if (*iter == NULL || (*iter)->isSuccessful() == false)
+            {
+               return false;
+            }
+         }
+         return true;
+      }
+   };
+}
+
 bool RasterUtilities::rotate(RasterElement* pDst, const RasterElement* pSrc, double angle, int defaultValue,
                              InterpolationType interp, Progress* pProgress, bool* pAbort)
 {
@@ -1444,156 +1900,102 @@ bool RasterUtilities::rotate(RasterElement* pDst, const RasterElement* pSrc, dou
    Opticks::PixelLocation lrPrime(static_cast<int>(lr.mX * cosA - lr.mY * sinA + 0.5),
       static_cast<int>(lr.mX * sinA + lr.mY * cosA + 0.5));
 
-   // use Bresenham's to calculate the start and end coordinates of each row
-   std::vector<Opticks::PixelLocation> newRowStartPre;
-   calculateNewPoints(ulPrime, llPrime, newRowStartPre);
-   std::vector<Opticks::PixelLocation> newRowEndPre;
-   calculateNewPoints(urPrime, lrPrime, newRowEndPre);
-
-   // interpolate so we have the proper number of points
    std::vector<Opticks::PixelLocation> newRowStart;
    std::vector<Opticks::PixelLocation> newRowEnd;
-   newRowStart.reserve(numRows);
-   newRowEnd.reserve(numRows);
-   double startMult = newRowStartPre.size() / static_cast<double>(numRows);
-   double endMult = newRowEndPre.size() / static_cast<double>(numRows);
-   for (unsigned int row = 0; row < numRows; ++row)
+   switch (interp)
    {
-      if (pProgress != NULL)
+   case INTERP_NEAREST_NEIGHBOR:
       {
-         pProgress->updateProgress("Calculating row shifts.", row * 100 / numRows, NORMAL);
-      }
-      switch(interp)
-      {
-      case INTERP_NEAREST_NEIGHBOR:
+         // use Bresenham's to calculate the start and end coordinates of each row
+         std::vector<Opticks::PixelLocation> newRowStartPre;
+         calculateNewPoints(ulPrime, llPrime, newRowStartPre);
+         std::vector<Opticks::PixelLocation> newRowEndPre;
+         calculateNewPoints(urPrime, lrPrime, newRowEndPre);
+
+         // interpolate so we have the proper number of points
+         newRowStart.reserve(numRows);
+         newRowEnd.reserve(numRows);
+         double startMult = newRowStartPre.size() / static_cast<double>(numRows);
+         double endMult = newRowEndPre.size() / static_cast<double>(numRows);
+         for (unsigned int row = 0; row < numRows; ++row)
          {
             unsigned int preStartRow = static_cast<int>(startMult * row + 0.5);
             unsigned int preEndRow = static_cast<int>(endMult * row + 0.5);
             newRowStart.push_back(newRowStartPre[preStartRow]);
             newRowEnd.push_back(newRowEndPre[preEndRow]);
-            break;
          }
-      case INTERP_BILINEAR:
-      case INTERP_BICUBIC:
-      case INTERP_AREA:
-      case INTERP_LANCZOS4:
-      default:
+         if (newRowStart.size() != numRows || newRowEnd.size() != numRows)
+         {
+            if (pProgress != NULL)
+            {
+               pProgress->updateProgress("Error calculating new row positions.", 0, ERRORS);
+            }
+            return false;
+         }
+         break;
+      }
+   case INTERP_BILINEAR:
+   case INTERP_BICUBIC:
+      if (pSrcDesc->getDataType() == INT4SCOMPLEX || pSrcDesc->getDataType() == FLT8COMPLEX)
+      {
          if (pProgress != NULL)
          {
-            pProgress->updateProgress("Invalid or unsupported interpolation method.", 0, ERRORS);
+            pProgress->updateProgress("Complex data can only be rotated with nearest neighbor interpolation.",
+               0, ERRORS);
          }
          return false;
       }
-   }
-   if (newRowStart.size() != numRows || newRowEnd.size() != numRows)
-   {
+      break;
+   case INTERP_AREA:
+   case INTERP_LANCZOS4:
+   default:
       if (pProgress != NULL)
       {
-         pProgress->updateProgress("Error calculating new row positions.", 0, ERRORS);
+         pProgress->updateProgress("Invalid or unsupported interpolation method.", 0, ERRORS);
       }
       return false;
    }
 
-   unsigned int outBandLoop = isBip ? 1 : numBands;
-   unsigned int inBandLoop = isBip ? numBands : 1;
-   for (unsigned int outBand = 0; outBand < outBandLoop; ++outBand)
-   {
-      FactoryResource<DataRequest> pSrcRequest;
-      FactoryResource<DataRequest> pDstRequest;
-      VERIFY(pSrcRequest.get() && pDstRequest.get());
-      pSrcRequest->setRows(DimensionDescriptor(), DimensionDescriptor(), 1);
-      pDstRequest->setRows(DimensionDescriptor(), DimensionDescriptor(), 1);
-      pSrcRequest->setColumns(DimensionDescriptor(), DimensionDescriptor(), numCols);
-      pDstRequest->setColumns(DimensionDescriptor(), DimensionDescriptor(), numCols);
-      if (!isBip)
-      {
-         pSrcRequest->setBands(pSrcDesc->getActiveBand(outBand), pSrcDesc->getActiveBand(outBand), 1);
-         pDstRequest->setBands(pDstDesc->getActiveBand(outBand), pDstDesc->getActiveBand(outBand), 1);
-      }
-      pDstRequest->setWritable(true);
-
-      DataAccessor pSrcAcc = pSrc->getDataAccessor(pSrcRequest.release());
-      DataAccessor pDstAcc = pDst->getDataAccessor(pDstRequest.release());
-      for (unsigned int row = 0; row < numRows; ++row)
+   // rotate the destination in tiles, with strips of tiles processed in parallel
+   RotateInput input;
+   input.mpSrc = pSrc;
+   input.mpDst = pDst;
+   input.mInterp = interp;
+   input.mDefaultValue = defaultValue;
+   input.mRows = numRows;
+   input.mColumns = numCols;
+   input.mBip = isBip;
+   input.mBandPasses = isBip ? 1 : numBands;
+   input.mPixelValues = isBip ? numBands : 1;
+   input.mEncoding = pDstDesc->getDataType();
+   input.mBytesPerElement = pDstDesc->getBytesPerElement();
+   input.mpRowStarts = &newRowStart;
+   input.mpRowEnds = &newRowEnd;
+   input.mX0 = x0;
+   input.mY0 = y0;
+   input.mCosA = cosA;
+   input.mSinA = sinA;
+   input.mpAbortFlag = pAbort;
+
+   if (numRows > 0 && numCols > 0)
+   {
+      RotateOutput output;
+      mta::ProgressObjectReporter reporter("Rotating data.", pProgress);
+      mta::MultiThreadedAlgorithm<RotateInput, RotateOutput, RotateThread> alg(
+         mta::getNumRequiredThreads((numRows + sRotateTileSize - 1) / sRotateTileSize), input, output, &reporter);
+      mta::Result result = alg.run();
+      if (pAbort != NULL && *pAbort)
       {
          if (pProgress != NULL)
          {
-            pProgress->updateProgress("Warping rows.", row * 100 / numRows, NORMAL);
-         }
-         if (pAbort != NULL && *pAbort)
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Aborted by user.", 0, ABORT);
-            }
-            return false;
-         }
-         if (!pDstAcc.isValid())
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Error copying data.", 0, ERRORS);
-            }
-            return false;
+            pProgress->updateProgress("Aborted by user.", 0, ABORT);
          }
-         // initialize the row...this is faster than checking validity at each
-         // pixel and setting the default value at that pixel
-         switchOnComplexEncoding(pDstDesc->getDataType(), setPixel,
-            pDstAcc->getRow(), defaultValue, inBandLoop*numCols);
-
-         // use Bresenham's to calculate the column coordinates
-         std::vector<Opticks::PixelLocation> newColPre;
-         calculateNewPoints(newRowStart[row], newRowEnd[row], newColPre);
-         // interpolate so we have the proper number of points
-         double mult = newColPre.size() / static_cast<double>(numCols);
-         for (unsigned int col = 0; col < numCols; ++col)
-         {
-            if (!pDstAcc.isValid())
-            {
-               if (pProgress != NULL)
-               {
-                  pProgress->updateProgress("Error copying data.", 0, ERRORS);
-               }
-               return false;
-            }
-            Opticks::PixelLocation sourcePixel;
-            switch(interp)
-            {
-            case INTERP_NEAREST_NEIGHBOR:
-               {
-                  unsigned int preCol = static_cast<int>(mult * col + 0.5);
-                  sourcePixel = newColPre[preCol];
-                  break;
-               }
-            case INTERP_BILINEAR:
-            case INTERP_BICUBIC:
-            case INTERP_AREA:
-            case INTERP_LANCZOS4:
-            default:
-               if (pProgress != NULL)
-               {
-                  pProgress->updateProgress("Invalid or unsupported interpolation method.", 0, ERRORS);
-               }
-               return false;
-            }
-            sourcePixel -= Opticks::PixelLocation(x0, y0);
-            if (sourcePixel.mX >= 0 && sourcePixel.mX < static_cast<int>(numCols) &&
-                sourcePixel.mY >= 0 && sourcePixel.mY < static_cast<int>(numRows))
-            {
-               pSrcAcc->toPixel(sourcePixel.mY, sourcePixel.mX);
-               if (!pSrcAcc.isValid())
-               {
-                  if (pProgress != NULL)
-                  {
-                     pProgress->updateProgress("Error reading source cube.", 0, ERRORS);
-                  }
-                  return false;
-               }
-               memcpy(pDstAcc->getColumn(), pSrcAcc->getColumn(), pDstDesc->getBytesPerElement() * inBandLoop);
-            }
-            pDstAcc->nextColumn();
-         }
-         pDstAcc->nextRow();
+         return false;
+      }
+      if (result != mta::SUCCESS)
+      {
+         // error message already reported by the rotation threads
+         return false;
       }
    }
    pDst->updateData();
@@ -10,6 +10,7 @@
 #include "Service.h"
 #include "ApplicationServices.h"
 #include "DesktopServices.h"
+#include "Instrumentation.h"
 #include "PlugInRegistration.h"
 #include "SessionExplorer.h"
 #include "UtilityServices.h"
@@ -100,6 +101,14 @@ DataVariantFactory* Service<DataVariantFactory>::get() const
    return pObjFact;
 }
 
+template<>
+Instrumentation* Service<Instrumentation>::get() const
+{
+   Instrumentation* pT = NULL;
+   ModuleManager::instance()->getService()->queryInterface("Instrumentation1", reinterpret_cast<void**>(&pT));
+   return pT;
+}
+
 template <>
 MessageLogMgr* Service<MessageLogMgr>::get() const
 {
@@ -0,0 +1,646 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "bthread.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DMutex.h"
+#include "FileResource.h"
+#include "ObjectResource.h"
+#include "Progress.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterFileDescriptor.h"
+#include "StreamingRasterWriter.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace
+{
+   // Number of columns copied per band before moving to the next band when converting pixel
+   // interleaved rows, which keeps the source pixels of the tile in the cache for all bands.
+   const size_t sTileColumns = 64;
+
+   template<typename T>
+   void copyElements(const std::vector<const char*>& bandStarts, const std::vector<size_t>& columnOffsets,
+      char* pDestination, size_t destinationColumnStride, size_t destinationBandStride)
+   {
+      const size_t numColumns = columnOffsets.size();
+      const size_t numBands = bandStarts.size();
+      if (destinationBandStride == sizeof(T))
+      {
+         for (size_t column = 0; column < numColumns; ++column)
+         {
+            T* pPixel = reinterpret_cast<T*>(pDestination + column * destinationColumnStride);
+            const size_t columnOffset = columnOffsets[column];
+            for (size_t band = 0; band < numBands; ++band)
+            {
+               pPixel[band] = *reinterpret_cast<const T*>(bandStarts[band] + columnOffset);
+            }
+         }
+      }
+      else
+      {
+         for (size_t firstColumn = 0; firstColumn < numColumns; firstColumn += sTileColumns)
+         {
+            const size_t lastColumn = std::min(firstColumn + sTileColumns, numColumns);
+            for (size_t band = 0; band < numBands; ++band)
+            {
+               const char* pSource = bandStarts[band];
+               char* pBand = pDestination + band * destinationBandStride;
+               for (size_t column = firstColumn; column < lastColumn; ++column)
+               {
+                  *reinterpret_cast<T*>(pBand + column * destinationColumnStride) =
+                     *reinterpret_cast<const T*>(pSource + columnOffsets[column]);
+               }
+            }
+         }
+      }
+   }
+
+   void copyElements(const std::vector<const char*>& bandStarts, const std::vector<size_t>& columnOffsets,
+      char* pDestination, size_t destinationColumnStride, size_t destinationBandStride, unsigned int bytesPerElement)
+   {
+      for (size_t column = 0; column < columnOffsets.size(); ++column)
+      {
+         char* pPixel = pDestination + column * destinationColumnStride;
+         for (size_t band = 0; band < bandStarts.size(); ++band)
+         {
+            memcpy(pPixel + band * destinationBandStride, bandStarts[band] + columnOffsets[column], bytesPerElement);
+         }
+      }
+   }
+}
+
+/**
+ * Writes the segments of one block while the next block is gathered.  Only one block
+ * is pending at a time so the caller can alternate between two blocks.
+ */
+class StreamingRasterWriter::BlockWriterThread
+{
+public:
+   BlockWriterThread(LargeFileResource& file) :
+      mFile(file),
+      mThread(static_cast<void*>(this), reinterpret_cast<void*>(BlockWriterThread::threadFunction)),
+      mpPending(NULL),
+      mStop(false),
+      mError(false),
+      mRunning(false)
+   {
+      mRunning = mThread.ThreadLaunch();
+   }
+
+   ~BlockWriterThread()
+   {
+      finish();
+   }
+
+   bool submit(const Block* pBlock)
+   {
+      if (mRunning == false)
+      {
+         return writeBlock(*pBlock);
+      }
+
+      mta::MutexLock lock(mMutex);
+      while (mpPending != NULL)
+      {
+         mDoneSignal.ThreadSignalWait(&mMutex);
+      }
+      if (mError)
+      {
+         return false;
+      }
+
+      mpPending = pBlock;
+      mWorkSignal.ThreadSignalActivate();
+      return true;
+   }
+
+   bool finish()
+   {
+      if (mRunning)
+      {
+         {
+            mta::MutexLock lock(mMutex);
+            while (mpPending != NULL)
+            {
+               mDoneSignal.ThreadSignalWait(&mMutex);
+            }
+            mStop = true;
+            mWorkSignal.ThreadSignalActivate();
+         }
+         mThread.ThreadWait();
+         mRunning = false;
+      }
+
+      return !mError;
+   }
+
+private:
+   BlockWriterThread& operator=(const BlockWriterThread& rhs);
+
+   static void threadFunction(BlockWriterThread* pWriter)
+   {
+      pWriter->run();
+   }
+
+   void run()
+   {
+      mta::MutexLock lock(mMutex);
+      while (true)
+      {
+         while (mpPending == NULL && mStop == false)
+         {
+            mWorkSignal.ThreadSignalWait(&mMutex);
+         }
+         if (mpPending == NULL)
+         {
+            break;
+         }
+
+         const Block* pBlock = mpPending;
+         mMutex.MutexUnlock();
+         bool success = writeBlock(*pBlock);
+         mMutex.MutexLock();
+
+         if (success == false)
+         {
+            mError = true;
+         }
+         mpPending = NULL;
+         mDoneSignal.ThreadSignalActivate();
+      }
+   }
+
+   bool writeBlock(const Block& block)
+   {
+      int64_t position = -1;
+      for (std::vector<Segment>::const_iterator iter = block.mSegments.begin(); iter != block.mSegments.end(); ++iter)
+      {
+         // consecutive segments are usually adjacent in the file so only seek when needed
+         if (iter->mOffset != position)
+         {
+            if (mFile.seek(iter->mOffset, SEEK_SET) != iter->mOffset)
+            {
+               return false;
+            }
+         }
+
+         int64_t size = static_cast<int64_t>(iter->mSize);
+         if (mFile.write(iter->mpData, size) != size)
+         {
+            return false;
+         }
+         position = iter->mOffset + size;
+      }
+
+      return true;
+   }
+
+   LargeFileResource& mFile;
+   BThread mThread;
+   mta::DMutex mMutex;
+   mta::DThreadSignal mWorkSignal;
+   mta::DThreadSignal mDoneSignal;
+   const Block* mpPending;
+   bool mStop;
+   bool mError;
+   bool mRunning;
+};
+
+StreamingRasterWriter::StreamingRasterWriter(const RasterElement* pRaster,
+                                             const RasterFileDescriptor* pFileDescriptor) :
+   mpRaster(pRaster),
+   mpFileDescriptor(pFileDescriptor),
+   mBlockSize(16 * 1024 * 1024),
+   mSourceInterleave(BIP),
+   mDestinationInterleave(BIP),
+   mSourceRowCount(0),
+   mSourceColumnCount(0),
+   mSourceBandCount(0),
+   mBytesPerElement(0),
+   mpRawData(NULL),
+   mColumnsContiguous(false)
+{
+}
+
+void StreamingRasterWriter::setBlockSize(size_t bytes)
+{
+   mBlockSize = bytes;
+}
+
+size_t StreamingRasterWriter::getBlockSize() const
+{
+   return mBlockSize;
+}
+
+const std::string& StreamingRasterWriter::getErrorMessage() const
+{
+   return mErrorMessage;
+}
+
+bool StreamingRasterWriter::write(LargeFileResource& file, int64_t fileOffset, Progress* pProgress,
+                                  const std::string& progressText, const bool* pAbort)
+{
+   mErrorMessage.clear();
+   if (mpRaster == NULL || mpFileDescriptor == NULL)
+   {
+      mErrorMessage = "The data to write is invalid.";
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   mSourceInterleave = pDescriptor->getInterleaveFormat();
+   mDestinationInterleave = mpFileDescriptor->getInterleaveFormat();
+   mSourceRowCount = pDescriptor->getRowCount();
+   mSourceColumnCount = pDescriptor->getColumnCount();
+   mSourceBandCount = pDescriptor->getBandCount();
+   mBytesPerElement = pDescriptor->getBytesPerElement();
+   mpRawData = static_cast<const char*>(mpRaster->getRawData());
+
+   // Convert the file descriptor dimensions into the element dimensions required by the data requests
+   const std::vector<DimensionDescriptor>& fileRows = mpFileDescriptor->getRows();
+   const std::vector<DimensionDescriptor>& fileColumns = mpFileDescriptor->getColumns();
+   const std::vector<DimensionDescriptor>& fileBands = mpFileDescriptor->getBands();
+   if (fileRows.empty() || fileColumns.empty() || fileBands.empty() || mBytesPerElement == 0)
+   {
+      mErrorMessage = "There is no data to write.";
+      return false;
+   }
+
+   mRows.clear();
+   mColumns.clear();
+   mBands.clear();
+   for (std::vector<DimensionDescriptor>::const_iterator iter = fileRows.begin(); iter != fileRows.end(); ++iter)
+   {
+      mRows.push_back(pDescriptor->getActiveRow(iter->getActiveNumber()));
+   }
+   for (std::vector<DimensionDescriptor>::const_iterator iter = fileColumns.begin(); iter != fileColumns.end(); ++iter)
+   {
+      mColumns.push_back(pDescriptor->getActiveColumn(iter->getActiveNumber()));
+   }
+   for (std::vector<DimensionDescriptor>::const_iterator iter = fileBands.begin(); iter != fileBands.end(); ++iter)
+   {
+      mBands.push_back(pDescriptor->getActiveBand(iter->getActiveNumber()));
+   }
+
+   const size_t sourceColumnStep = (mSourceInterleave == BIP) ? mSourceBandCount * mBytesPerElement : mBytesPerElement;
+   mColumnOffsets.resize(mColumns.size());
+   for (size_t column = 0; column < mColumns.size(); ++column)
+   {
+      mColumnOffsets[column] = mColumns[column].getActiveNumber() * sourceColumnStep;
+   }
+   mColumnsContiguous = isContiguous(mColumns, 0, static_cast<unsigned int>(mColumns.size()));
+
+   // Band sequential data from a band sequential element is written one band at a time so
+   // that each block is a single read from the element.  All other combinations gather
+   // every band for a range of rows.
+   std::vector<std::vector<unsigned int> > bandGroups;
+   if (mSourceInterleave == BSQ && mDestinationInterleave == BSQ)
+   {
+      for (unsigned int band = 0; band < mBands.size(); ++band)
+      {
+         bandGroups.push_back(std::vector<unsigned int>(1, band));
+      }
+   }
+   else
+   {
+      bandGroups.push_back(std::vector<unsigned int>());
+      for (unsigned int band = 0; band < mBands.size(); ++band)
+      {
+         bandGroups.back().push_back(band);
+      }
+   }
+
+   const unsigned int numRows = static_cast<unsigned int>(mRows.size());
+   const int64_t totalRows = static_cast<int64_t>(numRows) * bandGroups.size();
+   int64_t rowsWritten = 0;
+
+   Block blocks[2];
+   unsigned int currentBlock = 0;
+   BlockWriterThread writer(file);
+
+   for (std::vector<std::vector<unsigned int> >::const_iterator group = bandGroups.begin();
+      group != bandGroups.end(); ++group)
+   {
+      const size_t groupRowBytes = mColumns.size() * group->size() * mBytesPerElement;
+      const unsigned int rowsPerBlock = static_cast<unsigned int>(
+         std::max<size_t>(1, std::min<size_t>(mBlockSize / groupRowBytes, numRows)));
+
+      for (unsigned int firstRow = 0; firstRow < numRows; firstRow += rowsPerBlock)
+      {
+         if (pAbort != NULL && *pAbort == true)
+         {
+            writer.finish();
+            return false;
+         }
+
+         const unsigned int rowCount = std::min(rowsPerBlock, numRows - firstRow);
+         Block& block = blocks[currentBlock];
+         if (gatherBlock(block, *group, firstRow, rowCount, fileOffset) == false)
+         {
+            writer.finish();
+            return false;
+         }
+
+         if (writer.submit(&block) == false)
+         {
+            mErrorMessage = "Could not write the data to the file.";
+            return false;
+         }
+         currentBlock = 1 - currentBlock;
+
+         rowsWritten += rowCount;
+         if (pProgress != NULL)
+         {
+            pProgress->updateProgress(progressText, static_cast<int>(rowsWritten * 99 / totalRows), NORMAL);
+         }
+      }
+   }
+
+   if (writer.finish() == false)
+   {
+      mErrorMessage = "Could not write the data to the file.";
+      return false;
+   }
+
+   return true;
+}
+
+bool StreamingRasterWriter::gatherBlock(Block& block, const std::vector<unsigned int>& groupBands,
+                                        unsigned int firstRow, unsigned int rowCount, int64_t fileOffset)
+{
+   block.mSegments.clear();
+   if (mpRawData != NULL && getDirectSegments(block, groupBands, firstRow, rowCount, fileOffset) == true)
+   {
+      return true;
+   }
+
+   const size_t numColumns = mColumns.size();
+   const size_t numBands = groupBands.size();
+   const unsigned int bpe = mBytesPerElement;
+   block.mData.resize(rowCount * numColumns * numBands * bpe);
+   char* pBlock = &block.mData.front();
+
+   // Layout of the block in memory, which matches the layout of the rows in the file
+   size_t columnStride = bpe;
+   size_t bandStride = numColumns * bpe;
+   size_t rowStride = numBands * numColumns * bpe;
+   if (mDestinationInterleave == BIP)
+   {
+      columnStride = numBands * bpe;
+      bandStride = bpe;
+   }
+   else if (mDestinationInterleave == BSQ)
+   {
+      bandStride = rowCount * numColumns * bpe;
+      rowStride = numColumns * bpe;
+   }
+
+   // Offset of each band within a row of the element
+   size_t sourceBandStep = 0;
+   if (mSourceInterleave == BIP)
+   {
+      sourceBandStep = bpe;
+   }
+   else if (mSourceInterleave == BIL)
+   {
+      sourceBandStep = mSourceColumnCount * bpe;
+   }
+
+   std::vector<const char*> bandStarts(numBands);
+   if (mpRawData != NULL)
+   {
+      const size_t sourceRowBytes = static_cast<size_t>(mSourceColumnCount) * mSourceBandCount * bpe;
+      const size_t sourceBandBytes = static_cast<size_t>(mSourceRowCount) * mSourceColumnCount * bpe;
+      for (unsigned int row = 0; row < rowCount; ++row)
+      {
+         const size_t sourceRow = mRows[firstRow + row].getActiveNumber();
+         for (size_t band = 0; band < numBands; ++band)
+         {
+            const size_t sourceBand = mBands[groupBands[band]].getActiveNumber();
+            if (mSourceInterleave == BSQ)
+            {
+               bandStarts[band] = mpRawData + sourceBand * sourceBandBytes + sourceRow * mSourceColumnCount * bpe;
+            }
+            else
+            {
+               bandStarts[band] = mpRawData + sourceRow * sourceRowBytes + sourceBand * sourceBandStep;
+            }
+         }
+
+         gatherRow(bandStarts, pBlock + row * rowStride, columnStride, bandStride);
+      }
+   }
+   else if (mSourceInterleave == BSQ)
+   {
+      // Each band of a band sequential element requires its own accessor
+      bandStarts.resize(1);
+      for (size_t band = 0; band < numBands; ++band)
+      {
+         const DimensionDescriptor& sourceBand = mBands[groupBands[band]];
+
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setRows(mRows[firstRow], mRows[firstRow + rowCount - 1], rowCount);
+         pRequest->setBands(sourceBand, sourceBand, 1);
+         DataAccessor da = mpRaster->getDataAccessor(pRequest.release());
+         for (unsigned int row = 0; row < rowCount; ++row)
+         {
+            da->toPixel(mRows[firstRow + row].getActiveNumber(), 0);
+            if (da.isValid() == false)
+            {
+               mErrorMessage = "Could not access the data to write.";
+               return false;
+            }
+
+            bandStarts[0] = static_cast<const char*>(da->getRow());
+            gatherRow(bandStarts, pBlock + row * rowStride + band * bandStride, columnStride, bandStride);
+         }
+      }
+   }
+   else
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(mSourceInterleave);
+      pRequest->setRows(mRows[firstRow], mRows[firstRow + rowCount - 1], rowCount);
+      DataAccessor da = mpRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < rowCount; ++row)
+      {
+         da->toPixel(mRows[firstRow + row].getActiveNumber(), 0);
+         if (da.isValid() == false)
+         {
+            mErrorMessage = "Could not access the data to write.";
+            return false;
+         }
+
+         const char* pRow = static_cast<const char*>(da->getRow());
+         for (size_t band = 0; band < numBands; ++band)
+         {
+            bandStarts[band] = pRow + mBands[groupBands[band]].getActiveNumber() * sourceBandStep;
+         }
+
+         gatherRow(bandStarts, pBlock + row * rowStride, columnStride, bandStride);
+      }
+   }
+
+   if (mDestinationInterleave == BSQ)
+   {
+      for (size_t band = 0; band < numBands; ++band)
+      {
+         Segment segment;
+         segment.mOffset = fileOffset +
+            (static_cast<int64_t>(groupBands[band]) * mRows.size() + firstRow) * numColumns * bpe;
+         segment.mpData = pBlock + band * bandStride;
+         segment.mSize = bandStride;
+         block.mSegments.push_back(segment);
+      }
+   }
+   else
+   {
+      Segment segment;
+      segment.mOffset = fileOffset + static_cast<int64_t>(firstRow) * rowStride;
+      segment.mpData = pBlock;
+      segment.mSize = block.mData.size();
+      block.mSegments.push_back(segment);
+   }
+
+   return true;
+}
+
+bool StreamingRasterWriter::getDirectSegments(Block& block, const std::vector<unsigned int>& groupBands,
+                                              unsigned int firstRow, unsigned int rowCount, int64_t fileOffset) const
+{
+   // The element memory can only be written directly if the rows of the block are stored in the
+   // element exactly as they are written to the file
+   if (mSourceInterleave != mDestinationInterleave || mColumns.size() != mSourceColumnCount ||
+      mColumnsContiguous == false || isContiguous(mRows, firstRow, rowCount) == false)
+   {
+      return false;
+   }
+
+   const unsigned int bpe = mBytesPerElement;
+   const size_t columnBytes = static_cast<size_t>(mSourceColumnCount) * bpe;
+   const size_t sourceRow = mRows[firstRow].getActiveNumber();
+   if (mDestinationInterleave == BSQ)
+   {
+      for (std::vector<unsigned int>::const_iterator band = groupBands.begin(); band != groupBands.end(); ++band)
+      {
+         const size_t sourceBand = mBands[*band].getActiveNumber();
+         Segment segment;
+         segment.mOffset = fileOffset + (static_cast<int64_t>(*band) * mRows.size() + firstRow) * columnBytes;
+         segment.mpData = mpRawData + (sourceBand * mSourceRowCount + sourceRow) * columnBytes;
+         segment.mSize = rowCount * columnBytes;
+         block.mSegments.push_back(segment);
+      }
+
+      return true;
+   }
+
+   if (groupBands.size() != mSourceBandCount ||
+      isContiguous(mBands, 0, static_cast<unsigned int>(mBands.size())) == false)
+   {
+      return false;
+   }
+
+   const size_t rowBytes = columnBytes * mSourceBandCount;
+   Segment segment;
+   segment.mOffset = fileOffset + static_cast<int64_t>(firstRow) * rowBytes;
+   segment.mpData = mpRawData + sourceRow * rowBytes;
+   segment.mSize = rowCount * rowBytes;
+   block.mSegments.push_back(segment);
+   return true;
+}
+
+void StreamingRasterWriter::gatherRow(const std::vector<const char*>& bandStarts, char* pDestination,
+                                      size_t destinationColumnStride, size_t destinationBandStride) const
+{
+   const unsigned int bpe = mBytesPerElement;
+   const size_t numColumns = mColumnOffsets.size();
+   const size_t numBands = bandStarts.size();
+
+   bool bandsContiguous = true;
+   for (size_t band = 1; band < numBands && bandsContiguous; ++band)
+   {
+      bandsContiguous = (bandStarts[band] == bandStarts[band - 1] + bpe);
+   }
+
+   if (destinationBandStride == bpe && mSourceInterleave == BIP && bandsContiguous)
+   {
+      // Pixel interleaved to pixel interleaved copies whole pixels, or the whole row if
+      // every band and a contiguous range of columns are written
+      if (numBands == mSourceBandCount && mColumnsContiguous)
+      {
+         memcpy(pDestination, bandStarts.front() + mColumnOffsets.front(), numColumns * numBands * bpe);
+      }
+      else
+      {
+         for (size_t column = 0; column < numColumns; ++column)
+         {
+            memcpy(pDestination + column * destinationColumnStride, bandStarts.front() + mColumnOffsets[column],
+               numBands * bpe);
+         }
+      }
+      return;
+   }
+
+   if (destinationColumnStride == bpe && mSourceInterleave != BIP && mColumnsContiguous)
+   {
+      // Line and band interleaved sources store each band of a row contiguously
+      for (size_t band = 0; band < numBands; ++band)
+      {
+         memcpy(pDestination + band * destinationBandStride, bandStarts[band] + mColumnOffsets.front(),
+            numColumns * bpe);
+      }
+      return;
+   }
+
+   switch (bpe)
+   {
+   case 1:
+      copyElements<unsigned char>(bandStarts, mColumnOffsets, pDestination, destinationColumnStride,
+         destinationBandStride);
+      break;
+   case 2:
+      copyElements<unsigned short>(bandStarts, mColumnOffsets, pDestination, destinationColumnStride,
+         destinationBandStride);
+      break;
+   case 4:
+      copyElements<unsigned int>(bandStarts, mColumnOffsets, pDestination, destinationColumnStride,
+         destinationBandStride);
+      break;
+   case 8:
+      copyElements<uint64_t>(bandStarts, mColumnOffsets, pDestination, destinationColumnStride,
+         destinationBandStride);
+      break;
+   default:
+      copyElements(bandStarts, mColumnOffsets, pDestination, destinationColumnStride, destinationBandStride, bpe);
+      break;
+   }
+}
+
+bool StreamingRasterWriter::isContiguous(const std::vector<DimensionDescriptor>& dimensions, unsigned int first,
+                                         unsigned int count) const
+{
+   for (unsigned int index = first + 1; index < first + count; ++index)
+   {
+      if (dimensions[index].getActiveNumber() != dimensions[index - 1].getActiveNumber() + 1)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
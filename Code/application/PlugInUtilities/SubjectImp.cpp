@@ -131,6 +131,21 @@ bool SubjectImp::signalsEnabled() const
    return mpImpPrivate->signalsEnabled();
 }
 
+void SubjectImp::beginSignalBatch(bool modifiedOnly)
+{
+   mpImpPrivate->beginSignalBatch(modifiedOnly);
+}
+
+void SubjectImp::endSignalBatch(bool modifiedOnly)
+{
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   if (pSubject == NULL)
+   {
+      return;
+   }
+
+   mpImpPrivate->endSignalBatch(*pSubject, modifiedOnly);
+}
 
 void SubjectImp::clearSlots(const std::string& signal)
 {
@@ -11,14 +11,37 @@
 #include "SafeSlot.h"
 #include "Subject.h"
 
-#include <QtCore/QtGlobal>
-
 #include <algorithm>
 #include <vector>
 
 using namespace std;
 
-SubjectImpPrivate::SubjectImpPrivate() : mpSubject(NULL), mSignalsEnabled(true)
+SubjectImpPrivate::SignalId SubjectImpPrivate::getSignalId(const string& signal)
+{
+   // 64-bit FNV-1a
+   const SignalId prime = (static_cast<SignalId>(0x100) << 32) | 0x1b3;
+   SignalId id = (static_cast<SignalId>(0xcbf29ce4) << 32) | 0x84222325;
+   for (string::const_iterator iter = signal.begin(); iter != signal.end(); ++iter)
+   {
+      id ^= static_cast<unsigned char>(*iter);
+      id *= prime;
+   }
+
+   return id;
+}
+
+namespace
+{
+   const SubjectImpPrivate::SignalId DELETED_SIGNAL = SubjectImpPrivate::getSignalId(SIGNAL_NAME(Subject, Deleted));
+   const SubjectImpPrivate::SignalId MODIFIED_SIGNAL = SubjectImpPrivate::getSignalId(SIGNAL_NAME(Subject, Modified));
+}
+
+SubjectImpPrivate::SubjectImpPrivate() :
+   mpSubject(NULL),
+   mSignalsEnabled(true),
+   mBatchDepth(0),
+   mModifiedBatchDepth(0),
+   mModifiedPending(false)
 {
 }
 
@@ -38,22 +61,17 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
       mpSubject = &subject;
    }
 
-   MapType::iterator pSlotVec = mSlots.find(signal);
-   if (pSlotVec != mSlots.end())
+   list<SafeSlot>& slotVec = mSlots[getSignalId(signal)];
+   for (list<SafeSlot>::iterator pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot)
    {
-      list<SafeSlot>& slotVec = pSlotVec->second;
-      list<SafeSlot>::iterator pSlot;
-      for (pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot)
+      if (*pSlot == slot)
       {
-         if (*pSlot == slot)
-         {
-            return false;
-         }
+         return false;
       }
    }
 
-   mSlots[signal].push_back(slot);
-   SafeSlot& mappedSlot(mSlots[signal].back());
+   slotVec.push_back(slot);
+   SafeSlot& mappedSlot(slotVec.back());
    SlotInvalidator* pInvalidator = mappedSlot.getInvalidator();
    if (pInvalidator)
    {
@@ -76,7 +94,8 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
 bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slot& slot)
 {
    bool success = true;
-   MapType::iterator pSlotVec = mSlots.find(signal);
+   const SignalId signalId = getSignalId(signal);
+   MapType::iterator pSlotVec = mSlots.find(signalId);
    if (pSlotVec != mSlots.end())
    {
       list<SafeSlot>& slotVec = pSlotVec->second;
@@ -138,7 +157,7 @@ bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slo
          }
       }
 
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(signalId, slotVec);
    }
 
    return success;
@@ -147,7 +166,8 @@ bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slo
 class PopRecursion
 {
 public:
-   PopRecursion(vector<string>& recursions, const string& recursion) : mRecursions(recursions) 
+   PopRecursion(vector<SubjectImpPrivate::SignalId>& recursions, SubjectImpPrivate::SignalId recursion) :
+      mRecursions(recursions)
    {
       mRecursions.push_back(recursion);
    }
@@ -158,7 +178,7 @@ public:
 private:
    PopRecursion& operator=(const PopRecursion& rhs);
 
-   vector<string>& mRecursions;
+   vector<SubjectImpPrivate::SignalId>& mRecursions;
 };
 
 void SubjectImpPrivate::notify(Subject& subject, const string& signal, const string& originalSignal,
@@ -169,27 +189,39 @@ void SubjectImpPrivate::notify(Subject& subject, const string& signal, const str
       return;
    }
 
-   bool signalIsDeleted = false;
-   bool deletedFlagSet = false; // only want to do the signal name check if necessary
-   if (!mSignalsEnabled)
+   notify(subject, getSignalId(signal), signal, originalSignal, data, true);
+}
+
+void SubjectImpPrivate::notify(Subject& subject, SignalId signalId, const string& signal,
+                               const string& originalSignal, const boost::any& data, bool notifyModified)
+{
+   if (!mSignalsEnabled && signalId != DELETED_SIGNAL)
    {
-      signalIsDeleted = (signal == SIGNAL_NAME(Subject, Deleted));
-      if (!signalIsDeleted)
+      return;
+   }
+
+   // defer the signal until the outermost batch ends; Subject::Deleted is never deferred
+   if (signalId != DELETED_SIGNAL &&
+      (mBatchDepth > 0 || (mModifiedBatchDepth > 0 && signalId == MODIFIED_SIGNAL)))
+   {
+      queueSignal(signalId, signal, data);
+      if (signalId != MODIFIED_SIGNAL)
       {
-         return;
+         queueSignal(MODIFIED_SIGNAL, SIGNAL_NAME(Subject, Modified), data);
       }
-      deletedFlagSet = true;
+
+      return;
    }
 
    // notify slots attached to signal
-   MapType::iterator pSlotVec = mSlots.find(signal);
+   MapType::iterator pSlotVec = mSlots.find(signalId);
    if (pSlotVec != mSlots.end())
    {
       list<SafeSlot>& slotVec = pSlotVec->second;
 
       if (!slotVec.empty())
       {
-         PopRecursion popper(mRecursions, signal);
+         PopRecursion popper(mRecursions, signalId);
 
          // Keep a (unique) vector of Slots which have been notified to ensure that no Slot is notified more than once
          // For efficiency, only check the vector when Slots have been added during notification
@@ -218,13 +250,83 @@ void SubjectImpPrivate::notify(Subject& subject, const string& signal, const str
          }
       }
 
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(signalId, slotVec);
    }
 
-   if (signal != SIGNAL_NAME(Subject, Modified) && signal != SIGNAL_NAME(Subject, Deleted))
+   if (notifyModified && signalId != MODIFIED_SIGNAL && signalId != DELETED_SIGNAL)
    {
       string effectiveSignal = originalSignal + " as " + SIGNAL_NAME(Subject, Modified);
-      notify(subject, SIGNAL_NAME(Subject, Modified), effectiveSignal, data);
+      notify(subject, MODIFIED_SIGNAL, SIGNAL_NAME(Subject, Modified), effectiveSignal, data, false);
+   }
+}
+
+void SubjectImpPrivate::queueSignal(SignalId signalId, const string& signal, const boost::any& data)
+{
+   // Subject::Modified is held separately so that it is delivered after all other pending signals
+   if (signalId == MODIFIED_SIGNAL)
+   {
+      mModifiedPending = true;
+      mModifiedData = data;
+      return;
+   }
+
+   for (vector<PendingSignal>::iterator pPending = mPendingSignals.begin();
+      pPending != mPendingSignals.end(); ++pPending)
+   {
+      if (pPending->mId == signalId)
+      {
+         pPending->mData = data;
+         return;
+      }
+   }
+
+   PendingSignal pending;
+   pending.mId = signalId;
+   pending.mSignal = signal;
+   pending.mData = data;
+   mPendingSignals.push_back(pending);
+}
+
+void SubjectImpPrivate::beginSignalBatch(bool modifiedOnly)
+{
+   if (modifiedOnly)
+   {
+      ++mModifiedBatchDepth;
+   }
+   else
+   {
+      ++mBatchDepth;
+   }
+}
+
+void SubjectImpPrivate::endSignalBatch(Subject& subject, bool modifiedOnly)
+{
+   unsigned int& depth = (modifiedOnly ? mModifiedBatchDepth : mBatchDepth);
+   VERIFYNRV(depth > 0);
+   --depth;
+   if (mBatchDepth > 0 || mModifiedBatchDepth > 0)
+   {
+      return;
+   }
+
+   // Swap the pending signals out first since slots may notify again while they are being delivered
+   vector<PendingSignal> pendingSignals;
+   pendingSignals.swap(mPendingSignals);
+   bool modifiedPending = mModifiedPending;
+   boost::any modifiedData;
+   modifiedData.swap(mModifiedData);
+   mModifiedPending = false;
+
+   for (vector<PendingSignal>::const_iterator pPending = pendingSignals.begin();
+      pPending != pendingSignals.end(); ++pPending)
+   {
+      notify(subject, pPending->mId, pPending->mSignal, pPending->mSignal, pPending->mData, false);
+   }
+
+   if (modifiedPending)
+   {
+      notify(subject, MODIFIED_SIGNAL, SIGNAL_NAME(Subject, Modified), SIGNAL_NAME(Subject, Modified),
+         modifiedData, false);
    }
 }
 
@@ -237,11 +339,12 @@ const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
       return emptyList;
    }
 
-   MapType::iterator pSlotVec = mSlots.find(signal);
+   const SignalId signalId = getSignalId(signal);
+   MapType::iterator pSlotVec = mSlots.find(signalId);
    if (pSlotVec != mSlots.end())
    {
       list<SafeSlot>& slotVec = pSlotVec->second;
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(signalId, slotVec);
       return slotVec;
    }
    else
@@ -250,7 +353,7 @@ const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
    }
 }
 
-void SubjectImpPrivate::removeEmptySlots(const string& recursion, list<SafeSlot>& slotVec)
+void SubjectImpPrivate::removeEmptySlots(SignalId recursion, list<SafeSlot>& slotVec)
 {
    if (count(mRecursions.begin(), mRecursions.end(), recursion) == 0)
    {
@@ -270,9 +373,10 @@ void SubjectImpPrivate::removeEmptySlots(const string& recursion, list<SafeSlot>
 
 void SubjectImpPrivate::clearSlots(const std::string& signal)
 {
-   if (count(mRecursions.begin(), mRecursions.end(), signal) == 0)
+   const SignalId signalId = getSignalId(signal);
+   if (count(mRecursions.begin(), mRecursions.end(), signalId) == 0)
    {
-      MapType::iterator pSlotVec = mSlots.find(signal);
+      MapType::iterator pSlotVec = mSlots.find(signalId);
       if (pSlotVec != mSlots.end())
       {
          list<SafeSlot>& slotVec = pSlotVec->second;
@@ -24,9 +24,18 @@ class Subject;
 
 class SubjectImpPrivate
 {
-   typedef std::map<std::string,std::list<SafeSlot> > MapType;
-
 public:
+   /**
+    *  Signal names are converted to 64-bit hash values so that slot lookup,
+    *  recursion tracking and the checks for Subject::Deleted and
+    *  Subject::Modified do not compare strings.  The value depends only on the
+    *  name, so no shared table or lock is needed to compute it, and a collision
+    *  between the few hundred signal names in use is not a practical concern.
+    */
+   typedef uint64_t SignalId;
+
+   static SignalId getSignalId(const std::string& signal);
+
    SubjectImpPrivate();
    virtual ~SubjectImpPrivate();
    virtual bool attach(Subject& subject, const std::string& signal, const Slot& slot);
@@ -34,16 +43,36 @@ public:
    void notify(Subject& subject, const std::string& signal, const std::string& originalSignal,
       const boost::any& data = boost::any());
    const std::list<SafeSlot>& getSlots(const std::string& signal);
-   void removeEmptySlots(const std::string& recursion, std::list<SafeSlot>& slotVec);
    void clearSlots(const std::string& signal);
    void enableSignals(bool enabled);
    bool signalsEnabled() const;
+   void beginSignalBatch(bool modifiedOnly);
+   void endSignalBatch(Subject& subject, bool modifiedOnly);
 
 private:
+   typedef std::map<SignalId, std::list<SafeSlot> > MapType;
+
+   struct PendingSignal
+   {
+      SignalId mId;
+      std::string mSignal;
+      boost::any mData;
+   };
+
+   void notify(Subject& subject, SignalId signalId, const std::string& signal, const std::string& originalSignal,
+      const boost::any& data, bool notifyModified);
+   void queueSignal(SignalId signalId, const std::string& signal, const boost::any& data);
+   void removeEmptySlots(SignalId recursion, std::list<SafeSlot>& slotVec);
+
    MapType mSlots;
-   std::vector<std::string> mRecursions;
+   std::vector<SignalId> mRecursions;
    Subject* mpSubject;
    bool mSignalsEnabled;
+   unsigned int mBatchDepth;
+   unsigned int mModifiedBatchDepth;
+   std::vector<PendingSignal> mPendingSignals;
+   bool mModifiedPending;
+   boost::any mModifiedData;
 };
 
 #endif
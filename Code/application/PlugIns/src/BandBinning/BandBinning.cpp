@@ -19,6 +19,7 @@
 #include "DesktopServices.h"
 #include "DynamicObject.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
@@ -33,6 +34,7 @@
 #include "switchOnEncoding.h"
 #include "Wavelengths.h"
 
+#include <algorithm>
 #include <string>
 
 #include <QtCore/QString>
@@ -233,108 +235,191 @@ namespace
       return true;
    }
 
-   // Performs band binning on any data where bad values are uniform across all bands.
-   // Input can be any interleave; output is in BIP format.
-   template<typename T>
-   void createGroupedBandsBipUniformBadValues(const T* pJunk, ProgressTracker& progress, const bool& aborted,
-      const RasterElement* pElement, RasterElement* pOutputElement,
-      const std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >& groupedBands,
-      const BadValues* pBadValues)
+   // Target size of the source data read at once by each binning thread.
+   const size_t sBlockBytes = 8 * 1024 * 1024;
+
+   struct BinningThreadInput
+   {
+      BinningThreadInput() :
+         mpElement(NULL),
+         mpOutputElement(NULL),
+         mpGroupedBands(NULL),
+         mpBadValues(NULL),
+         mpAbortFlag(NULL)
+      {}
+
+      const RasterElement* mpElement;
+      RasterElement* mpOutputElement;
+      const std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >* mpGroupedBands;
+      const BadValues* mpBadValues;
+      const bool* mpAbortFlag;
+   };
+
+   /**
+    * Averages every bin for a range of rows of data where bad values are uniform across all bands.
+    *
+    * BSQ data is read one band at a time and accumulated along whole rows.  Other interleaves
+    * are read as BIP so the bands of every bin are contiguous for each pixel.  Either way, the
+    * values of each pixel are summed in band order so the averages match a pixel-by-pixel pass.
+    */
+   class BinningThread : public mta::AlgorithmThread
    {
-      // Timing tests have shown that this bool improves performance by as much as 25% when no bad values are present.
-      const bool zeroBadValues = (pBadValues == NULL || pBadValues->empty());
+   public:
+      BinningThread(const BinningThreadInput& input, int threadCount, int threadIndex,
+         mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRowRange(getThreadRange(threadCount,
+            static_cast<const RasterDataDescriptor*>(input.mpElement->getDataDescriptor())->getRowCount())),
+         mZeroBadValues(input.mpBadValues == NULL || input.mpBadValues->empty()),
+         mDefaultBadValue(input.mpBadValues == NULL ? 0.0 : input.mpBadValues->getDefaultBadValue()),
+         mFalseNegative(false)
+      {}
+
+      void run()
+      {
+         const RasterDataDescriptor* pDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpElement->getDataDescriptor());
+         if (pDescriptor->getInterleaveFormat() == BSQ)
+         {
+            switchOnEncoding(pDescriptor->getDataType(), binBsq, NULL);
+         }
+         else
+         {
+            switchOnEncoding(pDescriptor->getDataType(), binBip, NULL);
+         }
+      }
 
-      VERIFYNRV(pElement != NULL);
-      const RasterDataDescriptor* pDescriptor =
-         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
-      VERIFYNRV(pDescriptor != NULL);
-      const unsigned int rowCount = pDescriptor->getRowCount();
-      const unsigned int columnCount = pDescriptor->getColumnCount();
+      bool hasFalseNegative() const
+      {
+         return mFalseNegative;
+      }
 
-      VERIFYNRV(pOutputElement != NULL);
-      RasterDataDescriptor* pOutputDescriptor =
-         dynamic_cast<RasterDataDescriptor*>(pOutputElement->getDataDescriptor());
-      VERIFYNRV(pOutputDescriptor != NULL);
-      VERIFYNRV(groupedBands.empty() == false);
+   private:
+      BinningThread& operator=(const BinningThread& rhs);
 
-      bool falseNegative = false;
-      double percent = 0;
-      const double step = 99.0 / (groupedBands.size() * rowCount);
-      for (std::vector<std::pair<unsigned int, unsigned int> >::size_type i = 0; i < groupedBands.size(); ++i)
+      bool isAborted() const
       {
-         if (aborted == true)
+         return mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag;
+      }
+
+      DataAccessor getOutputAccessor(unsigned int startRow, unsigned int stopRow, unsigned int blockRows)
+      {
+         const RasterDataDescriptor* pOutputDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpOutputElement->getDataDescriptor());
+         FactoryResource<DataRequest> pOutputRequest;
+         pOutputRequest->setRows(pOutputDescriptor->getActiveRow(startRow), pOutputDescriptor->getActiveRow(stopRow),
+            blockRows);
+         pOutputRequest->setInterleaveFormat(BIP);
+         pOutputRequest->setWritable(true);
+         return mInput.mpOutputElement->getDataAccessor(pOutputRequest.release());
+      }
+
+      template<typename T>
+      void storeAverage(double sum, unsigned int goodValueCount, T* pDst)
+      {
+         if (goodValueCount == 0)
          {
-            break;
+            *pDst = static_cast<T>(mDefaultBadValue);
          }
+         else
+         {
+            *pDst = static_cast<T>(sum / goodValueCount); // Truncates integer types.
+            if (mZeroBadValues == false && mInput.mpBadValues->isBadValue(static_cast<double>(*pDst)) == true)
+            {
+               // Corner case: the average of one or more good values happened to match a defined bad value.
+               mFalseNegative = true;
+            }
+         }
+      }
+
+      template<typename T>
+      void binBip(const T* pJunk)
+      {
+         const std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >& groupedBands =
+            *mInput.mpGroupedBands;
+         const RasterDataDescriptor* pDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpElement->getDataDescriptor());
+         const unsigned int columnCount = pDescriptor->getColumnCount();
+
+         // Request the smallest band range containing every bin and locate each bin within it.
+         unsigned int firstBand = groupedBands.front().first.getActiveNumber();
+         unsigned int lastBand = groupedBands.front().second.getActiveNumber();
+         for (std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >::const_iterator iter =
+            groupedBands.begin(); iter != groupedBands.end(); ++iter)
+         {
+            firstBand = std::min(firstBand, iter->first.getActiveNumber());
+            lastBand = std::max(lastBand, iter->second.getActiveNumber());
+         }
+
+         std::vector<unsigned int> binOffsets;
+         std::vector<unsigned int> binBandCounts;
+         for (std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >::const_iterator iter =
+            groupedBands.begin(); iter != groupedBands.end(); ++iter)
+         {
+            binOffsets.push_back(iter->first.getActiveNumber() - firstBand);
+            binBandCounts.push_back(iter->second.getActiveNumber() - iter->first.getActiveNumber() + 1);
+         }
+
+         const unsigned int rowCount = mRowRange.mLast - mRowRange.mFirst + 1;
+         const size_t rowBytes = static_cast<size_t>(columnCount) * (lastBand - firstBand + 1) * sizeof(T);
+         const unsigned int blockRows = static_cast<unsigned int>(
+            std::min<size_t>(rowCount, std::max<size_t>(1, sBlockBytes / rowBytes)));
 
-         // Request all bands to be binned.
          FactoryResource<DataRequest> pRequest;
-         pRequest->setBands(groupedBands[i].first, groupedBands[i].second);
+         pRequest->setRows(pDescriptor->getActiveRow(mRowRange.mFirst), pDescriptor->getActiveRow(mRowRange.mLast),
+            blockRows);
+         pRequest->setBands(pDescriptor->getActiveBand(firstBand), pDescriptor->getActiveBand(lastBand));
          pRequest->setInterleaveFormat(BIP);
-         DataAccessor srcAccessor = pElement->getDataAccessor(pRequest.release());
-         const unsigned int bandCount =
-            groupedBands[i].second.getActiveNumber() - groupedBands[i].first.getActiveNumber() + 1;
+         DataAccessor srcAccessor = mInput.mpElement->getDataAccessor(pRequest.release());
+         DataAccessor dstAccessor = getOutputAccessor(mRowRange.mFirst, mRowRange.mLast, blockRows);
 
-         // Output one band at a time.
-         FactoryResource<DataRequest> pOutputRequest;
-         pOutputRequest->setBands(pOutputDescriptor->getActiveBand(i), DimensionDescriptor());
-         pOutputRequest->setInterleaveFormat(BIP);
-         pOutputRequest->setWritable(true);
-         DataAccessor dstAccessor = pOutputElement->getDataAccessor(pOutputRequest.release());
-         Statistics* pStatistics = pOutputElement->getStatistics(pOutputDescriptor->getActiveBand(i));
-         VERIFYNRV(pStatistics != NULL);
-         pStatistics->setBadValues(pBadValues);
-
-         // Iterate over each pixel, averaging each in turn.
-         const std::string text = QString("Creating bin %1 of %2").arg(i + 1).arg(groupedBands.size()).toStdString();
-         for (unsigned int row = 0; row < rowCount; ++row)
+         const unsigned int binCount = groupedBands.size();
+         for (int row = mRowRange.mFirst; row <= mRowRange.mLast; ++row)
          {
-            if (aborted == true)
+            if (isAborted())
             {
-               break;
+               return;
             }
 
-            progress.report(text, percent, NORMAL);
             for (unsigned int column = 0; column < columnCount; ++column)
             {
-               VERIFYNR(srcAccessor.isValid());
-               VERIFYNR(dstAccessor.isValid());
-
-               double average = 0;  // Use type double instead of T to combat overflow.
-               unsigned int goodValueCount = 0;
-               const T* pSrc = reinterpret_cast<T*>(srcAccessor->getColumn());
-               for (unsigned int band = 0; band < bandCount; ++band)
+               if (srcAccessor.isValid() == false || dstAccessor.isValid() == false)
                {
-                  if (zeroBadValues ||
-                     pBadValues->isBadValue(static_cast<double>(*pSrc)) == false)
-                  {
-                     average += static_cast<double>(*pSrc);
-                     ++goodValueCount;
-                  }
-
-                  ++pSrc;
+                  getReporter().reportError("Unable to access the band binning data.");
+                  return;
                }
 
+               const T* const pPixel = reinterpret_cast<T*>(srcAccessor->getColumn());
                T* const pDst = reinterpret_cast<T*>(dstAccessor->getColumn());
-               if (goodValueCount == 0)
+               for (unsigned int bin = 0; bin < binCount; ++bin)
                {
-                  double badValue(0.0);    // default bad value
-                  if (pBadValues != NULL)  // unlikely to be NULL since no good values were found, but check to be safe
+                  double sum = 0.0;  // Use type double instead of T to combat overflow.
+                  unsigned int goodValueCount = 0;
+                  const T* pSrc = pPixel + binOffsets[bin];
+                  const T* const pSrcEnd = pSrc + binBandCounts[bin];
+                  if (mZeroBadValues)
                   {
-                     badValue = pBadValues->getDefaultBadValue();
+                     for (; pSrc != pSrcEnd; ++pSrc)
+                     {
+                        sum += static_cast<double>(*pSrc);
+                     }
+
+                     goodValueCount = binBandCounts[bin];
                   }
-                  *pDst = static_cast<T>(badValue);
-               }
-               else
-               {
-                  *pDst = static_cast<T>(average / goodValueCount); // Truncates integer types.
-                  if (zeroBadValues == false &&                     // pBadValues can't be NULL if zeroBadValues is false
-                     pBadValues->isBadValue(static_cast<double>(*pDst)) == true)
+                  else
                   {
-                     // Corner case: the average of one or more good values happened to match a defined bad value.
-                     // Flag a warning, keep the pixel set to the bad value, and continue processing.
-                     falseNegative = true;
+                     for (; pSrc != pSrcEnd; ++pSrc)
+                     {
+                        if (mInput.mpBadValues->isBadValue(static_cast<double>(*pSrc)) == false)
+                        {
+                           sum += static_cast<double>(*pSrc);
+                           ++goodValueCount;
+                        }
+                     }
                   }
+
+                  storeAverage(sum, goodValueCount, pDst + bin);
                }
 
                srcAccessor->nextColumn();
@@ -343,16 +428,194 @@ namespace
 
             srcAccessor->nextRow();
             dstAccessor->nextRow();
-            percent += step;
+            getReporter().reportProgress(getThreadIndex(), mRowRange.computePercent(row + 1));
+         }
+      }
+
+      template<typename T>
+      void binBsq(const T* pJunk)
+      {
+         const std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >& groupedBands =
+            *mInput.mpGroupedBands;
+         const RasterDataDescriptor* pDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpElement->getDataDescriptor());
+         const unsigned int columnCount = pDescriptor->getColumnCount();
+
+         // The block size is limited by the accumulators, which are larger than the source rows.
+         const unsigned int rowCount = mRowRange.mLast - mRowRange.mFirst + 1;
+         const unsigned int blockRows = static_cast<unsigned int>(std::min<size_t>(rowCount,
+            std::max<size_t>(1, sBlockBytes / (static_cast<size_t>(columnCount) * sizeof(double)))));
+         std::vector<double> sums(static_cast<size_t>(blockRows) * columnCount);
+         std::vector<unsigned int> goodValueCounts(mZeroBadValues ? 0 : sums.size());
+
+         for (unsigned int blockStart = mRowRange.mFirst; blockStart <= static_cast<unsigned int>(mRowRange.mLast);
+            blockStart += blockRows)
+         {
+            const unsigned int blockStop = std::min(blockStart + blockRows - 1,
+               static_cast<unsigned int>(mRowRange.mLast));
+            const size_t blockValues = static_cast<size_t>(blockStop - blockStart + 1) * columnCount;
+            DataAccessor dstAccessor = getOutputAccessor(blockStart, blockStop, blockRows);
+
+            for (unsigned int bin = 0; bin < groupedBands.size(); ++bin)
+            {
+               if (isAborted())
+               {
+                  return;
+               }
+
+               std::fill(sums.begin(), sums.begin() + blockValues, 0.0);
+               std::fill(goodValueCounts.begin(), goodValueCounts.end(), 0);
+
+               // Accumulate each band of the bin along contiguous rows.
+               for (unsigned int band = groupedBands[bin].first.getActiveNumber();
+                  band <= groupedBands[bin].second.getActiveNumber(); ++band)
+               {
+                  FactoryResource<DataRequest> pRequest;
+                  pRequest->setRows(pDescriptor->getActiveRow(blockStart), pDescriptor->getActiveRow(blockStop),
+                     blockRows);
+                  pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band));
+                  pRequest->setInterleaveFormat(BSQ);
+                  DataAccessor srcAccessor = mInput.mpElement->getDataAccessor(pRequest.release());
+
+                  double* pSum = &sums.front();
+                  for (unsigned int row = blockStart; row <= blockStop; ++row)
+                  {
+                     if (srcAccessor.isValid() == false)
+                     {
+                        getReporter().reportError("Unable to access the band binning data.");
+                        return;
+                     }
+
+                     const T* const pSrc = reinterpret_cast<T*>(srcAccessor->getRow());
+                     if (mZeroBadValues)
+                     {
+                        for (unsigned int column = 0; column < columnCount; ++column)
+                        {
+                           pSum[column] += static_cast<double>(pSrc[column]);
+                        }
+                     }
+                     else
+                     {
+                        unsigned int* const pCount = &goodValueCounts[pSum - &sums.front()];
+                        for (unsigned int column = 0; column < columnCount; ++column)
+                        {
+                           if (mInput.mpBadValues->isBadValue(static_cast<double>(pSrc[column])) == false)
+                           {
+                              pSum[column] += static_cast<double>(pSrc[column]);
+                              ++pCount[column];
+                           }
+                        }
+                     }
+
+                     pSum += columnCount;
+                     srcAccessor->nextRow();
+                  }
+               }
+
+               // Write the averages of the bin into the output.
+               const unsigned int bandCount =
+                  groupedBands[bin].second.getActiveNumber() - groupedBands[bin].first.getActiveNumber() + 1;
+               size_t index = 0;
+               for (unsigned int row = blockStart; row <= blockStop; ++row)
+               {
+                  dstAccessor->toPixel(row, 0);
+                  for (unsigned int column = 0; column < columnCount; ++column, ++index)
+                  {
+                     if (dstAccessor.isValid() == false)
+                     {
+                        getReporter().reportError("Unable to access the band binning output.");
+                        return;
+                     }
+
+                     storeAverage(sums[index], mZeroBadValues ? bandCount : goodValueCounts[index],
+                        reinterpret_cast<T*>(dstAccessor->getColumn()) + bin);
+                     dstAccessor->nextColumn();
+                  }
+               }
+            }
+
+            getReporter().reportProgress(getThreadIndex(), mRowRange.computePercent(blockStop + 1));
+         }
+      }
+
+      const BinningThreadInput& mInput;
+      mta::AlgorithmThread::Range mRowRange;
+      const bool mZeroBadValues;
+      const double mDefaultBadValue;
+      bool mFalseNegative;
+   };
+
+   struct BinningThreadOutput
+   {
+      BinningThreadOutput() :
+         mFalseNegative(false)
+      {}
+
+      bool compileOverallResults(const std::vector<BinningThread*>& threads)
+      {
+         for (std::vector<BinningThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            mFalseNegative = mFalseNegative || (*iter)->hasFalseNegative();
          }
+
+         return true;
       }
 
-      if (falseNegative == true)
+      bool mFalseNegative;
+   };
+
+   // Performs band binning on any data where bad values are uniform across all bands.
+   // Input can be any interleave; output is in BIP format.
+   // Returns true if and only if the algorithm did not fail.
+   bool createGroupedBandsBipUniformBadValues(ProgressTracker& progress, const bool& aborted,
+      const RasterElement* pElement, RasterElement* pOutputElement,
+      const std::vector<std::pair<DimensionDescriptor, DimensionDescriptor> >& groupedBands,
+      const BadValues* pBadValues)
+   {
+      VERIFY(pElement != NULL);
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFY(pDescriptor != NULL);
+
+      VERIFY(pOutputElement != NULL);
+      RasterDataDescriptor* pOutputDescriptor =
+         dynamic_cast<RasterDataDescriptor*>(pOutputElement->getDataDescriptor());
+      VERIFY(pOutputDescriptor != NULL);
+      VERIFY(groupedBands.empty() == false);
+
+      // Statistics are not thread safe, so set the bad values of each bin before starting the threads.
+      for (unsigned int i = 0; i < groupedBands.size(); ++i)
+      {
+         Statistics* pStatistics = pOutputElement->getStatistics(pOutputDescriptor->getActiveBand(i));
+         VERIFY(pStatistics != NULL);
+         pStatistics->setBadValues(pBadValues);
+      }
+
+      BinningThreadInput input;
+      input.mpElement = pElement;
+      input.mpOutputElement = pOutputElement;
+      input.mpGroupedBands = &groupedBands;
+      input.mpBadValues = pBadValues;
+      input.mpAbortFlag = &aborted;
+
+      BinningThreadOutput output;
+      mta::ProgressObjectReporter reporter(QString("Creating %1 bins").arg(groupedBands.size()).toStdString(),
+         progress.getCurrentProgress());
+      mta::MultiThreadedAlgorithm<BinningThreadInput, BinningThreadOutput, BinningThread>
+         alg(mta::getNumRequiredThreads(pDescriptor->getRowCount()), input, output, &reporter);
+      if (alg.run() == mta::FAILURE)
+      {
+         return false;
+      }
+
+      if (output.mFalseNegative == true)
       {
          progress.report("One or more bands contain values which, when averaged, were equivalent to a bad value. "
             "These good values were not modified and will be indistinguishable from any bad values. "
             "Remove bad values and run this algorithm again to correct this problem.", 99, WARNING);
       }
+
+      return true;
    }
 
    // Performs band binning on any data.
@@ -400,6 +663,17 @@ namespace
          pOutputRequest->setWritable(true);
          DataAccessor dstAccessor = pOutputElement->getDataAccessor(pOutputRequest.release());
 
+         // Look up the bad values of each band once instead of for every pixel.
+         std::vector<const BadValues*> bandBadValues;
+         bandBadValues.reserve(bandCount);
+         for (unsigned int band = 0; band < bandCount; ++band)
+         {
+            DimensionDescriptor activeBand = pDescriptor->getActiveBand(groupedBands[i].first.getActiveNumber() + band);
+            Statistics* pStatistics = pElement->getStatistics(activeBand);
+            VERIFYNRV(pStatistics != NULL);
+            bandBadValues.push_back(pStatistics->getBadValues());
+         }
+
          // Iterate over each pixel, averaging each in turn.
          const std::string text = QString("Creating bin %1 of %2").arg(i + 1).arg(groupedBands.size()).toStdString();
          for (unsigned int row = 0; row < rowCount; ++row)
@@ -421,11 +695,7 @@ namespace
                T* const pDst = reinterpret_cast<T*>(dstAccessor->getColumn());
                for (unsigned int band = 0; band < bandCount; ++band)
                {
-                  DimensionDescriptor activeBand =
-                     pDescriptor->getActiveBand(groupedBands[i].first.getActiveNumber() + band);
-                  Statistics* pStatistics = pElement->getStatistics(activeBand);
-                  VERIFYNRV(pStatistics != NULL);
-                  const BadValues* pBadValues = pStatistics->getBadValues();
+                  const BadValues* pBadValues = bandBadValues[band];
                   if (pBadValues != NULL && pBadValues->isBadValue(static_cast<double>(*pSrc)) == true)
                   {
                      // Always writes the most recently encountered (arbitrary choice) bad value into *pDst.
@@ -593,10 +863,10 @@ bool BandBinning::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          "The output descriptor (including wavelengths) may be invalid.", 0, WARNING);
    }
 
-   // TODO: optimize for BIL and BSQ
-   if (pDescriptor->getInterleaveFormat() != BIP)
+   // TODO: optimize for BIL
+   if (pDescriptor->getInterleaveFormat() == BIL)
    {
-      progress.report("Band binning is optimized for BIP data.", 0, WARNING);
+      progress.report("Band binning is optimized for BIP and BSQ data.", 0, WARNING);
    }
 
    // Querying for bad values during execution of the algorithm is computationally expensive.
@@ -609,8 +879,12 @@ bool BandBinning::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
    {
       FactoryResource<BadValues> pBadValues;
       pBadValues->setBadValues(badValuesStr);
-      switchOnEncoding(pDescriptor->getDataType(), createGroupedBandsBipUniformBadValues, NULL,
-         progress, mAborted, pElement, pOutputElement.get(), groupedBands, pBadValues.get());
+      if (createGroupedBandsBipUniformBadValues(progress, mAborted, pElement, pOutputElement.get(), groupedBands,
+         pBadValues.get()) == false)
+      {
+         progress.report("Unable to create the band bins.", 0, ERRORS);
+         return false;
+      }
    }
    else
    {
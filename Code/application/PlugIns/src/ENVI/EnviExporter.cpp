@@ -16,8 +16,6 @@
 #include "AppVerify.h"
 #include "AppVersion.h"
 #include "Classification.h"
-#include "DataAccessorImpl.h"
-#include "DataRequest.h"
 #include "DimensionDescriptor.h"
 #include "Endian.h"
 #include "EnviExporter.h"
@@ -34,6 +32,7 @@
 #include "RasterFileDescriptor.h"
 #include "RasterUtilities.h"
 #include "SpecialMetadata.h"
+#include "StreamingRasterWriter.h"
 #include "TypesFile.h"
 #include "Units.h"
 
@@ -1077,664 +1076,37 @@ bool EnviExporter::exportDataFile() const
       return false;
    }
 
-   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
-   VERIFY(pDescriptor != NULL);
-
-   const vector<DimensionDescriptor>& exportRows = mpFileDescriptor->getRows();
-   const vector<DimensionDescriptor>& exportColumns = mpFileDescriptor->getColumns();
-   const vector<DimensionDescriptor>& exportBands = mpFileDescriptor->getBands();
-   unsigned int bytesPerElement = pDescriptor->getBytesPerElement();
-
-   DimensionDescriptor startRow = pDescriptor->getActiveRow(exportRows.front().getActiveNumber());
-   DimensionDescriptor endRow = pDescriptor->getActiveRow(exportRows.back().getActiveNumber());
-   DimensionDescriptor startColumn = pDescriptor->getActiveColumn(exportColumns.front().getActiveNumber());
-   DimensionDescriptor endColumn = pDescriptor->getActiveColumn(exportColumns.back().getActiveNumber());
-   DimensionDescriptor startBand = pDescriptor->getActiveBand(exportBands.front().getActiveNumber());
-   DimensionDescriptor endBand = pDescriptor->getActiveBand(exportBands.back().getActiveNumber());
-
    string progressText = "Exporting the data file...";
    if (mpProgress != NULL)
    {
       mpProgress->updateProgress(progressText, 0, NORMAL);
    }
 
-   int rowIndex = 0;
-   InterleaveFormatType interleave = mpFileDescriptor->getInterleaveFormat();
-   if (interleave == BIP)
+   // The writer reads large blocks of rows and performs any interleave conversion in memory
+   StreamingRasterWriter writer(mpRaster, mpFileDescriptor);
+   if (writer.write(dataFile, 0, mpProgress, progressText, &mAborted) == false)
    {
-      if (exportBands.size() == pDescriptor->getBandCount())   // All bands
+      if (isAborted() == true)
       {
-         if (exportColumns.size() ==
-            exportColumns.back().getActiveNumber() - exportColumns.front().getActiveNumber() + 1)
-         {
-            // Export a full contiguous row at a time
-            FactoryResource<DataRequest> pDataRequest;
-            pDataRequest->setInterleaveFormat(BIP);
-            pDataRequest->setRows(startRow, endRow, 1);
-            pDataRequest->setColumns(startColumn, endColumn, exportColumns.size());
-
-            DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-            if (dataAccessor.isValid() == false)
-            {
-               string message = "The data in the data set could not be accessed.";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ERRORS);
-               }
-
-               pStep->finalize(Message::Failure, message);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            vector<DimensionDescriptor>::const_iterator iter;
-            for (iter = exportRows.begin(); iter != exportRows.end(); ++iter)
-            {
-               if (isAborted() == true)
-               {
-                  string message = "ENVI export aborted!";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ABORT);
-                  }
-
-                  pStep->finalize(Message::Abort);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               DimensionDescriptor row = *iter;
-               dataAccessor->toPixel(row.getActiveNumber(), exportColumns.front().getActiveNumber());
-               if (dataAccessor.isValid() == false)
-               {
-                  string message = "An error occurred when reading the data from the data set.";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ERRORS);
-                  }
-
-                  pStep->finalize(Message::Failure, message);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               void* pData = dataAccessor->getRow();
-               dataFile.write(pData, bytesPerElement * exportBands.size() * exportColumns.size());
-
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(progressText, (rowIndex++ * 100) / exportRows.size(), NORMAL);
-               }
-            }
-         }
-         else
-         {
-            // Export one full pixel at a time
-            FactoryResource<DataRequest> pDataRequest;
-            pDataRequest->setInterleaveFormat(BIP);
-            pDataRequest->setRows(startRow, endRow, 1);
-            pDataRequest->setColumns(startColumn, endColumn, 1);
-
-            DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-            if (dataAccessor.isValid() == false)
-            {
-               string message = "The data in the data set could not be accessed.";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ERRORS);
-               }
-
-               pStep->finalize(Message::Failure, message);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            vector<DimensionDescriptor>::const_iterator rowIter;
-            for (rowIter = exportRows.begin(); rowIter != exportRows.end(); ++rowIter)
-            {
-               if (isAborted() == true)
-               {
-                  string message = "ENVI export aborted!";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ABORT);
-                  }
-
-                  pStep->finalize(Message::Abort);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               vector<DimensionDescriptor>::const_iterator colIter;
-               for (colIter = exportColumns.begin(); colIter != exportColumns.end(); ++colIter)
-               {
-                  DimensionDescriptor row = *rowIter;
-                  DimensionDescriptor column = *colIter;
-                  dataAccessor->toPixel(row.getActiveNumber(), column.getActiveNumber());
-                  if (dataAccessor.isValid() == false)
-                  {
-                     string message = "An error occurred when reading the data from the data set.";
-                     if (mpProgress != NULL)
-                     {
-                        mpProgress->updateProgress(message, 0, ERRORS);
-                     }
-
-                     pStep->finalize(Message::Failure, message);
-                     dataFile.close();
-                     remove(headerFilename.c_str());
-                     remove(dataFilename.c_str());
-                     return false;
-                  }
-
-                  void* pData = dataAccessor->getColumn();
-                  dataFile.write(pData, bytesPerElement * exportBands.size());
-               }
-
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(progressText, (rowIndex++ * 100) / exportRows.size(), NORMAL);
-               }
-            }
-         }
-      }
-      else
-      {
-         // Slowest possible copy, one pixel at a time
-         FactoryResource<DataRequest> pDataRequest;
-         pDataRequest->setInterleaveFormat(BIP);
-         pDataRequest->setRows(startRow, endRow, 1);
-         pDataRequest->setColumns(startColumn, endColumn, 1);
-
-         DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-         if (dataAccessor.isValid() == false)
+         string message = "ENVI export aborted!";
+         if (mpProgress != NULL)
          {
-            string message = "The data in the data set could not be accessed.";
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(message, 0, ERRORS);
-            }
-
-            pStep->finalize(Message::Failure, message);
-            dataFile.close();
-            remove(headerFilename.c_str());
-            remove(dataFilename.c_str());
-            return false;
+            mpProgress->updateProgress(message, 0, ABORT);
          }
 
-         vector<DimensionDescriptor>::const_iterator rowIter;
-         for (rowIter = exportRows.begin(); rowIter != exportRows.end(); ++rowIter)
-         {
-            if (isAborted() == true)
-            {
-               string message = "ENVI export aborted!";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ABORT);
-               }
-
-               pStep->finalize(Message::Abort);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            vector<DimensionDescriptor>::const_iterator colIter;
-            for (colIter = exportColumns.begin(); colIter != exportColumns.end(); ++colIter)
-            {
-               DimensionDescriptor row = *rowIter;
-               DimensionDescriptor column = *colIter;
-               dataAccessor->toPixel(row.getActiveNumber(), column.getActiveNumber());
-               if (dataAccessor.isValid() == false)
-               {
-                  string message = "An error occurred when reading the data from the data set.";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ERRORS);
-                  }
-
-                  pStep->finalize(Message::Failure, message);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               char* pData = reinterpret_cast<char*>(dataAccessor->getColumn());
-
-               vector<DimensionDescriptor>::const_iterator bandIter;
-               for (bandIter = exportBands.begin(); bandIter != exportBands.end(); ++bandIter)
-               {
-                  DimensionDescriptor band = *bandIter;
-                  dataFile.write(pData + bytesPerElement * (band.getActiveNumber()), bytesPerElement);
-               }
-            }
-
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(progressText, (rowIndex++ * 100) / exportRows.size(), NORMAL);
-            }
-         }
-      }
-   }
-   else if (interleave == BSQ)
-   {
-      if (exportColumns.size() == exportColumns.back().getActiveNumber() - exportColumns.front().getActiveNumber() + 1)
-      {
-         vector<DimensionDescriptor>::const_iterator bandIter;
-         for (bandIter = exportBands.begin(); bandIter != exportBands.end(); ++bandIter)
-         {
-            DimensionDescriptor exportBand = *bandIter;
-            DimensionDescriptor originalBand = pDescriptor->getActiveBand(exportBand.getActiveNumber());
-
-            // Export a full contiguous row at a time
-            FactoryResource<DataRequest> pDataRequest;
-            pDataRequest->setInterleaveFormat(BSQ);
-            pDataRequest->setRows(startRow, endRow, 1);
-            pDataRequest->setColumns(startColumn, endColumn, exportColumns.size());
-            pDataRequest->setBands(originalBand, originalBand, 1);
-
-            DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-            if (dataAccessor.isValid() == false)
-            {
-               string message = "The data in the data set could not be accessed.";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ERRORS);
-               }
-
-               pStep->finalize(Message::Failure, message);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            vector<DimensionDescriptor>::const_iterator rowIter;
-            for (rowIter = exportRows.begin(); rowIter != exportRows.end(); ++rowIter)
-            {
-               if (isAborted() == true)
-               {
-                  string message = "ENVI export aborted!";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ABORT);
-                  }
-
-                  pStep->finalize(Message::Abort);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               if (dataAccessor.isValid() == false)
-               {
-                  string message = "An error occurred when reading the data from the data set.";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ERRORS);
-                  }
-
-                  pStep->finalize(Message::Failure, message);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               void* pData = dataAccessor->getRow();
-               dataFile.write(pData, exportColumns.size() * bytesPerElement);
-
-               dataAccessor->nextRow();
-
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(progressText,
-                     (rowIndex++ * 100) / (exportRows.size() * exportBands.size()), NORMAL);
-               }
-            }
-         }
+         pStep->finalize(Message::Abort);
       }
       else
       {
-         vector<DimensionDescriptor>::const_iterator bandIter;
-         for (bandIter = exportBands.begin(); bandIter != exportBands.end(); ++bandIter)
-         {
-            DimensionDescriptor exportBand = *bandIter;
-            DimensionDescriptor originalBand = pDescriptor->getActiveBand(exportBand.getActiveNumber());
-
-            // Slowest possible copy, one pixel at a time
-            FactoryResource<DataRequest> pDataRequest;
-            pDataRequest->setInterleaveFormat(BSQ);
-            pDataRequest->setRows(startRow, endRow, 1);
-            pDataRequest->setColumns(startColumn, endColumn, 1);
-            pDataRequest->setBands(originalBand, originalBand, 1);
-
-            DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-            if (dataAccessor.isValid() == false)
-            {
-               string message = "The data in the data set could not be accessed.";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ERRORS);
-               }
-
-               pStep->finalize(Message::Failure, message);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            vector<DimensionDescriptor>::const_iterator rowIter;
-            for (rowIter = exportRows.begin(); rowIter != exportRows.end(); ++rowIter)
-            {
-               if (isAborted() == true)
-               {
-                  string message = "ENVI export aborted!";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ABORT);
-                  }
-
-                  pStep->finalize(Message::Abort);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               DimensionDescriptor row = *rowIter;
-
-               vector<DimensionDescriptor>::const_iterator columnIter;
-               for (columnIter = exportColumns.begin(); columnIter != exportColumns.end(); ++columnIter)
-               {
-                  DimensionDescriptor column = *columnIter;
-
-                  dataAccessor->toPixel(row.getActiveNumber(), column.getActiveNumber());
-                  if (dataAccessor.isValid() == false)
-                  {
-                     string message = "An error occurred when reading the data from the data set.";
-                     if (mpProgress != NULL)
-                     {
-                        mpProgress->updateProgress(message, 0, ERRORS);
-                     }
-
-                     pStep->finalize(Message::Failure, message);
-                     dataFile.close();
-                     remove(headerFilename.c_str());
-                     remove(dataFilename.c_str());
-                     return false;
-                  }
-
-                  void* pData = dataAccessor->getColumn();
-                  dataFile.write(pData, bytesPerElement);
-               }
-
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(progressText,
-                     (rowIndex++ * 100) / (exportRows.size() * exportBands.size()), NORMAL);
-               }
-            }
-         }
-      }
-   }
-   else if (interleave == BIL)
-   {
-      if (exportColumns.size() == pDescriptor->getColumnCount() &&
-         (exportBands.size() == exportBands.back().getActiveNumber() - exportBands.front().getActiveNumber() + 1))
-      {
-         // Export a full contiguous row at a time
-         FactoryResource<DataRequest> pDataRequest;
-         pDataRequest->setInterleaveFormat(BIL);
-         pDataRequest->setRows(startRow, endRow, 1);
-         pDataRequest->setColumns(startColumn, endColumn, exportColumns.size());
-         pDataRequest->setBands(startBand, endBand, exportBands.size());
-
-         DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-         if (dataAccessor.isValid() == false)
-         {
-            string message = "The data in the data set could not be accessed.";
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(message, 0, ERRORS);
-            }
-
-            pStep->finalize(Message::Failure, message);
-            dataFile.close();
-            remove(headerFilename.c_str());
-            remove(dataFilename.c_str());
-            return false;
-         }
-
-         for (vector<DimensionDescriptor>::const_iterator iter = exportRows.begin(); iter != exportRows.end(); ++iter)
-         {
-            if (isAborted() == true)
-            {
-               string message = "ENVI export aborted!";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ABORT);
-               }
-
-               pStep->finalize(Message::Abort);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            DimensionDescriptor row = *iter;
-            dataAccessor->toPixel(row.getActiveNumber(), exportColumns.front().getActiveNumber());
-            if (dataAccessor.isValid() == false)
-            {
-               string message = "An error occurred when reading the data from the data set.";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ERRORS);
-               }
-
-               pStep->finalize(Message::Failure, message);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            void* pData = dataAccessor->getRow();
-            dataFile.write(pData, bytesPerElement * exportBands.size() * exportColumns.size());
-
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(progressText, (rowIndex++ * 100) / exportRows.size(), NORMAL);
-            }
-         }
-      }
-      else if (exportColumns.size() ==
-         exportColumns.back().getActiveNumber() - exportColumns.front().getActiveNumber() + 1)
-      {
-         // Export a row from a single band at a time
-         vector<DimensionDescriptor>::const_iterator rowIter;
-         for (rowIter = exportRows.begin(); rowIter != exportRows.end(); ++rowIter)
+         string message = writer.getErrorMessage();
+         if (mpProgress != NULL)
          {
-            if (isAborted() == true)
-            {
-               string message = "ENVI export aborted!";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ABORT);
-               }
-
-               pStep->finalize(Message::Abort);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            DimensionDescriptor exportRow = *rowIter;
-            DimensionDescriptor originalRow = pDescriptor->getActiveRow(exportRow.getActiveNumber());
-
-            vector<DimensionDescriptor>::const_iterator bandIter;
-            for (bandIter = exportBands.begin(); bandIter != exportBands.end(); ++bandIter)
-            {
-               DimensionDescriptor exportBand = *bandIter;
-               DimensionDescriptor originalBand = pDescriptor->getActiveBand(exportBand.getActiveNumber());
-
-               FactoryResource<DataRequest> pDataRequest;
-               pDataRequest->setInterleaveFormat(BIL);
-               pDataRequest->setRows(originalRow, originalRow, 1);
-               pDataRequest->setColumns(startColumn, endColumn, exportColumns.size());
-               pDataRequest->setBands(originalBand, originalBand, 1);
-
-               DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-               if (dataAccessor.isValid() == false)
-               {
-                  string message = "The data in the data set could not be accessed.";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ERRORS);
-                  }
-
-                  pStep->finalize(Message::Failure, message);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               dataAccessor->toPixel(originalRow.getActiveNumber(), exportColumns.front().getActiveNumber());
-               if (dataAccessor.isValid() == false)
-               {
-                  string message = "An error occurred when reading the data from the data set.";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ERRORS);
-                  }
-
-                  pStep->finalize(Message::Failure, message);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               void* pData = dataAccessor->getColumn();
-               dataFile.write(pData, exportColumns.size() * bytesPerElement);
-            }
-
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(progressText, (rowIndex++ * 100) / exportRows.size(), NORMAL);
-            }
+            mpProgress->updateProgress(message, 0, ERRORS);
          }
-      }
-      else
-      {
-         // Slowest possible copy, one pixel at a time
-         vector<DimensionDescriptor>::const_iterator rowIter;
-         for (rowIter = exportRows.begin(); rowIter != exportRows.end(); ++rowIter)
-         {
-            if (isAborted() == true)
-            {
-               string message = "ENVI export aborted!";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(message, 0, ABORT);
-               }
 
-               pStep->finalize(Message::Abort);
-               dataFile.close();
-               remove(headerFilename.c_str());
-               remove(dataFilename.c_str());
-               return false;
-            }
-
-            DimensionDescriptor exportRow = *rowIter;
-            DimensionDescriptor originalRow = pDescriptor->getActiveRow(exportRow.getActiveNumber());
-
-            vector<DimensionDescriptor>::const_iterator bandIter;
-            for (bandIter = exportBands.begin(); bandIter != exportBands.end(); ++bandIter)
-            {
-               DimensionDescriptor exportBand = *bandIter;
-               DimensionDescriptor originalBand = pDescriptor->getActiveBand(exportBand.getActiveNumber());
-
-               FactoryResource<DataRequest> pDataRequest;
-               pDataRequest->setInterleaveFormat(BIL);
-               pDataRequest->setRows(originalRow, originalRow, 1);
-               pDataRequest->setColumns(startColumn, endColumn, 1);
-               pDataRequest->setBands(originalBand, originalBand, 1);
-
-               DataAccessor dataAccessor = mpRaster->getDataAccessor(pDataRequest.release());
-               if (dataAccessor.isValid() == false)
-               {
-                  string message = "The data in the data set could not be accessed.";
-                  if (mpProgress != NULL)
-                  {
-                     mpProgress->updateProgress(message, 0, ERRORS);
-                  }
-
-                  pStep->finalize(Message::Failure, message);
-                  dataFile.close();
-                  remove(headerFilename.c_str());
-                  remove(dataFilename.c_str());
-                  return false;
-               }
-
-               vector<DimensionDescriptor>::const_iterator columnIter;
-               for (columnIter = exportColumns.begin(); columnIter != exportColumns.end(); ++columnIter)
-               {
-                  DimensionDescriptor column = *columnIter;
-
-                  dataAccessor->toPixel(originalRow.getActiveNumber(), column.getActiveNumber());
-                  if (dataAccessor.isValid() == false)
-                  {
-                     string message = "An error occurred when reading the data from the data set.";
-                     if (mpProgress != NULL)
-                     {
-                        mpProgress->updateProgress(message, 0, ERRORS);
-                     }
-
-                     pStep->finalize(Message::Failure, message);
-                     dataFile.close();
-                     remove(headerFilename.c_str());
-                     remove(dataFilename.c_str());
-                     return false;
-                  }
-
-                  void* pData = dataAccessor->getColumn();
-                  dataFile.write(pData, bytesPerElement);
-               }
-            }
-
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(progressText, (rowIndex++ * 100) / exportRows.size(), NORMAL);
-            }
-         }
-      }
-   }
-   else
-   {
-      string message = "The interleave format of the data set is not supported.";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(message, 0, ERRORS);
+         pStep->finalize(Message::Failure, message);
       }
 
-      pStep->finalize(Message::Failure, message);
       dataFile.close();
       remove(headerFilename.c_str());
       remove(dataFilename.c_str());
@@ -67,3 +67,13 @@ bool CoordinateTransformation::translateShapeToApp(double xIn, double yIn, doubl
    xOut = xIn;
    return mpShapeToAppTransformation == NULL || mpShapeToAppTransformation->Transform(1, &xOut, &yOut);
 }
+
+bool CoordinateTransformation::translateShapeToApp(int count, double* pX, double* pY) const
+{
+   if (mpShapeToAppTransformation == NULL || count <= 0)
+   {
+      return true;
+   }
+
+   return mpShapeToAppTransformation->Transform(count, pX, pY) != FALSE;
+}
@@ -28,6 +28,9 @@ public:
    bool translateAppToShape(double xIn, double yIn, double& xOut, double& yOut) const;
    bool translateShapeToApp(double xIn, double yIn, double& xOut, double& yOut) const;
 
+   // Transforms the coordinates in place, which is much faster than transforming one point at a time.
+   bool translateShapeToApp(int count, double* pX, double* pY) const;
+
 private:
    OGRCoordinateTransformation* mpAppToShapeTransformation;
    OGRCoordinateTransformation* mpShapeToAppTransformation;
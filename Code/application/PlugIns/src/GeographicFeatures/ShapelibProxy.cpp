@@ -11,12 +11,21 @@
 #include "FormatStringProcessor.h"
 #include "ShapelibProxy.h"
 
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QFileInfo>
 #include <QtCore/QRectF>
 #include <QtCore/QUuid>
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
 namespace
 {
    class ShapelibFormatStringPreprocessor : public ArcProxyLib::FormatStringPreprocessor
@@ -63,6 +72,262 @@ namespace
       const ShapelibProxy::ShapelibHandle& mHandle;
       int mFeature;
    };
+
+   // Evaluates a where clause against the DBF record of a shape so that shapes can be rejected
+   // before their geometry is read. Only a conjunction of simple comparisons is supported, e.g.
+   // NAME = 'Main St' AND LANES >= 2
+   class AttributeFilter
+   {
+   public:
+      AttributeFilter() {}
+
+      bool parse(const ShapelibProxy::ShapelibHandle& handle, const std::string& whereClause,
+         std::string& errorMessage)
+      {
+         mConditions.clear();
+
+         std::vector<std::string> tokens;
+         if (tokenize(whereClause, tokens) == false)
+         {
+            errorMessage = "Unable to parse the where clause";
+            return false;
+         }
+
+         for (std::vector<std::string>::size_type i = 0; i < tokens.size(); i += 4)
+         {
+            if (i + 2 >= tokens.size() ||
+               (i + 3 < tokens.size() && (isAnd(tokens[i + 3]) == false || i + 4 >= tokens.size())))
+            {
+               errorMessage = "Shapelib only supports where clauses of the form FIELD operator value [AND ...]";
+               return false;
+            }
+
+            Condition condition;
+            condition.mField = DBFGetFieldIndex(handle.getDbfHandle(), tokens[i].c_str());
+            if (condition.mField < 0)
+            {
+               errorMessage = "Unknown field " + tokens[i] + " in the where clause";
+               return false;
+            }
+            condition.mType = DBFGetFieldInfo(handle.getDbfHandle(), condition.mField, NULL, NULL, NULL);
+
+            condition.mOperator = tokens[i + 1];
+            if (condition.mOperator == "!=")
+            {
+               condition.mOperator = "<>";
+            }
+            if (condition.mOperator != "=" && condition.mOperator != "<>" && condition.mOperator != "<" &&
+               condition.mOperator != "<=" && condition.mOperator != ">" && condition.mOperator != ">=")
+            {
+               errorMessage = "Unsupported operator " + tokens[i + 1] + " in the where clause";
+               return false;
+            }
+
+            const std::string& value = tokens[i + 2];
+            if (value.empty() == false && value[0] == '\'')
+            {
+               condition.mText = value.substr(1);
+               condition.mNumber = atof(condition.mText.c_str());
+            }
+            else
+            {
+               condition.mText = value;
+               char* pEnd = NULL;
+               condition.mNumber = strtod(value.c_str(), &pEnd);
+               if (value.empty() || *pEnd != '\0')
+               {
+                  errorMessage = "Invalid value " + value + " in the where clause";
+                  return false;
+               }
+            }
+
+            mConditions.push_back(condition);
+         }
+
+         return true;
+      }
+
+      bool matches(const ShapelibProxy::ShapelibHandle& handle, int record) const
+      {
+         for (std::vector<Condition>::const_iterator iter = mConditions.begin(); iter != mConditions.end(); ++iter)
+         {
+            if (DBFIsAttributeNULL(handle.getDbfHandle(), record, iter->mField))
+            {
+               return false;
+            }
+
+            int comparison = 0;
+            if (iter->mType == FTInteger || iter->mType == FTDouble)
+            {
+               double value = DBFReadDoubleAttribute(handle.getDbfHandle(), record, iter->mField);
+               comparison = (value < iter->mNumber ? -1 : (value > iter->mNumber ? 1 : 0));
+            }
+            else
+            {
+               const char* pValue = DBFReadStringAttribute(handle.getDbfHandle(), record, iter->mField);
+               std::string value(pValue == NULL ? "" : pValue);
+               value.erase(value.find_last_not_of(' ') + 1);
+               comparison = value.compare(iter->mText);
+            }
+
+            bool match = false;
+            const std::string& op = iter->mOperator;
+            if (op == "=")
+            {
+               match = (comparison == 0);
+            }
+            else if (op == "<>")
+            {
+               match = (comparison != 0);
+            }
+            else if (op == "<")
+            {
+               match = (comparison < 0);
+            }
+            else if (op == "<=")
+            {
+               match = (comparison <= 0);
+            }
+            else if (op == ">")
+            {
+               match = (comparison > 0);
+            }
+            else
+            {
+               match = (comparison >= 0);
+            }
+
+            if (match == false)
+            {
+               return false;
+            }
+         }
+
+         return true;
+      }
+
+   private:
+      struct Condition
+      {
+         int mField;
+         DBFFieldType mType;
+         std::string mOperator;
+         std::string mText;
+         double mNumber;
+      };
+
+      static bool isAnd(const std::string& token)
+      {
+         return token.size() == 3 && toupper(token[0]) == 'A' && toupper(token[1]) == 'N' &&
+            toupper(token[2]) == 'D';
+      }
+
+      // Splits the clause into field names, operators, numbers and quoted strings. Quoted strings
+      // keep their leading quote so that they can be distinguished from numbers.
+      static bool tokenize(const std::string& clause, std::vector<std::string>& tokens)
+      {
+         std::string::size_type pos = 0;
+         while (pos < clause.size())
+         {
+            char character = clause[pos];
+            if (isspace(static_cast<unsigned char>(character)))
+            {
+               ++pos;
+            }
+            else if (character == '\'' || character == '"')
+            {
+               std::string token;
+               if (character == '\'')
+               {
+                  token += '\'';
+               }
+               for (++pos; ; ++pos)
+               {
+                  if (pos >= clause.size())
+                  {
+                     return false;
+                  }
+                  if (clause[pos] == character)
+                  {
+                     // Two quotes in a row are an escaped quote
+                     if (pos + 1 < clause.size() && clause[pos + 1] == character)
+                     {
+                        token += character;
+                        ++pos;
+                        continue;
+                     }
+                     ++pos;
+                     break;
+                  }
+                  token += clause[pos];
+               }
+               tokens.push_back(token);
+            }
+            else if (strchr("=<>!", character) != NULL)
+            {
+               std::string::size_type end = clause.find_first_not_of("=<>!", pos);
+               tokens.push_back(clause.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+               pos = end;
+            }
+            else
+            {
+               std::string::size_type end = pos;
+               while (end < clause.size() && isspace(static_cast<unsigned char>(clause[end])) == 0 &&
+                  strchr("=<>!'\"", clause[end]) == NULL)
+               {
+                  ++end;
+               }
+               tokens.push_back(clause.substr(pos, end - pos));
+               pos = end;
+            }
+         }
+
+         return true;
+      }
+
+      std::vector<Condition> mConditions;
+   };
+
+   // Finds the bounding box in shapefile coordinates of a clip region in application coordinates.
+   // Points along the edges are transformed since a projection may curve the edges of the region.
+   bool getShapeBounds(const LocationType& minClip, const LocationType& maxClip,
+      const CoordinateTransformation* pCoordinateTransformation,
+      double& minX, double& minY, double& maxX, double& maxY)
+   {
+      const int steps = 8;
+      minX = minY = std::numeric_limits<double>::max();
+      maxX = maxY = -std::numeric_limits<double>::max();
+      for (int i = 0; i <= steps; ++i)
+      {
+         double fraction = static_cast<double>(i) / steps;
+         double lat = minClip.mX + (maxClip.mX - minClip.mX) * fraction;
+         double lon = minClip.mY + (maxClip.mY - minClip.mY) * fraction;
+         double points[4][2] = { { minClip.mY, lat }, { maxClip.mY, lat }, { lon, minClip.mX }, { lon, maxClip.mX } };
+         for (int point = 0; point < 4; ++point)
+         {
+            double x = points[point][0];
+            double y = points[point][1];
+            if (pCoordinateTransformation != NULL &&
+               pCoordinateTransformation->translateAppToShape(x, y, x, y) == false)
+            {
+               return false;
+            }
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+         }
+      }
+
+      // Allow for curvature between the sampled points
+      double marginX = (maxX - minX) * 0.01;
+      double marginY = (maxY - minY) * 0.01;
+      minX -= marginX;
+      maxX += marginX;
+      minY -= marginY;
+      maxY += marginY;
+      return true;
+   }
 }
 
 ShapelibProxy::ShapelibProxy()
@@ -179,9 +444,9 @@ bool ShapelibProxy::query(const std::string &handle, std::string &errorMessage,
    }
    ShapelibHandle& shapelibHandle = iter->second;
 
-   if (!whereClause.empty())
+   AttributeFilter filter;
+   if (!whereClause.empty() && filter.parse(shapelibHandle, whereClause, errorMessage) == false)
    {
-      errorMessage = "Shapelib does not support where clauses";
       return false;
    }
 
@@ -194,8 +459,36 @@ bool ShapelibProxy::query(const std::string &handle, std::string &errorMessage,
       return false;
    }
 
-   for (int i = 0; i < count; ++i)
+   QRectF clipRect(QPointF(minClip.mX, minClip.mY), QPointF(maxClip.mX, maxClip.mY));
+
+   // Use the spatial index to avoid reading the geometry of shapes outside of the clip region
+   std::vector<int> shapes;
+   double minShapeX = 0.0;
+   double minShapeY = 0.0;
+   double maxShapeX = 0.0;
+   double maxShapeY = 0.0;
+   if (clipRect.isEmpty() == true ||
+      getShapeBounds(minClip, maxClip, pCoordinateTransformation, minShapeX, minShapeY, maxShapeX, maxShapeY) == false ||
+      findShapes(shapelibHandle, minShapeX, minShapeY, maxShapeX, maxShapeY, shapes) == false)
+   {
+      shapes.resize(count);
+      for (int i = 0; i < count; ++i)
+      {
+         shapes[i] = i;
+      }
+   }
+
+   int fieldCount = DBFGetFieldCount(shapelibHandle.getDbfHandle());
+   for (std::vector<int>::const_iterator shape = shapes.begin(); shape != shapes.end(); ++shape)
    {
+      int i = *shape;
+
+      // Check the attributes first since reading the DBF record is much cheaper than reading the geometry
+      if (!whereClause.empty() && filter.matches(shapelibHandle, i) == false)
+      {
+         continue;
+      }
+
       SHPObject* pShpObject = SHPReadObject(shapelibHandle.getShpHandle(), i);
       if (pShpObject == NULL)
       {
@@ -213,12 +506,12 @@ bool ShapelibProxy::query(const std::string &handle, std::string &errorMessage,
             pCoordinateTransformation->translateShapeToApp(maxX, maxY, maxX, maxY) == false)
          {
             errorMessage = "Coordinate transformation failed for bounding box. Check the .prj file and try again.";
+            SHPDestroyObject(pShpObject);
             return false;
          }
       }
 
       QRectF objectRect(QPointF(minY, minX), QPointF(maxY, maxX));
-      QRectF clipRect(QPointF(minClip.mX, minClip.mY), QPointF(maxClip.mX, maxClip.mY));
 
       if ((clipRect.isEmpty() == true) ||
          ((objectRect.isEmpty() == true) && (clipRect.contains(objectRect.topLeft()) == true)) ||
@@ -227,22 +520,21 @@ bool ShapelibProxy::query(const std::string &handle, std::string &errorMessage,
          ArcProxyLib::Feature feature;
          feature.setType(featureType);
 
+         // Convert from shapefile coordinates to application coordinates.
+         // All of the vertices are transformed at once since this is much faster than one at a time.
+         if (pCoordinateTransformation != NULL &&
+            pCoordinateTransformation->translateShapeToApp(pShpObject->nVertices, pShpObject->padfX,
+               pShpObject->padfY) == false)
+         {
+            errorMessage = "Coordinate transformation failed for vertex. Check the .prj file and try again.";
+            SHPDestroyObject(pShpObject);
+            return false;
+         }
+
          std::vector<std::pair<double, double> > vertices(pShpObject->nVertices);
          for (int vertex = 0; vertex < pShpObject->nVertices; ++vertex)
          {
-            // Convert from shapefile coordinates to application coordinates.
-            double vertexX = pShpObject->padfX[vertex];
-            double vertexY = pShpObject->padfY[vertex];
-            if (pCoordinateTransformation != NULL)
-            {
-               if (pCoordinateTransformation->translateShapeToApp(vertexX, vertexY, vertexX, vertexY) == false)
-               {
-                  errorMessage = "Coordinate transformation failed for vertex. Check the .prj file and try again.";
-                  return false;
-               }
-            }
-
-            vertices[vertex] = std::make_pair(vertexY, vertexX);
+            vertices[vertex] = std::make_pair(pShpObject->padfY[vertex], pShpObject->padfX[vertex]);
          }
 
          feature.setVertices(vertices);
@@ -256,7 +548,6 @@ bool ShapelibProxy::query(const std::string &handle, std::string &errorMessage,
             shapelibHandle, i)).getProcessedString());
 
          std::vector<std::string> attributes;
-         int fieldCount = DBFGetFieldCount(shapelibHandle.getDbfHandle());
          for (int field = 0; field < fieldCount; ++field)
          {
             std::string name;
@@ -345,6 +636,76 @@ bool ShapelibProxy::getFieldAttributes(const ShapelibHandle &handle, std::string
    return true;
 }
 
+std::string ShapelibProxy::getIndexFilename(const ShapelibHandle &handle)
+{
+   // Use the same name as the .qix files written by the shptree utility
+   QFileInfo fileInfo(QString::fromStdString(handle.getFilename()));
+   QString baseName = fileInfo.fileName();
+   if (fileInfo.suffix().toLower() == "shp")
+   {
+      baseName = fileInfo.completeBaseName();
+   }
+
+   return fileInfo.dir().absoluteFilePath(baseName + ".qix").toStdString();
+}
+
+bool ShapelibProxy::findShapes(ShapelibHandle &handle, double minX, double minY, double maxX, double maxY,
+                               std::vector<int> &shapes)
+{
+   double boundsMin[4] = { minX, minY, 0.0, 0.0 };
+   double boundsMax[4] = { maxX, maxY, 0.0, 0.0 };
+   int count = 0;
+   int* pShapes = NULL;
+
+   if (handle.getTree() == NULL)
+   {
+      // Search the index file if it is at least as new as the shapefile
+      std::string indexFilename = getIndexFilename(handle);
+      QFileInfo indexInfo(QString::fromStdString(indexFilename));
+      QFileInfo shapeInfo(QString::fromStdString(indexFilename.substr(0, indexFilename.size() - 4) + ".shp"));
+      if (indexInfo.exists() == true && indexInfo.lastModified() >= shapeInfo.lastModified())
+      {
+         FILE* pFile = fopen(indexFilename.c_str(), "rb");
+         if (pFile != NULL)
+         {
+            char signature[3] = { 0, 0, 0 };
+            bool valid = (fread(signature, 1, 3, pFile) == 3 && strncmp(signature, "SQT", 3) == 0);
+            if (valid == true)
+            {
+               rewind(pFile);
+               pShapes = SHPSearchDiskTree(pFile, boundsMin, boundsMax, &count);
+            }
+            fclose(pFile);
+
+            if (valid == true)
+            {
+               shapes.assign(pShapes, pShapes + count);
+               free(pShapes);
+               std::sort(shapes.begin(), shapes.end());
+               return true;
+            }
+         }
+      }
+
+      // Build the index and save it for the next time the shapefile is loaded.
+      // The shapefile may be in a read-only directory, so failing to save is not an error.
+      SHPTree* pTree = SHPCreateTree(handle.getShpHandle(), 2, 0, NULL, NULL);
+      if (pTree == NULL)
+      {
+         return false;
+      }
+      SHPTreeTrimExtraNodes(pTree);
+      SHPWriteTree(pTree, indexFilename.c_str());
+      handle.setTree(pTree);
+   }
+
+   pShapes = SHPTreeFindLikelyShapes(handle.getTree(), boundsMin, boundsMax, &count);
+   shapes.assign(pShapes, pShapes + count);
+   free(pShapes);
+   std::sort(shapes.begin(), shapes.end());
+   return true;
+}
+
 std::string ShapelibProxy::preprocessFormatString(const ShapelibHandle &handle, const std::string &formatString)
 {
    if (handle.getDbfHandle() == NULL)
@@ -48,19 +48,23 @@ public:
    class ShapelibHandle
    {
    public:
-      ShapelibHandle() : mShpHandle(NULL), mDbfHandle(NULL)
+      ShapelibHandle() : mShpHandle(NULL), mDbfHandle(NULL), mpTree(NULL)
       {
       }
 
-      ShapelibHandle(const std::string& filename)
+      ShapelibHandle(const std::string& filename) :
+         mFilename(filename),
+         mpTree(NULL)
       {
          mShpHandle = SHPOpen(filename.c_str(), "rb");
          mDbfHandle = DBFOpen(filename.c_str(), "rb");
       }
 
       ShapelibHandle(const ShapelibHandle& rhs) :
+         mFilename(rhs.mFilename),
          mShpHandle(rhs.mShpHandle),
-         mDbfHandle(rhs.mDbfHandle)
+         mDbfHandle(rhs.mDbfHandle),
+         mpTree(rhs.mpTree)
       {
       }
 
@@ -76,6 +80,11 @@ public:
             DBFClose(mDbfHandle);
             mDbfHandle = NULL;
          }
+         if (mpTree != NULL)
+         {
+            SHPDestroyTree(mpTree);
+            mpTree = NULL;
+         }
       }
 
       bool isValid() const
@@ -93,9 +102,27 @@ public:
          return mDbfHandle;
       }
 
+      const std::string& getFilename() const
+      {
+         return mFilename;
+      }
+
+      // The quadtree used to find the shapes within a query's bounding box
+      SHPTree* getTree() const
+      {
+         return mpTree;
+      }
+
+      void setTree(SHPTree* pTree)
+      {
+         mpTree = pTree;
+      }
+
    private:
+      std::string mFilename;
       SHPHandle mShpHandle;
       DBFHandle mDbfHandle;
+      SHPTree* mpTree;
    };
 
    static std::string preprocessFormatString(const ShapelibHandle &handle, 
@@ -104,6 +131,9 @@ public:
       std::string &errorMessage, ArcProxyLib::FeatureType &featureType, int &count);
    static bool getFieldAttributes(const ShapelibHandle &handle, std::string &name, 
       std::string &type, std::string &value, int field, int feature);
+   static std::string getIndexFilename(const ShapelibHandle &handle);
+   static bool findShapes(ShapelibHandle &handle, double minX, double minY, double maxX, double maxY,
+      std::vector<int> &shapes);
 
 signals:
    void featureLoaded(const ArcProxyLib::Feature &feature);
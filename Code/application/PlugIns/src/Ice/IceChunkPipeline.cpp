@@ -0,0 +1,249 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "IceChunkPipeline.h"
+#include "ObjectResource.h"
+#include "RasterElement.h"
+
+#include <zlib.h>
+
+#include <string.h>
+
+namespace
+{
+   enum DimensionRole { ROW_DIMENSION, COLUMN_DIMENSION, BAND_DIMENSION };
+
+   // Returns the position of a raster dimension in the dataset for a given interleave.
+   // BIP datasets are [row, column, band], BIL are [row, band, column] and BSQ are [band, row, column].
+   unsigned int getDatasetDimension(InterleaveFormatType interleave, DimensionRole role)
+   {
+      switch (interleave)
+      {
+      case BIL:
+         return (role == ROW_DIMENSION) ? 0 : (role == BAND_DIMENSION ? 1 : 2);
+      case BSQ:
+         return (role == BAND_DIMENSION) ? 0 : (role == ROW_DIMENSION ? 1 : 2);
+      case BIP:
+      default:
+         return (role == ROW_DIMENSION) ? 0 : (role == COLUMN_DIMENSION ? 1 : 2);
+      }
+   }
+
+   // Equivalent to the HDF5 shuffle filter, which groups the n-th byte of every element together.
+   void shuffle(const char* pSource, char* pDestination, size_t numBytes, unsigned int bytesPerElement)
+   {
+      size_t numElements = numBytes / bytesPerElement;
+      for (unsigned int byteIndex = 0; byteIndex < bytesPerElement; ++byteIndex)
+      {
+         const char* pSourceByte = pSource + byteIndex;
+         char* pDestinationByte = pDestination + byteIndex * numElements;
+         for (size_t element = 0; element < numElements; ++element)
+         {
+            *pDestinationByte++ = *pSourceByte;
+            pSourceByte += bytesPerElement;
+         }
+      }
+
+      // the filter copies trailing bytes which do not form a complete element unchanged
+      size_t leftover = numBytes % bytesPerElement;
+      if (leftover != 0)
+      {
+         memcpy(pDestination + numBytes - leftover, pSource + numBytes - leftover, leftover);
+      }
+   }
+}
+
+IceChunkThread::IceChunkThread(const IceChunkThreadInput& input, int threadCount, int threadIndex,
+                               mta::ThreadReporter& reporter) :
+   mta::AlgorithmThread(threadIndex, reporter),
+   mInput(input),
+   mChunkRange(getThreadRange(threadCount, input.mChunkCount))
+{
+}
+
+void IceChunkThread::run()
+{
+   if (mInput.mpChunks == NULL || mInput.mpCube == NULL)
+   {
+      getReporter().reportError("Invalid chunk input.");
+      return;
+   }
+
+   for (int chunkIndex = mChunkRange.mFirst; chunkIndex <= mChunkRange.mLast; ++chunkIndex)
+   {
+      if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+      {
+         break;
+      }
+
+      IceChunk& chunk = mInput.mpChunks->at(mInput.mFirstChunk + chunkIndex);
+      if (!readChunk(chunk) || !filterChunk(chunk))
+      {
+         return;
+      }
+
+      getReporter().reportProgress(getThreadIndex(), mChunkRange.computePercent(chunkIndex + 1));
+   }
+}
+
+bool IceChunkThread::readChunk(IceChunk& chunk)
+{
+   const std::vector<DimensionDescriptor>& rows = *mInput.mpRows;
+   const std::vector<DimensionDescriptor>& columns = *mInput.mpColumns;
+   const std::vector<DimensionDescriptor>& bands = *mInput.mpBands;
+   const unsigned int bpe = mInput.mBytesPerElement;
+
+   const unsigned int rowDim = getDatasetDimension(mInput.mInterleave, ROW_DIMENSION);
+   const unsigned int columnDim = getDatasetDimension(mInput.mInterleave, COLUMN_DIMENSION);
+   const unsigned int bandDim = getDatasetDimension(mInput.mInterleave, BAND_DIMENSION);
+
+   const unsigned int startRow = static_cast<unsigned int>(chunk.mOffset[rowDim]);
+   const unsigned int numRows = static_cast<unsigned int>(chunk.mCount[rowDim]);
+   const unsigned int startColumn = static_cast<unsigned int>(chunk.mOffset[columnDim]);
+   const unsigned int numColumns = static_cast<unsigned int>(chunk.mCount[columnDim]);
+   const unsigned int startBand = static_cast<unsigned int>(chunk.mOffset[bandDim]);
+   const unsigned int numBands = static_cast<unsigned int>(chunk.mCount[bandDim]);
+
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(mInput.mInterleave);
+   pRequest->setRows(rows[startRow], rows[startRow + numRows - 1]);
+   if (mInput.mInterleave == BSQ)
+   {
+      // BSQ chunks never span more than one band
+      pRequest->setBands(bands[startBand], bands[startBand]);
+   }
+   DataAccessor da = mInput.mpCube->getDataAccessor(pRequest.release());
+   if (!da.isValid())
+   {
+      getReporter().reportError("Unable to access the cube data.");
+      return false;
+   }
+
+   // Byte offsets of each exported column and band within a row returned by the accessor
+   size_t columnStride = bpe;
+   size_t bandStride = 0;
+   if (mInput.mInterleave == BIP)
+   {
+      columnStride = mInput.mCubeBandCount * bpe;
+      bandStride = bpe;
+   }
+   else if (mInput.mInterleave == BIL)
+   {
+      bandStride = mInput.mCubeColumnCount * bpe;
+   }
+
+   std::vector<size_t> columnOffsets(numColumns);
+   for (unsigned int column = 0; column < numColumns; ++column)
+   {
+      columnOffsets[column] = columns[startColumn + column].getActiveNumber() * columnStride;
+   }
+   std::vector<size_t> bandOffsets(numBands);
+   for (unsigned int band = 0; band < numBands; ++band)
+   {
+      bandOffsets[band] = bands[startBand + band].getActiveNumber() * bandStride;
+   }
+
+   // The innermost dataset dimension is copied in runs, the other non-row dimension is iterated.
+   const bool bandsInner = (bandDim == 2);
+   const std::vector<size_t>& innerOffsets = bandsInner ? bandOffsets : columnOffsets;
+   const std::vector<size_t>& outerOffsets = bandsInner ? columnOffsets : bandOffsets;
+   bool innerContiguous = true;
+   for (size_t index = 1; index < innerOffsets.size() && innerContiguous; ++index)
+   {
+      innerContiguous = (innerOffsets[index] == innerOffsets[index - 1] + bpe);
+   }
+
+   const hsize_t* pDims = mInput.mChunkDimensions;
+   const size_t strides[3] = { pDims[1] * pDims[2] * bpe, pDims[2] * bpe, bpe };
+   const size_t rowStep = strides[rowDim];
+   const size_t outerStep = strides[bandsInner ? columnDim : bandDim];
+   const size_t innerBytes = innerOffsets.size() * bpe;
+
+   // Edge chunks are padded with zeros to the full chunk size
+   chunk.mData.assign(static_cast<size_t>(pDims[0] * pDims[1] * pDims[2] * bpe), 0);
+   chunk.mFiltered = false;
+   char* pChunk = &chunk.mData.front();
+
+   for (unsigned int row = 0; row < numRows; ++row)
+   {
+      da->toPixel(rows[startRow + row].getActiveNumber(), 0);
+      if (!da.isValid())
+      {
+         getReporter().reportError("Unable to access the cube data.");
+         return false;
+      }
+
+      const char* pRow = static_cast<const char*>(da->getRow());
+      char* pDestination = pChunk + row * rowStep;
+      for (std::vector<size_t>::const_iterator outer = outerOffsets.begin(); outer != outerOffsets.end(); ++outer)
+      {
+         const char* pSource = pRow + *outer;
+         if (innerContiguous)
+         {
+            memcpy(pDestination, pSource + innerOffsets.front(), innerBytes);
+         }
+         else
+         {
+            char* pElement = pDestination;
+            for (std::vector<size_t>::const_iterator inner = innerOffsets.begin();
+               inner != innerOffsets.end(); ++inner)
+            {
+               memcpy(pElement, pSource + *inner, bpe);
+               pElement += bpe;
+            }
+         }
+         pDestination += outerStep;
+      }
+   }
+
+   return true;
+}
+
+bool IceChunkThread::filterChunk(IceChunk& chunk)
+{
+   if (!mInput.mShuffle && mInput.mDeflateLevel < 0)
+   {
+      return true;
+   }
+
+   if (mInput.mShuffle)
+   {
+      mShuffleBuffer.resize(chunk.mData.size());
+      shuffle(&chunk.mData.front(), &mShuffleBuffer.front(), chunk.mData.size(), mInput.mBytesPerElement);
+      chunk.mData.swap(mShuffleBuffer);
+   }
+
+   if (mInput.mDeflateLevel >= 0)
+   {
+      // The HDF5 deflate filter stores zlib streams, which is what compress2() creates
+      uLong sourceLength = static_cast<uLong>(chunk.mData.size());
+      uLongf compressedLength = compressBound(sourceLength);
+      std::vector<char> compressed(compressedLength);
+      int status = compress2(reinterpret_cast<Bytef*>(&compressed.front()), &compressedLength,
+         reinterpret_cast<const Bytef*>(&chunk.mData.front()), sourceLength, mInput.mDeflateLevel);
+      if (status != Z_OK)
+      {
+         getReporter().reportError("Unable to compress the cube data.");
+         return false;
+      }
+      compressed.resize(compressedLength);
+      chunk.mData.swap(compressed);
+   }
+
+   chunk.mFiltered = true;
+   return true;
+}
+
+bool IceChunkThreadOutput::compileOverallResults(const std::vector<IceChunkThread*>& threads)
+{
+   return true;
+}
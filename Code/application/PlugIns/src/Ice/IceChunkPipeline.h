@@ -0,0 +1,112 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef ICECHUNKPIPELINE_H
+#define ICECHUNKPIPELINE_H
+
+#include "DimensionDescriptor.h"
+#include "MultiThreadedAlgorithm.h"
+#include "TypesFile.h"
+
+#include <hdf5.h>
+#include <vector>
+
+class RasterElement;
+
+// H5DOwrite_chunk() was added to the HDF5 high level library in 1.8.11. Older libraries
+// fall back to H5Dwrite() and apply the filter pipeline in the writing thread.
+#if H5_VERS_MAJOR > 1 || (H5_VERS_MAJOR == 1 && (H5_VERS_MINOR > 8 || (H5_VERS_MINOR == 8 && H5_VERS_RELEASE >= 11)))
+#define ICE_DIRECT_CHUNK_WRITE
+#endif
+
+/**
+ * A single chunk of the cube dataset.
+ */
+struct IceChunk
+{
+   IceChunk() :
+      mFiltered(false)
+   {
+      mOffset[0] = mOffset[1] = mOffset[2] = 0;
+      mCount[0] = mCount[1] = mCount[2] = 0;
+   }
+
+   hsize_t mOffset[3];        // position of the chunk in dataset coordinates
+   hsize_t mCount[3];         // valid extent of the chunk, smaller than the chunk dimensions along the dataset edge
+   std::vector<char> mData;   // chunk contents in dataset order padded to the full chunk dimensions
+   bool mFiltered;            // true if mData has been run through the shuffle and deflate filters
+};
+
+struct IceChunkThreadInput
+{
+   IceChunkThreadInput() :
+      mpCube(NULL),
+      mInterleave(BIP),
+      mpRows(NULL),
+      mpColumns(NULL),
+      mpBands(NULL),
+      mCubeColumnCount(0),
+      mCubeBandCount(0),
+      mBytesPerElement(0),
+      mShuffle(false),
+      mDeflateLevel(-1),
+      mpChunks(NULL),
+      mFirstChunk(0),
+      mChunkCount(0),
+      mpAbortFlag(NULL)
+   {
+      mChunkDimensions[0] = mChunkDimensions[1] = mChunkDimensions[2] = 1;
+   }
+
+   RasterElement* mpCube;
+   InterleaveFormatType mInterleave;
+   const std::vector<DimensionDescriptor>* mpRows;
+   const std::vector<DimensionDescriptor>* mpColumns;
+   const std::vector<DimensionDescriptor>* mpBands;
+   unsigned int mCubeColumnCount;
+   unsigned int mCubeBandCount;
+   unsigned int mBytesPerElement;
+   hsize_t mChunkDimensions[3];
+   bool mShuffle;
+   int mDeflateLevel;         // a negative value disables the deflate filter
+   std::vector<IceChunk>* mpChunks;
+   unsigned int mFirstChunk;  // the batch of chunks to be processed
+   unsigned int mChunkCount;
+   const bool* mpAbortFlag;
+};
+
+/**
+ * Reads, shuffles and deflates a range of chunks so the writing thread only
+ * needs to store the finished chunks in the file.
+ */
+class IceChunkThread : public mta::AlgorithmThread
+{
+public:
+   IceChunkThread(const IceChunkThreadInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter);
+   virtual ~IceChunkThread() {}
+
+   void run();
+
+private:
+   IceChunkThread& operator=(const IceChunkThread& rhs);
+
+   bool readChunk(IceChunk& chunk);
+   bool filterChunk(IceChunk& chunk);
+
+   const IceChunkThreadInput& mInput;
+   mta::AlgorithmThread::Range mChunkRange;
+   std::vector<char> mShuffleBuffer;
+};
+
+struct IceChunkThreadOutput
+{
+   bool compileOverallResults(const std::vector<IceChunkThread*>& threads);
+};
+
+#endif
@@ -79,6 +79,7 @@ bool IceExporterShell::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArg
       if (mpOptionsWidget.get() != NULL)
       {
          writer.setChunkSize(mpOptionsWidget->getChunkSize() * 1024 * 1024);
+         writer.setChunkLayout(mpOptionsWidget->getChunkLayout());
          writer.setCompressionType(mpOptionsWidget->getCompressionType());
          writer.setGzipCompressionLevel(mpOptionsWidget->getGzipCompressionLevel());
       }
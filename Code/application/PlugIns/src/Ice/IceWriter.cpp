@@ -11,6 +11,7 @@
 #include "BadValues.h"
 #include "Classification.h"
 #include "ColorType.h"
+#include "ConfigurationSettings.h"
 #include "DataAccessor.h"
 #include "DataAccessorImpl.h"
 #include "DataRequest.h"
@@ -18,6 +19,7 @@
 #include "DynamicObject.h"
 #include "Hdf5IncrementalWriter.h"
 #include "Hdf5Utilities.h"
+#include "IceChunkPipeline.h"
 #include "IceWriter.h"
 #include "Layer.h"
 #include "ObjectResource.h"
@@ -38,7 +40,14 @@
 #undef VERSION // Ensure no compile errors due to HDF5 headers
 #include "xmlwriter.h"
 
+#if defined(ICE_DIRECT_CHUNK_WRITE)
+#include <hdf5_hl.h>
+#endif
+
+#include <QtCore/QTime>
+
 #include <iomanip>
+#include <math.h>
 #include <sstream>
 
 using namespace std;
@@ -77,6 +86,12 @@ ADD_ENUM_MAPPING(NONE, "None", "none")
 ADD_ENUM_MAPPING(GZIP, "GZIP", "gzip")
 ADD_ENUM_MAPPING(SHUFFLE_AND_GZIP, "Shuffle+GZIP", "shuffle_gzip")
 END_ENUM_MAPPING()
+
+BEGIN_ENUM_MAPPING(IceChunkLayoutType)
+ADD_ENUM_MAPPING(ROW_STRIPS, "Row Strips", "row_strips")
+ADD_ENUM_MAPPING(TILES, "Tiles", "tiles")
+ADD_ENUM_MAPPING(BAND_PLANAR, "Band Planar", "band_planar")
+END_ENUM_MAPPING()
 }
 
 IceWriter::IceWriter(hid_t fileHandle, IceUtilities::FileType fileType) :
@@ -84,6 +99,7 @@ IceWriter::IceWriter(hid_t fileHandle, IceUtilities::FileType fileType) :
    mAborted(false),
    mFileType(fileType),
    mChunkSize(std::max(IceWriter::getSettingChunkSize(), 1) * 1024 * 1024), // convert from MB to bytes
+   mChunkLayout(StringUtilities::fromXmlString<IceChunkLayoutType>(IceWriter::getSettingChunkLayout())),
    mCompressionType(StringUtilities::fromXmlString<IceCompressionType>(IceWriter::getSettingCompressionType())),
    mGzipCompressionLevel(std::max(std::min(IceWriter::getSettingGzipCompressionLevel(), 9), 0))
 {
@@ -124,18 +140,7 @@ void IceWriter::writeCube(const string& hdfPath,
    const vector<DimensionDescriptor>& cols = pOutputFileDescriptor->getColumns();
 
    Hdf5DataSetResource dataId;
-   if (interleave == BIL)
-   {
-      writeBilCubeData(cubePath, pCube, pOutputFileDescriptor, dataId, pProgress);
-   }
-   else if (interleave == BIP)
-   {
-      writeBipCubeData(cubePath, pCube, pOutputFileDescriptor, dataId, pProgress);
-   }
-   else if (interleave == BSQ)
-   {
-      writeBsqCubeData(cubePath, pCube, pOutputFileDescriptor, dataId, pProgress);
-   }
+   writeCubeData(cubePath, pCube, pOutputFileDescriptor, dataId, pProgress);
 
    abortIfNecessary();
 
@@ -576,11 +581,11 @@ void IceWriter::writeDynamicObject(const DynamicObject* pDynObj,
    }
 }
 
-void IceWriter::writeBilCubeData(const std::string& hdfPath,
-                                 RasterElement* pCube,
-                                 const RasterFileDescriptor* pOutputFileDescriptor,
-                                 Hdf5DataSetResource& dataId,
-                                 Progress* pProgress)
+void IceWriter::writeCubeData(const std::string& hdfPath,
+                              RasterElement* pCube,
+                              const RasterFileDescriptor* pOutputFileDescriptor,
+                              Hdf5DataSetResource& dataId,
+                              Progress* pProgress)
 {
    RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pCube->getDataDescriptor());
    ICEVERIFY(pDescriptor != NULL);
@@ -588,491 +593,202 @@ void IceWriter::writeBilCubeData(const std::string& hdfPath,
    const vector<DimensionDescriptor>& rows = pOutputFileDescriptor->getRows();
    const vector<DimensionDescriptor>& cols = pOutputFileDescriptor->getColumns();
 
-   const vector<DimensionDescriptor>& cubeBands = pDescriptor->getBands();
-   const vector<DimensionDescriptor>& cubeCols = pDescriptor->getColumns();
+   ICEVERIFY_MSG(!rows.empty() && !cols.empty() && !bands.empty(), "No data selected for export.")
 
+   InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
    unsigned int bpe = pDescriptor->getBytesPerElement();
 
-   ICEVERIFY_MSG(!rows.empty() && !cols.empty() && !bands.empty(), "No data selected for export.")
-
-   // set up the dataspace for the amount of data to read in
-   hsize_t offset[3] = {0}; // the start offset to read in the file
-   hsize_t counts[3] = {1, 1, 1}; // how much data to read at a time
    hsize_t dimSpace[3];
-   hsize_t compSpace[3];
-
-   dimSpace[0] = rows.size();
-   compSpace[1] = dimSpace[1] = bands.size();
-   compSpace[2] = dimSpace[2] = cols.size();
-
-   unsigned int rowSize = cols.size() * bands.size() * bpe;
-   unsigned int rowsInChunk = mChunkSize/rowSize; // determine number of rows that fit into a 1MB chunk
-   if (rowsInChunk > rows.size())
-   {
-      rowsInChunk = rows.size();
-   }
-   if (rowsInChunk == 0)
+   switch (interleave)
    {
-      rowsInChunk = 1;
+   case BIL:
+      dimSpace[0] = rows.size();
+      dimSpace[1] = bands.size();
+      dimSpace[2] = cols.size();
+      break;
+   case BSQ:
+      dimSpace[0] = bands.size();
+      dimSpace[1] = rows.size();
+      dimSpace[2] = cols.size();
+      break;
+   case BIP:
+      dimSpace[0] = rows.size();
+      dimSpace[1] = cols.size();
+      dimSpace[2] = bands.size();
+      break;
+   default:
+      ICEVERIFY_MSG(false, "Unsupported interleave format");
    }
-   compSpace[0] = rowsInChunk;
 
-   createDatasetForCube(dimSpace, compSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId);
+   hsize_t chunkSpace[3];
+   computeChunkDimensions(interleave, rows.size(), cols.size(), bands.size(), bpe, chunkSpace);
+
+   bool chunked = createDatasetForCube(dimSpace, chunkSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId);
    Hdf5DataSpaceResource dspaceId(H5Dget_space(*dataId));
    ICEVERIFY(*dspaceId >= 0);
    Hdf5TypeResource hdfEncoding(H5Dget_type(*dataId));
    ICEVERIFY(*hdfEncoding >= 0);
 
-   FactoryResource<DataRequest> pRequest;
-   pRequest->setInterleaveFormat(BIL);
-   pRequest->setRows(rows.front(), rows.back());
-   DataAccessor da = pCube->getDataAccessor(pRequest.release());
-   ICEVERIFY(da.isValid());
-
-   bool bEntireRow = (cubeCols.size() == cols.size()) && (cubeBands.size() == bands.size());
-
-   vector<char> pWriteBufferRes(rowsInChunk*rowSize, 0);
-   char* pWriteBuffer = &pWriteBufferRes.front();
-
-   counts[0] = rowsInChunk;
-   counts[1] = bands.size();
-   counts[2] = cols.size();
-
-   Hdf5DataSpaceResource mspaceId(H5Screate_simple(3, counts, NULL));
-   ICEVERIFY(*mspaceId >= 0);
-   offset[1] = offset[2] = 0; // reset to beginning of rows and bands
-
-   unsigned int numChunks = rows.size() / rowsInChunk;
-   if (rows.size() % rowsInChunk != 0)
-   {
-      numChunks++;
-   }
-
-   abortIfNecessary();
-
-   int rowIndex = 0;
-   if (bEntireRow)
-   {
-      for (unsigned int chunkNumber = 0; chunkNumber < numChunks; ++chunkNumber)
-      {
-         unsigned int startChunkRow = chunkNumber * rowsInChunk;
-         unsigned int endChunkRow = (chunkNumber + 1) * rowsInChunk;
-         if (endChunkRow > rows.size())
-         {
-            endChunkRow = rows.size();
-         }
-
-         char* pBuffer = pWriteBuffer;
-         for (unsigned int rowCount = startChunkRow; rowCount < endChunkRow; ++rowCount)
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Exporting cube...",
-                  (rowIndex++ * 100) / rows.size(), NORMAL);
-            }
-
-            unsigned int rowActiveNum = rows[rowCount].getActiveNumber();
-            da->toPixel(rowActiveNum, 0);
-            ICEVERIFY(da.isValid());
-            memcpy(pBuffer, da->getRow(), rowSize);
-            pBuffer += rowSize;
-
-            abortIfNecessary();
-         }
-
-         offset[0] = startChunkRow;
-
-         if (chunkNumber + 1 == numChunks)
-         {
-            counts[0] = endChunkRow - startChunkRow;
-            mspaceId = Hdf5DataSpaceResource(H5Screate_simple(3, counts, NULL));
-            ICEVERIFY(*mspaceId >= 0);
-         }
-
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
-
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
-      }
-   }
-   else
+   // When the chunks can be stored directly, the worker threads apply the filter pipeline and
+   // the filtered chunks bypass the HDF5 filters. Otherwise the threads only gather the data.
+   bool directWrite = false;
+#if defined(ICE_DIRECT_CHUNK_WRITE)
+   directWrite = chunked;
+#endif
+
+   IceChunkThreadInput input;
+   input.mpCube = pCube;
+   input.mInterleave = interleave;
+   input.mpRows = &rows;
+   input.mpColumns = &cols;
+   input.mpBands = &bands;
+   input.mCubeColumnCount = pDescriptor->getColumnCount();
+   input.mCubeBandCount = pDescriptor->getBandCount();
+   input.mBytesPerElement = bpe;
+   input.mChunkDimensions[0] = chunkSpace[0];
+   input.mChunkDimensions[1] = chunkSpace[1];
+   input.mChunkDimensions[2] = chunkSpace[2];
+   input.mShuffle = directWrite && mCompressionType == SHUFFLE_AND_GZIP;
+   input.mDeflateLevel = (directWrite && mCompressionType != NONE) ? mGzipCompressionLevel : -1;
+   input.mpAbortFlag = &mAborted;
+
+   vector<IceChunk> chunks;
+   for (hsize_t offset0 = 0; offset0 < dimSpace[0]; offset0 += chunkSpace[0])
    {
-      unsigned int totalColumns = cubeCols.size();
-      for (unsigned int chunkNumber = 0; chunkNumber < numChunks; ++chunkNumber)
+      for (hsize_t offset1 = 0; offset1 < dimSpace[1]; offset1 += chunkSpace[1])
       {
-         unsigned int startChunkRow = chunkNumber * rowsInChunk;
-         unsigned int endChunkRow = (chunkNumber + 1) * rowsInChunk;
-         if (endChunkRow > rows.size())
-         {
-            endChunkRow = rows.size();
-         }
-
-         char* pBuffer = pWriteBuffer;
-         for (unsigned int rowCount = startChunkRow; rowCount < endChunkRow; ++rowCount)
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Exporting cube...",
-                  (rowIndex++ * 100) / rows.size(), NORMAL);
-            }
-
-            unsigned int rowActiveNum = rows[rowCount].getActiveNumber();
-            da->toPixel(rowActiveNum, 0);
-            ICEVERIFY(da.isValid());
-            
-            for (unsigned int bandCount = 0; bandCount < bands.size(); ++bandCount)
-            {
-               unsigned int bandActiveNum = bands[bandCount].getActiveNumber();
-               for (unsigned int colCount = 0; colCount < cols.size(); ++colCount)
-               {
-                  unsigned int colActiveNum = cols[colCount].getActiveNumber();
-                  memcpy(pBuffer, static_cast<char*>(da->getColumn()) +
-                     (bandActiveNum * totalColumns * bpe) + (colActiveNum * bpe), bpe);
-                  pBuffer += bpe;
-               }
-            }
-
-            abortIfNecessary();
-         }
-
-         offset[0] = startChunkRow;
-
-         if (chunkNumber + 1 == numChunks)
+         for (hsize_t offset2 = 0; offset2 < dimSpace[2]; offset2 += chunkSpace[2])
          {
-            counts[0] = endChunkRow - startChunkRow;
-            mspaceId = Hdf5DataSpaceResource(H5Screate_simple(3, counts, NULL));
-            ICEVERIFY(*mspaceId >= 0);
+            IceChunk chunk;
+            chunk.mOffset[0] = offset0;
+            chunk.mOffset[1] = offset1;
+            chunk.mOffset[2] = offset2;
+            chunk.mCount[0] = std::min(chunkSpace[0], dimSpace[0] - offset0);
+            chunk.mCount[1] = std::min(chunkSpace[1], dimSpace[1] - offset1);
+            chunk.mCount[2] = std::min(chunkSpace[2], dimSpace[2] - offset2);
+            chunks.push_back(chunk);
          }
-
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
-
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
       }
    }
-}
-
-void IceWriter::writeBipCubeData(const string& hdfPath,
-                                 RasterElement* pCube,
-                                 const RasterFileDescriptor* pOutputFileDescriptor,
-                                 Hdf5DataSetResource& dataId,
-                                 Progress* pProgress)
-{
-   RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pCube->getDataDescriptor());
-   ICEVERIFY(pDescriptor != NULL)
-   const vector<DimensionDescriptor>& bands = pOutputFileDescriptor->getBands();
-   const vector<DimensionDescriptor>& rows = pOutputFileDescriptor->getRows();
-   const vector<DimensionDescriptor>& cols = pOutputFileDescriptor->getColumns();
-
-   const vector<DimensionDescriptor>& cubeBands = pDescriptor->getBands();
-   const vector<DimensionDescriptor>& cubeCols = pDescriptor->getColumns();
-
-   unsigned int bpe = pDescriptor->getBytesPerElement();
-
-   ICEVERIFY_MSG(!rows.empty() && !cols.empty() && !bands.empty(), "No data selected for export.")
-
-   // set up the dataspace for the amount of data to read in
-   hsize_t offset[3] = {0}; // the start offset to read in the file
-   hsize_t counts[3] = {1, 1, 1}; // how much data to read at a time
-   hsize_t dimSpace[3];
-   hsize_t compSpace[3];
-
-   dimSpace[0] = rows.size();
-   dimSpace[1] = cols.size();
-   dimSpace[2] = bands.size();
-   compSpace[1] = cols.size();
-   compSpace[2] = bands.size();
-
-   unsigned int rowSize = cols.size() * bands.size() * bpe;
-   unsigned int rowsInChunk = mChunkSize/rowSize; // determine number of rows that fit into a chunk
-   if (rowsInChunk > rows.size())
-   {
-      rowsInChunk = rows.size();
-   }
-   if (rowsInChunk == 0)
-   {
-      rowsInChunk = 1;
-   }
-   compSpace[0] = rowsInChunk;
+   input.mpChunks = &chunks;
 
-   createDatasetForCube(dimSpace, compSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId );
-   Hdf5DataSpaceResource dspaceId(H5Dget_space(*dataId));
-   ICEVERIFY(*dspaceId >= 0);
-   Hdf5TypeResource hdfEncoding(H5Dget_type(*dataId));
-   ICEVERIFY(*hdfEncoding >= 0);
-
-   FactoryResource<DataRequest> pRequest;
-   pRequest->setInterleaveFormat(BIP);
-   pRequest->setRows(rows.front(), rows.back());
-   DataAccessor da = pCube->getDataAccessor(pRequest.release());
-   ICEVERIFY(da.isValid());
-
-   bool bEntireRow = (cubeCols.size() == cols.size()) && (cubeBands.size() == bands.size());
-
-   vector<char> pWriteBufferRes(rowsInChunk*rowSize, 0);
-   char* pWriteBuffer = &pWriteBufferRes.front();
-
-   counts[0] = rowsInChunk;
-   counts[1] = cols.size();
-   counts[2] = bands.size();
-
-   Hdf5DataSpaceResource mspaceId(H5Screate_simple(3, counts, NULL));
+   // Every chunk buffer has the full chunk dimensions, edge chunks select only their valid extent
+   Hdf5DataSpaceResource mspaceId(H5Screate_simple(3, chunkSpace, NULL));
    ICEVERIFY(*mspaceId >= 0);
-   offset[1] = 0;
-   offset[2] = 0; // reset to beginning of rows and bands
-
-   unsigned int numChunks = rows.size() / rowsInChunk;
-   if (rows.size() % rowsInChunk != 0)
-   {
-      numChunks++;
-   }
 
    abortIfNecessary();
 
-   int rowIndex = 0;
-   if (bEntireRow)
+   // Each batch gives every thread one chunk to read and compress; the chunks are then written
+   // in order by this thread so the file layout does not depend on the thread count.
+   unsigned int batchSize = std::max(ConfigurationSettings::getSettingThreadCount(), 1U);
+   double bytesWritten = 0.0;
+   QTime timer;
+   timer.start();
+   for (unsigned int firstChunk = 0; firstChunk < chunks.size(); firstChunk += batchSize)
    {
-      for (unsigned int chunkNumber = 0; chunkNumber < numChunks; ++chunkNumber)
-      {
-         unsigned int startChunkRow = chunkNumber * rowsInChunk;
-         unsigned int endChunkRow = (chunkNumber + 1) * rowsInChunk;
-         if (endChunkRow > rows.size())
-         {
-            endChunkRow = rows.size();
-         }
-
-         char* pBuffer = pWriteBuffer;
-         for (unsigned int rowCount = startChunkRow; rowCount < endChunkRow; ++rowCount)
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Exporting cube...",
-                  (rowIndex++ * 100) / rows.size(), NORMAL);
-            }
-
-            unsigned int rowActiveNum = rows[rowCount].getActiveNumber();
-            da->toPixel( rowActiveNum, 0 );
-            ICEVERIFY(da.isValid());
-            memcpy(pBuffer, da->getRow(), rowSize);
-            pBuffer += rowSize;
-            
-            abortIfNecessary();
-         }
-
-         offset[0] = startChunkRow;
-
-         if (chunkNumber + 1 == numChunks)
-         {
-            counts[0] = endChunkRow - startChunkRow;
-            mspaceId = Hdf5DataSpaceResource(H5Screate_simple(3, counts, NULL));
-            ICEVERIFY(*mspaceId >= 0);
-         }
+      input.mFirstChunk = firstChunk;
+      input.mChunkCount = std::min(batchSize, static_cast<unsigned int>(chunks.size()) - firstChunk);
 
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
+      IceChunkThreadOutput output;
+      mta::MultiThreadedAlgorithm<IceChunkThreadInput, IceChunkThreadOutput, IceChunkThread>
+         alg(mta::getNumRequiredThreads(input.mChunkCount), input, output, NULL);
+      mta::Result result = alg.run();
+      abortIfNecessary();
+      ICEVERIFY_MSG(result == mta::SUCCESS, alg.getErrorText());
 
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
-
-
-      }
-   }
-   else
-   {
-      for (unsigned int chunkNumber = 0; chunkNumber < numChunks; ++chunkNumber)
+      for (unsigned int chunkIndex = firstChunk; chunkIndex < firstChunk + input.mChunkCount; ++chunkIndex)
       {
-         unsigned int startChunkRow = chunkNumber * rowsInChunk;
-         unsigned int endChunkRow = (chunkNumber + 1) * rowsInChunk;
-         if (endChunkRow > rows.size())
-         {
-            endChunkRow = rows.size();
-         }
-
-         char* pBuffer = pWriteBuffer;
-         for (unsigned int rowCount = startChunkRow; rowCount < endChunkRow; ++rowCount)
+         IceChunk& chunk = chunks[chunkIndex];
+         ICEVERIFY(!chunk.mData.empty());
+         herr_t status = -1;
+#if defined(ICE_DIRECT_CHUNK_WRITE)
+         if (directWrite)
          {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Exporting cube...",
-                  (rowIndex++ * 100) / rows.size(), NORMAL);
-            }
-
-            for (unsigned int colCount = 0; colCount < cols.size(); ++colCount)
-            {
-               unsigned int rowActiveNum = rows[rowCount].getActiveNumber();
-               unsigned int colActiveNum = cols[colCount].getActiveNumber();
-               da->toPixel( rowActiveNum, colActiveNum );
-               ICEVERIFY(da.isValid());
-
-               for (unsigned int bandCount = 0; bandCount < bands.size(); ++bandCount)
-               {
-                  unsigned int bandActiveNum = bands[bandCount].getActiveNumber();
-                  memcpy(pBuffer,
-                     static_cast<char*>(da->getColumn())+(bandActiveNum*bpe), bpe);
-                  pBuffer += bpe;
-               }
-            }
-
-            abortIfNecessary();
+            status = H5DOwrite_chunk(*dataId, H5P_DEFAULT, 0, chunk.mOffset, chunk.mData.size(), &chunk.mData.front());
          }
-
-         offset[0] = startChunkRow;
-
-         if (chunkNumber + 1 == numChunks)
+         else
+#endif
          {
-            counts[0] = endChunkRow - startChunkRow;
-            mspaceId = Hdf5DataSpaceResource(H5Screate_simple(3, counts, NULL));
-            ICEVERIFY(*mspaceId >= 0);
+            hsize_t memoryOffset[3] = {0, 0, 0};
+            status = H5Sselect_hyperslab(*mspaceId, H5S_SELECT_SET, memoryOffset, NULL, chunk.mCount, NULL);
+            ICEVERIFY(status >= 0);
+            status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, chunk.mOffset, NULL, chunk.mCount, NULL);
+            ICEVERIFY(status >= 0);
+            status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, &chunk.mData.front());
          }
-
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
          ICEVERIFY(status >= 0);
 
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
+         bytesWritten += static_cast<double>(chunk.mCount[0] * chunk.mCount[1] * chunk.mCount[2] * bpe);
+         vector<char>().swap(chunk.mData);
+      }
+
+      if (pProgress != NULL)
+      {
+         double seconds = std::max(timer.elapsed(), 1) / 1000.0;
+         stringstream message;
+         message << "Exporting cube (" << fixed << setprecision(1) << bytesWritten / seconds / (1024.0 * 1024.0)
+                 << " MB/s)...";
+         pProgress->updateProgress(message.str(), ((firstChunk + input.mChunkCount) * 100) / chunks.size(), NORMAL);
       }
    }
 }
 
-void IceWriter::writeBsqCubeData(const string& hdfPath,
-                                 RasterElement* pCube,
-                                 const RasterFileDescriptor* pOutputFileDescriptor,
-                                 Hdf5DataSetResource& dataId,
-                                 Progress* pProgress)
+void IceWriter::computeChunkDimensions(InterleaveFormatType interleave, hsize_t numRows, hsize_t numColumns,
+                                       hsize_t numBands, unsigned int bytesPerElement, hsize_t chunkSpace[3]) const
 {
-   RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pCube->getDataDescriptor());
-   ICEVERIFY(pDescriptor != NULL);
-   const vector<DimensionDescriptor>& bands = pOutputFileDescriptor->getBands();
-   const vector<DimensionDescriptor>& rows = pOutputFileDescriptor->getRows();
-   const vector<DimensionDescriptor>& cols = pOutputFileDescriptor->getColumns();
-
-   unsigned int bpe = pDescriptor->getBytesPerElement();
-
-   ICEVERIFY_MSG(!rows.empty() && !cols.empty() && !bands.empty(), "No data selected for export.")
+   hsize_t chunkBytes = static_cast<hsize_t>(std::max(mChunkSize, 1));
 
-   // set up the dataspace for the amount of data to read in
-   hsize_t offset[3] = {0}; // the start offset to read in the file
-   hsize_t counts[3] = {1, 1, 1}; // how much data to read at a time
-   hsize_t dimSpace[3] = {1, 1, 1}; // define a memory dataspace that expresses how much of the file will be read
-
-   hsize_t compSpace[3] = {1, 1, 1};
-
-   dimSpace[0] = bands.size();
-   dimSpace[1] = rows.size();
-   dimSpace[2] = cols.size();
-
-   // compress in chunks
-   compSpace[0] = 1;
-   counts[0] = 1; //only try to fit 1 band into a chunk
-   compSpace[2] = cols.size();
-   counts[2] = cols.size();
-
-   unsigned int rowSize = cols.size() * bpe;
-   unsigned int rowsInChunk = mChunkSize/rowSize; // determine number of rows that fit into a chunk
-   if (rowsInChunk > rows.size())
+   // BSQ chunks always contain a single band
+   hsize_t chunkBands = numBands;
+   if (interleave == BSQ || mChunkLayout == BAND_PLANAR)
    {
-      rowsInChunk = rows.size();
+      chunkBands = 1;
    }
-   if (rowsInChunk == 0)
+
+   hsize_t chunkRows = 1;
+   hsize_t chunkColumns = numColumns;
+   hsize_t pixelBytes = chunkBands * bytesPerElement;
+   if (mChunkLayout == TILES)
    {
-      rowsInChunk = 1;
+      // square tiles unless the image is too narrow, in which case the tiles get taller
+      hsize_t pixelsInChunk = std::max<hsize_t>(chunkBytes / pixelBytes, 1);
+      hsize_t tileSize = std::max<hsize_t>(static_cast<hsize_t>(sqrt(static_cast<double>(pixelsInChunk))), 1);
+      chunkColumns = std::min(tileSize, numColumns);
+      chunkRows = std::max<hsize_t>(pixelsInChunk / chunkColumns, 1);
    }
-   compSpace[1] = rowsInChunk;
-   counts[1] = rowsInChunk;
-
-   createDatasetForCube(dimSpace, compSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId);
-   Hdf5DataSpaceResource dSpaceId(H5Dget_space(*dataId));
-   ICEVERIFY(*dSpaceId >= 0);
-   Hdf5TypeResource hdfEncoding(H5Dget_type(*dataId));
-   ICEVERIFY(*hdfEncoding >= 0);
-
-   vector<char> pWriteBufferRes(rowsInChunk*rowSize, 0);
-   char* pWriteBuffer = &pWriteBufferRes.front();
-
-   Hdf5DataSpaceResource mspaceId(H5Screate_simple(3, counts, NULL));
-   ICEVERIFY(*mspaceId >= 0);
-
-   unsigned int numChunks = rows.size() / rowsInChunk;
-   if (rows.size() % rowsInChunk != 0)
+   else
    {
-      numChunks++;
-      counts[1] = (rows.size() % rowsInChunk);
+      chunkRows = std::max<hsize_t>(chunkBytes / (numColumns * pixelBytes), 1);
    }
-   Hdf5DataSpaceResource lastChunkWriteId(H5Screate_simple(3, counts, NULL));
+   chunkRows = std::min(chunkRows, numRows);
 
-   abortIfNecessary();
-
-   offset[2] = 0; //always write out a whole row
-   int rowIndex = 0;
-   for (unsigned int bandCount = 0; bandCount < bands.size(); ++bandCount)
+   switch (interleave)
    {
-      offset[0] = bandCount;
-
-      // BSQ the slow way
-      FactoryResource<DataRequest> pRequest;
-      pRequest->setInterleaveFormat(BSQ);
-      pRequest->setBands(bands[bandCount], bands[bandCount]);
-      DataAccessor da = pCube->getDataAccessor(pRequest.release());
-      ICEVERIFY(da.isValid());
-
-      for (unsigned int chunkNumber = 0; chunkNumber < numChunks; ++chunkNumber)
-      {
-         unsigned int startChunkRow = chunkNumber * rowsInChunk;
-         unsigned int endChunkRow = (chunkNumber + 1) * rowsInChunk;
-         if (endChunkRow > rows.size())
-         {
-            endChunkRow = rows.size();
-         }
-
-         char* pBuffer = pWriteBuffer;
-         for (unsigned int rowCount = startChunkRow; rowCount < endChunkRow; ++rowCount)
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Exporting cube...",
-                  (rowIndex++ * 100) / (bands.size() * rows.size()), NORMAL);
-            }
-
-            unsigned int rowActiveNum = rows[rowCount].getActiveNumber();
-            for (unsigned int colCount = 0; colCount < cols.size(); ++colCount)
-            {
-               unsigned int colActiveNum = cols[colCount].getActiveNumber();
-               da->toPixel(rowActiveNum, colActiveNum);
-               ICEVERIFY(da.isValid());
-
-               memcpy(pBuffer, da->getColumn(), bpe);
-               pBuffer += bpe;
-            }
-
-            abortIfNecessary();
-         }
-
-         offset[1] = startChunkRow;
-         counts[1] = endChunkRow - startChunkRow;
-
-         hid_t memorySpace = *mspaceId;
-         if (chunkNumber + 1 == numChunks)
-         {
-            memorySpace = *lastChunkWriteId;
-         }
-
-         herr_t status = H5Sselect_hyperslab(*dSpaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
-
-         status = H5Dwrite(*dataId, *hdfEncoding, memorySpace, *dSpaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
-      }
+   case BIL:
+      chunkSpace[0] = chunkRows;
+      chunkSpace[1] = chunkBands;
+      chunkSpace[2] = chunkColumns;
+      break;
+   case BSQ:
+      chunkSpace[0] = chunkBands;
+      chunkSpace[1] = chunkRows;
+      chunkSpace[2] = chunkColumns;
+      break;
+   case BIP:
+   default:
+      chunkSpace[0] = chunkRows;
+      chunkSpace[1] = chunkColumns;
+      chunkSpace[2] = chunkBands;
+      break;
    }
 }
 
-void IceWriter::createDatasetForCube(hsize_t dimSpace[3],
-                                       hsize_t chunkSpace[],
-                                       EncodingType encoding,
-                                       hid_t fd,
-                                       const string& hdfPath,
-                                       Hdf5DataSetResource& dataset )
+bool IceWriter::createDatasetForCube(hsize_t dimSpace[3],
+                                     hsize_t chunkSpace[],
+                                     EncodingType encoding,
+                                     hid_t fd,
+                                     const string& hdfPath,
+                                     Hdf5DataSetResource& dataset)
 {
    //get hdf encoding
    bool bCompressible = true;
@@ -1152,7 +868,11 @@ void IceWriter::createDatasetForCube(hsize_t dimSpace[3],
    dataset = Hdf5DataSetResource(H5Dcreate1(fd, hdfPath.c_str(), hdfType, *dspaceId, plist));
    ICEVERIFY(*dataset >= 0);
 
-   H5Pclose(plist);
+   if (bCompressible)
+   {
+      H5Pclose(plist);
+   }
+   return bCompressible;
 }
 
 void IceWriter::writePseudocolorLayerProperties(const string& hdfPath,
@@ -1299,6 +1019,11 @@ void IceWriter::setChunkSize(int chunkSize)
    mChunkSize = chunkSize;
 }
 
+void IceWriter::setChunkLayout(IceChunkLayoutType layout)
+{
+   mChunkLayout = layout;
+}
+
 void IceWriter::setCompressionType(IceCompressionType type)
 {
    mCompressionType = type;
@@ -1314,6 +1039,11 @@ int IceWriter::getChunkSize() const
    return mChunkSize;
 }
 
+IceChunkLayoutType IceWriter::getChunkLayout() const
+{
+   return mChunkLayout;
+}
+
 IceCompressionType IceWriter::getCompressionType() const
 {
    return mCompressionType;
@@ -15,6 +15,7 @@
 #include "Hdf5Resource.h"
 #include "IceUtilities.h"
 #include "StringUtilities.h"
+#include "TypesFile.h"
 
 #include <hdf5.h>
 #include <string>
@@ -37,12 +38,29 @@ enum IceCompressionTypeEnum
 
 typedef EnumWrapper<IceCompressionTypeEnum> IceCompressionType;
 
+/**
+ * Specifies how the cube dataset is divided into HDF5 chunks.
+ *
+ * The chunk shape determines which reads of the exported file are efficient.
+ * ROW_STRIPS stores whole rows, TILES stores square spatial tiles containing
+ * all bands and BAND_PLANAR stores row strips of a single band.
+ */
+enum IceChunkLayoutTypeEnum
+{
+   ROW_STRIPS,
+   TILES,
+   BAND_PLANAR
+};
+
+typedef EnumWrapper<IceChunkLayoutTypeEnum> IceChunkLayoutType;
+
 class IceWriter
 {
 public:
    SETTING(CompressionType, IceWriter, std::string, std::string());
    SETTING(GzipCompressionLevel, IceWriter, int, 0);
    SETTING(ChunkSize, IceWriter, int, 0);
+   SETTING(ChunkLayout, IceWriter, std::string, std::string());
 
    IceWriter(hid_t fileHandle, IceUtilities::FileType fileType);
    void writeFileHeader();
@@ -56,25 +74,17 @@ public:
       unsigned int displayBandNumber);
    void abort();
    void setChunkSize(int chunkSize);
+   void setChunkLayout(IceChunkLayoutType layout);
    void setCompressionType(IceCompressionType type);
    void setGzipCompressionLevel(int level);
 
    int getChunkSize() const;
+   IceChunkLayoutType getChunkLayout() const;
    IceCompressionType getCompressionType() const;
    int getGzipCompressionLevel() const;
 
 private:
-   void writeBilCubeData(const std::string& hdfPath,
-      RasterElement* pCube,
-      const RasterFileDescriptor* pOutputFileDescriptor,
-      Hdf5DataSetResource& dataId,
-      Progress* pProgress);
-   void writeBipCubeData(const std::string& hdfPath,
-      RasterElement* pCube,
-      const RasterFileDescriptor* pOutputFileDescriptor,
-      Hdf5DataSetResource& dataId,
-      Progress* pProgress);
-   void writeBsqCubeData(const std::string& hdfPath,
+   void writeCubeData(const std::string& hdfPath,
       RasterElement* pCube,
       const RasterFileDescriptor* pOutputFileDescriptor,
       Hdf5DataSetResource& dataId,
@@ -85,9 +95,11 @@ private:
    void writeClassification(const Classification* pClassification,
       const std::string& groupName,
       Progress* pProgress);
-   void createDatasetForCube(hsize_t dimSpace[3], hsize_t chunkSpace[],
+   bool createDatasetForCube(hsize_t dimSpace[3], hsize_t chunkSpace[],
       EncodingType encoding, hid_t fd, const std::string& hdfPath,
       Hdf5DataSetResource& dataset);
+   void computeChunkDimensions(InterleaveFormatType interleave, hsize_t numRows, hsize_t numColumns,
+      hsize_t numBands, unsigned int bytesPerElement, hsize_t chunkSpace[3]) const;
    void writePseudocolorLayerProperties(const std::string& hdfPath,
       const PseudocolorLayer* pLayer, Progress*pProgress);
    void writeThresholdLayerProperties(const std::string& hdfPath, const ThresholdLayer* pLayer, Progress* pProgress);
@@ -104,6 +116,7 @@ private:
    bool mAborted;
    IceUtilities::FileType mFileType;
    int mChunkSize;
+   IceChunkLayoutType mChunkLayout;
    IceCompressionType mCompressionType;
    int mGzipCompressionLevel;
 };
@@ -118,6 +131,14 @@ namespace StringUtilities
    IceCompressionType fromDisplayString<IceCompressionType>(std::string valueText, bool* pError);
    template<>
    IceCompressionType fromXmlString<IceCompressionType>(std::string valueText, bool* pError);
+   template<>
+   std::string toDisplayString(const IceChunkLayoutType& value, bool* pError);
+   template<>
+   std::string toXmlString(const IceChunkLayoutType& value, bool* pError);
+   template<>
+   IceChunkLayoutType fromDisplayString<IceChunkLayoutType>(std::string valueText, bool* pError);
+   template<>
+   IceChunkLayoutType fromXmlString<IceChunkLayoutType>(std::string valueText, bool* pError);
 }
 
 #endif
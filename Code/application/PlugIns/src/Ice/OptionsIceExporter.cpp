@@ -16,7 +16,6 @@
 
 #include <QtGui/QComboBox>
 #include <QtGui/QGridLayout>
-#include <QtGui/QHBoxLayout>
 #include <QtGui/QLabel>
 #include <QtGui/QSlider>
 #include <QtGui/QSpinBox>
@@ -60,6 +59,14 @@ OptionsIceExporter::OptionsIceExporter() :
    mpChunkSize->setSuffix(" MB");
    mpChunkSize->setAccelerated(true);
 
+   QLabel* pChunkLayoutLabel = new QLabel("Chunk layout:", pChunkSizeLayoutWidget);
+   mpChunkLayoutCombo = new QComboBox(pChunkSizeLayoutWidget);
+   std::vector<std::string> clValues = StringUtilities::getAllEnumValuesAsDisplayString<IceChunkLayoutType>();
+   for (std::vector<std::string>::iterator clValue = clValues.begin(); clValue != clValues.end(); ++clValue)
+   {
+      mpChunkLayoutCombo->addItem(QString::fromStdString(*clValue));
+   }
+
    // Layout 
    QGridLayout* pCompressionLayout = new QGridLayout(pCompressionLayoutWidget);
    pCompressionLayout->setMargin(0);
@@ -71,18 +78,23 @@ OptionsIceExporter::OptionsIceExporter() :
    pCompressionLayout->addWidget(mpGzipLevelValue, 1, 3);
    pCompressionLayout->setColumnStretch(2, 10);
 
-   QHBoxLayout* pChunkSizeLayout = new QHBoxLayout(pChunkSizeLayoutWidget);
-   pChunkSizeLayout->addWidget(pChunkSizeLabel);
-   pChunkSizeLayout->addWidget(mpChunkSize);
+   QGridLayout* pChunkSizeLayout = new QGridLayout(pChunkSizeLayoutWidget);
+   pChunkSizeLayout->setMargin(0);
+   pChunkSizeLayout->setSpacing(5);
+   pChunkSizeLayout->addWidget(pChunkSizeLabel, 0, 0);
+   pChunkSizeLayout->addWidget(mpChunkSize, 0, 1);
+   pChunkSizeLayout->addWidget(pChunkLayoutLabel, 1, 0);
+   pChunkSizeLayout->addWidget(mpChunkLayoutCombo, 1, 1);
+   pChunkSizeLayout->setColumnStretch(2, 10);
 
    LabeledSection* pCompressionSection = new LabeledSection(pCompressionLayoutWidget, "Compression Options", this);
-   LabeledSection* pChunkSizeSection = new LabeledSection(pChunkSizeLayoutWidget, "Chunk Size Options", this);
+   LabeledSection* pChunkSizeSection = new LabeledSection(pChunkSizeLayoutWidget, "Chunk Options", this);
 
    // Initialization
    addSection(pCompressionSection);
    addSection(pChunkSizeSection);
    addStretch(10);
-   setSizeHint(300, 150);
+   setSizeHint(300, 175);
 
    VERIFYNR(connect(mpCompressionTypeCombo, SIGNAL(currentIndexChanged(const QString&)), this, SLOT(compressionTypeChanged(const QString&))));
    VERIFYNR(connect(mpGzipCompressionSlider, SIGNAL(valueChanged(int)), this, SLOT(gzipCompressionValueChanged(int))));
@@ -104,6 +116,12 @@ OptionsIceExporter::OptionsIceExporter() :
    {
       mpChunkSize->setValue(csize);
    }
+   IceChunkLayoutType clayout(StringUtilities::fromXmlString<IceChunkLayoutType>(IceWriter::getSettingChunkLayout()));
+   if (clayout.isValid())
+   {
+      mpChunkLayoutCombo->setCurrentIndex(mpChunkLayoutCombo->findText(QString::fromStdString(
+         StringUtilities::toDisplayString(clayout))));
+   }
 
    compressionTypeChanged(mpCompressionTypeCombo->currentText());
 }
@@ -115,6 +133,7 @@ void OptionsIceExporter::applyChanges()
       IceWriter::setSettingCompressionType(StringUtilities::toXmlString(getCompressionType()));
       IceWriter::setSettingGzipCompressionLevel(getGzipCompressionLevel());
       IceWriter::setSettingChunkSize(getChunkSize());
+      IceWriter::setSettingChunkLayout(StringUtilities::toXmlString(getChunkLayout()));
    }
 }
 
@@ -142,6 +161,11 @@ int OptionsIceExporter::getChunkSize()
    return mpChunkSize->value();
 }
 
+IceChunkLayoutType OptionsIceExporter::getChunkLayout()
+{
+   return StringUtilities::fromDisplayString<IceChunkLayoutType>(mpChunkLayoutCombo->currentText().toStdString());
+}
+
 void OptionsIceExporter::compressionTypeChanged(const QString& value)
 {
    IceCompressionType type(StringUtilities::fromDisplayString<IceCompressionType>(value.toStdString()));
@@ -33,6 +33,7 @@ public:
    IceCompressionType getCompressionType();
    int getGzipCompressionLevel();
    int getChunkSize();
+   IceChunkLayoutType getChunkLayout();
 
    static const std::string& getName()
    {
@@ -98,6 +99,7 @@ private:
    QSlider* mpGzipCompressionSlider;
    QLabel* mpGzipLevelValue;
    QSpinBox* mpChunkSize;
+   QComboBox* mpChunkLayoutCombo;
    bool mSaveSettings;
 };
 
@@ -27,6 +27,7 @@
 #include "RasterLayer.h"
 #include "SpatialDataWindow.h"
 #include "SpatialDataView.h"
+#include "TileHandler.h"
 #include "Window.h"
 #include "xmlwriter.h"
 
@@ -60,6 +61,14 @@ KMLServer::KMLServer() : MuHttpServer(hasSettingKmlServerPort() ? getSettingKmlS
 
    ImageHandler* pImageHandler = new ImageHandler(0, this);
    registerPath("images", pImageHandler);
+
+   // Tile cache sizes are in megabytes
+   const size_t megabyte = 1024 * 1024;
+   setThreadCount(hasSettingKmlServerThreadCount() ? getSettingKmlServerThreadCount() : 1);
+   TileHandler* pTileHandler = new TileHandler(
+      (hasSettingKmlTileCacheMemory() ? getSettingKmlTileCacheMemory() : 0) * megabyte,
+      (hasSettingKmlTileCacheDisk() ? getSettingKmlTileCacheDisk() : 0) * megabyte, this);
+   registerPath("tiles", pTileHandler);
 }
 
 KMLServer::~KMLServer()
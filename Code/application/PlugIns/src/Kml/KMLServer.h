@@ -26,6 +26,9 @@ class KMLServer : public MuHttpServer, public AlgorithmShell
 
 public:
    SETTING(KmlServerPort, Kml, int, 0);
+   SETTING(KmlServerThreadCount, Kml, unsigned int, 4);
+   SETTING(KmlTileCacheMemory, Kml, unsigned int, 64);
+   SETTING(KmlTileCacheDisk, Kml, unsigned int, 256);
 
    KMLServer();
    ~KMLServer();
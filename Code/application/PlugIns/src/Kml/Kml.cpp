@@ -30,6 +30,7 @@
 #include "RasterLayer.h"
 #include "SpatialDataView.h"
 #include "SpatialDataWindow.h"
+#include "TileHandler.h"
 #include "Undo.h"
 #include "xmlreader.h"
 
@@ -220,7 +221,11 @@ bool Kml::addLayer(Layer* pLayer, const Layer* pGeoLayer, const SpatialDataView*
             int order = totalLayers - pView->getLayerDisplayIndex(pLayer) - 1;
             if (pView->getAnimationController() == NULL)
             {
-               generateGroundOverlayLayer(pLayer, layerIsDisplayed, order, pGeoLayer, -1);
+               // The server streams full resolution tiles on demand instead of a single view sized image
+               if (mExportImages || !generateTileOverlayLayer(pLayer, layerIsDisplayed))
+               {
+                  generateGroundOverlayLayer(pLayer, layerIsDisplayed, order, pGeoLayer, -1);
+               }
             }
             else
             {
@@ -239,6 +244,11 @@ bool Kml::addLayer(Layer* pLayer, const Layer* pGeoLayer, const SpatialDataView*
          // fall through...if there is no displayed raster element, export the flattened layer
       }
    case PSEUDOCOLOR:
+      if (!mExportImages && generateTileOverlayLayer(pLayer, pView->isLayerDisplayed(pLayer)))
+      {
+         break;
+      }
+      // fall through...
    case THRESHOLD:
       // These are image layers
       generateGroundOverlayLayer(pLayer, pView->isLayerDisplayed(pLayer),
@@ -604,6 +614,118 @@ void Kml::generateGroundOverlayLayer(Layer* pLayer, bool visible, int order, con
    pView->refresh();
 }
 
+bool Kml::generateTileOverlayLayer(const Layer* pLayer, bool visible)
+{
+   double north = 0.0;
+   double south = 0.0;
+   double east = 0.0;
+   double west = 0.0;
+   if (!TileHandler::canRender(pLayer) || !TileHandler::getTileBoundingBox(pLayer, 0, 0, 0, north, south, east, west))
+   {
+      return false;
+   }
+
+   // Link to the root of a super-overlay so only the tiles in view at a suitable resolution are requested
+   mXml.pushAddPoint(mXml.addElement("NetworkLink"));
+   string name = pLayer->getDisplayName();
+   if (name.empty())
+   {
+      name = pLayer->getName();
+   }
+   mXml.addText(name, mXml.addElement("name"));
+   mXml.addText(pLayer->getDisplayText(), mXml.addElement("description"));
+   mXml.addText(visible ? "1" : "0", mXml.addElement("visibility"));
+   generateTileRegion(pLayer, 0, 0, 0);
+   mXml.pushAddPoint(mXml.addElement("Link"));
+   mXml.addText(TileHandler::getTileUrl(pLayer, 0, 0, 0, "kml").toStdString(), mXml.addElement("href"));
+   mXml.addText("onRegion", mXml.addElement("viewRefreshMode"));
+   mXml.popAddPoint(); // Link
+   mXml.popAddPoint(); // NetworkLink
+
+   return true;
+}
+
+bool Kml::addTileOverlay(const Layer* pLayer, int zoom, int x, int y)
+{
+   double north = 0.0;
+   double south = 0.0;
+   double east = 0.0;
+   double west = 0.0;
+   if (!TileHandler::canRender(pLayer) || !TileHandler::getTileBoundingBox(pLayer, zoom, x, y, north, south, east, west))
+   {
+      return false;
+   }
+
+   mXml.pushAddPoint(mXml.addElement("Document"));
+   mXml.addText(QString("%1/%2/%3").arg(zoom).arg(x).arg(y).toStdString(), mXml.addElement("name"));
+   generateTileRegion(pLayer, zoom, x, y);
+
+   mXml.pushAddPoint(mXml.addElement("GroundOverlay"));
+   mXml.addText(QString::number(zoom).toStdString(), mXml.addElement("drawOrder"));
+   mXml.pushAddPoint(mXml.addElement("Icon"));
+   mXml.addText(TileHandler::getTileUrl(pLayer, zoom, x, y, "png").toStdString(), mXml.addElement("href"));
+   mXml.popAddPoint(); // Icon
+   generateLatLonBox("LatLonBox", north, south, east, west);
+   mXml.popAddPoint(); // GroundOverlay
+
+   // Link the four tiles at the next zoom level, each of which is only loaded when its region is in view
+   for (int childY = 2 * y; childY <= 2 * y + 1; ++childY)
+   {
+      for (int childX = 2 * x; childX <= 2 * x + 1; ++childX)
+      {
+         if (!TileHandler::tileExists(pLayer, zoom + 1, childX, childY))
+         {
+            continue;
+         }
+
+         mXml.pushAddPoint(mXml.addElement("NetworkLink"));
+         mXml.addText(QString("%1/%2/%3").arg(zoom + 1).arg(childX).arg(childY).toStdString(),
+            mXml.addElement("name"));
+         generateTileRegion(pLayer, zoom + 1, childX, childY);
+         mXml.pushAddPoint(mXml.addElement("Link"));
+         mXml.addText(TileHandler::getTileUrl(pLayer, zoom + 1, childX, childY, "kml").toStdString(),
+            mXml.addElement("href"));
+         mXml.addText("onRegion", mXml.addElement("viewRefreshMode"));
+         mXml.popAddPoint(); // Link
+         mXml.popAddPoint(); // NetworkLink
+      }
+   }
+
+   mXml.popAddPoint(); // Document
+   return true;
+}
+
+bool Kml::generateTileRegion(const Layer* pLayer, int zoom, int x, int y)
+{
+   double north = 0.0;
+   double south = 0.0;
+   double east = 0.0;
+   double west = 0.0;
+   if (!TileHandler::getTileBoundingBox(pLayer, zoom, x, y, north, south, east, west))
+   {
+      return false;
+   }
+
+   mXml.pushAddPoint(mXml.addElement("Region"));
+   generateLatLonBox("LatLonAltBox", north, south, east, west);
+   mXml.pushAddPoint(mXml.addElement("Lod"));
+   mXml.addText(QString::number(TileHandler::TILE_SIZE / 2).toStdString(), mXml.addElement("minLodPixels"));
+   mXml.addText("-1", mXml.addElement("maxLodPixels"));
+   mXml.popAddPoint(); // Lod
+   mXml.popAddPoint(); // Region
+   return true;
+}
+
+void Kml::generateLatLonBox(const string& elementName, double north, double south, double east, double west)
+{
+   mXml.pushAddPoint(mXml.addElement(elementName));
+   mXml.addText(StringUtilities::toXmlString(north), mXml.addElement("north"));
+   mXml.addText(StringUtilities::toXmlString(south), mXml.addElement("south"));
+   mXml.addText(StringUtilities::toXmlString(east), mXml.addElement("east"));
+   mXml.addText(StringUtilities::toXmlString(west), mXml.addElement("west"));
+   mXml.popAddPoint();
+}
+
 const QMap<QString,QByteArray> Kml::getImages() const
 {
    return mImages;
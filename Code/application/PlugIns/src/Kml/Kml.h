@@ -35,14 +35,19 @@ public:
    bool addWindow(const SpatialDataWindow* pWindow);
    bool addView(const SpatialDataView* pView);
    bool addLayer(Layer* pLayer, const Layer* pGeoLayer, const SpatialDataView* pView, int totalLayers);
+   bool addTileOverlay(const Layer* pLayer, int zoom, int x, int y);
 
    void generateBoundingBox(const Layer* pGeoLayer);
    void generatePolygonalLayer(const GraphicLayer* pGraphicLayer, bool visible, int order, const Layer* pGeoLayer);
    void generateGroundOverlayLayer(Layer* pLayer, bool visible, int order, const Layer* pGeoLayer, int frame = -1);
+   bool generateTileOverlayLayer(const Layer* pLayer, bool visible);
 
    const QMap<QString, QByteArray> getImages() const;
 
 private:
+   bool generateTileRegion(const Layer* pLayer, int zoom, int x, int y);
+   void generateLatLonBox(const std::string& elementName, double north, double south, double east, double west);
+
    XMLWriter mXml;
    bool mExportImages;
    Progress* mpProgress;
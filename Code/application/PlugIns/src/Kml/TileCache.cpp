@@ -0,0 +1,190 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "TileCache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+
+TileCache::TileCache(size_t maxMemoryBytes, size_t maxDiskBytes, const QString& diskPath) :
+   mMaxMemoryBytes(maxMemoryBytes),
+   mMaxDiskBytes(maxDiskBytes),
+   mDiskPath(diskPath),
+   mMemoryBytes(0),
+   mDiskBytes(0)
+{
+   if (mMaxDiskBytes > 0 && !mDiskPath.isEmpty() && !QDir().mkpath(mDiskPath))
+   {
+      mDiskPath.clear();
+   }
+   if (mDiskPath.isEmpty())
+   {
+      mMaxDiskBytes = 0;
+   }
+}
+
+TileCache::~TileCache()
+{
+   clear();
+   if (!mDiskPath.isEmpty())
+   {
+      QDir().rmdir(mDiskPath);
+   }
+}
+
+bool TileCache::find(const QString& key, QByteArray& tile)
+{
+   QMutexLocker lock(&mMutex);
+   QHash<QString, MemoryList::iterator>::iterator memoryIter = mMemoryIndex.find(key);
+   if (memoryIter != mMemoryIndex.end())
+   {
+      // Move the tile to the front of the list so the least recently used tile is always at the back
+      mMemory.splice(mMemory.begin(), mMemory, memoryIter.value());
+      tile = mMemory.front().mTile;
+      return true;
+   }
+
+   QHash<QString, DiskList::iterator>::iterator diskIter = mDiskIndex.find(key);
+   if (diskIter == mDiskIndex.end())
+   {
+      return false;
+   }
+
+   QFile file(getDiskFilename(key));
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      removeDisk(diskIter.value());
+      return false;
+   }
+
+   tile = file.readAll();
+   mDisk.splice(mDisk.begin(), mDisk, diskIter.value());
+   insertMemory(key, tile);
+   return true;
+}
+
+void TileCache::insert(const QString& key, const QByteArray& tile)
+{
+   QMutexLocker lock(&mMutex);
+   if (mMemoryIndex.contains(key))
+   {
+      return;
+   }
+
+   insertMemory(key, tile);
+}
+
+void TileCache::removeLayer(const QString& layerId)
+{
+   QString prefix = layerId + "/";
+
+   QMutexLocker lock(&mMutex);
+   for (MemoryList::iterator iter = mMemory.begin(); iter != mMemory.end();)
+   {
+      if (iter->mKey.startsWith(prefix))
+      {
+         mMemoryBytes -= iter->mTile.size();
+         mMemoryIndex.remove(iter->mKey);
+         iter = mMemory.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
+
+   for (DiskList::iterator iter = mDisk.begin(); iter != mDisk.end();)
+   {
+      DiskList::iterator current = iter++;
+      if (current->mKey.startsWith(prefix))
+      {
+         removeDisk(current);
+      }
+   }
+}
+
+void TileCache::clear()
+{
+   QMutexLocker lock(&mMutex);
+   mMemory.clear();
+   mMemoryIndex.clear();
+   mMemoryBytes = 0;
+
+   while (!mDisk.empty())
+   {
+      removeDisk(mDisk.begin());
+   }
+}
+
+QString TileCache::getDiskFilename(const QString& key) const
+{
+   // Layer IDs contain characters which are not valid in filenames so name the files by a hash of the key
+   QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+   return mDiskPath + "/" + QString::fromAscii(hash.constData());
+}
+
+void TileCache::insertMemory(const QString& key, const QByteArray& tile)
+{
+   MemoryEntry entry;
+   entry.mKey = key;
+   entry.mTile = tile;
+   mMemory.push_front(entry);
+   mMemoryIndex.insert(key, mMemory.begin());
+   mMemoryBytes += tile.size();
+
+   while (mMemoryBytes > mMaxMemoryBytes && !mMemory.empty())
+   {
+      MemoryEntry& oldest = mMemory.back();
+      if (!mDiskIndex.contains(oldest.mKey))
+      {
+         insertDisk(oldest.mKey, oldest.mTile);
+      }
+
+      mMemoryBytes -= oldest.mTile.size();
+      mMemoryIndex.remove(oldest.mKey);
+      mMemory.pop_back();
+   }
+}
+
+void TileCache::insertDisk(const QString& key, const QByteArray& tile)
+{
+   if (mMaxDiskBytes == 0 || static_cast<size_t>(tile.size()) > mMaxDiskBytes)
+   {
+      return;
+   }
+
+   while (mDiskBytes + tile.size() > mMaxDiskBytes && !mDisk.empty())
+   {
+      removeDisk(--mDisk.end());
+   }
+
+   QFile file(getDiskFilename(key));
+   if (!file.open(QIODevice::WriteOnly) || file.write(tile) != tile.size())
+   {
+      file.remove();
+      return;
+   }
+
+   DiskEntry entry;
+   entry.mKey = key;
+   entry.mSize = tile.size();
+   mDisk.push_front(entry);
+   mDiskIndex.insert(key, mDisk.begin());
+   mDiskBytes += entry.mSize;
+}
+
+void TileCache::removeDisk(DiskList::iterator iter)
+{
+   QFile::remove(getDiskFilename(iter->mKey));
+   mDiskBytes -= iter->mSize;
+   mDiskIndex.remove(iter->mKey);
+   mDisk.erase(iter);
+}
@@ -0,0 +1,74 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <list>
+
+/**
+ * A bounded least recently used cache of encoded map tiles.
+ *
+ * Tiles are keyed by "layerId/z/x/y.format". Tiles evicted from memory are
+ * written to a private directory on disk which is itself bounded and is
+ * removed when the cache is destroyed. All methods may be called from any thread.
+ */
+class TileCache
+{
+public:
+   TileCache(size_t maxMemoryBytes, size_t maxDiskBytes, const QString& diskPath);
+   ~TileCache();
+
+   bool find(const QString& key, QByteArray& tile);
+   void insert(const QString& key, const QByteArray& tile);
+   void removeLayer(const QString& layerId);
+   void clear();
+
+private:
+   TileCache(const TileCache& rhs);
+   TileCache& operator=(const TileCache& rhs);
+
+   struct MemoryEntry
+   {
+      QString mKey;
+      QByteArray mTile;
+   };
+   struct DiskEntry
+   {
+      QString mKey;
+      size_t mSize;
+   };
+   typedef std::list<MemoryEntry> MemoryList;
+   typedef std::list<DiskEntry> DiskList;
+
+   QString getDiskFilename(const QString& key) const;
+   void insertMemory(const QString& key, const QByteArray& tile);
+   void insertDisk(const QString& key, const QByteArray& tile);
+   void removeDisk(DiskList::iterator iter);
+
+   QMutex mMutex;
+   size_t mMaxMemoryBytes;
+   size_t mMaxDiskBytes;
+   QString mDiskPath;
+
+   MemoryList mMemory;
+   QHash<QString, MemoryList::iterator> mMemoryIndex;
+   size_t mMemoryBytes;
+
+   DiskList mDisk;
+   QHash<QString, DiskList::iterator> mDiskIndex;
+   size_t mDiskBytes;
+};
+
+#endif
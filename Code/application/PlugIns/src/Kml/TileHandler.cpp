@@ -0,0 +1,585 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "Filename.h"
+#include "Kml.h"
+#include "KMLServer.h"
+#include "LayerList.h"
+#include "ObjectResource.h"
+#include "PseudocolorLayer.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterLayer.h"
+#include "SessionManager.h"
+#include "Slot.h"
+#include "SpatialDataView.h"
+#include "TileHandler.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QReadLocker>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QUrl>
+#include <QtCore/QWriteLocker>
+#include <QtGui/QImage>
+#include <QtGui/QImageWriter>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   QString getTileKey(const QString& layerId, int zoom, int x, int y, const QString& extension)
+   {
+      return QString("%1/%2/%3/%4.%5").arg(layerId).arg(zoom).arg(x).arg(y).arg(extension);
+   }
+
+   QString getDiskCachePath()
+   {
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      if (pTempPath == NULL)
+      {
+         return QString();
+      }
+
+      return QDir(QString::fromStdString(pTempPath->getFullPathAndName())).absoluteFilePath(
+         QString("KmlTiles%1").arg(QCoreApplication::applicationPid()));
+   }
+
+   unsigned char stretch(double value, double lower, double upper)
+   {
+      if (upper == lower)
+      {
+         return (value < lower) ? 0 : 255;
+      }
+
+      double scaled = (value - lower) / (upper - lower) * 255.0;
+      return static_cast<unsigned char>(std::max(0.0, std::min(255.0, scaled + 0.5)));
+   }
+}
+
+TileHandler::TileHandler(size_t maxMemoryBytes, size_t maxDiskBytes, QObject* pParent) :
+   MuHttpServer(0, pParent),
+   mNextGeneration(0),
+   mCache(maxMemoryBytes, maxDiskBytes, getDiskCachePath())
+{}
+
+TileHandler::~TileHandler()
+{
+   QWriteLocker lock(&mSourceLock);
+   while (!mSources.empty())
+   {
+      removeSource(mSources.begin());
+   }
+}
+
+bool TileHandler::canRender(const Layer* pLayer)
+{
+   if (pLayer == NULL)
+   {
+      return false;
+   }
+
+   const RasterLayer* pRasterLayer = dynamic_cast<const RasterLayer*>(pLayer);
+   if (pRasterLayer != NULL)
+   {
+      DisplayMode mode = pRasterLayer->getDisplayMode();
+      if (pRasterLayer->getStretchType(mode) != LINEAR)
+      {
+         return false;
+      }
+
+      if (mode == GRAYSCALE_MODE)
+      {
+         return pRasterLayer->getDisplayedRasterElement(GRAY) != NULL &&
+            pRasterLayer->getDisplayedBand(GRAY).isValid();
+      }
+
+      RasterChannelType channels[] = { RED, GREEN, BLUE };
+      for (int i = 0; i < 3; ++i)
+      {
+         if (pRasterLayer->getDisplayedRasterElement(channels[i]) == NULL ||
+            pRasterLayer->getDisplayedBand(channels[i]).isValid() == false)
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   return dynamic_cast<const PseudocolorLayer*>(pLayer) != NULL &&
+      dynamic_cast<const RasterElement*>(pLayer->getDataElement()) != NULL;
+}
+
+bool TileHandler::getTileSize(const Layer* pLayer, unsigned int& rows, unsigned int& columns)
+{
+   const RasterElement* pElement = dynamic_cast<const RasterElement*>(pLayer == NULL ? NULL : pLayer->getDataElement());
+   if (pElement == NULL)
+   {
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   rows = pDescriptor->getRowCount();
+   columns = pDescriptor->getColumnCount();
+   return rows > 0 && columns > 0;
+}
+
+int TileHandler::getMaxZoom(unsigned int rows, unsigned int columns)
+{
+   unsigned int size = std::max(rows, columns);
+   int zoom = 0;
+   while ((static_cast<unsigned int>(TILE_SIZE) << zoom) < size)
+   {
+      ++zoom;
+   }
+
+   return zoom;
+}
+
+int TileHandler::getMaxZoom(const Layer* pLayer)
+{
+   unsigned int rows = 0;
+   unsigned int columns = 0;
+   if (!getTileSize(pLayer, rows, columns))
+   {
+      return -1;
+   }
+
+   return getMaxZoom(rows, columns);
+}
+
+bool TileHandler::tileExists(const Layer* pLayer, int zoom, int x, int y)
+{
+   unsigned int rows = 0;
+   unsigned int columns = 0;
+   if (!getTileSize(pLayer, rows, columns))
+   {
+      return false;
+   }
+
+   int maxZoom = getMaxZoom(rows, columns);
+   if (zoom < 0 || zoom > maxZoom || x < 0 || y < 0)
+   {
+      return false;
+   }
+
+   unsigned int tileExtent = static_cast<unsigned int>(TILE_SIZE) << (maxZoom - zoom);
+   return static_cast<unsigned int>(x) * tileExtent < columns && static_cast<unsigned int>(y) * tileExtent < rows;
+}
+
+bool TileHandler::getTileBoundingBox(const Layer* pLayer, int zoom, int x, int y,
+                                     double& north, double& south, double& east, double& west)
+{
+   if (!tileExists(pLayer, zoom, x, y))
+   {
+      return false;
+   }
+
+   SpatialDataView* pView = dynamic_cast<SpatialDataView*>(pLayer->getView());
+   LayerList* pLayerList = (pView == NULL) ? NULL : pView->getLayerList();
+   RasterElement* pGeoElement = (pLayerList == NULL) ? NULL : pLayerList->getPrimaryRasterElement();
+   Layer* pGeoLayer = (pGeoElement == NULL) ? NULL : pLayerList->getLayer(RASTER, pGeoElement);
+   if (pGeoLayer == NULL || pGeoElement->isGeoreferenced() == false)
+   {
+      return false;
+   }
+
+   unsigned int rows = 0;
+   unsigned int columns = 0;
+   getTileSize(pLayer, rows, columns);
+   unsigned int tileExtent = static_cast<unsigned int>(TILE_SIZE) << (getMaxZoom(rows, columns) - zoom);
+   double left = static_cast<double>(x) * tileExtent;
+   double top = static_cast<double>(y) * tileExtent;
+   double right = std::min(left + tileExtent, static_cast<double>(columns));
+   double bottom = std::min(top + tileExtent, static_cast<double>(rows));
+
+   // Translate the tile corners from layer pixels to primary raster pixels through world coordinates
+   LocationType corners[] =
+   {
+      LocationType(left, top), LocationType(right, top), LocationType(right, bottom), LocationType(left, bottom)
+   };
+   north = -90.0;
+   south = 90.0;
+   east = -180.0;
+   west = 180.0;
+   for (int i = 0; i < 4; ++i)
+   {
+      double worldX = 0.0;
+      double worldY = 0.0;
+      pLayer->translateDataToWorld(corners[i].mX, corners[i].mY, worldX, worldY);
+
+      LocationType pixel;
+      pGeoLayer->translateWorldToData(worldX, worldY, pixel.mX, pixel.mY);
+
+      LocationType geocoord = pGeoElement->convertPixelToGeocoord(pixel);
+      north = std::max(geocoord.mX, north);
+      south = std::min(geocoord.mX, south);
+      east = std::max(geocoord.mY, east);
+      west = std::min(geocoord.mY, west);
+   }
+
+   return true;
+}
+
+QString TileHandler::getTileUrl(const Layer* pLayer, int zoom, int x, int y, const QString& extension)
+{
+   VERIFYRV(pLayer != NULL, QString());
+   QString layerId = QString::fromAscii(QUrl::toPercentEncoding(QString::fromStdString(pLayer->getId())));
+   return QString("http://localhost:%1/tiles/%2").arg(KMLServer::getSettingKmlServerPort())
+      .arg(getTileKey(layerId, zoom, x, y, extension));
+}
+
+void TileHandler::subjectModified(Subject& subject, const string& signal, const boost::any& value)
+{
+   // Drop every snapshot which uses the subject, waiting for any tiles being rendered from it to complete
+   QWriteLocker lock(&mSourceLock);
+   for (map<QString, TileSource>::iterator iter = mSources.begin(); iter != mSources.end();)
+   {
+      map<QString, TileSource>::iterator current = iter++;
+      const vector<Subject*>& subjects = current->second.mSubjects;
+      if (std::find(subjects.begin(), subjects.end(), &subject) != subjects.end())
+      {
+         removeSource(current);
+      }
+   }
+}
+
+bool TileHandler::isThreadSafe(const QString& uri) const
+{
+   // Image tiles are rendered from a snapshot which does not use the layer
+   return !uri.endsWith(".kml", Qt::CaseInsensitive);
+}
+
+MuHttpServer::Response TileHandler::getRequest(const QString& uri, const QString& contentType,
+                                               const QString& body, const FormValueMap& form)
+{
+   Response r;
+   r.mCode = HTTPRESPONSECODE_404_NOTFOUND;
+   r.mHeaders["content-type"] = "text/html";
+   r.mBody = "<html><body><h1>Not found</h1>The requested tile does not exist.</body></html>";
+
+   QStringList path = uri.split("/", QString::SkipEmptyParts);
+   if (path.size() != 4)
+   {
+      return r;
+   }
+
+   QStringList name = path[3].split(".");
+   if (name.size() != 2)
+   {
+      return r;
+   }
+
+   bool zoomOk = false;
+   bool xOk = false;
+   bool yOk = false;
+   QString layerId = QUrl::fromPercentEncoding(path[0].toAscii());
+   int zoom = path[1].toInt(&zoomOk);
+   int x = path[2].toInt(&xOk);
+   int y = name[0].toInt(&yOk);
+   QString extension = name[1].toLower();
+   if (!zoomOk || !xOk || !yOk)
+   {
+      return r;
+   }
+
+   if (extension == "kml")
+   {
+      Layer* pLayer = dynamic_cast<Layer*>(Service<SessionManager>()->getSessionItem(layerId.toStdString()));
+      Kml k;
+      if (k.addTileOverlay(pLayer, zoom, x, y))
+      {
+         r.mCode = HTTPRESPONSECODE_200_OK;
+         r.mHeaders["content-type"] = "application/vnd.google-earth.kml+xml";
+         r.mBody = k.toString();
+      }
+      return r;
+   }
+
+   QString format;
+   if (extension == "png")
+   {
+      format = "PNG";
+   }
+   else if (extension == "jpg" || extension == "jpeg")
+   {
+      format = "JPEG";
+   }
+   else
+   {
+      return r;
+   }
+
+   QString key = getTileKey(layerId, zoom, x, y, extension);
+   QByteArray tile;
+   if (!mCache.find(key, tile))
+   {
+      bool rendered = false;
+      for (;;)
+      {
+         QReadLocker lock(&mSourceLock);
+         map<QString, TileSource>::const_iterator source = mSources.find(layerId);
+         if (source != mSources.end())
+         {
+            rendered = renderTile(source->second, zoom, x, y, format, tile);
+
+            // The cache is only updated while the snapshot is current so that a tile rendered
+            // concurrently with a modification of the layer is never cached
+            if (rendered)
+            {
+               mCache.insert(key, tile);
+            }
+            break;
+         }
+         lock.unlock();
+
+         // The snapshot must be taken on the thread which owns the layer
+         if (QThread::currentThread() != thread())
+         {
+            return processOnOwnerThread(true, uri, contentType, body, form);
+         }
+         if (!createSource(layerId))
+         {
+            break;
+         }
+      }
+
+      if (!rendered)
+      {
+         return r;
+      }
+   }
+
+   r.mCode = HTTPRESPONSECODE_200_OK;
+   r.mHeaders["content-type"] = QString("image/%1").arg(format.toLower());
+   r.mBody.clear();
+   r.mOctets = tile;
+   r.mEncoding = Response::OCTET;
+   return r;
+}
+
+bool TileHandler::createSource(const QString& layerId)
+{
+   Layer* pLayer = dynamic_cast<Layer*>(Service<SessionManager>()->getSessionItem(layerId.toStdString()));
+   if (!canRender(pLayer))
+   {
+      return false;
+   }
+
+   TileSource source;
+   source.mComponent = COMPLEX_MAGNITUDE;
+   source.mPseudocolor = false;
+   source.mAlpha = 255;
+   getTileSize(pLayer, source.mRows, source.mColumns);
+   source.mMaxZoom = getMaxZoom(source.mRows, source.mColumns);
+   source.mSubjects.push_back(pLayer);
+
+   RasterLayer* pRasterLayer = dynamic_cast<RasterLayer*>(pLayer);
+   PseudocolorLayer* pPseudocolorLayer = dynamic_cast<PseudocolorLayer*>(pLayer);
+   if (pRasterLayer != NULL)
+   {
+      vector<RasterChannelType> channels;
+      if (pRasterLayer->getDisplayMode() == GRAYSCALE_MODE)
+      {
+         channels.push_back(GRAY);
+      }
+      else
+      {
+         channels.push_back(RED);
+         channels.push_back(GREEN);
+         channels.push_back(BLUE);
+      }
+
+      for (vector<RasterChannelType>::const_iterator iter = channels.begin(); iter != channels.end(); ++iter)
+      {
+         double lower = 0.0;
+         double upper = 0.0;
+         pRasterLayer->getStretchValues(*iter, lower, upper);
+         source.mElements.push_back(pRasterLayer->getDisplayedRasterElement(*iter));
+         source.mBands.push_back(pRasterLayer->getDisplayedBand(*iter));
+         source.mLower.push_back(pRasterLayer->convertStretchValue(*iter, lower, RAW_VALUE));
+         source.mUpper.push_back(pRasterLayer->convertStretchValue(*iter, upper, RAW_VALUE));
+      }
+
+      source.mComponent = pRasterLayer->getComplexComponent();
+      source.mAlpha = pRasterLayer->getAlpha();
+   }
+   else if (pPseudocolorLayer != NULL)
+   {
+      RasterElement* pElement = static_cast<RasterElement*>(pPseudocolorLayer->getDataElement());
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFY(pDescriptor != NULL);
+      source.mElements.push_back(pElement);
+      source.mBands.push_back(pDescriptor->getActiveBand(0));
+      source.mPseudocolor = true;
+
+      vector<int> classIds;
+      pPseudocolorLayer->getClassIDs(classIds);
+      for (vector<int>::const_iterator iter = classIds.begin(); iter != classIds.end(); ++iter)
+      {
+         if (pPseudocolorLayer->isClassDisplayed(*iter))
+         {
+            source.mClassColors[pPseudocolorLayer->getClassValue(*iter)] = pPseudocolorLayer->getClassColor(*iter);
+         }
+      }
+   }
+
+   for (vector<RasterElement*>::const_iterator iter = source.mElements.begin(); iter != source.mElements.end(); ++iter)
+   {
+      if (std::find(source.mSubjects.begin(), source.mSubjects.end(), *iter) == source.mSubjects.end())
+      {
+         source.mSubjects.push_back(*iter);
+      }
+   }
+
+   for (vector<Subject*>::const_iterator iter = source.mSubjects.begin(); iter != source.mSubjects.end(); ++iter)
+   {
+      (*iter)->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &TileHandler::subjectModified));
+      (*iter)->attach(SIGNAL_NAME(Subject, Deleted), Slot(this, &TileHandler::subjectModified));
+   }
+
+   QWriteLocker lock(&mSourceLock);
+   source.mGeneration = mNextGeneration++;
+   mSources[layerId] = source;
+   return true;
+}
+
+void TileHandler::removeSource(map<QString, TileSource>::iterator iter)
+{
+   const vector<Subject*>& subjects = iter->second.mSubjects;
+   for (vector<Subject*>::const_iterator subject = subjects.begin(); subject != subjects.end(); ++subject)
+   {
+      (*subject)->detach(SIGNAL_NAME(Subject, Modified), Slot(this, &TileHandler::subjectModified));
+      (*subject)->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &TileHandler::subjectModified));
+   }
+
+   mCache.removeLayer(iter->first);
+   mSources.erase(iter);
+}
+
+bool TileHandler::renderTile(const TileSource& source, int zoom, int x, int y, const QString& format,
+                             QByteArray& tile) const
+{
+   if (zoom < 0 || zoom > source.mMaxZoom || x < 0 || y < 0)
+   {
+      return false;
+   }
+
+   // Each tile pixel is the nearest source pixel at the decimation factor of the zoom level
+   unsigned int factor = 1 << (source.mMaxZoom - zoom);
+   unsigned int startRow = static_cast<unsigned int>(y) * TILE_SIZE * factor;
+   unsigned int startColumn = static_cast<unsigned int>(x) * TILE_SIZE * factor;
+   if (startRow >= source.mRows || startColumn >= source.mColumns)
+   {
+      return false;
+   }
+
+   unsigned int tileRows = std::min<unsigned int>(TILE_SIZE, (source.mRows - startRow + factor - 1) / factor);
+   unsigned int tileColumns = std::min<unsigned int>(TILE_SIZE, (source.mColumns - startColumn + factor - 1) / factor);
+
+   vector<vector<double> > values(source.mElements.size());
+   for (vector<RasterElement*>::size_type channel = 0; channel < source.mElements.size(); ++channel)
+   {
+      RasterElement* pElement = source.mElements[channel];
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFY(pDescriptor != NULL);
+
+      // Data elements displayed in a layer may be smaller than the layer's primary element
+      unsigned int rowCount = pDescriptor->getRowCount();
+      unsigned int columnCount = pDescriptor->getColumnCount();
+      if (startRow >= rowCount || startColumn >= columnCount)
+      {
+         return false;
+      }
+      unsigned int stopRow = std::min(startRow + (tileRows - 1) * factor, rowCount - 1);
+      unsigned int stopColumn = std::min(startColumn + (tileColumns - 1) * factor, columnCount - 1);
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow));
+      pRequest->setColumns(pDescriptor->getActiveColumn(startColumn), pDescriptor->getActiveColumn(stopColumn));
+      pRequest->setBands(source.mBands[channel], source.mBands[channel]);
+      pRequest->setInterleaveFormat(BSQ);
+      DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+      VERIFY(accessor.isValid());
+
+      vector<double>& channelValues = values[channel];
+      channelValues.resize(tileRows * tileColumns);
+      for (unsigned int row = 0; row < tileRows; ++row)
+      {
+         unsigned int sourceRow = std::min(startRow + row * factor, stopRow);
+         for (unsigned int column = 0; column < tileColumns; ++column)
+         {
+            accessor->toPixel(sourceRow, std::min(startColumn + column * factor, stopColumn));
+            VERIFY(accessor.isValid());
+            channelValues[row * tileColumns + column] = accessor->getColumnAsDouble(0, source.mComponent);
+         }
+      }
+   }
+
+   QImage image(TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32);
+   image.fill(0);
+   for (unsigned int row = 0; row < tileRows; ++row)
+   {
+      QRgb* pLine = reinterpret_cast<QRgb*>(image.scanLine(row));
+      for (unsigned int column = 0; column < tileColumns; ++column)
+      {
+         unsigned int index = row * tileColumns + column;
+         if (source.mPseudocolor)
+         {
+            map<int, ColorType>::const_iterator color =
+               source.mClassColors.find(static_cast<int>(values[0][index]));
+            if (color != source.mClassColors.end())
+            {
+               pLine[column] = qRgba(color->second.mRed, color->second.mGreen, color->second.mBlue, 255);
+            }
+         }
+         else if (values.size() == 1)
+         {
+            unsigned char gray = stretch(values[0][index], source.mLower[0], source.mUpper[0]);
+            pLine[column] = qRgba(gray, gray, gray, source.mAlpha);
+         }
+         else
+         {
+            pLine[column] = qRgba(stretch(values[0][index], source.mLower[0], source.mUpper[0]),
+               stretch(values[1][index], source.mLower[1], source.mUpper[1]),
+               stretch(values[2][index], source.mLower[2], source.mUpper[2]), source.mAlpha);
+         }
+      }
+   }
+
+   if (format == "JPEG")
+   {
+      // JPEG has no alpha channel so transparent pixels are written as black
+      image = image.convertToFormat(QImage::Format_RGB32);
+   }
+
+   tile.clear();
+   QBuffer buffer(&tile);
+   buffer.open(QIODevice::WriteOnly);
+   QImageWriter writer(&buffer, format.toAscii());
+   return writer.write(image);
+}
@@ -0,0 +1,100 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TILEHANDLER_H
+#define TILEHANDLER_H
+
+#include "ColorType.h"
+#include "DimensionDescriptor.h"
+#include "MuHttpServer.h"
+#include "TileCache.h"
+#include "TypesFile.h"
+
+#include <QtCore/QMap>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QString>
+#include <boost/any.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Layer;
+class RasterElement;
+class Subject;
+
+/**
+ * Serves raster and pseudocolor layers as a pyramid of fixed size image tiles.
+ *
+ * Tiles are requested as "<layerId>/<z>/<x>/<y>.png" (or .jpg) where zoom level
+ * getMaxZoom() is full resolution and each lower level is decimated by a further
+ * factor of two. Requesting "<layerId>/<z>/<x>/<y>.kml" returns a KML super-overlay
+ * region for the tile which links to the tile image and the four tiles below it.
+ *
+ * Image tiles are rendered on the server's worker threads from a snapshot of the
+ * layer's display settings and are kept in a TileCache until the layer or its data
+ * is modified.
+ */
+class TileHandler : public MuHttpServer
+{
+public:
+   static const int TILE_SIZE = 256;
+
+   TileHandler(size_t maxMemoryBytes, size_t maxDiskBytes, QObject* pParent = NULL);
+   ~TileHandler();
+
+   static bool canRender(const Layer* pLayer);
+   static int getMaxZoom(const Layer* pLayer);
+   static bool tileExists(const Layer* pLayer, int zoom, int x, int y);
+   static bool getTileBoundingBox(const Layer* pLayer, int zoom, int x, int y,
+      double& north, double& south, double& east, double& west);
+   static QString getTileUrl(const Layer* pLayer, int zoom, int x, int y, const QString& extension);
+
+   void subjectModified(Subject& subject, const std::string& signal, const boost::any& value);
+
+protected:
+   bool isThreadSafe(const QString& uri) const;
+   MuHttpServer::Response getRequest(const QString& uri, const QString& contentType, const QString& body,
+      const FormValueMap& form);
+
+private:
+   TileHandler(const TileHandler& rhs);
+   TileHandler& operator=(const TileHandler& rhs);
+
+   struct TileSource
+   {
+      std::vector<RasterElement*> mElements;
+      std::vector<DimensionDescriptor> mBands;
+      std::vector<double> mLower;
+      std::vector<double> mUpper;
+      ComplexComponent mComponent;
+      bool mPseudocolor;
+      std::map<int, ColorType> mClassColors;
+      unsigned int mAlpha;
+      unsigned int mRows;
+      unsigned int mColumns;
+      int mMaxZoom;
+      unsigned int mGeneration;
+      std::vector<Subject*> mSubjects;
+   };
+
+   static bool getTileSize(const Layer* pLayer, unsigned int& rows, unsigned int& columns);
+   static int getMaxZoom(unsigned int rows, unsigned int columns);
+
+   bool createSource(const QString& layerId);
+   void removeSource(std::map<QString, TileSource>::iterator iter);
+   bool renderTile(const TileSource& source, int zoom, int x, int y, const QString& format, QByteArray& tile) const;
+
+   QReadWriteLock mSourceLock;
+   std::map<QString, TileSource> mSources;
+   unsigned int mNextGeneration;
+   TileCache mCache;
+};
+
+#endif
@@ -47,6 +47,7 @@
 
 #include <cstdio>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 #include <boost/shared_ptr.hpp>
@@ -201,6 +202,16 @@ bool Nitf::NitfExporter::execute(PlugInArgList *pInParam, PlugInArgList *pOutPar
    RasterDataDescriptor* pDd = dynamic_cast<RasterDataDescriptor*>(mpRaster->getDataDescriptor());
    VERIFY(pDd != NULL);
 
+   // TREs which have not been accessed since the import are still only in the original file
+   map<string, TrePlugInResource> parsers;
+   string parseMessage;
+   Nitf::importDeferredMetadata(pDd, parsers, parseMessage);
+   if (parseMessage.empty() == false)
+   {
+      mpProgress->updateProgress(parseMessage, 0, WARNING);
+      pStep->addMessage(parseMessage, "app", "5C6E2D3A-8B41-4F7D-9A62-1E0B7C94D358", true);
+   }
+
    // VQ exports are unsupported
    const string icomPathName[] = { Nitf::NITF_METADATA, Nitf::IMAGE_SUBHEADER,
       Nitf::ImageSubheaderFieldNames::COMPRESSION, END_METADATA_NAME };
@@ -11,6 +11,7 @@
 #include "AppVersion.h"
 #include "CachedPage.h"
 #include "DataRequest.h"
+#include "MultiThreadedAlgorithm.h"
 #include "NitfPager.h"
 #include "NitfUtilities.h"
 #include "PlugInArgList.h"
@@ -29,8 +30,144 @@
 
 #include <QtCore/QString>
 
+#include <algorithm>
+#include <string.h>
+
 REGISTER_PLUGIN(OpticksNitf, Pager, Nitf::Pager);
 
+namespace Nitf
+{
+   /**
+    *  An image handler which only changes its output band list when a read
+    *  requests different bands than the previous read.
+    */
+   class PagerImageHandler
+   {
+   public:
+      PagerImageHandler(const std::string& filename) :
+         mpHandler(filename)
+      {}
+
+      ossimImageHandler* get()
+      {
+         return mpHandler.get();
+      }
+
+      ossimRefPtr<ossimImageData> getTile(const ossimIrect& region, const std::vector<ossim_uint32>& bandList)
+      {
+         if (bandList != mBandList)
+         {
+            // Try to set the output band list.
+            // If it cannot succeed (e.g.: for VQ), this is not an error.
+            mpHandler->setOutputBandList(bandList);
+            mBandList = bandList;
+         }
+
+         return mpHandler->getTile(region);
+      }
+
+   private:
+      Nitf::OssimImageHandlerResource mpHandler;
+      std::vector<ossim_uint32> mBandList;
+   };
+}
+
+namespace
+{
+   struct TileReadInput
+   {
+      std::vector<Nitf::PagerImageHandler*> mHandlers; // one per thread
+      std::vector<ossimIrect> mStrips;
+      std::vector<ossim_uint32> mBandList;
+      ossimIrect mRegion;
+      ossimInterleaveType mInterleave;
+      bool mSingleBand;
+      int mBytesPerBand;
+      char* mpData;
+   };
+
+   /**
+    *  Reads columns of NITF blocks into the fetch unit.  Each thread reads its
+    *  strips through its own image handler, and the strips do not share blocks
+    *  so no block is decoded more than once.
+    */
+   class TileReadThread : public mta::AlgorithmThread
+   {
+   public:
+      TileReadThread(const TileReadInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mStrips.size()))),
+         mSuccess(true)
+      {}
+
+      void run()
+      {
+         Nitf::PagerImageHandler* pHandler = mInput.mHandlers[getThreadIndex()];
+         for (int strip = mRange.mFirst; strip <= mRange.mLast; ++strip)
+         {
+            const ossimIrect& stripRegion = mInput.mStrips[strip];
+            ossimRefPtr<ossimImageData> cubeData = pHandler->getTile(stripRegion, mInput.mBandList);
+            if (cubeData == NULL || cubeData->getBuf() == NULL)
+            {
+               mSuccess = false;
+               return;
+            }
+
+            if (mInput.mSingleBand)
+            {
+               // See fetchUnit() for why single band data is copied from the first band of the tile.
+               // Since ossimImageData stores data as BSQ, each row of the strip is contiguous.
+               const char* pSource = static_cast<const char*>(cubeData->getBuf(0));
+               unsigned int stripWidth = stripRegion.width();
+               unsigned int regionWidth = mInput.mRegion.width();
+               size_t sourceStride = static_cast<size_t>(cubeData->getWidth()) * mInput.mBytesPerBand;
+               size_t rowBytes = static_cast<size_t>(std::min(stripWidth, cubeData->getWidth())) * mInput.mBytesPerBand;
+               char* pDestination = mInput.mpData +
+                  static_cast<size_t>(stripRegion.ul().x - mInput.mRegion.ul().x) * mInput.mBytesPerBand;
+               unsigned int rowCount = std::min(stripRegion.height(), cubeData->getHeight());
+               for (unsigned int row = 0; row < rowCount; ++row)
+               {
+                  memcpy(pDestination + static_cast<size_t>(row) * regionWidth * mInput.mBytesPerBand,
+                     pSource + row * sourceStride, rowBytes);
+               }
+            }
+            else
+            {
+               cubeData->unloadTile(mInput.mpData, mInput.mRegion, mInput.mInterleave);
+            }
+         }
+      }
+
+      bool isSuccessful() const
+      {
+         return mSuccess;
+      }
+
+   private:
+      TileReadThread& operator=(const TileReadThread& rhs);
+
+      const TileReadInput& mInput;
+      Range mRange;
+      bool mSuccess;
+   };
+
+   struct TileReadOutput
+   {
+      bool compileOverallResults(const std::vector<TileReadThread*>& threads)
+      {
+         for (std::vector<TileReadThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            if (*iter == NULL || (*iter)->isSuccessful() == false)
+            {
+               return false;
+            }
+         }
+         return true;
+      }
+   };
+}
+
 Nitf::Pager::Pager() :
    mSegment(0),
    mpStep(NULL)
@@ -60,8 +197,30 @@ bool Nitf::Pager::parseInputArgs(PlugInArgList* pInputArgList)
 
 bool Nitf::Pager::openFile(const string& filename)
 {
-   mpImageHandler = Nitf::OssimImageHandlerResource(filename);
-   return mpImageHandler.get() != NULL;
+   mFilename = filename;
+   mImageHandlers.clear();
+   return getImageHandler(0) != NULL;
+}
+
+Nitf::PagerImageHandler* Nitf::Pager::getImageHandler(unsigned int index)
+{
+   while (index >= mImageHandlers.size())
+   {
+      boost::shared_ptr<PagerImageHandler> pHandler(new PagerImageHandler(mFilename));
+      ossimImageHandler* pImageHandler = pHandler->get();
+      if (pImageHandler == NULL || pImageHandler->canCastTo("ossimNitfTileSource") == false)
+      {
+         return NULL;
+      }
+
+      ossimNitfTileSource* pTileSource = PTR_CAST(ossimNitfTileSource, pImageHandler);
+      VERIFYRV(pTileSource != NULL, NULL);
+      pTileSource->setExpandLut(false);
+      pImageHandler->setCurrentEntry(mSegment);
+      mImageHandlers.push_back(pHandler);
+   }
+
+   return mImageHandlers[index].get();
 }
 
 CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
@@ -69,41 +228,32 @@ CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
    VERIFYRV(pOriginalRequest != NULL, CachedPage::UnitPtr());
    DimensionDescriptor startRow = pOriginalRequest->getStartRow();
    DimensionDescriptor stopRow = pOriginalRequest->getStopRow();
-   DimensionDescriptor startColumn = pOriginalRequest->getStartColumn();
-   DimensionDescriptor stopColumn = pOriginalRequest->getStopColumn();
    DimensionDescriptor startBand = pOriginalRequest->getStartBand();
-   DimensionDescriptor stopBand = pOriginalRequest->getStopBand();
    unsigned int concurrentRows = pOriginalRequest->getConcurrentRows();
    unsigned int concurrentColumns = getColumnCount();
    unsigned int concurrentBands = pOriginalRequest->getConcurrentBands();
 
    unsigned int rowNumber = startRow.getOnDiskNumber();
-   unsigned int colNumber = startColumn.getOnDiskNumber();
+   unsigned int colNumber = pOriginalRequest->getStartColumn().getOnDiskNumber();
    unsigned int bandNumber = startBand.getOnDiskNumber();
 
-   VERIFYRV(mpImageHandler.get() != NULL, CachedPage::UnitPtr());
-   if (mpImageHandler->canCastTo("ossimNitfTileSource") == false)
+   PagerImageHandler* pHandler = getImageHandler(0);
+   if (pHandler == NULL)
    {
       return CachedPage::UnitPtr();
    }
 
-   ossimNitfTileSource* pTileSource = PTR_CAST(ossimNitfTileSource, mpImageHandler.get());
-   VERIFYRV(pTileSource != NULL, CachedPage::UnitPtr());
-   pTileSource->setExpandLut(false);
-   mpImageHandler->setCurrentEntry(mSegment);
+   ossimImageHandler* pImageHandler = pHandler->get();
+   VERIFYRV(pImageHandler != NULL, CachedPage::UnitPtr());
 
-   // Try to set the output band list.
-   // If it cannot succeed (e.g.: for VQ), this is not an error.
    vector<ossim_uint32> bandList(concurrentBands);
    for (unsigned int band = 0; band < concurrentBands; ++band)
    {
       bandList[band] = bandNumber + band;
    }
 
-   mpImageHandler->setOutputBandList(bandList);
-
    // The Bounding Rectangle contains NITF Chipping Information.
-   ossimIrect br = mpImageHandler->getBoundingRect();
+   ossimIrect br = pImageHandler->getBoundingRect();
 
    int minx;
    int miny;
@@ -111,6 +261,22 @@ CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
    int maxy;
    br.getBounds(minx, miny, maxx, maxy);
 
+   // End the unit on a block boundary so that the next unit starts on one and
+   // no block is decoded by two consecutive units.  Very tall blocks are not
+   // aligned so that the unit is never more than twice the requested size.
+   int blockWidth = static_cast<int>(pImageHandler->getImageTileWidth());
+   int blockHeight = static_cast<int>(pImageHandler->getImageTileHeight());
+   if (blockHeight > 0)
+   {
+      unsigned int maxRows = stopRow.getActiveNumber() - startRow.getActiveNumber() + 1;
+      int stopY = rowNumber + miny + concurrentRows;
+      unsigned int extraRows = ((stopY + blockHeight - 1) / blockHeight) * blockHeight - stopY;
+      if (extraRows <= concurrentRows)
+      {
+         concurrentRows = std::min(maxRows, concurrentRows + extraRows);
+      }
+   }
+
    ossimIrect region(colNumber + minx, rowNumber + miny,
                      colNumber + minx + concurrentColumns-1, rowNumber + miny + concurrentRows-1);
 
@@ -121,10 +287,23 @@ CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
       return CachedPage::UnitPtr();
    }
 
-   ossimRefPtr<ossimImageData> cubeData = mpImageHandler->getTile(region);
-   if (cubeData == NULL || cubeData->getBuf() == NULL)
+   // Split the region into columns of blocks which can be decoded independently
+   TileReadInput input;
+   input.mBandList = bandList;
+   input.mRegion = region;
+   input.mSingleBand = (concurrentBands == 1);
+   input.mBytesPerBand = getBytesPerBand();
+   input.mpData = pData.get();
+   if (blockWidth <= 0)
    {
-      return CachedPage::UnitPtr();
+      blockWidth = concurrentColumns;
+   }
+
+   for (int x = region.ul().x; x <= region.lr().x; )
+   {
+      int stripStopX = std::min(((x / blockWidth) + 1) * blockWidth - 1, region.lr().x);
+      input.mStrips.push_back(ossimIrect(x, region.ul().y, stripStopX, region.lr().y));
+      x = stripStopX + 1;
    }
 
    if (concurrentBands == 1)
@@ -138,34 +317,46 @@ CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
       // interleave is equivalent to any other interleave, it also happens to be a very convenient optimization for
       // single band data. And since ossimImageData stores data as BSQ, memcpy is safe to use in this scenario.
 
-      // Since concurrentBands is set to 1, the earlier call to setOutputBandList only requested a single band. In the
+      // Since concurrentBands is set to 1, the output band list only requested a single band. In the
       // case of VQ, there will actually be 3 bands, all of which must be identical because ossimNitfTileSource only
-      // accepts single-band VQ. In all other cases, the call to setOutputBandList will have restricted cubeData to a
+      // accepts single-band VQ. In all other cases, the output band list will have restricted cubeData to a
       // single band, meaning that the only valid parameter to cubeData->getBuf is a 0. This parameter cannot be
-      // bandNumber because of the earlier call to setOutputBandList (setting it to bandNumber returns a NULL pointer).
-      memcpy(pData.get(), cubeData->getBuf(0), dstSize);
+      // bandNumber because of the output band list (setting it to bandNumber returns a NULL pointer).
+      input.mInterleave = OSSIM_BSQ;
+   }
+   else if (pOriginalRequest->getInterleaveFormat() == BSQ)
+   {
+      input.mInterleave = OSSIM_BSQ;
+   }
+   else if (pOriginalRequest->getInterleaveFormat() == BIL)
+   {
+      input.mInterleave = OSSIM_BIL;
+   }
+   else if (pOriginalRequest->getInterleaveFormat() == BIP)
+   {
+      input.mInterleave = OSSIM_BIP;
    }
    else
    {
-      ossimInterleaveType interleave;
-      if (pOriginalRequest->getInterleaveFormat() == BSQ)
-      {
-         interleave = OSSIM_BSQ;
-      }
-      else if (pOriginalRequest->getInterleaveFormat() == BIL)
-      {
-         interleave = OSSIM_BIL;
-      }
-      else if (pOriginalRequest->getInterleaveFormat() == BIP)
-      {
-         interleave = OSSIM_BIP;
-      }
-      else
+      return CachedPage::UnitPtr();
+   }
+
+   unsigned int threadCount = mta::getNumRequiredThreads(input.mStrips.size());
+   for (unsigned int thread = 0; thread < threadCount; ++thread)
+   {
+      PagerImageHandler* pThreadHandler = getImageHandler(thread);
+      if (pThreadHandler == NULL)
       {
          return CachedPage::UnitPtr();
       }
+      input.mHandlers.push_back(pThreadHandler);
+   }
 
-      cubeData->unloadTile(pData.get(), region, interleave);
+   TileReadOutput output;
+   mta::MultiThreadedAlgorithm<TileReadInput, TileReadOutput, TileReadThread> alg(threadCount, input, output, NULL);
+   if (alg.run() != mta::SUCCESS)
+   {
+      return CachedPage::UnitPtr();
    }
 
    return CachedPage::UnitPtr(new CachedPage::CacheUnit(pData.release(), startRow, concurrentRows,
@@ -14,12 +14,16 @@
 #include "NitfResource.h"
 #include "PlugInArg.h"
 
+#include <boost/shared_ptr.hpp>
+#include <string>
 #include <vector>
 
 class NITF_IMAGE_SEGMENT_BASE;
 
 namespace Nitf
 {
+   class PagerImageHandler;
+
    class Pager : public CachedPager
    {
    public:
@@ -46,11 +50,26 @@ namespace Nitf
 
       virtual CachedPage::UnitPtr fetchUnit(DataRequest *pOriginalRequest);
 
+      /**
+       *  Gets an image handler for the segment, opening the file if necessary.
+       *
+       *  Each handler keeps its current entry and output band list between
+       *  calls, so independent blocks can be decoded concurrently by using a
+       *  different handler in each thread.
+       *
+       *  @param   index
+       *           The index of the handler in the pool.
+       *
+       *  @return  The handler or \c NULL if the file could not be opened.
+       */
+      PagerImageHandler* getImageHandler(unsigned int index);
+
    private:
       Pager& operator=(const Pager& rhs);
 
       unsigned int mSegment; // 0-based segment number
-      Nitf::OssimImageHandlerResource mpImageHandler;
+      std::string mFilename;
+      std::vector<boost::shared_ptr<PagerImageHandler> > mImageHandlers;
       Step* mpStep;
    };
 }
@@ -13,13 +13,16 @@
 #include "DataElement.h"
 #include "DynamicObject.h"
 #include "NitfConstants.h"
+#include "NitfMetadataParsing.h"
 #include "NitfPropertiesManager.h"
 #include "NitfProperties.h"
 #include "PlugInDescriptor.h"
 #include "PlugInManagerServices.h"
 #include "PlugInRegistration.h"
 #include "PlugInResource.h"
+#include "RasterDataDescriptor.h"
 #include "Slot.h"
+#include "StepResource.h"
 #include "StringUtilities.h"
 
 REGISTER_PLUGIN(OpticksNitf, NitfPropertiesManager, Nitf::NitfPropertiesManager);
@@ -107,6 +110,23 @@ void NitfPropertiesManager::addProperties(Subject& subject, const std::string& s
    VERIFYNRV(data.second);
    DataElement* pElement = dynamic_cast<DataElement*>(data.first);
    DataDescriptor* pDesc = (pElement == NULL) ? NULL : pElement->getDataDescriptor();
+
+   // The properties dialog displays all of the metadata, so parse every TRE which was deferred during import
+   RasterDataDescriptor* pRasterDesc = dynamic_cast<RasterDataDescriptor*>(pDesc);
+   if (pRasterDesc != NULL)
+   {
+      std::map<std::string, TrePlugInResource> parsers;
+      std::string errorMessage;
+      Nitf::importDeferredMetadata(pRasterDesc, parsers, errorMessage);
+      if (errorMessage.empty() == false)
+      {
+         StepResource pStep("Import NITF TREs", "app", "0F4B8A6E-2D73-4C19-B5E8-7A3D91C6F204");
+         pStep->addProperty("name", pElement->getName());
+         pStep->finalize(Message::Failure, errorMessage);
+         mpDesktop->showMessageBox("NITF Properties", "Some TREs could not be imported:\n" + errorMessage);
+      }
+   }
+
    const DynamicObject* pMeta = (pDesc == NULL) ? NULL : pDesc->getMetadata();
    const DynamicObject* pTres = (pMeta == NULL) ? NULL : dv_cast<DynamicObject>(
       &pMeta->getAttributeByPath(Nitf::NITF_METADATA + "/" + Nitf::TRE_METADATA));
@@ -9,6 +9,7 @@
 
 #include "AppVerify.h"
 #include "AppVersion.h"
+#include "BadValues.h"
 #include "DataVariant.h"
 #include "DynamicObject.h"
 #include "GeoreferenceDescriptor.h"
@@ -28,6 +29,9 @@
 
 #include <ossim/base/ossimKeywordlist.h>
 
+#include <algorithm>
+#include <limits>
+#include <math.h>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -43,7 +47,9 @@ REGISTER_PLUGIN(OpticksNitf, RpcGeoreference, Nitf::RpcGeoreference);
 Nitf::RpcGeoreference::RpcGeoreference() :
    mpRaster(NULL),
    mHeight(0.0),
-   mpGui(NULL)
+   mpGui(NULL),
+   mGridRows(0),
+   mGridColumns(0)
 {
    setName("RPC Georeference");
    setVersion(APP_VERSION_NUMBER);
@@ -64,6 +70,23 @@ Nitf::RpcGeoreference::~RpcGeoreference()
 
 namespace
 {
+   // The terrain intersection stops when the height changes by less than this many meters
+   const int sMaxTerrainIterations = 10;
+   const double sTerrainTolerance = 0.5;
+
+   // Spacing in pixels of the cached grid nodes and the maximum number of nodes in each dimension
+   const double sGridSpacing = 64.0;
+   const unsigned int sMaxGridNodes = 65;
+
+   // Maximum error in pixels of the quick conversions
+   const double sQuickTolerance = 0.25;
+   const int sMaxQuickIterations = 3;
+
+   double getPixelDistance(LocationType first, LocationType second)
+   {
+      return sqrt((first.mX - second.mX) * (first.mX - second.mX) + (first.mY - second.mY) * (first.mY - second.mY));
+   }
+
    struct FindFirstValidRpc
    {
       bool operator()(const DynamicObject& dynObj)
@@ -108,6 +131,18 @@ bool Nitf::RpcGeoreference::execute(PlugInArgList* pInParam, PlugInArgList* pOut
 
    bool heightArgSet = pInParam->getPlugInArgValue<double>("Height", mHeight);
 
+   mpDem.reset(pInParam->getPlugInArgValue<RasterElement>("DEM"));
+   if (mpDem.get() != NULL && mpDem->isGeoreferenced() == false)
+   {
+      messageText = "The DEM is not georeferenced and will not be used.";
+      if (pProgress)
+      {
+         pProgress->updateProgress(messageText, 0, WARNING);
+      }
+      pStep->addMessage(messageText, "app", "7C0D6A9E-5B49-4B43-A1D6-1C6F4A6C2E35", true);
+      mpDem.reset(NULL);
+   }
+
    // If the height value was not contained in the arg list, get the value from the georeference descriptor
    RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(mpRaster->getDataDescriptor());
    if (pDescriptor == NULL)
@@ -286,6 +321,12 @@ bool Nitf::RpcGeoreference::execute(PlugInArgList* pInParam, PlugInArgList* pOut
       return false;
    }
 
+   if (pProgress)
+   {
+      pProgress->updateProgress("Building the RPC georeference grid...", 50, NORMAL);
+   }
+   buildGrids();
+
    mpRaster->setGeoreferencePlugin(this);
 
    // Update the georeference descriptor with the current georeference parameters if necessary
@@ -324,54 +365,385 @@ bool Nitf::RpcGeoreference::getInputSpecification(PlugInArgList*& pArgList)
    VERIFY(pArgList != NULL);
    VERIFY(pArgList->addArg<double>("Height", "Height value for the georeferencing calculations in meters.  If not "
       "specified, the height value contained in the " + Executable::DataElementArg() + " input will be used.") == true);
+   VERIFY(pArgList->addArg<RasterElement>("DEM", NULL, "Georeferenced elevation raster, such as a DTED element, "
+      "from which terrain heights in meters are taken.  The Height value is used where the DEM has no data.") == true);
 
    return true;
 }
 
 LocationType Nitf::RpcGeoreference::pixelToGeo(LocationType pixel, bool* pAccurate) const
 {
-   pixel = mpChipConverter->activeToOriginal(pixel);
-   ossimDpt imagePoint(pixel.mX, pixel.mY);
-   ossimGpt worldPoint;
-   mModel.lineSampleHeightToWorld(imagePoint, mHeight, worldPoint);
-   if (worldPoint.isNan())
+   LocationType geo;
+   double height = mHeight;
+   bool accurate = intersectTerrain(pixel, geo, height);
+   if (pAccurate != NULL)
+   {
+      *pAccurate = accurate;
+   }
+
+   return geo;
+}
+
+LocationType Nitf::RpcGeoreference::pixelToGeoQuick(LocationType pixel, bool* pAccurate) const
+{
+   if (mGridRows < 2 || mGridColumns < 2)
+   {
+      return pixelToGeo(pixel, pAccurate);
+   }
+
+   double gridColumn = pixel.mX / mGridSpacing.mX;
+   double gridRow = pixel.mY / mGridSpacing.mY;
+   if (gridColumn < 0.0 || gridRow < 0.0 || gridColumn > mGridColumns - 1 || gridRow > mGridRows - 1)
    {
-      if (pAccurate != NULL)
+      return pixelToGeo(pixel, pAccurate);
+   }
+
+   unsigned int column = std::min(static_cast<unsigned int>(gridColumn), mGridColumns - 2);
+   unsigned int row = std::min(static_cast<unsigned int>(gridRow), mGridRows - 2);
+   if (mGridCellValid[row * (mGridColumns - 1) + column] == false)
+   {
+      return pixelToGeo(pixel, pAccurate);
+   }
+
+   // Bilinear estimate from the cell corners
+   unsigned int node = row * mGridColumns + column;
+   const LocationType& geo00 = mGridGeocoords[node];
+   const LocationType& geo01 = mGridGeocoords[node + 1];
+   const LocationType& geo10 = mGridGeocoords[node + mGridColumns];
+   const LocationType& geo11 = mGridGeocoords[node + mGridColumns + 1];
+   double fx = gridColumn - column;
+   double fy = gridRow - row;
+
+   LocationType geo = (geo00 * (1.0 - fx) + geo01 * fx) * (1.0 - fy) + (geo10 * (1.0 - fx) + geo11 * fx) * fy;
+   double height = (mGridHeights[node] * (1.0 - fx) + mGridHeights[node + 1] * fx) * (1.0 - fy) +
+      (mGridHeights[node + mGridColumns] * (1.0 - fx) + mGridHeights[node + mGridColumns + 1] * fx) * fy;
+
+   // Geocoordinate change per pixel within the cell
+   LocationType dGeoDx = ((geo01 - geo00) * (1.0 - fy) + (geo11 - geo10) * fy) * (1.0 / mGridSpacing.mX);
+   LocationType dGeoDy = ((geo10 - geo00) * (1.0 - fx) + (geo11 - geo01) * fx) * (1.0 / mGridSpacing.mY);
+
+   // Refine the estimate with the forward model until it projects to the requested pixel
+   for (int i = 0; i < sMaxQuickIterations; ++i)
+   {
+      LocationType projected;
+      if (projectToPixel(geo, height, projected) == false)
       {
-         *pAccurate = false;
+         break;
       }
-      return LocationType();
+
+      if (getPixelDistance(projected, pixel) <= sQuickTolerance)
+      {
+         if (pAccurate != NULL)
+         {
+            *pAccurate = true;
+         }
+         return geo;
+      }
+
+      geo += dGeoDx * (pixel.mX - projected.mX) + dGeoDy * (pixel.mY - projected.mY);
    }
 
+   return pixelToGeo(pixel, pAccurate);
+}
+
+LocationType Nitf::RpcGeoreference::geoToPixel(LocationType geo, bool* pAccurate) const
+{
+   double height = mHeight;
+   getTerrainHeight(geo, height);
+
+   LocationType pixel;
+   bool accurate = projectToPixel(geo, height, pixel);
    if (pAccurate != NULL)
    {
-      *pAccurate = true;
+      *pAccurate = accurate;
    }
-   return LocationType(worldPoint.latd(), worldPoint.lond());
+
+   return pixel;
 }
 
-LocationType Nitf::RpcGeoreference::geoToPixel(LocationType geo, bool* pAccurate) const
+LocationType Nitf::RpcGeoreference::geoToPixelQuick(LocationType geo, bool* pAccurate) const
+{
+   if (mHeightGrid.empty() == true)
+   {
+      return geoToPixel(geo, pAccurate);
+   }
+
+   double gridColumn = (geo.mY - mHeightGridOrigin.mY) / mHeightGridSpacing.mY;
+   double gridRow = (geo.mX - mHeightGridOrigin.mX) / mHeightGridSpacing.mX;
+   if (gridColumn < 0.0 || gridRow < 0.0 || gridColumn > mGridColumns - 1 || gridRow > mGridRows - 1)
+   {
+      return geoToPixel(geo, pAccurate);
+   }
+
+   unsigned int column = std::min(static_cast<unsigned int>(gridColumn), mGridColumns - 2);
+   unsigned int row = std::min(static_cast<unsigned int>(gridRow), mGridRows - 2);
+   unsigned int node = row * mGridColumns + column;
+   double fx = gridColumn - column;
+   double fy = gridRow - row;
+   double height = (mHeightGrid[node] * (1.0 - fx) + mHeightGrid[node + 1] * fx) * (1.0 - fy) +
+      (mHeightGrid[node + mGridColumns] * (1.0 - fx) + mHeightGrid[node + mGridColumns + 1] * fx) * fy;
+
+   LocationType pixel;
+   bool accurate = projectToPixel(geo, height, pixel);
+   if (pAccurate != NULL)
+   {
+      *pAccurate = accurate;
+   }
+
+   return pixel;
+}
+
+/**
+ *  Gets the DEM height at a geocoordinate.
+ *
+ *  @param   geo
+ *           The latitude and longitude.
+ *  @param   height
+ *           Set to the bilinearly interpolated DEM height in meters.  It is not
+ *           modified if the geocoordinate is outside of the DEM or on a void.
+ *
+ *  @return  Returns \c true if the height was taken from the DEM.
+ */
+bool Nitf::RpcGeoreference::getTerrainHeight(LocationType geo, double& height) const
+{
+   const RasterElement* pDem = mpDem.get();
+   if (pDem == NULL)
+   {
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pDem->getDataDescriptor());
+   if (pDescriptor == NULL || pDescriptor->getRowCount() == 0 || pDescriptor->getColumnCount() == 0)
+   {
+      return false;
+   }
+
+   // Pixel centers are at the half pixel locations
+   LocationType demPixel = pDem->convertGeocoordToPixel(geo, true) - LocationType(0.5, 0.5);
+   int numColumns = static_cast<int>(pDescriptor->getColumnCount());
+   int numRows = static_cast<int>(pDescriptor->getRowCount());
+   if (demPixel.mX < -0.5 || demPixel.mY < -0.5 || demPixel.mX > numColumns - 0.5 || demPixel.mY > numRows - 0.5)
+   {
+      return false;
+   }
+
+   double column = std::max(0.0, std::min(demPixel.mX, numColumns - 1.0));
+   double row = std::max(0.0, std::min(demPixel.mY, numRows - 1.0));
+   int column0 = static_cast<int>(column);
+   int row0 = static_cast<int>(row);
+   int column1 = std::min(column0 + 1, numColumns - 1);
+   int row1 = std::min(row0 + 1, numRows - 1);
+
+   double heights[4];
+   heights[0] = pDem->getPixelValue(pDescriptor->getActiveColumn(column0), pDescriptor->getActiveRow(row0));
+   heights[1] = pDem->getPixelValue(pDescriptor->getActiveColumn(column1), pDescriptor->getActiveRow(row0));
+   heights[2] = pDem->getPixelValue(pDescriptor->getActiveColumn(column0), pDescriptor->getActiveRow(row1));
+   heights[3] = pDem->getPixelValue(pDescriptor->getActiveColumn(column1), pDescriptor->getActiveRow(row1));
+
+   const BadValues* pBadValues = pDescriptor->getBadValues();
+   if (pBadValues != NULL)
+   {
+      for (int i = 0; i < 4; ++i)
+      {
+         if (pBadValues->isBadValue(heights[i]))
+         {
+            return false;
+         }
+      }
+   }
+
+   double fx = column - column0;
+   double fy = row - row0;
+   height = (heights[0] * (1.0 - fx) + heights[1] * fx) * (1.0 - fy) + (heights[2] * (1.0 - fx) + heights[3] * fx) * fy;
+   return true;
+}
+
+/**
+ *  Intersects the line of sight of an active pixel with the terrain.
+ *
+ *  The RPC model is solved at the height of the previous solution's DEM
+ *  location until the height converges.  Without a DEM, the model is solved
+ *  once at the constant height.
+ */
+bool Nitf::RpcGeoreference::intersectTerrain(LocationType pixel, LocationType& geo, double& height) const
 {
+   if (mpChipConverter.get() == NULL)
+   {
+      return false;
+   }
+
+   pixel = mpChipConverter->activeToOriginal(pixel);
+   ossimDpt imagePoint(pixel.mX, pixel.mY);
+   ossimGpt worldPoint;
+   for (int i = 0; i < sMaxTerrainIterations; ++i)
+   {
+      mModel.lineSampleHeightToWorld(imagePoint, height, worldPoint);
+      if (worldPoint.isNan())
+      {
+         return false;
+      }
+
+      geo = LocationType(worldPoint.latd(), worldPoint.lond());
+
+      double terrainHeight = height;
+      if (getTerrainHeight(geo, terrainHeight) == false || fabs(terrainHeight - height) < sTerrainTolerance)
+      {
+         break;
+      }
+      height = terrainHeight;
+   }
+
+   return true;
+}
+
+bool Nitf::RpcGeoreference::projectToPixel(LocationType geo, double height, LocationType& pixel) const
+{
+   if (mpChipConverter.get() == NULL)
+   {
+      return false;
+   }
+
    ossimGpt worldPoint;
    worldPoint.latd(geo.mX);
    worldPoint.lond(geo.mY);
-   worldPoint.height(mHeight);
+   worldPoint.height(height);
    ossimDpt imagePoint;
    mModel.worldToLineSample(worldPoint, imagePoint);
    if (imagePoint.isNan())
    {
-      if (pAccurate != NULL)
+      return false;
+   }
+
+   pixel = mpChipConverter->originalToActive(LocationType(imagePoint.x, imagePoint.y));
+   return true;
+}
+
+/**
+ *  Builds the grids used by the quick conversions.
+ *
+ *  The terrain is intersected at regularly spaced pixels over the active image.
+ *  A grid cell is only used by pixelToGeoQuick() if bilinear interpolation of
+ *  its corners is within the quick tolerance at the center of the cell, so
+ *  cells over rough terrain fall back to the full intersection.  When a DEM is
+ *  used, the DEM heights are also sampled over the geographic extent of the
+ *  image so that geoToPixelQuick() does not need to read the DEM.
+ */
+void Nitf::RpcGeoreference::buildGrids()
+{
+   mGridRows = 0;
+   mGridColumns = 0;
+   mGridGeocoords.clear();
+   mGridHeights.clear();
+   mGridNodeValid.clear();
+   mGridCellValid.clear();
+   mHeightGrid.clear();
+
+   if (mpRaster == NULL || mpChipConverter.get() == NULL)
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   if (pDescriptor == NULL || pDescriptor->getRowCount() == 0 || pDescriptor->getColumnCount() == 0)
+   {
+      return;
+   }
+
+   double numColumns = pDescriptor->getColumnCount();
+   double numRows = pDescriptor->getRowCount();
+   mGridColumns = std::max(2u, std::min(sMaxGridNodes, static_cast<unsigned int>(ceil(numColumns / sGridSpacing)) + 1));
+   mGridRows = std::max(2u, std::min(sMaxGridNodes, static_cast<unsigned int>(ceil(numRows / sGridSpacing)) + 1));
+   mGridSpacing = LocationType(numColumns / (mGridColumns - 1), numRows / (mGridRows - 1));
+
+   unsigned int numNodes = mGridRows * mGridColumns;
+   mGridGeocoords.resize(numNodes);
+   mGridHeights.resize(numNodes, mHeight);
+   mGridNodeValid.resize(numNodes, false);
+   for (unsigned int row = 0; row < mGridRows; ++row)
+   {
+      for (unsigned int column = 0; column < mGridColumns; ++column)
       {
-         *pAccurate = false;
+         unsigned int node = row * mGridColumns + column;
+         LocationType pixel(column * mGridSpacing.mX, row * mGridSpacing.mY);
+         mGridNodeValid[node] = intersectTerrain(pixel, mGridGeocoords[node], mGridHeights[node]);
       }
-      return LocationType();
    }
 
-   if (pAccurate != NULL)
+   mGridCellValid.resize((mGridRows - 1) * (mGridColumns - 1), false);
+   for (unsigned int row = 0; row + 1 < mGridRows; ++row)
    {
-      *pAccurate = true;
+      for (unsigned int column = 0; column + 1 < mGridColumns; ++column)
+      {
+         unsigned int node = row * mGridColumns + column;
+         if (mGridNodeValid[node] == false || mGridNodeValid[node + 1] == false ||
+            mGridNodeValid[node + mGridColumns] == false || mGridNodeValid[node + mGridColumns + 1] == false)
+         {
+            continue;
+         }
+
+         LocationType center((column + 0.5) * mGridSpacing.mX, (row + 0.5) * mGridSpacing.mY);
+         LocationType centerGeo;
+         double centerHeight = mHeight;
+         if (intersectTerrain(center, centerGeo, centerHeight) == false)
+         {
+            continue;
+         }
+
+         LocationType interpolatedGeo = (mGridGeocoords[node] + mGridGeocoords[node + 1] +
+            mGridGeocoords[node + mGridColumns] + mGridGeocoords[node + mGridColumns + 1]) * 0.25;
+         double interpolatedHeight = (mGridHeights[node] + mGridHeights[node + 1] +
+            mGridHeights[node + mGridColumns] + mGridHeights[node + mGridColumns + 1]) * 0.25;
+
+         // Both the interpolated location and the interpolated height must be within the tolerance
+         LocationType interpolatedPixel;
+         LocationType heightPixel;
+         if (projectToPixel(interpolatedGeo, interpolatedHeight, interpolatedPixel) &&
+            projectToPixel(centerGeo, interpolatedHeight, heightPixel))
+         {
+            mGridCellValid[row * (mGridColumns - 1) + column] =
+               getPixelDistance(interpolatedPixel, center) <= sQuickTolerance &&
+               getPixelDistance(heightPixel, center) <= sQuickTolerance;
+         }
+      }
+   }
+
+   if (mpDem.get() == NULL)
+   {
+      return;
+   }
+
+   // The height grid covers the geographic extent of the image with the same number of nodes
+   double minLat = numeric_limits<double>::max();
+   double maxLat = -numeric_limits<double>::max();
+   double minLon = numeric_limits<double>::max();
+   double maxLon = -numeric_limits<double>::max();
+   for (unsigned int node = 0; node < numNodes; ++node)
+   {
+      if (mGridNodeValid[node] == true)
+      {
+         minLat = std::min(minLat, mGridGeocoords[node].mX);
+         maxLat = std::max(maxLat, mGridGeocoords[node].mX);
+         minLon = std::min(minLon, mGridGeocoords[node].mY);
+         maxLon = std::max(maxLon, mGridGeocoords[node].mY);
+      }
+   }
+
+   if (minLat >= maxLat || minLon >= maxLon)
+   {
+      return;
+   }
+
+   mHeightGridOrigin = LocationType(minLat, minLon);
+   mHeightGridSpacing = LocationType((maxLat - minLat) / (mGridRows - 1), (maxLon - minLon) / (mGridColumns - 1));
+   mHeightGrid.resize(numNodes, mHeight);
+   for (unsigned int row = 0; row < mGridRows; ++row)
+   {
+      for (unsigned int column = 0; column < mGridColumns; ++column)
+      {
+         LocationType geo(minLat + row * mHeightGridSpacing.mX, minLon + column * mHeightGridSpacing.mY);
+         getTerrainHeight(geo, mHeightGrid[row * mGridColumns + column]);
+      }
    }
-   return mpChipConverter->originalToActive(LocationType(imagePoint.x, imagePoint.y));
 }
 
 const DynamicObject* Nitf::RpcGeoreference::getRpcInstance(const RasterDataDescriptor* pDescriptor) const
@@ -495,7 +867,20 @@ bool Nitf::RpcGeoreference::serialize(SessionItemSerializer& serializer) const
       return false;
    }
    ossimString str = kwl.toString();
-   return serializer.serialize(str.chars(), str.size());
+   if (!serializer.serialize(str.chars(), str.size()))
+   {
+      return false;
+   }
+
+   const RasterElement* pDem = mpDem.get();
+   if (pDem != NULL)
+   {
+      serializer.endBlock();
+      string demId = pDem->getId();
+      return serializer.serialize(demId.c_str(), demId.size());
+   }
+
+   return true;
 }
 
 bool Nitf::RpcGeoreference::deserialize(SessionItemDeserializer& deserializer)
@@ -507,7 +892,7 @@ bool Nitf::RpcGeoreference::deserialize(SessionItemDeserializer& deserializer)
       return true;
    }
 
-   if (sizes.size() != 2)
+   if (sizes.size() != 2 && sizes.size() != 3)
    {
       return false;
    }
@@ -516,6 +901,15 @@ bool Nitf::RpcGeoreference::deserialize(SessionItemDeserializer& deserializer)
    bool success = deserializer.deserialize(&id[0], id.size());
    deserializer.nextBlock();
    success = success && deserializer.deserialize(&state[0], state.size());
+
+   string demId;
+   if (sizes.size() == 3)
+   {
+      demId.resize(sizes[2]);
+      deserializer.nextBlock();
+      success = success && deserializer.deserialize(&demId[0], demId.size());
+   }
+
    if (!success)
    {
       return false;
@@ -548,5 +942,16 @@ bool Nitf::RpcGeoreference::deserialize(SessionItemDeserializer& deserializer)
    {
       return false;
    }
-   return mModel.loadState(kwl);
+   if (!mModel.loadState(kwl))
+   {
+      return false;
+   }
+
+   if (demId.empty() == false)
+   {
+      mpDem.reset(dynamic_cast<RasterElement*>(Service<SessionManager>()->getSessionItem(demId)));
+   }
+
+   buildGrids();
+   return true;
 }
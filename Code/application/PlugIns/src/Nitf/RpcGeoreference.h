@@ -10,17 +10,19 @@
 #ifndef RPCGEOREFERENCE_H
 #define RPCGEOREFERENCE_H
 
+#include "AttachmentPtr.h"
 #include "GeoreferenceShell.h"
 #include "NitfChipConverter.h"
+#include "RasterElement.h"
 
 #include <ossim/projection/ossimRpcModel.h>
 #include <memory>
+#include <vector>
 
 #define NUM_RPC_COEFFICIENTS 20
 
 class DynamicObject;
 class PlugInArgList;
-class RasterElement;
 class RpcGui;
 
 namespace Nitf
@@ -38,13 +40,19 @@ namespace Nitf
       QWidget* getWidget(RasterDataDescriptor* pDescriptor);
       bool validate(const RasterDataDescriptor* pDescriptor, std::string& errorMessage) const;
       LocationType pixelToGeo(LocationType pixel, bool* pAccurate = NULL) const;
+      LocationType pixelToGeoQuick(LocationType pixel, bool* pAccurate = NULL) const;
       LocationType geoToPixel(LocationType geo, bool* pAccurate = NULL) const;
+      LocationType geoToPixelQuick(LocationType geo, bool* pAccurate = NULL) const;
 
       bool serialize(SessionItemSerializer &serializer) const;
       bool deserialize(SessionItemDeserializer &deserializer);
 
    private:
       const DynamicObject* getRpcInstance(const RasterDataDescriptor* pDescriptor) const;
+      bool getTerrainHeight(LocationType geo, double& height) const;
+      bool intersectTerrain(LocationType pixel, LocationType& geo, double& height) const;
+      bool projectToPixel(LocationType geo, double height, LocationType& pixel) const;
+      void buildGrids();
 
       RasterElement* mpRaster;
       mutable std::string mRpcVersion;
@@ -53,7 +61,22 @@ namespace Nitf
 
       ossimRpcModel mModel;
       double mHeight;
+      AttachmentPtr<RasterElement> mpDem;
       RpcGui* mpGui;
+
+      // Terrain intersections at regularly spaced active pixels, used by pixelToGeoQuick()
+      unsigned int mGridRows;
+      unsigned int mGridColumns;
+      LocationType mGridSpacing;
+      std::vector<LocationType> mGridGeocoords;
+      std::vector<double> mGridHeights;
+      std::vector<bool> mGridNodeValid;
+      std::vector<bool> mGridCellValid;
+
+      // Terrain heights at regularly spaced geocoordinates over the image, used by geoToPixelQuick()
+      LocationType mHeightGridOrigin;
+      LocationType mHeightGridSpacing;
+      std::vector<double> mHeightGrid;
    };
 }
 
@@ -25,53 +25,355 @@
 #include "RasterUtilities.h"
 #include "SpatialDataView.h"
 #include "StringUtilities.h"
-#include "UtilityServices.h"
 
-#include <opencv2/imgproc/imgproc.hpp>
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "MultiThreadedAlgorithm.h"
+
+#include <algorithm>
+#include <limits>
 
 REGISTER_PLUGIN_BASIC(OpticksObjectFinding, ConnectedComponents);
 
 namespace
 {
-   void fillContours(cv::Mat labels,
-                     const std::vector<std::vector<cv::Point> >& contours,
-                     const std::vector<cv::Vec4i>& hierarchy,
-                     unsigned short& label,
-                     unsigned short parentLabel, // or 0 for an external
-                     int contourIdx)
-   {
-      if (static_cast<int>(hierarchy.size()) <= contourIdx)
+   // Tiles are small enough that the number of 8-connected components in a tile fits in a label
+   const int TILE_SIZE = 256;
+
+   struct Component
+   {
+      Component() :
+         mArea(0),
+         mMinX(std::numeric_limits<int>::max()),
+         mMinY(std::numeric_limits<int>::max()),
+         mMaxX(std::numeric_limits<int>::min()),
+         mMaxY(std::numeric_limits<int>::min()),
+         mSumX(0.0),
+         mSumY(0.0)
+      {}
+
+      void addPixel(int x, int y)
+      {
+         if (mArea == 0)
+         {
+            mFirstX = x;
+            mFirstY = y;
+         }
+         ++mArea;
+         mMinX = std::min(mMinX, x);
+         mMinY = std::min(mMinY, y);
+         mMaxX = std::max(mMaxX, x);
+         mMaxY = std::max(mMaxY, y);
+         mSumX += x;
+         mSumY += y;
+      }
+
+      void merge(const Component& other)
+      {
+         if (other.mFirstY < mFirstY || (other.mFirstY == mFirstY && other.mFirstX < mFirstX))
+         {
+            mFirstX = other.mFirstX;
+            mFirstY = other.mFirstY;
+         }
+         mArea += other.mArea;
+         mMinX = std::min(mMinX, other.mMinX);
+         mMinY = std::min(mMinY, other.mMinY);
+         mMaxX = std::max(mMaxX, other.mMaxX);
+         mMaxY = std::max(mMaxY, other.mMaxY);
+         mSumX += other.mSumX;
+         mSumY += other.mSumY;
+      }
+
+      // Orders components by their first pixel in raster order
+      bool operator<(const Component& other) const
+      {
+         return mFirstY < other.mFirstY || (mFirstY == other.mFirstY && mFirstX < other.mFirstX);
+      }
+
+      unsigned int mArea;
+      int mFirstX;
+      int mFirstY;
+      int mMinX;
+      int mMinY;
+      int mMaxX;
+      int mMaxY;
+      double mSumX;
+      double mSumY;
+   };
+
+   // The components found in a tile along with the local labels on its edges,
+   // which are used to merge components which cross tile boundaries.
+   struct Tile
+   {
+      int mStartRow;
+      int mStartColumn;
+      int mRows;
+      int mColumns;
+      std::vector<Component> mComponents;
+      std::vector<unsigned short> mTop;
+      std::vector<unsigned short> mBottom;
+      std::vector<unsigned short> mLeft;
+      std::vector<unsigned short> mRight;
+   };
+
+   class BlobLess
+   {
+   public:
+      BlobLess(const std::vector<Component>& blobs) :
+         mBlobs(blobs)
+      {}
+
+      bool operator()(int first, int second) const
+      {
+         return mBlobs[first] < mBlobs[second];
+      }
+
+   private:
+      const std::vector<Component>& mBlobs;
+   };
+
+   int findRoot(std::vector<int>& parents, int label)
+   {
+      int root = label;
+      while (parents[root] != root)
+      {
+         root = parents[root];
+      }
+      while (parents[label] != root)
+      {
+         int next = parents[label];
+         parents[label] = root;
+         label = next;
+      }
+      return root;
+   }
+
+   void unite(std::vector<int>& parents, int first, int second)
+   {
+      first = findRoot(parents, first);
+      second = findRoot(parents, second);
+      if (first < second)
+      {
+         parents[second] = first;
+      }
+      else if (second < first)
       {
-         return;
+         parents[first] = second;
       }
-      // Loop all contours at this level of the tree
-      while (contourIdx != -1)
+   }
+
+   DataAccessor getTileAccessor(RasterElement* pLabels, const Tile& tile)
+   {
+      const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(pLabels->getDataDescriptor());
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(pDescriptor->getActiveRow(tile.mStartRow),
+         pDescriptor->getActiveRow(tile.mStartRow + tile.mRows - 1), 1);
+      pRequest->setColumns(pDescriptor->getActiveColumn(tile.mStartColumn),
+         pDescriptor->getActiveColumn(tile.mStartColumn + tile.mColumns - 1));
+      pRequest->setWritable(true);
+      return pLabels->getDataAccessor(pRequest.release());
+   }
+
+   struct LabelThreadInput
+   {
+      LabelThreadInput() :
+         mpBitmask(NULL),
+         mpLabels(NULL),
+         mpTiles(NULL),
+         mpFinalLabels(NULL),
+         mpTileBases(NULL),
+         mpAbortFlag(NULL),
+         mXOffset(0),
+         mYOffset(0)
+      {}
+
+      const BitMask* mpBitmask;
+      RasterElement* mpLabels;
+      std::vector<Tile>* mpTiles;
+      // When NULL, tiles are labeled. Otherwise, local labels are replaced with these final labels.
+      const std::vector<unsigned short>* mpFinalLabels;
+      const std::vector<int>* mpTileBases;
+      const bool* mpAbortFlag;
+      int mXOffset;
+      int mYOffset;
+   };
+
+   class LabelThread : public mta::AlgorithmThread
+   {
+   public:
+      LabelThread(const LabelThreadInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mpTiles->size())))
+      {}
+
+      void run()
       {
-         if (parentLabel > 0)
+         int count = mRange.mLast - mRange.mFirst + 1;
+         for (int idx = mRange.mFirst; idx <= mRange.mLast; ++idx)
          {
-            // Internal contours include the edge of object, not the edge of the hole
-            // So we blank out the internal contour then redraw the contour line
-            cv::drawContours(labels, contours, contourIdx, cv::Scalar(0), CV_FILLED, 8, hierarchy, 0);
-            cv::drawContours(labels, contours, contourIdx, cv::Scalar(parentLabel), 1, 8, hierarchy, 0);
-            if (hierarchy[contourIdx][2] != -1)
+            if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
             {
-               // If there are nested contours, draw them as well
-               fillContours(labels, contours, hierarchy, label, 0, hierarchy[contourIdx][2]);
+               break;
+            }
+            getReporter().reportProgress(getThreadIndex(), 100 * (idx - mRange.mFirst) / count);
+
+            Tile& tile = (*mInput.mpTiles)[idx];
+            bool success = (mInput.mpFinalLabels == NULL) ? labelTile(tile) :
+               relabelTile(tile, (*mInput.mpTileBases)[idx]);
+            if (!success)
+            {
+               getReporter().reportError("Unable to access the label element.");
+               return;
             }
          }
-         else
+      }
+
+   private:
+      LabelThread& operator=(const LabelThread& rhs);
+
+      // Two pass labeling of the 8-connected components within a tile
+      bool labelTile(Tile& tile)
+      {
+         std::vector<int> labels(tile.mRows * tile.mColumns, 0);
+         std::vector<int> parents(1, 0);
+         for (int row = 0; row < tile.mRows; ++row)
          {
-            // Fill the entire contour poly
-            cv::drawContours(labels, contours, contourIdx, cv::Scalar(++label), CV_FILLED, 8, hierarchy, 0);
-            if (hierarchy[contourIdx][2] != -1)
+            int y = tile.mStartRow + row + mInput.mYOffset;
+            for (int col = 0; col < tile.mColumns; ++col)
             {
-               // If there are nested contours, draw them as well
-               fillContours(labels, contours, hierarchy, label, label, hierarchy[contourIdx][2]);
+               if (!mInput.mpBitmask->getPixel(tile.mStartColumn + col + mInput.mXOffset, y))
+               {
+                  continue;
+               }
+
+               // Previously visited neighbors: west, north west, north and north east
+               int neighbors[4] = { 0, 0, 0, 0 };
+               if (col > 0)
+               {
+                  neighbors[0] = labels[row * tile.mColumns + col - 1];
+               }
+               if (row > 0)
+               {
+                  const int* pAbove = &labels[(row - 1) * tile.mColumns];
+                  neighbors[1] = (col > 0) ? pAbove[col - 1] : 0;
+                  neighbors[2] = pAbove[col];
+                  neighbors[3] = (col + 1 < tile.mColumns) ? pAbove[col + 1] : 0;
+               }
+
+               int label = 0;
+               for (int neighbor = 0; neighbor < 4; ++neighbor)
+               {
+                  if (neighbors[neighbor] != 0)
+                  {
+                     if (label == 0)
+                     {
+                        label = neighbors[neighbor];
+                     }
+                     else
+                     {
+                        unite(parents, label, neighbors[neighbor]);
+                     }
+                  }
+               }
+               if (label == 0)
+               {
+                  label = static_cast<int>(parents.size());
+                  parents.push_back(label);
+               }
+               labels[row * tile.mColumns + col] = label;
+            }
+         }
+
+         // Number the components in raster order and gather their statistics
+         std::vector<int> localLabels(parents.size(), 0);
+         tile.mComponents.clear();
+         for (int row = 0; row < tile.mRows; ++row)
+         {
+            for (int col = 0; col < tile.mColumns; ++col)
+            {
+               int& label = labels[row * tile.mColumns + col];
+               if (label == 0)
+               {
+                  continue;
+               }
+               int root = findRoot(parents, label);
+               if (localLabels[root] == 0)
+               {
+                  tile.mComponents.push_back(Component());
+                  localLabels[root] = static_cast<int>(tile.mComponents.size());
+               }
+               label = localLabels[root];
+               tile.mComponents[label - 1].addPixel(tile.mStartColumn + col, tile.mStartRow + row);
+            }
+         }
+
+         tile.mTop.assign(labels.begin(), labels.begin() + tile.mColumns);
+         tile.mBottom.assign(labels.end() - tile.mColumns, labels.end());
+         tile.mLeft.resize(tile.mRows);
+         tile.mRight.resize(tile.mRows);
+         for (int row = 0; row < tile.mRows; ++row)
+         {
+            tile.mLeft[row] = static_cast<unsigned short>(labels[row * tile.mColumns]);
+            tile.mRight[row] = static_cast<unsigned short>(labels[row * tile.mColumns + tile.mColumns - 1]);
+         }
+
+         // Store the local labels in the label element until the final labels are known
+         DataAccessor accessor = getTileAccessor(mInput.mpLabels, tile);
+         for (int row = 0; row < tile.mRows; ++row)
+         {
+            if (!accessor.isValid())
+            {
+               return false;
+            }
+            unsigned short* pRow = reinterpret_cast<unsigned short*>(accessor->getRow());
+            for (int col = 0; col < tile.mColumns; ++col)
+            {
+               pRow[col] = static_cast<unsigned short>(labels[row * tile.mColumns + col]);
             }
+            accessor->nextRow();
          }
-         contourIdx = hierarchy[contourIdx][0];
+         return true;
       }
-   }
+
+      bool relabelTile(const Tile& tile, int base)
+      {
+         if (tile.mComponents.empty())
+         {
+            return true;
+         }
+         DataAccessor accessor = getTileAccessor(mInput.mpLabels, tile);
+         for (int row = 0; row < tile.mRows; ++row)
+         {
+            if (!accessor.isValid())
+            {
+               return false;
+            }
+            unsigned short* pRow = reinterpret_cast<unsigned short*>(accessor->getRow());
+            for (int col = 0; col < tile.mColumns; ++col)
+            {
+               if (pRow[col] != 0)
+               {
+                  pRow[col] = (*mInput.mpFinalLabels)[base + pRow[col] - 1];
+               }
+            }
+            accessor->nextRow();
+         }
+         return true;
+      }
+
+      const LabelThreadInput& mInput;
+      mta::AlgorithmThread::Range mRange;
+   };
+
+   struct LabelThreadOutput
+   {
+      bool compileOverallResults(const std::vector<LabelThread*>& threads)
+      {
+         return true;
+      }
+   };
 }
 
 ConnectedComponents::ConnectedComponents() : mpView(NULL), mpLabels(NULL), mXOffset(0), mYOffset(0)
@@ -84,7 +386,6 @@ ConnectedComponents::ConnectedComponents() : mpView(NULL), mpLabels(NULL), mXOff
    setProductionStatus(APP_IS_PRODUCTION_RELEASE);
    setAbortSupported(true);
    setMenuLocation("[General Algorithms]/Connected Components");
-   addDependencyCopyright("OpenCV", Service<UtilityServices>()->getTextFromFile(":/licenses/opencv"));
 }
 
 ConnectedComponents::~ConnectedComponents()
@@ -204,63 +505,220 @@ bool ConnectedComponents::execute(PlugInArgList* pInArgList, PlugInArgList* pOut
    }
    ModelResource<RasterElement> pLabels(mpLabels);
 
-   try
+   // Label the tiles in parallel, then merge the components which cross tile boundaries
+   std::vector<Tile> tiles;
+   int tileRows = (static_cast<int>(height) + TILE_SIZE - 1) / TILE_SIZE;
+   int tileColumns = (static_cast<int>(width) + TILE_SIZE - 1) / TILE_SIZE;
+   for (int tileRow = 0; tileRow < tileRows; ++tileRow)
+   {
+      for (int tileColumn = 0; tileColumn < tileColumns; ++tileColumn)
+      {
+         Tile tile;
+         tile.mStartRow = tileRow * TILE_SIZE;
+         tile.mStartColumn = tileColumn * TILE_SIZE;
+         tile.mRows = std::min(TILE_SIZE, static_cast<int>(height) - tile.mStartRow);
+         tile.mColumns = std::min(TILE_SIZE, static_cast<int>(width) - tile.mStartColumn);
+         tiles.push_back(tile);
+      }
+   }
+
+   LabelThreadInput input;
+   input.mpBitmask = mpBitmask;
+   input.mpLabels = mpLabels;
+   input.mpTiles = &tiles;
+   input.mpAbortFlag = &mAborted;
+   input.mXOffset = mXOffset;
+   input.mYOffset = mYOffset;
+   LabelThreadOutput output;
+   {
+      mta::ProgressObjectReporter reporter("Labeling tiles", mProgress.getCurrentProgress());
+      mta::MultiThreadedAlgorithm<LabelThreadInput, LabelThreadOutput, LabelThread>
+         alg(mta::getNumRequiredThreads(tiles.size()), input, output, &reporter);
+      if (alg.run() != mta::SUCCESS || isAborted())
+      {
+         mProgress.report(isAborted() ? "Labeling aborted." : "Unable to label the AOI.", 0,
+            isAborted() ? ABORT : ERRORS, true);
+         return false;
+      }
+   }
+
+   mProgress.report("Merging blobs", 60, NORMAL);
+   std::vector<int> tileBases(tiles.size(), 0);
+   int componentCount = 0;
+   for (std::vector<Tile>::size_type idx = 0; idx < tiles.size(); ++idx)
    {
-      cv::Mat data(height, width, CV_8UC1, cv::Scalar(0));
-      for (unsigned int y = 0; y < height; ++y)
+      tileBases[idx] = componentCount;
+      componentCount += static_cast<int>(tiles[idx].mComponents.size());
+   }
+   std::vector<int> parents(componentCount);
+   for (int idx = 0; idx < componentCount; ++idx)
+   {
+      parents[idx] = idx;
+   }
+   for (int tileRow = 0; tileRow < tileRows; ++tileRow)
+   {
+      for (int tileColumn = 0; tileColumn < tileColumns; ++tileColumn)
       {
-         mProgress.report("Reading AOI data", 10 * y / height, NORMAL);
-         for (unsigned int x = 0; x < width; ++x)
+         int idx = tileRow * tileColumns + tileColumn;
+         const Tile& tile = tiles[idx];
+         if (tileColumn + 1 < tileColumns)
          {
-            if (mpBitmask->getPixel(x + mXOffset, y + mYOffset))
+            const Tile& right = tiles[idx + 1];
+            for (int row = 0; row < tile.mRows; ++row)
             {
-               data.at<unsigned char>(y, x) = 255;
+               for (int offset = -1; offset <= 1; ++offset)
+               {
+                  int neighbor = row + offset;
+                  if (tile.mRight[row] != 0 && neighbor >= 0 && neighbor < right.mRows && right.mLeft[neighbor] != 0)
+                  {
+                     unite(parents, tileBases[idx] + tile.mRight[row] - 1,
+                        tileBases[idx + 1] + right.mLeft[neighbor] - 1);
+                  }
+               }
+            }
+         }
+         if (tileRow + 1 < tileRows)
+         {
+            int belowIdx = idx + tileColumns;
+            const Tile& below = tiles[belowIdx];
+            for (int col = 0; col < tile.mColumns; ++col)
+            {
+               for (int offset = -1; offset <= 1; ++offset)
+               {
+                  int neighbor = col + offset;
+                  if (tile.mBottom[col] != 0 && neighbor >= 0 && neighbor < below.mColumns && below.mTop[neighbor] != 0)
+                  {
+                     unite(parents, tileBases[idx] + tile.mBottom[col] - 1,
+                        tileBases[belowIdx] + below.mTop[neighbor] - 1);
+                  }
+               }
+            }
+
+            // Diagonal neighbors across the tile corners
+            if (tileColumn + 1 < tileColumns && tile.mBottom.back() != 0 && tiles[belowIdx + 1].mTop.front() != 0)
+            {
+               unite(parents, tileBases[idx] + tile.mBottom.back() - 1,
+                  tileBases[belowIdx + 1] + tiles[belowIdx + 1].mTop.front() - 1);
+            }
+            if (tileColumn > 0 && tile.mBottom.front() != 0 && tiles[belowIdx - 1].mTop.back() != 0)
+            {
+               unite(parents, tileBases[idx] + tile.mBottom.front() - 1,
+                  tileBases[belowIdx - 1] + tiles[belowIdx - 1].mTop.back() - 1);
             }
          }
       }
-      mProgress.report("Finding contours", 15, NORMAL);
-      std::vector<std::vector<cv::Point> > contours;
-      std::vector<cv::Vec4i> hierarchy;
-      cv::findContours(data, contours, hierarchy, CV_RETR_TREE, CV_CHAIN_APPROX_SIMPLE);
-      cv::Mat labels(height, width, CV_16UC1, mpLabels->getRawData());
-      mProgress.report("Filling blobs", 50, NORMAL);
-      unsigned short lastLabel = 0;
-      fillContours(labels, contours, hierarchy, lastLabel, 0, 0);
-
-      // create a pseudocolor layer for display
-      mProgress.report("Displaying results", 90, NORMAL);
-      mpLabels->updateData();
-      if (!createPseudocolor(lastLabel))
-      {
-         mProgress.report("Unable to create blob layer", 0, ERRORS, true);
-         return false;
-      }
+   }
 
-      // add blob count to the metadata
-      DynamicObject* pMeta = pLabels->getMetadata();
-      VERIFY(pMeta);
-      unsigned int numBlobs = static_cast<unsigned int>(lastLabel);
-      pMeta->setAttribute("BlobCount", numBlobs);
-      if (numBlobs == 0 && !isBatch())
+   // Combine the statistics of the merged components and number them by their first pixel
+   std::vector<Component> blobs;
+   std::vector<int> blobIndices(componentCount, -1);
+   for (std::vector<Tile>::size_type idx = 0; idx < tiles.size(); ++idx)
+   {
+      for (std::vector<Component>::size_type local = 0; local < tiles[idx].mComponents.size(); ++local)
       {
-         // Inform the user that there were no blobs so they don't think there was an
-         // error running the algorithm. No need to do this in batch since this is
-         // represented in the metadata already.
-         mProgress.report("No blobs were found.", 95, WARNING);
+         int root = findRoot(parents, tileBases[idx] + static_cast<int>(local));
+         if (blobIndices[root] == -1)
+         {
+            blobIndices[root] = static_cast<int>(blobs.size());
+            blobs.push_back(tiles[idx].mComponents[local]);
+         }
+         else
+         {
+            blobs[blobIndices[root]].merge(tiles[idx].mComponents[local]);
+         }
       }
-      // update the output arg list
-      if (pOutArgList != NULL)
+   }
+   if (blobs.size() > std::numeric_limits<unsigned short>::max())
+   {
+      mProgress.report("More than " + StringUtilities::toDisplayString(std::numeric_limits<unsigned short>::max()) +
+         " blobs were found.", 0, ERRORS, true);
+      return false;
+   }
+   std::vector<int> order(blobs.size());
+   for (std::vector<int>::size_type idx = 0; idx < order.size(); ++idx)
+   {
+      order[idx] = static_cast<int>(idx);
+   }
+   std::sort(order.begin(), order.end(), BlobLess(blobs));
+   std::vector<unsigned short> blobLabels(blobs.size());
+   for (std::vector<int>::size_type idx = 0; idx < order.size(); ++idx)
+   {
+      blobLabels[order[idx]] = static_cast<unsigned short>(idx + 1);
+   }
+   std::vector<unsigned short> finalLabels(componentCount);
+   for (int idx = 0; idx < componentCount; ++idx)
+   {
+      finalLabels[idx] = blobLabels[blobIndices[findRoot(parents, idx)]];
+   }
+
+   input.mpFinalLabels = &finalLabels;
+   input.mpTileBases = &tileBases;
+   {
+      mta::ProgressObjectReporter reporter("Relabeling tiles", mProgress.getCurrentProgress());
+      mta::MultiThreadedAlgorithm<LabelThreadInput, LabelThreadOutput, LabelThread>
+         alg(mta::getNumRequiredThreads(tiles.size()), input, output, &reporter);
+      if (alg.run() != mta::SUCCESS || isAborted())
       {
-         pOutArgList->setPlugInArgValue("Blobs", pLabels.get());
-         pOutArgList->setPlugInArgValue("Number of Blobs", &numBlobs);
+         mProgress.report(isAborted() ? "Labeling aborted." : "Unable to label the AOI.", 0,
+            isAborted() ? ABORT : ERRORS, true);
+         return false;
       }
    }
-   catch(const cv::Exception& exc)
+
+   // create a pseudocolor layer for display
+   mProgress.report("Displaying results", 90, NORMAL);
+   unsigned short lastLabel = static_cast<unsigned short>(blobs.size());
+   mpLabels->updateData();
+   if (!createPseudocolor(lastLabel))
    {
-      mProgress.report(exc.what(), 0, ERRORS, true);
+      mProgress.report("Unable to create blob layer", 0, ERRORS, true);
       return false;
    }
 
+   // add blob count and statistics to the metadata, in scene pixel coordinates
+   DynamicObject* pMeta = pLabels->getMetadata();
+   VERIFY(pMeta);
+   unsigned int numBlobs = static_cast<unsigned int>(lastLabel);
+   pMeta->setAttribute("BlobCount", numBlobs);
+   std::vector<unsigned int> areas(numBlobs);
+   std::vector<int> minX(numBlobs);
+   std::vector<int> minY(numBlobs);
+   std::vector<int> maxX(numBlobs);
+   std::vector<int> maxY(numBlobs);
+   std::vector<double> centroidX(numBlobs);
+   std::vector<double> centroidY(numBlobs);
+   for (unsigned int idx = 0; idx < numBlobs; ++idx)
+   {
+      const Component& blob = blobs[order[idx]];
+      areas[idx] = blob.mArea;
+      minX[idx] = blob.mMinX + mXOffset;
+      minY[idx] = blob.mMinY + mYOffset;
+      maxX[idx] = blob.mMaxX + mXOffset;
+      maxY[idx] = blob.mMaxY + mYOffset;
+      centroidX[idx] = blob.mSumX / blob.mArea + mXOffset;
+      centroidY[idx] = blob.mSumY / blob.mArea + mYOffset;
+   }
+   pMeta->setAttribute("BlobArea", areas);
+   pMeta->setAttribute("BlobMinX", minX);
+   pMeta->setAttribute("BlobMinY", minY);
+   pMeta->setAttribute("BlobMaxX", maxX);
+   pMeta->setAttribute("BlobMaxY", maxY);
+   pMeta->setAttribute("BlobCentroidX", centroidX);
+   pMeta->setAttribute("BlobCentroidY", centroidY);
+   if (numBlobs == 0 && !isBatch())
+   {
+      // Inform the user that there were no blobs so they don't think there was an
+      // error running the algorithm. No need to do this in batch since this is
+      // represented in the metadata already.
+      mProgress.report("No blobs were found.", 95, WARNING);
+   }
+   // update the output arg list
+   if (pOutArgList != NULL)
+   {
+      pOutArgList->setPlugInArgValue("Blobs", pLabels.get());
+      pOutArgList->setPlugInArgValue("Number of Blobs", &numBlobs);
+   }
+
    pLabels.release();
    mProgress.report("Labeling connected components", 100, NORMAL);
    mProgress.upALevel();
@@ -22,6 +22,7 @@
 #include "LayerList.h"
 #include "LocationType.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectFactory.h"
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
@@ -38,24 +39,180 @@
 #include <QtCore/QList>
 #include <QtCore/QPoint>
 #include <QtGui/QApplication>
-#include <limits>
+#include <algorithm>
 #include <math.h>
-#if !defined(DEBUG)
-// boost optimizations on
-#define NDEBUG
-#endif
-#include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/matrix_proxy.hpp>
-#include <boost/numeric/ublas/symmetric.hpp>
-
-using namespace boost::numeric;
+#include <set>
+#include <utility>
+#include <vector>
 
 REGISTER_PLUGIN_BASIC(OpticksObjectFinding, QtCluster);
 
 namespace
 {
 typedef QList<QPoint> PointsType;
-typedef ublas::symmetric_matrix<int> MatrixType;
+
+/**
+ * Buckets points into square cells at least as large as the cluster size so that
+ * every point within the cluster size of a point is in the same or an adjacent cell.
+ */
+class PointGrid
+{
+public:
+   PointGrid(const PointsType& points, double clusterSize) :
+      mPoints(points),
+      mClusterSize(clusterSize),
+      mCellSize(std::max(1, static_cast<int>(ceil(clusterSize)))),
+      mMinX(0),
+      mMinY(0)
+   {
+      for (int idx = 0; idx < mPoints.size(); ++idx)
+      {
+         mMinX = (idx == 0) ? mPoints[idx].x() : std::min(mMinX, mPoints[idx].x());
+         mMinY = (idx == 0) ? mPoints[idx].y() : std::min(mMinY, mPoints[idx].y());
+      }
+      mCells.reserve(mPoints.size());
+      for (int idx = 0; idx < mPoints.size(); ++idx)
+      {
+         mCells.push_back(Entry(getCell(mPoints[idx]), idx));
+      }
+      std::sort(mCells.begin(), mCells.end());
+   }
+
+   /**
+    * Finds the points within the cluster size of a point, including the point itself.
+    * The same distance calculation as the original all-pairs matrix is used so that
+    * points on the boundary are treated identically.
+    *
+    * @param index
+    *        The index of the point.
+    * @param pActive
+    *        If not NULL, points whose entry is zero are skipped.
+    * @param neighbors
+    *        The indices of the points are appended to this vector.
+    */
+   void findNeighbors(int index, const std::vector<char>* pActive, std::vector<int>& neighbors) const
+   {
+      const QPoint& a = mPoints[index];
+      Cell cell = getCell(a);
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+         for (int dy = -1; dy <= 1; ++dy)
+         {
+            std::pair<std::vector<Entry>::const_iterator, std::vector<Entry>::const_iterator> range =
+               std::equal_range(mCells.begin(), mCells.end(),
+               Entry(Cell(cell.first + dx, cell.second + dy), 0), CellLess());
+            for (std::vector<Entry>::const_iterator iter = range.first; iter != range.second; ++iter)
+            {
+               int other = iter->second;
+               if (pActive != NULL && (*pActive)[other] == 0)
+               {
+                  continue;
+               }
+               if (other == index)
+               {
+                  neighbors.push_back(other);
+                  continue;
+               }
+               QPoint b = mPoints[other];
+               QPoint c = b - a;
+               double distance = sqrt(static_cast<double>(c.x()) * c.x() + c.y() * c.y());
+               if (distance <= mClusterSize)
+               {
+                  neighbors.push_back(other);
+               }
+            }
+         }
+      }
+   }
+
+private:
+   typedef std::pair<int, int> Cell;
+   typedef std::pair<Cell, int> Entry;
+
+   struct CellLess
+   {
+      bool operator()(const Entry& lhs, const Entry& rhs) const
+      {
+         return lhs.first < rhs.first;
+      }
+   };
+
+   Cell getCell(const QPoint& point) const
+   {
+      return Cell((point.x() - mMinX) / mCellSize, (point.y() - mMinY) / mCellSize);
+   }
+
+   const PointsType& mPoints;
+   double mClusterSize;
+   int mCellSize;
+   int mMinX;
+   int mMinY;
+   std::vector<Entry> mCells;
+};
+
+struct CandidateThreadInput
+{
+   CandidateThreadInput() :
+      mpGrid(NULL),
+      mpCounts(NULL),
+      mpAbortFlag(NULL)
+   {}
+
+   const PointGrid* mpGrid;
+   std::vector<int>* mpCounts;
+   const bool* mpAbortFlag;
+};
+
+/**
+ * Counts the points in the candidate cluster centered on each point in a range of points.
+ */
+class CandidateThread : public mta::AlgorithmThread
+{
+public:
+   CandidateThread(const CandidateThreadInput& input, int threadCount, int threadIndex,
+      mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mInput(input),
+      mRange(getThreadRange(threadCount, static_cast<int>(input.mpCounts->size())))
+   {}
+
+   void run()
+   {
+      std::vector<int> neighbors;
+      int oldPercentDone = -1;
+      int count = mRange.mLast - mRange.mFirst + 1;
+      for (int idx = mRange.mFirst; idx <= mRange.mLast; ++idx)
+      {
+         int percentDone = 100 * (idx - mRange.mFirst) / count;
+         if (percentDone > oldPercentDone)
+         {
+            oldPercentDone = percentDone;
+            getReporter().reportProgress(getThreadIndex(), percentDone);
+            if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+            {
+               break;
+            }
+         }
+         neighbors.clear();
+         mInput.mpGrid->findNeighbors(idx, NULL, neighbors);
+         (*mInput.mpCounts)[idx] = static_cast<int>(neighbors.size());
+      }
+   }
+
+private:
+   CandidateThread& operator=(const CandidateThread& rhs);
+
+   const CandidateThreadInput& mInput;
+   mta::AlgorithmThread::Range mRange;
+};
+
+struct CandidateThreadOutput
+{
+   bool compileOverallResults(const std::vector<CandidateThread*>& threads)
+   {
+      return true;
+   }
+};
 }
 
 QtCluster::QtCluster()
@@ -179,11 +336,6 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          progress.report("No points in the AOI.", 0, ERRORS, true);
          return false;
       }
-      if (pOrigMaskIt->getCount() > sqrt(static_cast<double>(std::numeric_limits<unsigned int>::max())))
-      {
-         progress.report("Too many points in the AOI.", 0, ERRORS, true);
-         return false;
-      }
    }
    else
    {
@@ -192,13 +344,8 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          progress.report("No points in the AOI.", 0, ERRORS, true);
          return false;
       }
-      if (pOrigMask->getCount() > sqrt(static_cast<double>(std::numeric_limits<unsigned int>::max())))
-      {
-         progress.report("Too many points in the AOI.", 0, ERRORS, true);
-         return false;
-      }
    }
-   if (!isBatch() && pOrigMask->getCount() > 10000)
+   if (!isBatch() && pOrigMask->getCount() > 1000000)
    {
       if (Service<DesktopServices>()->showMessageBox("Warning", "The AOI contains a large number of points. "
          "Clustering may take a long time. Would you like to continue?", "Yes", "No") == 1)
@@ -301,7 +448,7 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
    }
 
    /**********
-    * Calculate pairwise distances
+    * Collect the points in the AOI
     **********/
    PointsType points;
    int bx1, bx2, by1, by2;
@@ -346,42 +493,29 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
    }
    delete pOrigMaskIt;
    /**********
-    * Calculate in range points
+    * Count the points in range of each point
     **********/
-   MatrixType inRange(points.size(), points.size());
-   numToIncPercentage = points.size() / 99;
-   if (numToIncPercentage <= 0)
-   {
-      numToIncPercentage = 1;
-   }
-   else if (numToIncPercentage > 100)
+   PointGrid grid(points, clusterSize);
+   std::vector<int> counts(points.size(), 0);
+   CandidateThreadInput candidateInput;
+   candidateInput.mpGrid = &grid;
+   candidateInput.mpCounts = &counts;
+   candidateInput.mpAbortFlag = &mAborted;
+   CandidateThreadOutput candidateOutput;
+   mta::ProgressObjectReporter reporter("Calculating candidate clusters", progress.getCurrentProgress());
+   mta::MultiThreadedAlgorithm<CandidateThreadInput, CandidateThreadOutput, CandidateThread>
+      alg(mta::getNumRequiredThreads(points.size()), candidateInput, candidateOutput, &reporter);
+   if (alg.run() != mta::SUCCESS || isAborted())
    {
-      numToIncPercentage = 100;
+      progress.report("User aborted", 0, ABORT, true);
+      return false;
    }
-   progress.report("Calculating distance matrix", 0, NORMAL);
-   for (int start = 0; start < points.size(); ++start)
+
+   // Ordered so that the first candidate is the largest, with ties going to the lowest point index
+   std::set<std::pair<int, int> > candidates;
+   for (int idx = 0; idx < points.size(); ++idx)
    {
-      inRange(start, start) = 1;
-      if (start % numToIncPercentage == 0)
-      {
-         if (isAborted())
-         {
-            progress.report("User aborted", 0, ABORT, true);
-            return false;
-         }
-         progress.report("Calculating distance matrix", 99 * start / points.size(), NORMAL);
-      }
-      for (int end = start+1; end < points.size(); ++end)
-      {
-         QPoint a = points[start];
-         QPoint b = points[end];
-         QPoint c = b - a;
-         double distance = sqrt(static_cast<double>(c.x()) * c.x() + c.y() * c.y());
-         // if the pairwise distance is larger than the cluster size,
-         // these two points will never be in a cluster together so
-         // we throw them out
-         inRange(start,end) = (distance <= clusterSize) ? 1 : 0;
-      }
+      candidates.insert(std::make_pair(-counts[idx], idx));
    }
 
    /**********
@@ -390,6 +524,12 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
    int total = points.size();
    int pointsChosen = 0;
    int clusterNumber = 1;
+   int oldPercentDone = -1;
+   std::vector<char> active(points.size(), 1);
+   std::vector<int> removed(points.size(), 0);
+   std::vector<int> cluster;
+   std::vector<int> neighbors;
+   std::vector<int> changed;
    progress.report("Locating clusters", 0, NORMAL);
    while (pointsChosen < total)
    {
@@ -398,69 +538,76 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          progress.report("User aborted", 0, ABORT, true);
          return false;
       }
-      progress.report(QString("Locating clusters. %1 clusters, %2 points remain unclustered.")
-         .arg(clusterNumber-1).arg(total - pointsChosen).toStdString(),
-         99 * pointsChosen / total, NORMAL);
-
-      int largest = -1;
-      int largestCount = 0;
-      for (int row = 0; row < points.size(); ++row)
+      int percentDone = 99 * pointsChosen / total;
+      if (percentDone > oldPercentDone)
       {
-         int tmpCount = sum(ublas::matrix_row<MatrixType>(inRange, row));
-         if (tmpCount > largestCount)
-         {
-            largest = row;
-            largestCount = tmpCount;
-         }
+         oldPercentDone = percentDone;
+         progress.report(QString("Locating clusters. %1 clusters, %2 points remain unclustered.")
+            .arg(clusterNumber-1).arg(total - pointsChosen).toStdString(), percentDone, NORMAL);
       }
-      if (largestCount == 0)
+
+      if (candidates.empty() || candidates.begin()->first == 0)
       {
          break;
       }
+      int largest = candidates.begin()->second;
+      int largestCount = -candidates.begin()->first;
 
       LocationType centroid(0, 0);
 
-      ublas::vector<int> row(inRange.size1());
-      for (size_t col = 0; col < inRange.size1(); ++col)
-      {
-         row(col) = inRange(largest, col);
-      }
-      for (size_t col = 0; col < row.size(); ++col)
+      cluster.clear();
+      grid.findNeighbors(largest, &active, cluster);
+      std::sort(cluster.begin(), cluster.end());
+      for (std::vector<int>::size_type member = 0; member < cluster.size(); ++member)
       {
-         if (col % 100 == 0)
+         if (member % 100 == 0)
          {
             QApplication::processEvents();
          }
-         if (row(col) != 0)
-         {
-            ++pointsChosen;
-            centroid.mX += points[col].x();
-            centroid.mY += points[col].y();
+         int col = cluster[member];
+         ++pointsChosen;
+         centroid.mX += points[col].x();
+         centroid.mY += points[col].y();
+         active[col] = 0;
+         candidates.erase(std::make_pair(-counts[col], col));
 
-            for (size_t idx = 0; idx < inRange.size1(); ++idx)
+         if (displayType == PSEUDO)
+         {
+            pPseudoAcc->toPixel(points[col].y(), points[col].x());
+            if (!pPseudoAcc.isValid())
             {
-               inRange(col, idx) = 0;
+               progress.report("Unable to access pseudocolor layer.", 0, ERRORS, true);
+               return false;
             }
+            *reinterpret_cast<unsigned char*>(pPseudoAcc->getColumn()) = clusterNumber;
+         }
+      }
 
-            if (displayType == PSEUDO)
+      // The clustered points are no longer part of the candidate clusters of the remaining points
+      changed.clear();
+      for (std::vector<int>::const_iterator member = cluster.begin(); member != cluster.end(); ++member)
+      {
+         neighbors.clear();
+         grid.findNeighbors(*member, &active, neighbors);
+         for (std::vector<int>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end(); ++neighbor)
+         {
+            if (removed[*neighbor]++ == 0)
             {
-               pPseudoAcc->toPixel(points[col].y(), points[col].x());
-               if (!pPseudoAcc.isValid())
-               {
-                  progress.report("Unable to access pseudocolor layer.", 0, ERRORS, true);
-                  return false;
-               }
-               *reinterpret_cast<unsigned char*>(pPseudoAcc->getColumn()) = clusterNumber;
+               changed.push_back(*neighbor);
             }
          }
       }
-      centroid.mX /= largestCount;
-      centroid.mY /= largestCount;
-      for (size_t idx = 0; idx < inRange.size1(); ++idx)
+      for (std::vector<int>::const_iterator idx = changed.begin(); idx != changed.end(); ++idx)
       {
-         inRange(largest, idx) = 0;
+         candidates.erase(std::make_pair(-counts[*idx], *idx));
+         counts[*idx] -= removed[*idx];
+         removed[*idx] = 0;
+         candidates.insert(std::make_pair(-counts[*idx], *idx));
       }
 
+      centroid.mX /= largestCount;
+      centroid.mY /= largestCount;
+
       // adjust the centroid to the center of a pixel
       centroid.mX += 0.5;
       centroid.mY += 0.5;
@@ -12,6 +12,7 @@
 #include "AppVerify.h"
 #include "BadValues.h"
 #include "DataAccessorImpl.h"
+#include "DataRequest.h"
 #include "DesktopServices.h"
 #include "DimensionDescriptor.h"
 #include "Filename.h"
@@ -21,6 +22,7 @@
 #include "LayerList.h"
 #include "MathUtil.h"
 #include "MessageLogResource.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ModelServices.h"
 #include "ObjectFactory.h"
 #include "ObjectResource.h"
@@ -39,9 +41,12 @@
 #include "SpatialDataWindow.h"
 #include "Statistics.h"
 #include "StringUtilities.h"
+#include "switchOnEncoding.h"
 #include "ThresholdLayer.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 
@@ -49,6 +54,203 @@ using namespace std;
 
 REGISTER_PLUGIN_BASIC(OpticksResults, ResultsExporter);
 
+namespace
+{
+   const unsigned int sRowsPerBlock = 256;
+   const unsigned int sPixelsPerThread = 4096;
+
+   struct ExportedPixel
+   {
+      unsigned int mRow;
+      unsigned int mColumn;
+      double mValue;
+   };
+
+   template<typename T>
+   void readRowValues(const T* pRow, const vector<unsigned int>& columnOffsets, vector<double>& values)
+   {
+      for (unsigned int column = 0; column < columnOffsets.size(); ++column)
+      {
+         values[column] = static_cast<double>(pRow[columnOffsets[column]]);
+      }
+   }
+
+   void appendUnsigned(uint64_t value, string& text)
+   {
+      char digits[24];
+      char* pDigit = digits + sizeof(digits);
+      do
+      {
+         *--pDigit = static_cast<char>('0' + value % 10);
+         value /= 10;
+      }
+      while (value != 0);
+
+      text.append(pDigit, digits + sizeof(digits));
+   }
+
+   /**
+    * Appends a value with the same text as printf("%lf") without going through
+    * the C library for the common case.
+    *
+    * The value is rounded to six decimal places with integer arithmetic, which
+    * is exact while the scaled value fits in the mantissa and is not within
+    * rounding error of a tie.  Other values, zero (which may be negative),
+    * infinities and NaN are formatted with sprintf.
+    */
+   void appendValue(double value, string& text)
+   {
+      const double scaled = fabs(value) * 1000000.0;
+      if (scaled > 0.0 && scaled < 4503599627370496.0)
+      {
+         const double whole = floor(scaled);
+         const double fraction = scaled - whole;
+         if (fabs(fraction - 0.5) > scaled * 2.3e-16)
+         {
+            uint64_t rounded = static_cast<uint64_t>(whole);
+            if (fraction > 0.5)
+            {
+               ++rounded;
+            }
+
+            if (value < 0.0)
+            {
+               text += '-';
+            }
+
+            appendUnsigned(rounded / 1000000, text);
+
+            char decimals[7];
+            decimals[0] = '.';
+            uint64_t remainder = rounded % 1000000;
+            for (int digit = 6; digit > 0; --digit)
+            {
+               decimals[digit] = static_cast<char>('0' + remainder % 10);
+               remainder /= 10;
+            }
+
+            text.append(decimals, sizeof(decimals));
+            return;
+         }
+      }
+
+      char buffer[1024];
+      sprintf(buffer, "%lf", value);
+      text += buffer;
+   }
+
+   struct ExportFormatInput
+   {
+      const string* mpName;
+      const vector<ExportedPixel>* mpPixels;
+      const vector<LocationType>* mpGeocoords;   // Empty when pixel locations are written
+      GeocoordType mGeocoordType;
+   };
+
+   void formatPixels(const ExportFormatInput& input, unsigned int first, unsigned int last, string& text)
+   {
+      const vector<ExportedPixel>& pixels = *input.mpPixels;
+      const vector<LocationType>& geocoords = *input.mpGeocoords;
+      const string& name = *input.mpName;
+
+      text.reserve(text.size() + (last - first) * (name.size() + 48));
+      for (unsigned int index = first; index < last; ++index)
+      {
+         const ExportedPixel& pixel = pixels[index];
+
+         text += name;
+         text += "    ";
+         if (geocoords.empty())
+         {
+            text += "Pixel: (";
+            appendUnsigned(pixel.mColumn + 1, text);
+            text += ", ";
+            appendUnsigned(pixel.mRow + 1, text);
+            text += ")";
+         }
+         else
+         {
+            LatLonPoint latLonPoint(geocoords[index]);
+            if (input.mGeocoordType == GEOCOORD_UTM)
+            {
+               UtmPoint utmPoint(latLonPoint);
+               text += "UTM: (" + utmPoint.getText() + ")";
+            }
+            else if (input.mGeocoordType == GEOCOORD_MGRS)
+            {
+               MgrsPoint mgrsPoint(latLonPoint);
+               text += "MGRS: (" + mgrsPoint.getText() + ")";
+            }
+            else
+            {
+               text += "Geo: (" + latLonPoint.getText() + ")";
+            }
+         }
+
+         text += "    ";
+         appendValue(pixel.mValue, text);
+         text += '\n';
+      }
+   }
+
+   /**
+    * Formats a contiguous range of the exported values in a block of rows.
+    */
+   class ExportFormatThread : public mta::AlgorithmThread
+   {
+   public:
+      ExportFormatThread(const ExportFormatInput& input, int threadCount, int threadIndex,
+         mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mpPixels->size())))
+      {
+      }
+
+      void run()
+      {
+         if (mRange.mLast >= mRange.mFirst)
+         {
+            formatPixels(mInput, mRange.mFirst, mRange.mLast + 1, mText);
+         }
+      }
+
+      const string& getText() const
+      {
+         return mText;
+      }
+
+   private:
+      ExportFormatThread& operator=(const ExportFormatThread& rhs);
+
+      const ExportFormatInput& mInput;
+      mta::AlgorithmThread::Range mRange;
+      string mText;
+   };
+
+   struct ExportFormatOutput
+   {
+      bool compileOverallResults(const vector<ExportFormatThread*>& threads)
+      {
+         size_t length = 0;
+         for (vector<ExportFormatThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            length += (*iter)->getText().size();
+         }
+
+         mText.reserve(length);
+         for (vector<ExportFormatThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            mText += (*iter)->getText();
+         }
+
+         return true;
+      }
+
+      string mText;
+   };
+}
+
 ResultsExporter::ResultsExporter() :
    mbInteractive(false),
    mbAbort(false),
@@ -451,22 +653,33 @@ bool ResultsExporter::writeOutput(ostream &stream)
    }
 
    RasterElement* pGeo = getGeoreferencedRaster();
+   bool writeGeocoords = (pGeo != NULL) && ((mGeocoordType == GEOCOORD_LATLON) || (mGeocoordType == GEOCOORD_UTM) ||
+      (mGeocoordType == GEOCOORD_MGRS));
 
-   DataAccessor da = mpResults->getDataAccessor();
-   if (!da.isValid())
-   {
-      mMessage = "Could not access the data in the results raster!";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(mMessage, 0, ERRORS);
-      }
+   // UTM and MGRS text is created by a single shared conversion engine, so only pixel and
+   // latitude/longitude locations can be formatted in multiple threads
+   bool threadedFormat = (writeGeocoords == false) || (mGeocoordType == GEOCOORD_LATLON);
 
-      pStep->finalize(Message::Failure);
-      return false;
+   vector<unsigned int> columnOffsets;
+   columnOffsets.reserve(columns.size());
+   for (vector<DimensionDescriptor>::const_iterator iter = columns.begin(); iter != columns.end(); ++iter)
+   {
+      columnOffsets.push_back(iter->getActiveNumber());
    }
 
-   unsigned int activeRowNumber = 0;
-   for (unsigned int r = 0; r < rows.size(); ++r)
+   vector<double> rowValues(columns.size());
+   vector<ExportedPixel> pixels;
+   vector<LocationType> geocoords;
+   string text;
+
+   ExportFormatInput formatInput;
+   formatInput.mpName = &name;
+   formatInput.mpPixels = &pixels;
+   formatInput.mpGeocoords = &geocoords;
+   formatInput.mGeocoordType = mGeocoordType;
+
+   const unsigned int numExportRows = rows.size();
+   for (unsigned int blockStart = 0; blockStart < numExportRows; blockStart += sRowsPerBlock)
    {
       if (mbAbort)
       {
@@ -480,37 +693,96 @@ bool ResultsExporter::writeOutput(ostream &stream)
          return false;
       }
 
-      DimensionDescriptor rowDim = rows[r];
-      // Skip to the next row
-      for (; activeRowNumber < rowDim.getActiveNumber(); ++activeRowNumber)
+      unsigned int blockEnd = min(blockStart + sRowsPerBlock, numExportRows);
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(rows[blockStart], rows[blockEnd - 1]);
+      DataAccessor da = mpResults->getDataAccessor(pRequest.release());
+      if (!da.isValid())
       {
-         da->nextRow();
+         mMessage = "Could not access the data in the results raster!";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(mMessage, 0, ERRORS);
+         }
+
+         pStep->finalize(Message::Failure);
+         return false;
       }
 
-      unsigned int activeColumnNumber = 0;
-      for (unsigned int c = 0; c < columns.size(); ++c)
+      // Collect the exported values in the block
+      pixels.clear();
+      for (unsigned int r = blockStart; r < blockEnd; ++r)
       {
-         DimensionDescriptor columnDim = columns[c];
-         // Skip to the next column
-         for (; activeColumnNumber < columnDim.getActiveNumber(); ++activeColumnNumber)
+         da->toPixel(rows[r].getActiveNumber(), 0);
+         VERIFY(da.isValid());
+
+         switchOnEncoding(eDataType, readRowValues, da->getRow(), columnOffsets, rowValues);
+         for (unsigned int c = 0; c < rowValues.size(); ++c)
          {
-            da->nextColumn();
+            if (isValueExported(rowValues[c], pBadValues))
+            {
+               ExportedPixel pixel;
+               pixel.mRow = r;
+               pixel.mColumn = c;
+               pixel.mValue = rowValues[c];
+               pixels.push_back(pixel);
+            }
          }
+      }
 
-         VERIFY(da.isValid());
+      // Convert the locations of all exported values in the block at once
+      geocoords.clear();
+      if (writeGeocoords && pixels.empty() == false)
+      {
+         vector<LocationType> pixelCoords;
+         pixelCoords.reserve(pixels.size());
+         for (vector<ExportedPixel>::const_iterator iter = pixels.begin(); iter != pixels.end(); ++iter)
+         {
+            pixelCoords.push_back(LocationType(iter->mColumn, iter->mRow));
+         }
 
-         double dValue = ModelServices::getDataValue(eDataType, da->getColumn(), COMPLEX_MAGNITUDE, 0);
-         if (isValueExported(dValue, pBadValues))
+         geocoords = pGeo->convertPixelsToGeocoords(pixelCoords);
+         VERIFY(geocoords.size() == pixels.size());
+      }
+
+      // Format the block
+      unsigned int pixelCount = pixels.size();
+      unsigned int threadCount = 1;
+      if (threadedFormat && pixelCount >= 2 * sPixelsPerThread)
+      {
+         threadCount = mta::getNumRequiredThreads(pixelCount / sPixelsPerThread);
+      }
+
+      if (threadCount > 1)
+      {
+         ExportFormatOutput formatOutput;
+         mta::MultiThreadedAlgorithm<ExportFormatInput, ExportFormatOutput, ExportFormatThread>
+            alg(threadCount, formatInput, formatOutput, NULL);
+         if (alg.run() != mta::SUCCESS)
          {
-            string location = getLocationString(r, c, pGeo);
-            char buffer[1024];
-            sprintf(buffer, "%lf\n", dValue);
-            stream << name << "    " << location << "    " << buffer;
+            mMessage = "Could not format the results values!";
+            if (mpProgress != NULL)
+            {
+               mpProgress->updateProgress(mMessage, 0, ERRORS);
+            }
+
+            pStep->finalize(Message::Failure);
+            return false;
          }
+
+         text.swap(formatOutput.mText);
+      }
+      else
+      {
+         text.clear();
+         formatPixels(formatInput, 0, pixelCount, text);
       }
 
+      stream.write(text.data(), text.size());
+
       // Update the progress
-      int iProgress = (r * 100) / rows.size();
+      int iProgress = (blockEnd * 100) / numExportRows;
       if (iProgress == 100)
       {
          iProgress = 99;
@@ -794,43 +1066,6 @@ RasterElement* ResultsExporter::getGeoreferencedRaster() const
    return NULL;
 }
 
-string ResultsExporter::getLocationString(unsigned int uiRow, unsigned int uiColumn, const RasterElement* pGeo) const
-{
-   char buffer[1024];
-   sprintf(buffer, "Pixel: (%u, %u)", uiColumn + 1, uiRow + 1);
-
-   string location = buffer;
-   if (pGeo != NULL && pGeo->isGeoreferenced())
-   {
-      LocationType pixelCoord;
-      pixelCoord.mX = uiColumn;
-      pixelCoord.mY = uiRow;
-
-      LocationType coords = pGeo->convertPixelToGeocoord(pixelCoord);
-
-      LatLonPoint latLonPoint(coords);
-      if (mGeocoordType == GEOCOORD_UTM)
-      {
-         UtmPoint utmPoint(latLonPoint);
-         string utmText = utmPoint.getText();
-         location = "UTM: (" + utmText + ")";
-      }
-      else if (mGeocoordType == GEOCOORD_MGRS)
-      {
-         MgrsPoint mgrsPoint(latLonPoint);
-         string mgrsText = mgrsPoint.getText();
-         location = "MGRS: (" + mgrsText + ")";
-      }
-      else if (mGeocoordType == GEOCOORD_LATLON)
-      {
-         string latLonText = latLonPoint.getText();
-         location = "Geo: (" + latLonText + ")";
-      }
-   }
-
-   return location;
-}
-
 bool ResultsExporter::runOperationalTests(Progress* pProgress, ostream& failure)
 {
    return runAllTests(pProgress, failure);
@@ -49,7 +49,6 @@ public:
 protected:
    bool extractInputArgs(PlugInArgList* pArgList);
    bool isValueExported(double dValue, const BadValues* pBadValues) const;
-   std::string getLocationString(unsigned int uiRow, unsigned int uiColumn, const RasterElement* pGeo) const;
    RasterElement* getGeoreferencedRaster() const;
    bool writeOutput(std::ostream &stream);
 
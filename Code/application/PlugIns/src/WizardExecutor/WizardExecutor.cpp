@@ -7,6 +7,7 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "ApplicationServices.h"
 #include "AppVersion.h"
 #include "AppAssert.h"
 #include "AppVerify.h"
@@ -19,6 +20,7 @@
 #include "Layer.h"
 #include "MessageLogResource.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectFactory.h"
 #include "ObjectResource.h"
 #include "PlugInArg.h"
@@ -38,8 +40,13 @@
 #include "xmlreader.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QWaitCondition>
 #include <QtGui/QFileDialog>
 
+#include <algorithm>
+#include <set>
+
 using namespace std;
 
 REGISTER_PLUGIN_BASIC(OpticksWizardExecutor, WizardExecutor);
@@ -50,7 +57,6 @@ WizardExecutor::WizardExecutor() :
    mbDeleteWizard(false),
    mpProgress(NULL),
    mpWizard(NULL),
-   mpCurrentPlugIn(NULL),
    mpStep(NULL)
 {
    setName("Wizard Executor");
@@ -91,9 +97,11 @@ bool WizardExecutor::setInteractive()
 bool WizardExecutor::hasAbort()
 {
    bool bSuccess = true;
-   if (mpCurrentPlugIn != NULL)
+
+   QMutexLocker lock(&mMutex);
+   for (vector<Executable*>::const_iterator iter = mRunningPlugIns.begin(); iter != mRunningPlugIns.end(); ++iter)
    {
-      bSuccess = mpCurrentPlugIn->hasAbort();
+      bSuccess = bSuccess && (*iter)->hasAbort();
    }
 
    return bSuccess;
@@ -162,6 +170,11 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
 
    pStep->addMessage(mMessage, "app", "2D53370C-DD0D-4160-9BD5-4D46C49A4B7E", true);
 
+   if (canExecuteConcurrently(wizardItems))
+   {
+      return finishExecution(executeConcurrently(wizardItems));
+   }
+
    vector<WizardItem*> populateList;
    for (vector<WizardItem*>::const_iterator wiIter = wizardItems.begin(); wiIter != wizardItems.end(); ++wiIter)
    {
@@ -206,7 +219,7 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
             mMessage = "Executing Value Item: " + (*plIter)->getName();
             pStep->addMessage(mMessage, "app", "9FC4024E-00FA-42cd-8EC3-2AAE84843BA7", true);
             bSuccess = true;
-            setConnectedNodeValues(*plIter);
+            setConnectedNodeValues(*plIter, NULL, mpProgress);
          }
          else
          {
@@ -216,81 +229,92 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
       }
       populateList.clear();
 
-      if (mbAbort)
+      if (mbAbort || mpWizard == NULL || !bSuccess)
       {
-         resetAllNodeValues();
-
-         mMessage = "Wizard Exector Aborted!";
-         pStep->finalize(Message::Abort, mMessage);
-         if (mpProgress != NULL)
-         {
-            string progressMessage;
-            int percent = 0;
-            ReportingLevel level;
-            mpProgress->getProgress(progressMessage, percent, level);
+         return finishExecution(bSuccess);
+      }
+   }
+   if (!populateList.empty() && mpProgress != NULL)
+   {
+      mpProgress->updateProgress(QString("%1 value item(s) ignored. They are not connected to any wizard items.")
+         .arg(populateList.size()).toStdString(), 0, WARNING);
+   }
 
-            if (level != ABORT)
-            {
-               mpProgress->updateProgress(mMessage, 0, ABORT);
-            }
-         }
-         if (mbDeleteWizard)
-         {
-            mpObjFact->destroyObject(mpWizard, "WizardObject");
-         }
-         else if (mpWizard != NULL)
-         {
-            mpWizard->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &WizardExecutor::wizardDeleted));
-         }
+   return finishExecution(true);
+}
 
-         return false;
-      }
+bool WizardExecutor::finishExecution(bool bSuccess)
+{
+   if (mbAbort)
+   {
+      resetAllNodeValues();
 
-      if (mpWizard == NULL)
+      mMessage = "Wizard Exector Aborted!";
+      mpStep->finalize(Message::Abort, mMessage);
+      if (mpProgress != NULL)
       {
-         mMessage = "The wizard is no longer valid!  Execution will be terminated.";
-         if (mpProgress != NULL)
+         string progressMessage;
+         int percent = 0;
+         ReportingLevel level;
+         mpProgress->getProgress(progressMessage, percent, level);
+
+         if (level != ABORT)
          {
-            mpProgress->updateProgress(mMessage, 0, ERRORS);
+            mpProgress->updateProgress(mMessage, 0, ABORT);
          }
-
-         pStep->finalize(Message::Failure, mMessage);
-         return false;
       }
-      if (!bSuccess)
+      if (mbDeleteWizard)
       {
-         resetAllNodeValues();
+         mpObjFact->destroyObject(mpWizard, "WizardObject");
+      }
+      else if (mpWizard != NULL)
+      {
+         mpWizard->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &WizardExecutor::wizardDeleted));
+      }
 
-         if (mpProgress != NULL)
-         {
-            string progressMessage;
-            int percent = 0;
-            ReportingLevel level;
-            mpProgress->getProgress(progressMessage, percent, level);
+      return false;
+   }
 
-            if (level != ERRORS)
-            {
-               mpProgress->updateProgress("The wizard failed to complete successfully.", 0, ERRORS);
-            }
-         }
+   if (mpWizard == NULL)
+   {
+      mMessage = "The wizard is no longer valid!  Execution will be terminated.";
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(mMessage, 0, ERRORS);
+      }
 
-         if (mbDeleteWizard)
-         {
-            mpObjFact->destroyObject(mpWizard, "WizardObject");
-         }
-         else if (mpWizard != NULL)
+      mpStep->finalize(Message::Failure, mMessage);
+      return false;
+   }
+
+   if (!bSuccess)
+   {
+      resetAllNodeValues();
+
+      if (mpProgress != NULL)
+      {
+         string progressMessage;
+         int percent = 0;
+         ReportingLevel level;
+         mpProgress->getProgress(progressMessage, percent, level);
+
+         if (level != ERRORS)
          {
-            mpWizard->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &WizardExecutor::wizardDeleted));
+            mpProgress->updateProgress("The wizard failed to complete successfully.", 0, ERRORS);
          }
+      }
 
-         pStep->finalize(Message::Failure);
-         return false;
+      if (mbDeleteWizard)
+      {
+         mpObjFact->destroyObject(mpWizard, "WizardObject");
       }
-   }
-   if (!populateList.empty() && mpProgress != NULL)
-   {
-      mpProgress->updateProgress(QString("%1 value item(s) ignored. They are not connected to any wizard items.")
-         .arg(populateList.size()).toStdString(), 0, WARNING);
+      else if (mpWizard != NULL)
+      {
+         mpWizard->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &WizardExecutor::wizardDeleted));
+      }
+
+      mpStep->finalize(Message::Failure);
+      return false;
    }
 
    mMessage = "Wizard complete.";
@@ -299,7 +323,7 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
       mpProgress->updateProgress(mMessage, 100, NORMAL);
    }
 
-   pStep->finalize(Message::Success);
+   mpStep->finalize(Message::Success);
 
    if (mbDeleteWizard)
    {
@@ -315,12 +339,13 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
 
 bool WizardExecutor::abort()
 {
-   mbAbort = true;
-
    bool bSuccess = true;
-   if (mpCurrentPlugIn != NULL)
+
+   QMutexLocker lock(&mMutex);
+   mbAbort = true;
+   for (vector<Executable*>::const_iterator iter = mRunningPlugIns.begin(); iter != mRunningPlugIns.end(); ++iter)
    {
-      bSuccess = mpCurrentPlugIn->abort();
+      bSuccess = (*iter)->abort() && bSuccess;
    }
 
    return bSuccess;
@@ -454,7 +479,8 @@ bool WizardExecutor::extractInputArgs(PlugInArgList* pInArgList)
    return true;
 }
 
-void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs)
+void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs,
+                                           Progress* pProgress)
 {
    if ((pArgList == NULL) || (pItem == NULL))
    {
@@ -509,7 +535,7 @@ void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const Wizard
                   else if (nodeType == TypeConverter::toString<Progress>() && bInArgs)
                   {
                      // only for input args - bkg plugin must set output arg to its Progress arg
-                     pArg->setActualValue(mpProgress);
+                     pArg->setActualValue(pProgress);
                   }
 
                   break;
@@ -521,7 +547,7 @@ void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const Wizard
          {
             if (argType == TypeConverter::toString<Progress>())
             {
-               pArg->setActualValue(mpProgress);
+               pArg->setActualValue(pProgress);
             }
          }
       }
@@ -532,30 +558,42 @@ bool WizardExecutor::launchPlugIn(WizardItem* pItem)
 {
    VERIFY(pItem != NULL);
 
+   ExecutableResource pExecutable(pItem->getName(), "", mpProgress, pItem->getBatchMode());
+   return executePlugIn(pItem, pExecutable, mpProgress);
+}
+
+bool WizardExecutor::executePlugIn(WizardItem* pItem, ExecutableResource& pExecutable, Progress* pProgress)
+{
+   VERIFY(pItem != NULL);
+
    StepResource pStep("Executing " + pItem->getType() + " Item: " + pItem->getName(), "app",
       "6A743B49-618B-44ed-9C5A-B4D67FB809D2");
 
    bool pluginExecuteStatus = false;
 
-   ExecutableResource pExecutable(pItem->getName(), "", mpProgress, pItem->getBatchMode());
-
    pExecutable->setAutoArg(false);
-   try
+
+   // Set the current plug-in
+   Executable* pPlugIn = dynamic_cast<Executable*>(pExecutable->getPlugIn());
+   if (pPlugIn != NULL)
    {
-      // Set the current plug-in
-      mpCurrentPlugIn = dynamic_cast<Executable*>(pExecutable->getPlugIn());
+      QMutexLocker lock(&mMutex);
+      mRunningPlugIns.push_back(pPlugIn);
+   }
 
-      if (mpCurrentPlugIn != NULL)
+   try
+   {
+      if (pPlugIn != NULL)
       {
-          populatePlugInArgList(&pExecutable->getInArgList(), pItem, true);
-          populatePlugInArgList(&pExecutable->getOutArgList(), pItem, false);
+          populatePlugInArgList(&pExecutable->getInArgList(), pItem, true, pProgress);
+          populatePlugInArgList(&pExecutable->getOutArgList(), pItem, false, pProgress);
 
           pluginExecuteStatus = pExecutable->execute();
 
           // Execute the plug-in
           if (pluginExecuteStatus)
           {
-             setConnectedNodeValues(pItem, &pExecutable->getOutArgList());
+             setConnectedNodeValues(pItem, &pExecutable->getOutArgList(), pProgress);
              pStep->finalize(Message::Success);
           }
           else
@@ -565,33 +603,38 @@ bool WizardExecutor::launchPlugIn(WizardItem* pItem)
       }
       else
       {
-         mMessage = "The " + pItem->getName() + " plug-in could not be created! Wizard execution will be terminated.";
-         if (mpProgress != NULL)
+         string message = "The " + pItem->getName() +
+            " plug-in could not be created! Wizard execution will be terminated.";
+         if (pProgress != NULL)
          {
-            mpProgress->updateProgress(mMessage, 0, ERRORS);
+            pProgress->updateProgress(message, 0, ERRORS);
          }
 
-         pStep->finalize(Message::Failure, mMessage);
+         pStep->finalize(Message::Failure, message);
       }
 
    }
    catch (AssertException exc)
    {
-      if (mpProgress != NULL) 
+      if (pProgress != NULL) 
       {
-         mpProgress->updateProgress(exc.getText(), 0, ERRORS);
+         pProgress->updateProgress(exc.getText(), 0, ERRORS);
       }
       pStep->finalize(Message::Failure, exc.getText());
       pluginExecuteStatus = false;
    }
 
    // Cleanup
-   mpCurrentPlugIn = NULL;
+   if (pPlugIn != NULL)
+   {
+      QMutexLocker lock(&mMutex);
+      mRunningPlugIns.erase(std::find(mRunningPlugIns.begin(), mRunningPlugIns.end(), pPlugIn));
+   }
 
    return pluginExecuteStatus;
 }
 
-void WizardExecutor::setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pOutArgList)
+void WizardExecutor::setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pOutArgList, Progress* pProgress)
 {
    VERIFYNRV(pItem != NULL);
 
@@ -625,6 +668,11 @@ void WizardExecutor::setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pO
                if (pArg->isActualSet())
                {
                   pValue = pArg->getActualValue();
+                  if (pValue == pProgress)
+                  {
+                     // An item's own progress object does not outlive the item
+                     pValue = static_cast<void*>(mpProgress);
+                  }
                }
                else if (nodeType == TypeConverter::toString<Progress>())
                {
@@ -742,15 +790,15 @@ void WizardExecutor::setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pO
                      }
                   }
 
-                  mMessage = "Could not set the " + connectedNodeName + " input node value" +
-                              connectedItemName + "! The node type is incompatible with the " +
-                              nodeName + " connected node type on the " + itemName + " item.";
-                  if (mpProgress != NULL)
+                  string message = "Could not set the " + connectedNodeName + " input node value" +
+                                   connectedItemName + "! The node type is incompatible with the " +
+                                   nodeName + " connected node type on the " + itemName + " item.";
+                  if (pProgress != NULL)
                   {
-                     mpProgress->updateProgress(mMessage, 0, WARNING);
+                     pProgress->updateProgress(message, 0, WARNING);
                   }
 
-                  mpStep->addMessage(mMessage, "app", "CFA1428A-E382-4b2b-8A23-0C10F8BA97EC", true);
+                  mpStep->addMessage(message, "app", "CFA1428A-E382-4b2b-8A23-0C10F8BA97EC", true);
                }
             }
          }
@@ -806,3 +854,595 @@ void WizardExecutor::resetAllNodeValues()
       }
    }
 }
+
+namespace
+{
+   /**
+    * Tracks which wizard items are ready to run.  An item becomes ready once every item
+    * connected to one of its input nodes has completed successfully.  Serial items also
+    * wait for the previous serial item, so that they run one after another in wizard order.
+    * As with serial execution, no further items are started once an item has failed, but
+    * items which are already running are allowed to finish.
+    */
+   class ItemScheduler
+   {
+   public:
+      enum ItemResult { NOT_RUN, SUCCEEDED, FAILED };
+
+      ItemScheduler(const vector<WizardItem*>& items, const vector<bool>& serialItems) :
+         mDependents(items.size()),
+         mBlockingCounts(items.size(), 0),
+         mResults(items.size(), NOT_RUN),
+         mRunningCount(0),
+         mCompletedCount(0),
+         mAborted(false)
+      {
+         bool bSerialItem = false;
+         vector<WizardItem*>::size_type previousSerialItem = 0;
+         for (vector<WizardItem*>::size_type index = 0; index < items.size(); ++index)
+         {
+            vector<WizardItem*> connectedItems;
+            items[index]->getConnectedItems(true, connectedItems);
+
+            // Only earlier items can provide values, matching the order of serial execution
+            set<vector<WizardItem*>::size_type> predecessors;
+            for (vector<WizardItem*>::const_iterator iter = connectedItems.begin();
+               iter != connectedItems.end();
+               ++iter)
+            {
+               vector<WizardItem*>::const_iterator predecessor = std::find(items.begin(), items.end(), *iter);
+               if (predecessor != items.end() && predecessor - items.begin() < static_cast<ptrdiff_t>(index))
+               {
+                  predecessors.insert(predecessor - items.begin());
+               }
+            }
+
+            if (serialItems[index])
+            {
+               if (bSerialItem)
+               {
+                  predecessors.insert(previousSerialItem);
+               }
+
+               bSerialItem = true;
+               previousSerialItem = index;
+            }
+
+            for (set<vector<WizardItem*>::size_type>::const_iterator iter = predecessors.begin();
+               iter != predecessors.end();
+               ++iter)
+            {
+               mDependents[*iter].push_back(index);
+            }
+
+            mBlockingCounts[index] = predecessors.size();
+            if (predecessors.empty())
+            {
+               mReadyItems.insert(index);
+            }
+         }
+      }
+
+      /**
+       * Waits for an item to become ready and marks it as running.  Ready items are
+       * started in wizard order.  Returns false when no more items can be started.
+       */
+      bool takeNextItem(unsigned int& index)
+      {
+         QMutexLocker lock(&mMutex);
+         while (mReadyItems.empty() && mRunningCount > 0 && !mAborted)
+         {
+            mItemReady.wait(&mMutex);
+         }
+
+         if (mReadyItems.empty() || mAborted)
+         {
+            return false;
+         }
+
+         index = *mReadyItems.begin();
+         mReadyItems.erase(mReadyItems.begin());
+         ++mRunningCount;
+         return true;
+      }
+
+      void completeItem(unsigned int index, bool bSuccess)
+      {
+         QMutexLocker lock(&mMutex);
+         --mRunningCount;
+         ++mCompletedCount;
+         mResults[index] = (bSuccess ? SUCCEEDED : FAILED);
+         if (bSuccess == false)
+         {
+            mAborted = true;
+         }
+         else
+         {
+            for (vector<unsigned int>::const_iterator iter = mDependents[index].begin();
+               iter != mDependents[index].end();
+               ++iter)
+            {
+               if (--mBlockingCounts[*iter] == 0)
+               {
+                  mReadyItems.insert(*iter);
+               }
+            }
+         }
+
+         mItemReady.wakeAll();
+      }
+
+      void abort()
+      {
+         QMutexLocker lock(&mMutex);
+         mAborted = true;
+         mItemReady.wakeAll();
+      }
+
+      int getPercentComplete()
+      {
+         QMutexLocker lock(&mMutex);
+         return static_cast<int>(100 * mCompletedCount / mResults.size());
+      }
+
+      const vector<ItemResult>& getResults() const
+      {
+         return mResults;
+      }
+
+   private:
+      QMutex mMutex;
+      QWaitCondition mItemReady;
+      vector<vector<unsigned int> > mDependents;
+      vector<unsigned int> mBlockingCounts;
+      vector<ItemResult> mResults;
+      set<unsigned int> mReadyItems;
+      unsigned int mRunningCount;
+      unsigned int mCompletedCount;
+      bool mAborted;
+   };
+
+   /**
+    * A private Progress for an item which runs concurrently with other items.  Warnings and
+    * errors are kept so that they can be reported in wizard order once all items have finished.
+    */
+   class ItemProgress
+   {
+   public:
+      ItemProgress() :
+         mpProgress(Service<UtilityServices>()->getProgress())
+      {
+         mpProgress->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &ItemProgress::progressUpdated));
+      }
+
+      virtual ~ItemProgress()
+      {
+         mpProgress->detach(SIGNAL_NAME(Subject, Modified), Slot(this, &ItemProgress::progressUpdated));
+         Service<UtilityServices>()->destroyProgress(mpProgress);
+      }
+
+      void progressUpdated(Subject& subject, const string& signal, const boost::any& value)
+      {
+         string text;
+         int percent = 0;
+         ReportingLevel level;
+         mpProgress->getProgress(text, percent, level);
+         if (level != NORMAL)
+         {
+            mMessages.push_back(make_pair(text, level));
+         }
+      }
+
+      Progress* getProgress() const
+      {
+         return mpProgress;
+      }
+
+      const vector<pair<string, ReportingLevel> >& getMessages() const
+      {
+         return mMessages;
+      }
+
+   private:
+      ItemProgress(const ItemProgress& rhs);
+      ItemProgress& operator=(const ItemProgress& rhs);
+
+      Progress* mpProgress;
+      vector<pair<string, ReportingLevel> > mMessages;
+   };
+
+   class ItemInput
+   {
+   public:
+      ItemInput(WizardExecutor& executor, ItemScheduler& scheduler, const vector<WizardItem*>& items,
+         const vector<bool>& mainThreadItems, const vector<ItemProgress*>& progress) :
+         mExecutor(executor),
+         mScheduler(scheduler),
+         mItems(items),
+         mMainThreadItems(mainThreadItems),
+         mProgress(progress)
+      {
+      }
+
+      WizardExecutor& mExecutor;
+      ItemScheduler& mScheduler;
+      const vector<WizardItem*>& mItems;
+      const vector<bool>& mMainThreadItems;
+      const vector<ItemProgress*>& mProgress;
+
+   private:
+      ItemInput& operator=(const ItemInput& rhs);
+   };
+
+   class ItemOutput
+   {
+   public:
+      template<class T>
+      bool compileOverallResults(const vector<T*>& threads)
+      {
+         return true;
+      }
+   };
+}
+
+class WizardExecutor::ItemThread : public mta::AlgorithmThread
+{
+public:
+   ItemThread(const ItemInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mInput(input)
+   {
+   }
+
+   void run()
+   {
+      WizardExecutor& executor = mInput.mExecutor;
+      unsigned int index = 0;
+      while (mInput.mScheduler.takeNextItem(index))
+      {
+         WizardItem* pItem = mInput.mItems[index];
+         Progress* pProgress = mInput.mProgress[index]->getProgress();
+
+         bool bSuccess = false;
+         if (mInput.mMainThreadItems[index])
+         {
+            ExecuteItem execute(executor, pItem, pProgress);
+            runInMainThread(execute);
+            bSuccess = execute.getSuccess();
+         }
+         else
+         {
+            // The plug-in manager and the wizard nodes are not thread-safe, so only
+            // the execution of the plug-in itself takes place in this thread
+            PrepareItem prepare(executor, pItem, pProgress);
+            runInMainThread(prepare);
+
+            Executable* pPlugIn = prepare.getPlugIn();
+            if (pPlugIn != NULL)
+            {
+               try
+               {
+                  ExecutableResource& pExecutable = *prepare.getExecutable();
+                  bSuccess = pPlugIn->execute(&pExecutable->getInArgList(), &pExecutable->getOutArgList());
+               }
+               catch (AssertException exc)
+               {
+                  pProgress->updateProgress(exc.getText(), 0, ERRORS);
+                  bSuccess = false;
+               }
+            }
+
+            FinishItem finish(executor, pItem, prepare.getExecutable(), bSuccess, pProgress);
+            runInMainThread(finish);
+         }
+
+         mInput.mScheduler.completeItem(index, bSuccess);
+
+         bool bAbort = false;
+         {
+            QMutexLocker lock(&executor.mMutex);
+            bAbort = executor.mbAbort;
+         }
+
+         if (bAbort)
+         {
+            mInput.mScheduler.abort();
+         }
+
+         getReporter().reportProgress(getThreadIndex(), mInput.mScheduler.getPercentComplete());
+      }
+   }
+
+private:
+   ItemThread& operator=(const ItemThread& rhs);
+
+   /**
+    * Creates, executes and destroys a plug-in which is not known to be thread-safe.
+    */
+   class ExecuteItem : public mta::ThreadCommand
+   {
+   public:
+      ExecuteItem(WizardExecutor& executor, WizardItem* pItem, Progress* pProgress) :
+         mExecutor(executor),
+         mpItem(pItem),
+         mpProgress(pProgress),
+         mSuccess(false)
+      {
+      }
+
+      void run()
+      {
+         ExecutableResource pExecutable(mpItem->getName(), string(), mpProgress, mpItem->getBatchMode());
+         mSuccess = mExecutor.executePlugIn(mpItem, pExecutable, mpProgress);
+         mExecutor.resetNodeValues(mpItem);
+      }
+
+      bool getSuccess() const
+      {
+         return mSuccess;
+      }
+
+   private:
+      ExecuteItem& operator=(const ExecuteItem& rhs);
+
+      WizardExecutor& mExecutor;
+      WizardItem* mpItem;
+      Progress* mpProgress;
+      bool mSuccess;
+   };
+
+   /**
+    * Creates a thread-safe plug-in and populates its argument lists from the wizard nodes.
+    */
+   class PrepareItem : public mta::ThreadCommand
+   {
+   public:
+      PrepareItem(WizardExecutor& executor, WizardItem* pItem, Progress* pProgress) :
+         mExecutor(executor),
+         mpItem(pItem),
+         mpProgress(pProgress),
+         mpExecutable(NULL),
+         mpPlugIn(NULL)
+      {
+      }
+
+      void run()
+      {
+         mpExecutable = new ExecutableResource(mpItem->getName(), string(), mpProgress, mpItem->getBatchMode());
+         (*mpExecutable)->setAutoArg(false);
+
+         mpPlugIn = dynamic_cast<Executable*>((*mpExecutable)->getPlugIn());
+         if (mpPlugIn == NULL)
+         {
+            mpProgress->updateProgress("The " + mpItem->getName() +
+               " plug-in could not be created! Wizard execution will be terminated.", 0, ERRORS);
+            return;
+         }
+
+         // The batch mode check is otherwise made by ExecutableAgent::execute()
+         if (mpPlugIn->setBatch() == false)
+         {
+            mpProgress->updateProgress("The " + mpItem->getName() + " plug-in does not support batch mode!",
+               0, ERRORS);
+            mpPlugIn = NULL;
+            return;
+         }
+
+         mExecutor.populatePlugInArgList(&(*mpExecutable)->getInArgList(), mpItem, true, mpProgress);
+         mExecutor.populatePlugInArgList(&(*mpExecutable)->getOutArgList(), mpItem, false, mpProgress);
+
+         QMutexLocker lock(&mExecutor.mMutex);
+         mExecutor.mRunningPlugIns.push_back(mpPlugIn);
+      }
+
+      ExecutableResource* getExecutable() const
+      {
+         return mpExecutable;
+      }
+
+      Executable* getPlugIn() const
+      {
+         return mpPlugIn;
+      }
+
+   private:
+      PrepareItem& operator=(const PrepareItem& rhs);
+
+      WizardExecutor& mExecutor;
+      WizardItem* mpItem;
+      Progress* mpProgress;
+      ExecutableResource* mpExecutable;
+      Executable* mpPlugIn;
+   };
+
+   /**
+    * Passes the output values of a thread-safe plug-in to the wizard nodes and destroys the plug-in.
+    */
+   class FinishItem : public mta::ThreadCommand
+   {
+   public:
+      FinishItem(WizardExecutor& executor, WizardItem* pItem, ExecutableResource* pExecutable, bool bSuccess,
+         Progress* pProgress) :
+         mExecutor(executor),
+         mpItem(pItem),
+         mpExecutable(pExecutable),
+         mSuccess(bSuccess),
+         mpProgress(pProgress)
+      {
+      }
+
+      void run()
+      {
+         Executable* pPlugIn = dynamic_cast<Executable*>((*mpExecutable)->getPlugIn());
+         if (pPlugIn != NULL)
+         {
+            QMutexLocker lock(&mExecutor.mMutex);
+            vector<Executable*>::iterator iter =
+               std::find(mExecutor.mRunningPlugIns.begin(), mExecutor.mRunningPlugIns.end(), pPlugIn);
+            if (iter != mExecutor.mRunningPlugIns.end())
+            {
+               mExecutor.mRunningPlugIns.erase(iter);
+            }
+         }
+
+         if (mSuccess)
+         {
+            mExecutor.setConnectedNodeValues(mpItem, &(*mpExecutable)->getOutArgList(), mpProgress);
+         }
+
+         delete mpExecutable;
+         mExecutor.resetNodeValues(mpItem);
+      }
+
+   private:
+      FinishItem& operator=(const FinishItem& rhs);
+
+      WizardExecutor& mExecutor;
+      WizardItem* mpItem;
+      ExecutableResource* mpExecutable;
+      bool mSuccess;
+      Progress* mpProgress;
+   };
+
+   const ItemInput& mInput;
+};
+
+bool WizardExecutor::canExecuteConcurrently(const vector<WizardItem*>& items) const
+{
+   if (getSettingConcurrentItemCount() < 2 || Service<ApplicationServices>()->isBatch() == false)
+   {
+      return false;
+   }
+
+   // Interactive value items prompt the user between items, which requires serial execution
+   unsigned int plugInCount = 0;
+   bool bThreadSafeItem = false;
+   for (vector<WizardItem*>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+   {
+      if ((*iter)->getType() == "Value")
+      {
+         if ((*iter)->getBatchMode() == false)
+         {
+            return false;
+         }
+      }
+      else
+      {
+         ++plugInCount;
+         bThreadSafeItem = bThreadSafeItem || !isMainThreadItem(*iter);
+      }
+   }
+
+   // Items which are not thread-safe run one at a time, so at least one thread-safe item is needed
+   return plugInCount > 1 && bThreadSafeItem;
+}
+
+bool WizardExecutor::isMainThreadItem(const WizardItem* pItem) const
+{
+   VERIFY(pItem != NULL);
+
+   // Only plug-ins which have been declared as thread-safe can be executed outside of the main thread
+   const vector<string> threadSafePlugIns = getSettingThreadSafePlugIns();
+   if (std::find(threadSafePlugIns.begin(), threadSafePlugIns.end(), pItem->getName()) == threadSafePlugIns.end())
+   {
+      return true;
+   }
+
+   const string& itemType = pItem->getType();
+   if (pItem->getBatchMode() == false || itemType == PlugInManagerServices::ViewerType() ||
+      itemType == PlugInManagerServices::WizardType())
+   {
+      return true;
+   }
+
+   // Items which receive or produce views or layers work with widgets
+   vector<WizardNode*> nodes = pItem->getInputNodes();
+   const vector<WizardNode*>& outputNodes = pItem->getOutputNodes();
+   nodes.insert(nodes.end(), outputNodes.begin(), outputNodes.end());
+   for (vector<WizardNode*>::const_iterator iter = nodes.begin(); iter != nodes.end(); ++iter)
+   {
+      const string& nodeType = (*iter)->getType();
+      if (mpDesktop->isKindOfView(nodeType, TypeConverter::toString<View>()) ||
+         mpDesktop->isKindOfLayer(nodeType, TypeConverter::toString<Layer>()))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool WizardExecutor::executeConcurrently(const vector<WizardItem*>& items)
+{
+   // Value items have no inputs, so set all of their values before any plug-in runs
+   vector<WizardItem*> plugInItems;
+   for (vector<WizardItem*>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+   {
+      WizardItem* pItem = *iter;
+      VERIFY(pItem != NULL);
+      if (pItem->getType() == "Value")
+      {
+         mMessage = "Executing Value Item: " + pItem->getName();
+         mpStep->addMessage(mMessage, "app", "9FC4024E-00FA-42cd-8EC3-2AAE84843BA7", true);
+         setConnectedNodeValues(pItem, NULL, mpProgress);
+      }
+      else
+      {
+         plugInItems.push_back(pItem);
+      }
+   }
+
+   vector<bool> mainThreadItems;
+   vector<ItemProgress*> progress;
+   for (vector<WizardItem*>::const_iterator iter = plugInItems.begin(); iter != plugInItems.end(); ++iter)
+   {
+      mainThreadItems.push_back(isMainThreadItem(*iter));
+      progress.push_back(new ItemProgress);
+   }
+
+   ItemScheduler scheduler(plugInItems, mainThreadItems);
+   ItemInput input(*this, scheduler, plugInItems, mainThreadItems, progress);
+   ItemOutput output;
+   unsigned int threadCount = std::min(getSettingConcurrentItemCount(),
+      static_cast<unsigned int>(plugInItems.size()));
+   mta::ProgressObjectReporter reporter("Executing wizard items", mpProgress);
+   mta::MultiThreadedAlgorithm<ItemInput, ItemOutput, ItemThread> algorithm(threadCount, input, output, &reporter);
+   algorithm.run();
+
+   // Report in wizard order so the output does not depend on which items finished first
+   bool bSuccess = true;
+   const vector<ItemScheduler::ItemResult>& results = scheduler.getResults();
+   for (vector<WizardItem*>::size_type index = 0; index < plugInItems.size(); ++index)
+   {
+      if (mpProgress != NULL)
+      {
+         const vector<pair<string, ReportingLevel> >& messages = progress[index]->getMessages();
+         for (vector<pair<string, ReportingLevel> >::const_iterator iter = messages.begin();
+            iter != messages.end();
+            ++iter)
+         {
+            mpProgress->updateProgress(iter->first, 0, iter->second);
+         }
+      }
+
+      // Items executed in the main thread have already added their steps
+      if (results[index] != ItemScheduler::NOT_RUN && mainThreadItems[index] == false)
+      {
+         StepResource pStep("Executing " + plugInItems[index]->getType() + " Item: " + plugInItems[index]->getName(),
+            "app", "6A743B49-618B-44ed-9C5A-B4D67FB809D2");
+         pStep->finalize(results[index] == ItemScheduler::SUCCEEDED ? Message::Success : Message::Failure);
+      }
+
+      if (results[index] == ItemScheduler::NOT_RUN && mbAbort == false)
+      {
+         mMessage = "The " + plugInItems[index]->getName() +
+            " item was not executed because another item failed.";
+         mpStep->addMessage(mMessage, "app", "0F3B7C51-4C0E-4F1B-9E0B-6E3C8B3A1D27", true);
+      }
+
+      bSuccess = bSuccess && (results[index] == ItemScheduler::SUCCEEDED);
+      delete progress[index];
+   }
+
+   return bSuccess;
+}
@@ -10,13 +10,18 @@
 #ifndef WIZARDEXECUTOR_H
 #define WIZARDEXECUTOR_H
 
+#include "ConfigurationSettings.h"
 #include "DesktopServices.h"
 #include "ObjectFactory.h"
 #include "WizardShell.h"
 
+#include <QtCore/QMutex>
+
 #include <string>
+#include <vector>
 
 class Executable;
+class ExecutableResource;
 class Progress;
 class Step;
 class WizardItem;
@@ -30,6 +35,9 @@ namespace boost
 class WizardExecutor : public WizardShell
 {
 public:
+   SETTING(ConcurrentItemCount, WizardExecutor, unsigned int, 1);
+   SETTING(ThreadSafePlugIns, WizardExecutor, std::vector<std::string>, std::vector<std::string>());
+
    WizardExecutor();
    ~WizardExecutor();
 
@@ -44,13 +52,21 @@ public:
 
 protected:
    bool extractInputArgs(PlugInArgList* pInArgList);
-   void populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs);
+   void populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs, Progress* pProgress);
    bool launchPlugIn(WizardItem* pItem);
-   void setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pOutArgList = NULL);
+   bool executePlugIn(WizardItem* pItem, ExecutableResource& executable, Progress* pProgress);
+   void setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pOutArgList, Progress* pProgress);
    void resetNodeValues(WizardItem* pItem);
    void resetAllNodeValues();
+   bool finishExecution(bool bSuccess);
+
+   bool canExecuteConcurrently(const std::vector<WizardItem*>& items) const;
+   bool isMainThreadItem(const WizardItem* pItem) const;
+   bool executeConcurrently(const std::vector<WizardItem*>& items);
 
 private:
+   class ItemThread;
+
    bool mbInteractive;
    bool mbAbort;
    bool mbDeleteWizard;
@@ -58,7 +74,8 @@ private:
    Service<ObjectFactory> mpObjFact;
    Progress* mpProgress;
    WizardObject* mpWizard;
-   Executable* mpCurrentPlugIn;
+   std::vector<Executable*> mRunningPlugIns;
+   QMutex mMutex;
 
    Step* mpStep;
    std::string mMessage;
@@ -16,6 +16,7 @@
 #include "OpticksMethods.h"
 #include "DataDescriptor.h"
 #include "DesktopServices.h"
+#include "Endian.h"
 #include "Filename.h"
 #include "GraphicElement.h"
 #include "GraphicGroup.h"
@@ -30,11 +31,13 @@
 #include "RasterDataDescriptor.h"
 #include "RasterFileDescriptor.h"
 #include "RasterElement.h"
+#include "RasterTransfer.h"
 #include "RasterUtilities.h"
 #include "RectangleObject.h"
 #include "SessionManager.h"
 #include "SpatialDataView.h"
 #include "SpatialDataWindow.h"
+#include "Statistics.h"
 #include "StringUtilities.h"
 #include "WorkspaceWindow.h"
 #include "XmlRpcArrayParam.h"
@@ -90,6 +93,21 @@ namespace // utility functions
       return pView;
    }
 
+   RasterElement* getRasterElement(const XmlRpcParams& params, int paramNumber)
+   {
+      SpatialDataView* pView = dynamic_cast<SpatialDataView*>(getView(params, paramNumber));
+      if (pView == NULL)
+      {
+         throw XmlRpcMethodFault(300);
+      }
+      RasterElement* pElement = pView->getLayerList()->getPrimaryRasterElement();
+      if (pElement == NULL)
+      {
+         throw XmlRpcMethodFault(303);
+      }
+      return pElement;
+   }
+
    void setAnnotationProperties(GraphicObject& object, const XmlRpcStructParam& properties)
    {
       for (XmlRpcStructParam::type::const_iterator it = properties.begin(); it != properties.end(); ++it)
@@ -1327,6 +1345,206 @@ XmlRpcArrayParam* PanTo::getSignature()
    return pSignatures;
 }
 
+XmlRpcParam* Raster::GetInfo::operator()(const XmlRpcParams& params)
+{
+   if (params.size() > 1)
+   {
+      throw XmlRpcMethodFault(200);
+   }
+   RasterElement* pElement = getRasterElement(params, 0);
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      throw XmlRpcMethodFault(303);
+   }
+
+   XmlRpcStructParam* pRval = new XmlRpcStructParam;
+   pRval->insert("rows", new XmlRpcParam(INT_PARAM, pDescriptor->getRowCount()));
+   pRval->insert("columns", new XmlRpcParam(INT_PARAM, pDescriptor->getColumnCount()));
+   pRval->insert("bands", new XmlRpcParam(INT_PARAM, pDescriptor->getBandCount()));
+   pRval->insert("data type", new XmlRpcParam(STRING_PARAM,
+      QString::fromStdString(StringUtilities::toXmlString(pDescriptor->getDataType()))));
+   pRval->insert("bytes per element", new XmlRpcParam(INT_PARAM, pDescriptor->getBytesPerElement()));
+   pRval->insert("interleave", new XmlRpcParam(STRING_PARAM,
+      QString::fromStdString(StringUtilities::toXmlString(pDescriptor->getInterleaveFormat()))));
+   pRval->insert("byte order", new XmlRpcParam(STRING_PARAM,
+      QString::fromStdString(StringUtilities::toXmlString(Endian::getSystemEndian()))));
+   pRval->insert("max chunk bytes", new XmlRpcParam(INT_PARAM, RasterTransfer::MAX_CHUNK_BYTES));
+   return pRval;
+}
+
+QString Raster::GetInfo::getHelp()
+{
+   return "Get the dimensions and data type of the primary raster element of a view. "
+          "Raster data returned by opticks.raster.getSubcube is in the listed byte order.";
+}
+
+XmlRpcArrayParam* Raster::GetInfo::getSignature()
+{
+   XmlRpcArrayParam* pSignatures = new XmlRpcArrayParam;
+
+   XmlRpcArrayParam* pParams = new XmlRpcArrayParam;
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct");
+   *pSignatures << pParams;
+
+   pParams = new XmlRpcArrayParam;
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct");
+   *pParams << new XmlRpcParam(STRING_PARAM, "string ViewID");
+   *pSignatures << pParams;
+
+   return pSignatures;
+}
+
+XmlRpcParam* Raster::GetStatistics::operator()(const XmlRpcParams& params)
+{
+   if (params.size() < 1 || params.size() > 2)
+   {
+      throw XmlRpcMethodFault(200);
+   }
+   RasterElement* pElement = getRasterElement(params, 1);
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      throw XmlRpcMethodFault(303);
+   }
+
+   const XmlRpcParam* pBand = params[0];
+   if ((pBand == NULL) || (pBand->type() != INT_PARAM))
+   {
+      throw XmlRpcMethodFault(200);
+   }
+   DimensionDescriptor band = pDescriptor->getActiveBand(pBand->value().toUInt());
+   if (pBand->value().toInt() < 0 || band.isValid() == false)
+   {
+      throw XmlRpcMethodFault(201);
+   }
+
+   Statistics* pStatistics = pElement->getStatistics(band);
+   if (pStatistics == NULL)
+   {
+      throw XmlRpcMethodFault(314);
+   }
+
+   const double* pBinCenters = NULL;
+   const unsigned int* pCounts = NULL;
+   pStatistics->getHistogram(pBinCenters, pCounts);
+   if (pBinCenters == NULL || pCounts == NULL)
+   {
+      throw XmlRpcMethodFault(314);
+   }
+
+   // The histogram is returned as raw arrays in host byte order rather than as arrays of XML-RPC values
+   const int binCount = 256;
+   QByteArray binCenters(reinterpret_cast<const char*>(pBinCenters), binCount * sizeof(double));
+   QByteArray counts(reinterpret_cast<const char*>(pCounts), binCount * sizeof(unsigned int));
+
+   XmlRpcStructParam* pRval = new XmlRpcStructParam;
+   pRval->insert("minimum", new XmlRpcParam(DOUBLE_PARAM, pStatistics->getMin()));
+   pRval->insert("maximum", new XmlRpcParam(DOUBLE_PARAM, pStatistics->getMax()));
+   pRval->insert("average", new XmlRpcParam(DOUBLE_PARAM, pStatistics->getAverage()));
+   pRval->insert("standard deviation", new XmlRpcParam(DOUBLE_PARAM, pStatistics->getStandardDeviation()));
+   pRval->insert("bin centers", new XmlRpcParam(BASE64_PARAM, QString::fromAscii(binCenters.toBase64())));
+   pRval->insert("histogram counts", new XmlRpcParam(BASE64_PARAM, QString::fromAscii(counts.toBase64())));
+   return pRval;
+}
+
+QString Raster::GetStatistics::getHelp()
+{
+   return "Get the statistics of a band of the primary raster element of a view. "
+          "The 256 histogram bin centers are returned as base64 encoded doubles and the "
+          "histogram counts as base64 encoded 32-bit unsigned integers.";
+}
+
+XmlRpcArrayParam* Raster::GetStatistics::getSignature()
+{
+   XmlRpcArrayParam* pSignatures = new XmlRpcArrayParam;
+
+   XmlRpcArrayParam* pParams = new XmlRpcArrayParam;
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct");
+   *pParams << new XmlRpcParam(STRING_PARAM, "int Band");
+   *pSignatures << pParams;
+
+   pParams = new XmlRpcArrayParam;
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct");
+   *pParams << new XmlRpcParam(STRING_PARAM, "int Band");
+   *pParams << new XmlRpcParam(STRING_PARAM, "string ViewID");
+   *pSignatures << pParams;
+
+   return pSignatures;
+}
+
+XmlRpcParam* Raster::GetSubcube::operator()(const XmlRpcParams& params)
+{
+   if (params.size() < 1 || params.size() > 2)
+   {
+      throw XmlRpcMethodFault(200);
+   }
+   const XmlRpcStructParam* pRequest = dynamic_cast<const XmlRpcStructParam*>(params[0]);
+   if (pRequest == NULL)
+   {
+      throw XmlRpcMethodFault(200);
+   }
+   RasterElement* pElement = getRasterElement(params, 1);
+
+   QMap<QString, QString> request;
+   for (XmlRpcStructParam::type::const_iterator it = pRequest->begin(); it != pRequest->end(); ++it)
+   {
+      if (it.value() != NULL)
+      {
+         request[it.key()] = it.value()->value().toString();
+      }
+   }
+
+   RasterTransfer transfer(pElement);
+   if (!transfer.setRequest(request))
+   {
+      throw XmlRpcMethodFault(201);
+   }
+   QByteArray chunk;
+   if (!transfer.read(chunk))
+   {
+      throw XmlRpcMethodFault(314);
+   }
+
+   XmlRpcStructParam* pRval = new XmlRpcStructParam;
+   pRval->insert("data", new XmlRpcParam(BASE64_PARAM, QString::fromAscii(chunk.toBase64())));
+   pRval->insert("offset", new XmlRpcParam(DOUBLE_PARAM, static_cast<double>(transfer.getOffset())));
+   pRval->insert("length", new XmlRpcParam(INT_PARAM, chunk.size()));
+   pRval->insert("total bytes", new XmlRpcParam(DOUBLE_PARAM, static_cast<double>(transfer.getTotalBytes())));
+   pRval->insert("interleave", new XmlRpcParam(STRING_PARAM,
+      QString::fromStdString(StringUtilities::toXmlString(transfer.getInterleave()))));
+   return pRval;
+}
+
+QString Raster::GetSubcube::getHelp()
+{
+   return "Get a chunk of a subcube of the primary raster element of a view as base64 encoded data in host byte "
+          "order. The Request struct may contain StartRow, EndRow, StartColumn, EndColumn, StartBand and EndBand "
+          "as inclusive zero-based active numbers, Interleave (BIP, BIL or BSQ), Offset as the byte offset into "
+          "the subcube and Length as the maximum number of bytes to return. Call repeatedly with an increasing "
+          "Offset until offset plus length equals total bytes to transfer a subcube larger than one chunk. "
+          "The same request may be sent as form values to http://localhost:<port>/raster to receive the chunk "
+          "as raw octets.";
+}
+
+XmlRpcArrayParam* Raster::GetSubcube::getSignature()
+{
+   XmlRpcArrayParam* pSignatures = new XmlRpcArrayParam;
+
+   XmlRpcArrayParam* pParams = new XmlRpcArrayParam;
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct");
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct Request");
+   *pSignatures << pParams;
+
+   pParams = new XmlRpcArrayParam;
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct");
+   *pParams << new XmlRpcParam(STRING_PARAM, "struct Request");
+   *pParams << new XmlRpcParam(STRING_PARAM, "string ViewID");
+   *pSignatures << pParams;
+
+   return pSignatures;
+}
+
 RegisterCallback::~RegisterCallback()
 {
    for (std::list<XmlRpcCallback*>::iterator cit = mCallbacks.begin(); cit != mCallbacks.end(); ++cit)
@@ -276,6 +276,42 @@ public:
    virtual XmlRpcArrayParam *getSignature();
 };
 
+namespace Raster
+{
+   class GetInfo : public XmlRpcMethodCallImp
+   {
+   public:
+      GetInfo() {}
+      GetInfo(const GetInfo &other) {}
+      virtual ~GetInfo() {}
+      virtual XmlRpcParam *operator()(const XmlRpcParams &params);
+      virtual QString getHelp();
+      virtual XmlRpcArrayParam *getSignature();
+   };
+
+   class GetStatistics : public XmlRpcMethodCallImp
+   {
+   public:
+      GetStatistics() {}
+      GetStatistics(const GetStatistics &other) {}
+      virtual ~GetStatistics() {}
+      virtual XmlRpcParam *operator()(const XmlRpcParams &params);
+      virtual QString getHelp();
+      virtual XmlRpcArrayParam *getSignature();
+   };
+
+   class GetSubcube : public XmlRpcMethodCallImp
+   {
+   public:
+      GetSubcube() {}
+      GetSubcube(const GetSubcube &other) {}
+      virtual ~GetSubcube() {}
+      virtual XmlRpcParam *operator()(const XmlRpcParams &params);
+      virtual QString getHelp();
+      virtual XmlRpcArrayParam *getSignature();
+   };
+};
+
 class RegisterCallback : public XmlRpcMethodCallImp
 {
 public:
@@ -0,0 +1,349 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DesktopServices.h"
+#include "LayerList.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterTransfer.h"
+#include "SessionManager.h"
+#include "SpatialDataView.h"
+#include "SpatialDataWindow.h"
+#include "StringUtilities.h"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+   bool getValue(const QMap<QString, QString>& request, const QString& key, unsigned int& value)
+   {
+      QMap<QString, QString>::const_iterator iter = request.find(key);
+      if (iter == request.end())
+      {
+         return true;
+      }
+
+      bool ok = false;
+      value = iter.value().toUInt(&ok);
+      return ok;
+   }
+}
+
+RasterTransfer::RasterTransfer(RasterElement* pElement) :
+   mpElement(pElement),
+   mpDescriptor(NULL),
+   mValid(false),
+   mStartRow(0),
+   mRowCount(0),
+   mStartColumn(0),
+   mColumnCount(0),
+   mStartBand(0),
+   mBandCount(0),
+   mOffset(0),
+   mLength(MAX_CHUNK_BYTES)
+{
+   if (mpElement != NULL)
+   {
+      mpDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpElement->getDataDescriptor());
+   }
+   if (mpDescriptor != NULL)
+   {
+      mInterleave = mpDescriptor->getInterleaveFormat();
+   }
+}
+
+bool RasterTransfer::setRequest(const QMap<QString, QString>& request)
+{
+   mValid = false;
+   if (mpDescriptor == NULL || mpDescriptor->getRowCount() == 0 || mpDescriptor->getColumnCount() == 0 ||
+      mpDescriptor->getBandCount() == 0)
+   {
+      return false;
+   }
+
+   unsigned int startRow = 0;
+   unsigned int endRow = mpDescriptor->getRowCount() - 1;
+   unsigned int startColumn = 0;
+   unsigned int endColumn = mpDescriptor->getColumnCount() - 1;
+   unsigned int startBand = 0;
+   unsigned int endBand = mpDescriptor->getBandCount() - 1;
+   unsigned int length = MAX_CHUNK_BYTES;
+   if (!getValue(request, "StartRow", startRow) || !getValue(request, "EndRow", endRow) ||
+      !getValue(request, "StartColumn", startColumn) || !getValue(request, "EndColumn", endColumn) ||
+      !getValue(request, "StartBand", startBand) || !getValue(request, "EndBand", endBand) ||
+      !getValue(request, "Length", length))
+   {
+      return false;
+   }
+
+   if (startRow > endRow || endRow >= mpDescriptor->getRowCount() ||
+      startColumn > endColumn || endColumn >= mpDescriptor->getColumnCount() ||
+      startBand > endBand || endBand >= mpDescriptor->getBandCount() || length == 0)
+   {
+      return false;
+   }
+
+   // Offsets may exceed the range of an XML-RPC int so they are also accepted as doubles
+   uint64_t offset = 0;
+   QMap<QString, QString>::const_iterator offsetIter = request.find("Offset");
+   if (offsetIter != request.end())
+   {
+      bool ok = false;
+      double value = offsetIter.value().toDouble(&ok);
+      if (!ok || value < 0.0)
+      {
+         return false;
+      }
+      offset = static_cast<uint64_t>(value);
+   }
+
+   InterleaveFormatType interleave = mpDescriptor->getInterleaveFormat();
+   QMap<QString, QString>::const_iterator interleaveIter = request.find("Interleave");
+   if (interleaveIter != request.end())
+   {
+      bool error = true;
+      interleave = StringUtilities::fromXmlString<InterleaveFormatType>(
+         interleaveIter.value().toUpper().toStdString(), &error);
+      if (error || interleave.isValid() == false)
+      {
+         return false;
+      }
+   }
+
+   mStartRow = startRow;
+   mRowCount = endRow - startRow + 1;
+   mStartColumn = startColumn;
+   mColumnCount = endColumn - startColumn + 1;
+   mStartBand = startBand;
+   mBandCount = endBand - startBand + 1;
+   mInterleave = interleave;
+   mOffset = offset;
+   mLength = (length < MAX_CHUNK_BYTES) ? length : MAX_CHUNK_BYTES;
+   mValid = (mOffset <= getTotalBytes());
+   return mValid;
+}
+
+bool RasterTransfer::isValid() const
+{
+   return mValid;
+}
+
+uint64_t RasterTransfer::getOffset() const
+{
+   return mOffset;
+}
+
+uint64_t RasterTransfer::getTotalBytes() const
+{
+   if (mpDescriptor == NULL)
+   {
+      return 0;
+   }
+
+   return static_cast<uint64_t>(mRowCount) * mColumnCount * mBandCount * mpDescriptor->getBytesPerElement();
+}
+
+InterleaveFormatType RasterTransfer::getInterleave() const
+{
+   return mInterleave;
+}
+
+size_t RasterTransfer::getLineBytes() const
+{
+   // A line is one row of every band for BIP and BIL and one row of a single band for BSQ
+   size_t lineBytes = static_cast<size_t>(mColumnCount) * mpDescriptor->getBytesPerElement();
+   if (mInterleave != BSQ)
+   {
+      lineBytes *= mBandCount;
+   }
+
+   return lineBytes;
+}
+
+void RasterTransfer::copyLine(const char* pRow, char* pDestination) const
+{
+   // The accessor rows contain every column and, except for BSQ, every band of the element
+   const size_t bpe = mpDescriptor->getBytesPerElement();
+   if (mInterleave == BIP)
+   {
+      const size_t columnBytes = mpDescriptor->getBandCount() * bpe;
+      const size_t runBytes = mBandCount * bpe;
+      const char* pSource = pRow + mStartColumn * columnBytes + mStartBand * bpe;
+      if (mBandCount == mpDescriptor->getBandCount())
+      {
+         memcpy(pDestination, pSource, mColumnCount * runBytes);
+         return;
+      }
+
+      for (unsigned int column = 0; column < mColumnCount; ++column)
+      {
+         memcpy(pDestination, pSource, runBytes);
+         pDestination += runBytes;
+         pSource += columnBytes;
+      }
+   }
+   else if (mInterleave == BIL)
+   {
+      const size_t bandBytes = mpDescriptor->getColumnCount() * bpe;
+      const size_t runBytes = mColumnCount * bpe;
+      const char* pSource = pRow + mStartBand * bandBytes + mStartColumn * bpe;
+      for (unsigned int band = 0; band < mBandCount; ++band)
+      {
+         memcpy(pDestination, pSource, runBytes);
+         pDestination += runBytes;
+         pSource += bandBytes;
+      }
+   }
+   else
+   {
+      memcpy(pDestination, pRow + mStartColumn * bpe, mColumnCount * bpe);
+   }
+}
+
+bool RasterTransfer::read(QByteArray& chunk) const
+{
+   chunk.clear();
+   if (!mValid)
+   {
+      return false;
+   }
+
+   const uint64_t totalBytes = getTotalBytes();
+   const size_t length = static_cast<size_t>(std::min<uint64_t>(mLength, totalBytes - mOffset));
+   if (length == 0)
+   {
+      return true;
+   }
+   chunk.resize(static_cast<int>(length));
+
+   const size_t lineBytes = getLineBytes();
+   const uint64_t firstLine = mOffset / lineBytes;
+   const uint64_t lastLine = (mOffset + length - 1) / lineBytes;
+   std::vector<char> partialLine(lineBytes);
+
+   DataAccessor da(NULL, NULL);
+   unsigned int accessorBand = 0;
+   for (uint64_t line = firstLine; line <= lastLine; ++line)
+   {
+      // BSQ lines are ordered by band and then by row
+      const unsigned int band = (mInterleave == BSQ) ? static_cast<unsigned int>(line / mRowCount) : 0;
+      const unsigned int row = static_cast<unsigned int>(line % mRowCount);
+      if (!da.isValid() || band != accessorBand)
+      {
+         // Request every row of the chunk in this band at once so the data is read in large blocks
+         const uint64_t bandEndLine = (mInterleave == BSQ) ? (static_cast<uint64_t>(band) + 1) * mRowCount - 1 :
+            static_cast<uint64_t>(mRowCount) - 1;
+         const unsigned int endRow = row + static_cast<unsigned int>(std::min(lastLine, bandEndLine) - line);
+
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(mInterleave);
+         pRequest->setRows(mpDescriptor->getActiveRow(mStartRow + row), mpDescriptor->getActiveRow(mStartRow + endRow),
+            endRow - row + 1);
+         if (mInterleave == BSQ)
+         {
+            DimensionDescriptor bandDescriptor = mpDescriptor->getActiveBand(mStartBand + band);
+            pRequest->setBands(bandDescriptor, bandDescriptor);
+         }
+         da = mpElement->getDataAccessor(pRequest.release());
+         accessorBand = band;
+      }
+
+      da->toPixel(mStartRow + row, 0);
+      if (!da.isValid())
+      {
+         chunk.clear();
+         return false;
+      }
+
+      // Lines which are entirely within the chunk are copied in place
+      const uint64_t lineStart = line * lineBytes;
+      const uint64_t copyStart = std::max(lineStart, mOffset);
+      const uint64_t copyEnd = std::min(lineStart + lineBytes, mOffset + length);
+      char* pChunk = chunk.data() + static_cast<size_t>(copyStart - mOffset);
+      const char* pRow = static_cast<const char*>(da->getRow());
+      if (copyStart == lineStart && copyEnd == lineStart + lineBytes)
+      {
+         copyLine(pRow, pChunk);
+      }
+      else
+      {
+         copyLine(pRow, &partialLine.front());
+         memcpy(pChunk, &partialLine[static_cast<size_t>(copyStart - lineStart)],
+            static_cast<size_t>(copyEnd - copyStart));
+      }
+   }
+
+   return true;
+}
+
+RasterTransferHandler::RasterTransferHandler(QObject* pParent) :
+   MuHttpServer(0, pParent)
+{}
+
+RasterTransferHandler::~RasterTransferHandler()
+{}
+
+MuHttpServer::Response RasterTransferHandler::getRequest(const QString& uri, const QString& contentType,
+                                                         const QString& body, const FormValueMap& form)
+{
+   Response r;
+   r.mCode = HTTPRESPONSECODE_404_NOTFOUND;
+   r.mHeaders["content-type"] = "text/html";
+   r.mBody = "<html><body><h1>Not found</h1>The requested raster data can not be located.</body></html>";
+
+   QMap<QString, QString> request;
+   for (FormValueMap::const_iterator iter = form.begin(); iter != form.end(); ++iter)
+   {
+      request[QString::fromStdString(iter->first)] = QString::fromStdString(iter->second.m_sBody);
+   }
+
+   SpatialDataWindow* pWindow = NULL;
+   QMap<QString, QString>::const_iterator viewIter = request.find("ViewID");
+   if (viewIter == request.end())
+   {
+      pWindow = dynamic_cast<SpatialDataWindow*>(Service<DesktopServices>()->getCurrentWorkspaceWindow());
+   }
+   else
+   {
+      pWindow = dynamic_cast<SpatialDataWindow*>(
+         Service<SessionManager>()->getSessionItem(viewIter.value().toStdString()));
+   }
+
+   SpatialDataView* pView = (pWindow == NULL) ? NULL : pWindow->getSpatialDataView();
+   RasterElement* pElement = (pView == NULL) ? NULL : pView->getLayerList()->getPrimaryRasterElement();
+   if (pElement == NULL)
+   {
+      return r;
+   }
+
+   RasterTransfer transfer(pElement);
+   QByteArray chunk;
+   if (!transfer.setRequest(request) || !transfer.read(chunk))
+   {
+      r.mCode = HTTPRESPONSECODE_400_BADREQUEST;
+      r.mBody = "<html><body><h1>Bad request</h1>The requested subcube is not valid.</body></html>";
+      return r;
+   }
+
+   r.mCode = HTTPRESPONSECODE_200_OK;
+   r.mHeaders["content-type"] = "application/octet-stream";
+   r.mHeaders["X-Offset"] = QString::number(transfer.getOffset());
+   r.mHeaders["X-Total-Bytes"] = QString::number(transfer.getTotalBytes());
+   r.mHeaders["X-Interleave"] = QString::fromStdString(StringUtilities::toXmlString(transfer.getInterleave()));
+   r.mBody.clear();
+   r.mOctets = chunk;
+   r.mEncoding = Response::OCTET;
+   return r;
+}
@@ -0,0 +1,98 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RASTERTRANSFER_H
+#define RASTERTRANSFER_H
+
+#include "AppConfig.h"
+#include "MuHttpServer.h"
+#include "TypesFile.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+
+class RasterDataDescriptor;
+class RasterElement;
+
+/**
+ * Reads a subcube of a raster element as a stream of bytes in a requested interleave.
+ *
+ * The stream is read in chunks of at most MAX_CHUNK_BYTES starting at any byte offset
+ * so that a client can transfer an arbitrarily large subcube without the server holding
+ * more than one chunk in memory. Values are in the host byte order.
+ *
+ * The subcube is described by a map with the optional keys StartRow, EndRow, StartColumn,
+ * EndColumn, StartBand and EndBand (inclusive, zero-based active numbers which default
+ * to the full extent), Interleave (BIP, BIL or BSQ which defaults to the element's
+ * interleave), Offset (the byte offset of the chunk which defaults to zero) and Length
+ * (the maximum number of bytes in the chunk).
+ */
+class RasterTransfer
+{
+public:
+   static const unsigned int MAX_CHUNK_BYTES = 16 * 1024 * 1024;
+
+   explicit RasterTransfer(RasterElement* pElement);
+
+   bool setRequest(const QMap<QString, QString>& request);
+   bool isValid() const;
+
+   uint64_t getOffset() const;
+   uint64_t getTotalBytes() const;
+   InterleaveFormatType getInterleave() const;
+
+   bool read(QByteArray& chunk) const;
+
+private:
+   RasterTransfer(const RasterTransfer& rhs);
+   RasterTransfer& operator=(const RasterTransfer& rhs);
+
+   size_t getLineBytes() const;
+   void copyLine(const char* pRow, char* pDestination) const;
+
+   RasterElement* mpElement;
+   const RasterDataDescriptor* mpDescriptor;
+   bool mValid;
+   unsigned int mStartRow;
+   unsigned int mRowCount;
+   unsigned int mStartColumn;
+   unsigned int mColumnCount;
+   unsigned int mStartBand;
+   unsigned int mBandCount;
+   InterleaveFormatType mInterleave;
+   uint64_t mOffset;
+   unsigned int mLength;
+};
+
+/**
+ * Publishes raster subcubes as raw octets via HTTP.
+ *
+ * This is a binary side channel for opticks.raster.getSubcube which avoids
+ * the base64 encoding of the XML-RPC response. The request is the same map
+ * as RasterTransfer passed as form values along with an optional ViewID.
+ * The response headers X-Offset and X-Total-Bytes describe the position of
+ * the returned chunk in the subcube.
+ */
+class RasterTransferHandler : public MuHttpServer
+{
+public:
+   RasterTransferHandler(QObject* pParent = NULL);
+   ~RasterTransferHandler();
+
+protected:
+   MuHttpServer::Response getRequest(const QString& uri, const QString& contentType, const QString& body,
+      const FormValueMap& form);
+
+private:
+   RasterTransferHandler(const RasterTransferHandler& rhs);
+   RasterTransferHandler& operator=(const RasterTransferHandler& rhs);
+};
+
+#endif
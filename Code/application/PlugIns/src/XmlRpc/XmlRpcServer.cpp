@@ -15,6 +15,7 @@
 #include "IntrospectionMethods.h"
 #include "MessageLogResource.h"
 #include "PlugInRegistration.h"
+#include "RasterTransfer.h"
 #include "UtilityServices.h"
 #include "XmlRpcServer.h"
 #include "xmlreader.h"
@@ -40,6 +41,7 @@ XmlRpcServer::XmlRpcServer() : MuHttpServer(getSettingXmlRpcServerPort(), NULL)
    executeOnStartup(true);
    setWizardSupported(false);
    registerPath("images", new ImageHandler(this));
+   registerPath("raster", new RasterTransferHandler(this));
 }
 
 XmlRpcServer::~XmlRpcServer()
@@ -81,6 +83,9 @@ bool XmlRpcServer::execute(PlugInArgList *pInArgList, PlugInArgList *pOutArgList
    registerMethodCall("opticks.open", new OpticksXmlRpcMethods::Open);
    registerMethodCall("opticks.panBy", new OpticksXmlRpcMethods::PanBy);
    registerMethodCall("opticks.panTo", new OpticksXmlRpcMethods::PanTo);
+   registerMethodCall("opticks.raster.getInfo", new OpticksXmlRpcMethods::Raster::GetInfo);
+   registerMethodCall("opticks.raster.getStatistics", new OpticksXmlRpcMethods::Raster::GetStatistics);
+   registerMethodCall("opticks.raster.getSubcube", new OpticksXmlRpcMethods::Raster::GetSubcube);
    registerMethodCall("opticks.registerCallback", new OpticksXmlRpcMethods::RegisterCallback(*this));
    registerMethodCall("opticks.rotateBy", new OpticksXmlRpcMethods::RotateBy);
    registerMethodCall("opticks.rotateTo", new OpticksXmlRpcMethods::RotateTo);
@@ -25,6 +25,7 @@
 #include "switchOnEncoding.h"
 #include "TypeConverter.h"
 
+#include <memory>
 #include <vector>
 
 namespace
@@ -185,6 +186,115 @@ namespace
          }
       }
    }
+
+   struct DataBlockImp : public DataBlock
+   {
+      RasterElement* mpElement;
+      DataAccessorImpl* mpAccessor;
+      char* mpBuffer;
+      DataPointerArgs mArgs;
+      bool mWritable;
+   };
+
+   inline void copyBytes(char* pPage, char* pBlock, size_t size, bool push)
+   {
+      if (push)
+      {
+         memcpy(pPage, pBlock, size);
+      }
+      else
+      {
+         memcpy(pBlock, pPage, size);
+      }
+   }
+
+   /**
+    * Copies a subcube between a RasterElement and a packed buffer in the element's interleave.
+    * Each line of a row is copied with a single memcpy() instead of one call per pixel.
+    */
+   bool copyBlock(RasterElement* pElement, const DataPointerArgs& args, char* pBuffer, bool push)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+      size_t bytesPerElement = pDesc->getBytesPerElement();
+      unsigned int rows = args.rowEnd - args.rowStart + 1;
+      unsigned int columns = args.columnEnd - args.columnStart + 1;
+      unsigned int bands = args.bandEnd - args.bandStart + 1;
+      size_t lineSize = columns * bytesPerElement;
+
+      // BSQ needs an accessor for each band, BIP and BIL read every band of a row through a single accessor
+      unsigned int accessorCount = (interleave == BSQ ? bands : 1);
+      for (unsigned int accessorIndex = 0; accessorIndex < accessorCount; ++accessorIndex)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setWritable(push);
+         pRequest->setInterleaveFormat(interleave);
+         pRequest->setRows(pDesc->getActiveRow(args.rowStart), pDesc->getActiveRow(args.rowEnd));
+         pRequest->setColumns(pDesc->getActiveColumn(args.columnStart),
+            pDesc->getActiveColumn(args.columnEnd), columns);
+         if (interleave == BSQ)
+         {
+            pRequest->setBands(pDesc->getActiveBand(args.bandStart + accessorIndex),
+               pDesc->getActiveBand(args.bandStart + accessorIndex), 1);
+         }
+         DataAccessor daImage = pElement->getDataAccessor(pRequest.release());
+         if (!daImage.isValid() || (interleave != BSQ && daImage->getConcurrentBands() <= args.bandEnd))
+         {
+            return false;
+         }
+
+         for (unsigned int row = 0; row < rows; ++row)
+         {
+            daImage->toPixel(args.rowStart + row, args.columnStart);
+            if (!daImage.isValid())
+            {
+               return false;
+            }
+
+            char* pPage = reinterpret_cast<char*>(daImage->getColumn());
+            switch (interleave)
+            {
+            case BIP:
+               {
+                  size_t pagePixelSize = daImage->getConcurrentBands() * bytesPerElement;
+                  size_t blockPixelSize = bands * bytesPerElement;
+                  char* pBlock = pBuffer + row * columns * blockPixelSize;
+                  pPage += args.bandStart * bytesPerElement;
+                  if (pagePixelSize == blockPixelSize)
+                  {
+                     copyBytes(pPage, pBlock, columns * blockPixelSize, push);
+                  }
+                  else
+                  {
+                     for (unsigned int col = 0; col < columns; ++col)
+                     {
+                        copyBytes(pPage + col * pagePixelSize, pBlock + col * blockPixelSize, blockPixelSize, push);
+                     }
+                  }
+                  break;
+               }
+            case BIL:
+               {
+                  size_t pageLineSize = daImage->getConcurrentColumns() * bytesPerElement;
+                  char* pBlock = pBuffer + row * bands * lineSize;
+                  for (unsigned int band = 0; band < bands; ++band)
+                  {
+                     copyBytes(pPage + (args.bandStart + band) * pageLineSize, pBlock + band * lineSize,
+                        lineSize, push);
+                  }
+                  break;
+               }
+            case BSQ:
+               copyBytes(pPage, pBuffer + (accessorIndex * rows + row) * lineSize, lineSize, push);
+               break;
+            default:
+               return false;
+            }
+         }
+      }
+
+      return true;
+   }
 }
 
 extern "C"
@@ -477,6 +587,185 @@ extern "C"
       setLastError(SIMPLE_NO_ERROR);
    }
 
+   DataBlock* createDataBlock(DataElement* pElement, DataPointerArgs* pArgs, int writable)
+   {
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(pElement);
+      if (pRaster == NULL)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      unsigned int numRows = pDesc->getRowCount();
+      unsigned int numColumns = pDesc->getColumnCount();
+      unsigned int numBands = pDesc->getBandCount();
+      DataPointerArgs args = {
+         0, numRows - 1,
+         0, numColumns - 1,
+         0, numBands - 1,
+         static_cast<uint32_t>(pDesc->getInterleaveFormat()) };
+      if (pArgs != NULL)
+      {
+         args = *pArgs;
+      }
+      if (args.rowStart > args.rowEnd || args.rowEnd >= numRows ||
+         args.columnStart > args.columnEnd || args.columnEnd >= numColumns ||
+         args.bandStart > args.bandEnd || args.bandEnd >= numBands)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
+      }
+
+      std::auto_ptr<DataBlockImp> pBlock(new DataBlockImp);
+      pBlock->numRows = args.rowEnd - args.rowStart + 1;
+      pBlock->numColumns = args.columnEnd - args.columnStart + 1;
+      pBlock->numBands = args.bandEnd - args.bandStart + 1;
+      pBlock->encodingType = static_cast<uint32_t>(pDesc->getDataType());
+      pBlock->encodingTypeSize = pDesc->getBytesPerElement();
+      pBlock->copied = 0;
+      pBlock->mpElement = pRaster;
+      pBlock->mpAccessor = NULL;
+      pBlock->mpBuffer = NULL;
+      pBlock->mArgs = args;
+      pBlock->mWritable = (writable != 0);
+
+      InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+      uint64_t bytesPerElement = pBlock->encodingTypeSize;
+
+      // In-memory data can be addressed directly for any subcube
+      char* pRawData = reinterpret_cast<char*>(pRaster->getRawData());
+      if (pRawData != NULL)
+      {
+         switch (interleave)
+         {
+         case BIP:
+            pBlock->bandStride = bytesPerElement;
+            pBlock->columnStride = numBands * bytesPerElement;
+            pBlock->rowStride = numColumns * pBlock->columnStride;
+            break;
+         case BIL:
+            pBlock->columnStride = bytesPerElement;
+            pBlock->bandStride = numColumns * bytesPerElement;
+            pBlock->rowStride = numBands * pBlock->bandStride;
+            break;
+         default:
+            pBlock->columnStride = bytesPerElement;
+            pBlock->rowStride = numColumns * bytesPerElement;
+            pBlock->bandStride = numRows * pBlock->rowStride;
+            break;
+         }
+         pBlock->pData = pRawData + args.rowStart * pBlock->rowStride + args.columnStart * pBlock->columnStride +
+            args.bandStart * pBlock->bandStride;
+         setLastError(SIMPLE_NO_ERROR);
+         return pBlock.release();
+      }
+
+      // When a single page holds the whole subcube, pin the page by keeping its accessor until the block is destroyed
+      if (interleave != BSQ || args.bandStart == args.bandEnd)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setWritable(writable != 0);
+         pRequest->setInterleaveFormat(interleave);
+         pRequest->setRows(pDesc->getActiveRow(args.rowStart), pDesc->getActiveRow(args.rowEnd), pBlock->numRows);
+         pRequest->setColumns(pDesc->getActiveColumn(args.columnStart),
+            pDesc->getActiveColumn(args.columnEnd), pBlock->numColumns);
+         if (interleave == BSQ)
+         {
+            pRequest->setBands(pDesc->getActiveBand(args.bandStart), pDesc->getActiveBand(args.bandStart), 1);
+         }
+         DataAccessor daImage = pRaster->getDataAccessor(pRequest.release());
+         if (daImage.isValid() && daImage->getConcurrentRows() >= pBlock->numRows &&
+            daImage->getConcurrentColumns() >= pBlock->numColumns &&
+            (interleave == BSQ || daImage->getConcurrentBands() > args.bandEnd))
+         {
+            DataAccessorImpl* pAccessor = daImage.operator->();
+            char* pPage = reinterpret_cast<char*>(pAccessor->getRow());
+            pBlock->rowStride = pAccessor->getRowStride();
+            switch (interleave)
+            {
+            case BIP:
+               pBlock->bandStride = bytesPerElement;
+               pBlock->columnStride = pAccessor->getConcurrentBands() * bytesPerElement;
+               break;
+            case BIL:
+               pBlock->columnStride = bytesPerElement;
+               pBlock->bandStride = pAccessor->getConcurrentColumns() * bytesPerElement;
+               break;
+            default:
+               pBlock->columnStride = bytesPerElement;
+               pBlock->bandStride = pBlock->numRows * pBlock->rowStride;
+               break;
+            }
+            pBlock->pData = (interleave == BSQ ? pPage : pPage + args.bandStart * pBlock->bandStride);
+            pAccessor->incrementRefCount();
+            pBlock->mpAccessor = pAccessor;
+            setLastError(SIMPLE_NO_ERROR);
+            return pBlock.release();
+         }
+      }
+
+      // Otherwise read the subcube into a packed buffer with one bulk copy
+      size_t blockSize = static_cast<size_t>(pBlock->numRows) * pBlock->numColumns * pBlock->numBands *
+         pBlock->encodingTypeSize;
+      pBlock->mpBuffer = new (std::nothrow) char[blockSize];
+      if (pBlock->mpBuffer == NULL)
+      {
+         setLastError(SIMPLE_NO_MEM);
+         return NULL;
+      }
+      switch (interleave)
+      {
+      case BIP:
+         pBlock->bandStride = bytesPerElement;
+         pBlock->columnStride = pBlock->numBands * bytesPerElement;
+         pBlock->rowStride = pBlock->numColumns * pBlock->columnStride;
+         break;
+      case BIL:
+         pBlock->columnStride = bytesPerElement;
+         pBlock->bandStride = pBlock->numColumns * bytesPerElement;
+         pBlock->rowStride = pBlock->numBands * pBlock->bandStride;
+         break;
+      default:
+         pBlock->columnStride = bytesPerElement;
+         pBlock->rowStride = pBlock->numColumns * bytesPerElement;
+         pBlock->bandStride = pBlock->numRows * pBlock->rowStride;
+         break;
+      }
+      if (!copyBlock(pRaster, args, pBlock->mpBuffer, false))
+      {
+         delete [] pBlock->mpBuffer;
+         setLastError(SIMPLE_OTHER_FAILURE);
+         return NULL;
+      }
+      pBlock->pData = pBlock->mpBuffer;
+      pBlock->copied = 1;
+      setLastError(SIMPLE_NO_ERROR);
+      return pBlock.release();
+   }
+
+   int destroyDataBlock(DataBlock* pBlock)
+   {
+      DataBlockImp* pBlockImp = static_cast<DataBlockImp*>(pBlock);
+      if (pBlockImp == NULL)
+      {
+         return 0;
+      }
+
+      int rval = 0;
+      if (pBlockImp->mpBuffer != NULL)
+      {
+         if (pBlockImp->mWritable && !copyBlock(pBlockImp->mpElement, pBlockImp->mArgs, pBlockImp->mpBuffer, true))
+         {
+            setLastError(SIMPLE_OTHER_FAILURE);
+            rval = 1;
+         }
+         delete [] pBlockImp->mpBuffer;
+      }
+      destroyDataAccessor(pBlockImp->mpAccessor);
+      delete pBlockImp;
+      return rval;
+   }
+
    DataAccessorImpl* createDataAccessor(DataElement* pElement, DataAccessorArgs* pArgs)
    {
       RasterElement* pRasterElement = dynamic_cast<RasterElement*>(pElement);
@@ -230,6 +230,71 @@ extern "C"
     */
    EXPORT_SYMBOL void updateRasterElement(DataElement* pElement);
 
+   /**
+    * Description of a rectangular subcube of raster data in memory.
+    *
+    * The element at (row, column, band) of the block is located at
+    * <tt>(char*)pData + row * rowStride + column * columnStride + band * bandStride</tt>.
+    * The strides are in bytes and follow the interleave of the RasterElement, so they
+    * may be passed directly to array libraries such as numpy.
+    *
+    * @see createDataBlock()
+    */
+   struct DataBlock
+   {
+      void* pData;               /**< The first element of the block. */
+      uint32_t numRows;          /**< The number of rows in the block. */
+      uint32_t numColumns;       /**< The number of columns in the block. */
+      uint32_t numBands;         /**< The number of bands in the block. */
+      uint64_t rowStride;        /**< The number of bytes between consecutive rows. */
+      uint64_t columnStride;     /**< The number of bytes between consecutive columns. */
+      uint64_t bandStride;       /**< The number of bytes between consecutive bands. */
+      uint32_t encodingType;     /**< The data type of each element.  @see DataInfo::encodingType */
+      uint32_t encodingTypeSize; /**< The number of bytes per element. */
+      uint32_t copied;           /**< 0 -> pData points at the original data,
+                                      Any other value -> pData points at a copy of the data. */
+   };
+
+   /**
+    * Obtain a pinned pointer to a subcube of raw data which must be released by calling destroyDataBlock().
+    *
+    * When the data is in memory, or a single pager page holds the entire requested subcube, the block points
+    * directly at the original data and no copy is made.  Otherwise, the subcube is read into a new buffer with a
+    * single bulk copy.  In either case the memory remains valid until destroyDataBlock() is called, so it may be
+    * wrapped as an array without any further calls.
+    *
+    * @param pElement
+    *        The RasterElement to access.
+    * @param pArgs
+    *        The structure containing information to process the request or \c NULL to access the entire cube.
+    *        The interleaveFormat member is ignored; the strides of the returned block describe the layout.
+    * @param writable
+    *        0 -> The block will only be read, Any other value -> The block may be modified.
+    *        If the block is a copy, the modified data is written to the RasterElement by destroyDataBlock().
+    * @return A newly-created DataBlock which must be destroyed by calling destroyDataBlock().
+    *         On failure, \c NULL is returned and getLastError() may be queried for information on the error.
+    *
+    * @see getDataElement(), destroyDataBlock(), createDataPointer()
+    */
+   EXPORT_SYMBOL DataBlock* createDataBlock(DataElement* pElement, DataPointerArgs* pArgs, int writable);
+
+   /**
+    * Release a DataBlock obtained by calling createDataBlock().
+    *
+    * If the block is a writable copy, the data is written back to the RasterElement first.
+    * The caller should call updateRasterElement() to redisplay modified data.
+    *
+    * Suitable for use as a cleanup callback.
+    *
+    * @param pBlock
+    *        The DataBlock to release.  The pData member must not be used after this call.
+    *
+    * @return a non-zero if writing back a modified copy failed or a zero on success.
+    *
+    * @see createDataBlock(), updateRasterElement()
+    */
+   EXPORT_SYMBOL int destroyDataBlock(DataBlock* pBlock);
+
    /**
     * Descriptor for data access.
     * Rows, columns, and bands are all 0-based and reflect active numbers.
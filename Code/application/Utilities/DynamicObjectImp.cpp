@@ -85,6 +85,7 @@ DynamicObjectImp& DynamicObjectImp::operator=(const DynamicObjectImp& rhs)
       return *this;
    }
 
+   SignalBatch batch(*this, true);
    clear();
    map<string, DataVariant>::const_iterator pPair;
    for (pPair = rhs.mVariantAttributes.begin(); pPair != rhs.mVariantAttributes.end(); ++pPair)
@@ -105,6 +106,10 @@ void DynamicObjectImp::merge(const DynamicObject* pObject)
    vector<string> attributes;
    pObject->getAttributeNames(attributes);
 
+   // Attribute signals are notified as each attribute is set, but Subject::Modified,
+   // which is also notified by modified child objects, is only notified once
+   SignalBatch batch(*this, true);
+
    vector<string>::const_iterator iter;
    for (iter = attributes.begin(); iter != attributes.end(); iter++)
    {
@@ -140,6 +145,8 @@ void DynamicObjectImp::adoptiveMerge(DynamicObject* pObject)
    vector<string> attributes;
    pObject->getAttributeNames(attributes);
 
+   SignalBatch batch(*this, true);
+
    vector<string>::const_iterator iter;
    for (iter = attributes.begin(); iter != attributes.end(); ++iter)
    {
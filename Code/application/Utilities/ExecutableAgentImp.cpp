@@ -12,6 +12,7 @@
 #include "Executable.h"
 #include "ExecutableAgentImp.h"
 #include "GraphicLayer.h"
+#include "InstrumentationImp.h"
 #include "LayerList.h"
 #include "PlugIn.h"
 #include "PlugInArg.h"
@@ -39,7 +40,9 @@ ExecutableAgentImp::ExecutableAgentImp() :
    mpProgress(NULL),
    mPlugInProgress(false),
    mProgressDialog(false),
-   mAutoInArg(true)
+   mAutoInArg(true),
+   mpCountedPlugIn(NULL),
+   mExecuteCounterId(0)
 {
 }
 
@@ -242,8 +245,22 @@ bool ExecutableAgentImp::executePlugIn()
             pProgressImp->setPlugIn(pPlugIn);
          }
 
+         InstrumentationImp* pInstrumentation = InstrumentationImp::instance();
+         bool instrumented = pInstrumentation->isEnabled();
+         if (instrumented && mpCountedPlugIn != pPlugIn)
+         {
+            mExecuteCounterId = pInstrumentation->getCounterId("PlugIn::execute/" + pPlugIn->getName());
+            mpCountedPlugIn = pPlugIn;
+         }
+         int64_t executeStart = instrumented ? pInstrumentation->getTime() : 0;
+
          bSuccess = pExecutable->execute(&inArgList, &outArgList);
 
+         if (instrumented)
+         {
+            pInstrumentation->addSpan(mExecuteCounterId, executeStart, pInstrumentation->getTime());
+         }
+
          if (pProgressImp != NULL)
          {
             pProgressImp->setPlugIn(pPreviousPlugIn);
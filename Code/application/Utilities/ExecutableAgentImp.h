@@ -98,6 +98,8 @@ private:
    bool mProgressDialog;
    PlugInResource mPlugIn;
    bool mAutoInArg;
+   const PlugIn* mpCountedPlugIn;
+   unsigned int mExecuteCounterId;
 };
 
 #define EXECUTABLEAGENTADAPTER_METHODS(impClass) \
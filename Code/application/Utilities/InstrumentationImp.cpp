@@ -0,0 +1,385 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "InstrumentationImp.h"
+
+#include <fstream>
+#include <stdexcept>
+using namespace std;
+
+InstrumentationImp* InstrumentationImp::spInstance = NULL;
+bool InstrumentationImp::mDestroyed = false;
+
+InstrumentationImp* InstrumentationImp::instance()
+{
+   if (spInstance == NULL)
+   {
+      spInstance = new InstrumentationImp;
+   }
+
+   return spInstance;
+}
+
+void InstrumentationImp::destroy()
+{
+   if (mDestroyed)
+   {
+      throw std::logic_error("Attempting to destroy Instrumentation after "
+         "destroying it.");
+   }
+
+   mDestroyed = true;
+   if (spInstance != NULL)
+   {
+      spInstance->mEnabled = false;
+      spInstance->mTracing = false;
+      spInstance->reset();
+   }
+}
+
+InstrumentationImp::ThreadData::ThreadData(unsigned int index) :
+   mNextEvent(0),
+   mWrapped(false),
+   mIndex(index),
+   mInUse(true)
+{
+   for (unsigned int i = 0; i < sMaxCounters; ++i)
+   {
+      mTotals[i] = 0;
+      mCounts[i] = 0;
+   }
+}
+
+InstrumentationImp::ThreadSlot::ThreadSlot(ThreadData* pData) :
+   mpData(pData)
+{
+}
+
+InstrumentationImp::ThreadSlot::~ThreadSlot()
+{
+   releaseThreadData(mpData);
+}
+
+InstrumentationImp::InstrumentationImp() :
+   mEnabled(false),
+   mTracing(false),
+   mpSlots(new QThreadStorage<ThreadSlot*>)
+{
+   mTimer.start();
+}
+
+InstrumentationImp::~InstrumentationImp()
+{
+   // Threads which are still running will not release their slots until after this object
+   // is gone, so releaseThreadData() checks spInstance before touching the thread data.
+   spInstance = NULL;
+   delete mpSlots;
+   for (vector<ThreadData*>::iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   {
+      delete *iter;
+   }
+}
+
+void InstrumentationImp::setEnabled(bool enabled)
+{
+   mEnabled = enabled && !mDestroyed;
+}
+
+bool InstrumentationImp::isEnabled() const
+{
+   return mEnabled;
+}
+
+void InstrumentationImp::setTracing(bool tracing)
+{
+   mTracing = tracing && !mDestroyed;
+}
+
+bool InstrumentationImp::isTracing() const
+{
+   return mTracing;
+}
+
+unsigned int InstrumentationImp::getCounterId(const string& name)
+{
+   mta::MutexLock lock(mMutex);
+   map<string, unsigned int>::const_iterator iter = mIds.find(name);
+   if (iter != mIds.end())
+   {
+      return iter->second;
+   }
+
+   if (mNames.size() >= sMaxCounters)
+   {
+      return sMaxCounters;
+   }
+
+   unsigned int id = static_cast<unsigned int>(mNames.size());
+   mNames.push_back(name);
+   mIds[name] = id;
+   return id;
+}
+
+unsigned int InstrumentationImp::getMaxCounters() const
+{
+   return sMaxCounters;
+}
+
+void InstrumentationImp::addToCounter(unsigned int id, int64_t value)
+{
+   if (mEnabled == false || id >= sMaxCounters)
+   {
+      return;
+   }
+
+   ThreadData* pData = getThreadData();
+   pData->mTotals[id] += value;
+   ++pData->mCounts[id];
+}
+
+int64_t InstrumentationImp::getTime() const
+{
+   return mTimer.nsecsElapsed() / 1000;
+}
+
+void InstrumentationImp::addSpan(unsigned int id, int64_t start, int64_t end)
+{
+   if (mEnabled == false || id >= sMaxCounters)
+   {
+      return;
+   }
+
+   ThreadData* pData = getThreadData();
+   pData->mTotals[id] += end - start;
+   ++pData->mCounts[id];
+
+   if (mTracing)
+   {
+      mta::MutexLock lock(pData->mEventMutex);
+      if (pData->mEvents.empty())
+      {
+         pData->mEvents.resize(sMaxTraceEvents);
+      }
+
+      TraceEvent& event = pData->mEvents[pData->mNextEvent];
+      event.mId = id;
+      event.mStart = start;
+      event.mDuration = end - start;
+      if (++pData->mNextEvent == pData->mEvents.size())
+      {
+         pData->mNextEvent = 0;
+         pData->mWrapped = true;
+      }
+   }
+}
+
+vector<string> InstrumentationImp::getCounterNames() const
+{
+   mta::MutexLock lock(mMutex);
+   return mNames;
+}
+
+int64_t InstrumentationImp::getCounterTotal(const string& name) const
+{
+   unsigned int id = findCounter(name);
+   if (id >= sMaxCounters)
+   {
+      return 0;
+   }
+
+   mta::MutexLock lock(mMutex);
+   int64_t total = 0;
+   for (vector<ThreadData*>::const_iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   {
+      total += (*iter)->mTotals[id];
+   }
+
+   return total;
+}
+
+int64_t InstrumentationImp::getCounterCount(const string& name) const
+{
+   unsigned int id = findCounter(name);
+   if (id >= sMaxCounters)
+   {
+      return 0;
+   }
+
+   mta::MutexLock lock(mMutex);
+   int64_t count = 0;
+   for (vector<ThreadData*>::const_iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   {
+      count += (*iter)->mCounts[id];
+   }
+
+   return count;
+}
+
+void InstrumentationImp::reset()
+{
+   mta::MutexLock lock(mMutex);
+   for (vector<ThreadData*>::iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   {
+      ThreadData* pData = *iter;
+      for (unsigned int i = 0; i < sMaxCounters; ++i)
+      {
+         pData->mTotals[i] = 0;
+         pData->mCounts[i] = 0;
+      }
+
+      mta::MutexLock eventLock(pData->mEventMutex);
+      pData->mNextEvent = 0;
+      pData->mWrapped = false;
+   }
+}
+
+bool InstrumentationImp::writeChromeTrace(const string& filename) const
+{
+   ofstream output(filename.c_str());
+   if (output.is_open() == false)
+   {
+      return false;
+   }
+
+   mta::MutexLock lock(mMutex);
+   bool first = true;
+   output << "{\"traceEvents\":[";
+   vector<TraceEvent> events;
+   for (vector<ThreadData*>::const_iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   {
+      ThreadData* pData = *iter;
+
+      // Copy the events, oldest first when the buffer has wrapped, so the
+      // thread can keep adding spans while the file is written
+      events.clear();
+      {
+         mta::MutexLock eventLock(pData->mEventMutex);
+         if (pData->mWrapped)
+         {
+            events.assign(pData->mEvents.begin() + pData->mNextEvent, pData->mEvents.end());
+         }
+         events.insert(events.end(), pData->mEvents.begin(), pData->mEvents.begin() + pData->mNextEvent);
+      }
+
+      if (events.empty())
+      {
+         continue;
+      }
+
+      output << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" <<
+         pData->mIndex << ",\"args\":{\"name\":\"Thread " << pData->mIndex << "\"}}";
+      first = false;
+
+      for (vector<TraceEvent>::const_iterator eventIter = events.begin(); eventIter != events.end(); ++eventIter)
+      {
+         const TraceEvent& event = *eventIter;
+         if (event.mId >= mNames.size())
+         {
+            continue;
+         }
+
+         // Counter names are identifiers and plug-in names, so only quotes and backslashes need escaping
+         string name = mNames[event.mId];
+         for (string::size_type pos = name.find_first_of("\"\\"); pos != string::npos;
+            pos = name.find_first_of("\"\\", pos + 2))
+         {
+            name.insert(pos, "\\");
+         }
+
+         output << ",\n{\"name\":\"" << name << "\",\"cat\":\"opticks\",\"ph\":\"X\",\"ts\":" << event.mStart <<
+            ",\"dur\":" << event.mDuration << ",\"pid\":1,\"tid\":" << pData->mIndex << "}";
+      }
+   }
+   output << "\n]}\n";
+
+   return output.good();
+}
+
+void InstrumentationImp::getTotals(vector<int64_t>& totals, vector<int64_t>& counts) const
+{
+   totals.assign(sMaxCounters, 0);
+   counts.assign(sMaxCounters, 0);
+
+   mta::MutexLock lock(mMutex);
+   for (vector<ThreadData*>::const_iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   {
+      for (unsigned int i = 0; i < mNames.size(); ++i)
+      {
+         totals[i] += (*iter)->mTotals[i];
+         counts[i] += (*iter)->mCounts[i];
+      }
+   }
+}
+
+string InstrumentationImp::getCounterName(unsigned int id) const
+{
+   mta::MutexLock lock(mMutex);
+   if (id < mNames.size())
+   {
+      return mNames[id];
+   }
+
+   return string();
+}
+
+InstrumentationImp::ThreadData* InstrumentationImp::getThreadData()
+{
+   ThreadSlot* pSlot = mpSlots->localData();
+   if (pSlot != NULL)
+   {
+      return pSlot->mpData;
+   }
+
+   // First use from this thread, so reuse the data of a thread which has exited
+   ThreadData* pData = NULL;
+   {
+      mta::MutexLock lock(mMutex);
+      for (vector<ThreadData*>::iterator iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+      {
+         if ((*iter)->mInUse == false)
+         {
+            pData = *iter;
+            pData->mInUse = true;
+            break;
+         }
+      }
+
+      if (pData == NULL)
+      {
+         pData = new ThreadData(static_cast<unsigned int>(mThreads.size()));
+         mThreads.push_back(pData);
+      }
+   }
+
+   mpSlots->setLocalData(new ThreadSlot(pData));
+   return pData;
+}
+
+void InstrumentationImp::releaseThreadData(ThreadData* pData)
+{
+   if (spInstance == NULL || pData == NULL)
+   {
+      return;
+   }
+
+   mta::MutexLock lock(spInstance->mMutex);
+   pData->mInUse = false;
+}
+
+unsigned int InstrumentationImp::findCounter(const string& name) const
+{
+   mta::MutexLock lock(mMutex);
+   map<string, unsigned int>::const_iterator iter = mIds.find(name);
+   if (iter == mIds.end())
+   {
+      return sMaxCounters;
+   }
+
+   return iter->second;
+}
@@ -0,0 +1,129 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2015 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef INSTRUMENTATIONIMP_H
+#define INSTRUMENTATIONIMP_H
+
+#include "DMutex.h"
+#include "Instrumentation.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadStorage>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class InstrumentationImp : public Instrumentation
+{
+public:
+   static InstrumentationImp* instance();
+
+   /**
+    *  Disables the instrumentation and discards the recorded values.
+    *
+    *  The object itself is not deleted since InstrumentationCounter objects
+    *  in plug-ins keep a pointer to it, and may be used from static
+    *  destructors which run after the application has shut down.
+    */
+   static void destroy();
+
+   void setEnabled(bool enabled);
+   bool isEnabled() const;
+   void setTracing(bool tracing);
+   bool isTracing() const;
+
+   unsigned int getCounterId(const std::string& name);
+   unsigned int getMaxCounters() const;
+   void addToCounter(unsigned int id, int64_t value);
+   int64_t getTime() const;
+   void addSpan(unsigned int id, int64_t start, int64_t end);
+
+   std::vector<std::string> getCounterNames() const;
+   int64_t getCounterTotal(const std::string& name) const;
+   int64_t getCounterCount(const std::string& name) const;
+   void reset();
+   bool writeChromeTrace(const std::string& filename) const;
+
+   /**
+    *  Sums the counters of all threads, indexed by counter identifier.
+    *
+    *  Used by StepImp to report the counters which changed while a step was
+    *  active.
+    */
+   void getTotals(std::vector<int64_t>& totals, std::vector<int64_t>& counts) const;
+   std::string getCounterName(unsigned int id) const;
+
+protected:
+   InstrumentationImp();
+   ~InstrumentationImp();
+
+private:
+   InstrumentationImp(const InstrumentationImp& rhs);
+   InstrumentationImp& operator=(const InstrumentationImp& rhs);
+
+   static const unsigned int sMaxCounters = 1024;
+   static const unsigned int sMaxTraceEvents = 65536;
+
+   struct TraceEvent
+   {
+      unsigned int mId;
+      int64_t mStart;
+      int64_t mDuration;
+   };
+
+   // Written only by the thread which owns it, so no locking is needed to
+   // accumulate values.  Readers may see slightly stale values.  Trace events
+   // are protected by mEventMutex so they can be written out while the thread
+   // is still adding spans; the owning thread is the only other user, so the
+   // lock is not contended.
+   struct ThreadData
+   {
+      ThreadData(unsigned int index);
+
+      int64_t mTotals[sMaxCounters];
+      int64_t mCounts[sMaxCounters];
+      mta::DMutex mEventMutex;
+      std::vector<TraceEvent> mEvents;
+      size_t mNextEvent;
+      bool mWrapped;
+      unsigned int mIndex;
+      bool mInUse;
+   };
+
+   // Owned by QThreadStorage so that the thread data can be reused once the
+   // thread exits.
+   class ThreadSlot
+   {
+   public:
+      ThreadSlot(ThreadData* pData);
+      ~ThreadSlot();
+
+      ThreadData* mpData;
+   };
+
+   ThreadData* getThreadData();
+   static void releaseThreadData(ThreadData* pData);
+   unsigned int findCounter(const std::string& name) const;
+
+   static InstrumentationImp* spInstance;
+   static bool mDestroyed;
+
+   volatile bool mEnabled;
+   volatile bool mTracing;
+   QElapsedTimer mTimer;
+
+   mutable mta::DMutex mMutex;
+   std::vector<std::string> mNames;
+   std::map<std::string, unsigned int> mIds;
+   std::vector<ThreadData*> mThreads;
+   QThreadStorage<ThreadSlot*>* mpSlots;
+};
+
+#endif
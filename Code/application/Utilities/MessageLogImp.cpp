@@ -13,6 +13,7 @@
 #include "DateTimeImp.h"
 #include "DynamicObjectAdapter.h"
 #include "FilenameImp.h"
+#include "InstrumentationImp.h"
 #include "Int64.h"
 #include "MessageLogAdapter.h"
 #include "UInt64.h"
@@ -1179,6 +1180,11 @@ StepImp::StepImp(const string& action, const string& component, const string& ke
    mResult(Message::Unresolved),
    mpCurrentStep(NULL)
 {
+   InstrumentationImp* pInstrumentation = InstrumentationImp::instance();
+   if (pInstrumentation->isEnabled())
+   {
+      pInstrumentation->getTotals(mInstrumentationTotals, mInstrumentationCounts);
+   }
 }
 
 StepImp::~StepImp()
@@ -1288,6 +1294,25 @@ bool StepImp::finalize(Message::Result result, const string& failureReason)
       return false;
    }
 
+   // Record the instrumentation counters which changed while this step was active
+   if (mInstrumentationTotals.empty() == false)
+   {
+      InstrumentationImp* pInstrumentation = InstrumentationImp::instance();
+      vector<int64_t> totals;
+      vector<int64_t> counts;
+      pInstrumentation->getTotals(totals, counts);
+      for (vector<int64_t>::size_type id = 0; id < counts.size() && id < mInstrumentationCounts.size(); ++id)
+      {
+         int64_t count = counts[id] - mInstrumentationCounts[id];
+         if (count > 0)
+         {
+            string name = pInstrumentation->getCounterName(static_cast<unsigned int>(id));
+            addProperty(name, Int64(totals[id] - mInstrumentationTotals[id]));
+            addProperty(name + " count", Int64(count));
+         }
+      }
+   }
+
    mResult = result;
    mFailureReason = failureReason;
    for (std::vector<Message*>::iterator it = mMessageList.begin(); it != mMessageList.end(); ++it)
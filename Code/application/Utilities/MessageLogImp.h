@@ -344,6 +344,10 @@ private:
    std::string mFailureReason;
    std::vector<Message*> mMessageList;
    Step* mpCurrentStep;
+
+   // Instrumentation counter values when the step was created, empty if instrumentation was disabled
+   std::vector<int64_t> mInstrumentationTotals;
+   std::vector<int64_t> mInstrumentationCounts;
 };
 
 #define MESSAGEADAPTEREXTENSION_CLASSES \